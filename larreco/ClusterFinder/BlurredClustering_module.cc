@@ -39,9 +39,14 @@
 
 // ROOT & C++ includes
 #include "TH2F.h"
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <map>
 
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 namespace cluster {
   class BlurredClustering;
 }
@@ -53,11 +58,18 @@ public:
 private:
   void produce(art::Event& evt) override;
 
+  /// Blur and cluster the hits of one plane, returning the final clusters
+  std::vector<art::PtrVector<recob::Hit>> ClusterPlane(cluster::BlurredClusteringAlg& blurredClusteringAlg,
+                                                       std::pair<int, int> const& plane,
+                                                       std::vector<art::Ptr<recob::Hit>> const& hits) const;
+
   std::string const fHitsModuleLabel, fTrackModuleLabel, fVertexModuleLabel, fPFParticleModuleLabel;
   bool const fCreateDebugPDF, fMergeClusters, fGlobalTPCRecon, fShowerReconOnly;
+  unsigned int const fNumThreads;
 
   // Create instances of algorithm classes to perform the clustering
   cluster::BlurredClusteringAlg fBlurredClusteringAlg;
+  std::vector<std::unique_ptr<cluster::BlurredClusteringAlg>> fWorkerClusteringAlgs; // the alg keeps the image of the plane being clustered, one per extra thread
   cluster::MergeClusterAlg fMergeClusterAlg;
   shower::TrackShowerSeparationAlg fTrackShowerSeparationAlg;
 };
@@ -72,10 +84,14 @@ cluster::BlurredClustering::BlurredClustering(fhicl::ParameterSet const &pset)
   , fMergeClusters{pset.get<bool>("MergeClusters")}
   , fGlobalTPCRecon{pset.get<bool>("GlobalTPCRecon")}
   , fShowerReconOnly{pset.get<bool>("ShowerReconOnly")}
+  , fNumThreads{fCreateDebugPDF ? 1 : std::max(pset.get<unsigned int>("NumThreads", 1), 1u)}
   , fBlurredClusteringAlg{pset.get<fhicl::ParameterSet>("BlurredClusterAlg")}
   , fMergeClusterAlg{pset.get<fhicl::ParameterSet>("MergeClusterAlg")}
   , fTrackShowerSeparationAlg{pset.get<fhicl::ParameterSet>("TrackShowerSeparationAlg")}
 {
+  for (unsigned int thread = 1; thread < fNumThreads; ++thread)
+    fWorkerClusteringAlgs.push_back(std::make_unique<cluster::BlurredClusteringAlg>(pset.get<fhicl::ParameterSet>("BlurredClusterAlg")));
+
   produces<std::vector<recob::Cluster>>();
   produces<art::Assns<recob::Cluster,recob::Hit>>();
 }
@@ -152,50 +168,32 @@ void cluster::BlurredClustering::produce(art::Event &evt)
     planeToHits[std::make_pair(planeNo, tpc)].push_back(hitToCluster);
   }
 
-  // Loop over views
+  // Cluster the views, spreading them over the threads in contiguous groups
+  std::vector<std::pair<int, int>> planes;
+  std::vector<std::vector<art::Ptr<recob::Hit>> const*> planeHits;
   for (auto const& [plane, hits] : planeToHits) {
-    std::vector<art::PtrVector<recob::Hit>> finalClusters;
-
-    // Implement the algorithm
-    if (hits.size() >= fBlurredClusteringAlg.GetMinSize()) {
-
-      // Convert hit map to TH2 histogram and blur it
-      auto const image = fBlurredClusteringAlg.ConvertRecobHitsToVector(hits);
-      auto const blurred = fBlurredClusteringAlg.GaussianBlur(image);
-
-       // Find clusters in histogram
-      std::vector<std::vector<int>> allClusterBins; // Vector of clusters (clusters are vectors of hits)
-      int numClusters = fBlurredClusteringAlg.FindClusters(blurred, allClusterBins);
-      mf::LogVerbatim("Blurred Clustering") << "Found " << numClusters << " clusters" << std::endl;
-
-      // Create output clusters from the vector of clusters made in FindClusters
-      std::vector<art::PtrVector<recob::Hit>> planeClusters;
-      fBlurredClusteringAlg.ConvertBinsToClusters(image, allClusterBins, planeClusters);
-
-      // Use the cluster merging algorithm
-      if (fMergeClusters) {
-        int numMergedClusters = fMergeClusterAlg.MergeClusters(planeClusters, finalClusters);
-        mf::LogVerbatim("Blurred Clustering") << "After merging, there are " << numMergedClusters << " clusters" << std::endl;
-      }
-      else finalClusters = planeClusters;
-
-      // Make the debug PDF
-      if (fCreateDebugPDF) {
-        std::stringstream name;
-        name << "blurred_image";
-        TH2F* imageHist = fBlurredClusteringAlg.MakeHistogram(image, TString{name.str()});
-        name << "_convolved";
-        TH2F* blurredHist = fBlurredClusteringAlg.MakeHistogram(blurred, TString{name.str()});
-        auto const [planeNo, tpc] = plane;
-        fBlurredClusteringAlg.SaveImage(imageHist, 1, tpc, planeNo);
-        fBlurredClusteringAlg.SaveImage(blurredHist, 2, tpc, planeNo);
-        fBlurredClusteringAlg.SaveImage(blurredHist, allClusterBins, 3, tpc, planeNo);
-        fBlurredClusteringAlg.SaveImage(imageHist, finalClusters, 4, tpc, planeNo);
-        imageHist->Delete();
-        blurredHist->Delete();
-      }
-
-    } // End min hits check
+    planes.push_back(plane);
+    planeHits.push_back(&hits);
+  }
+
+  std::vector<std::vector<art::PtrVector<recob::Hit>>> planeFinalClusters(planes.size());
+  size_t const numGroups = std::min(static_cast<size_t>(fNumThreads), planes.size());
+
+  auto clusterGroup = [&](size_t const group) {
+    auto& blurredClusteringAlg = group == 0 ? fBlurredClusteringAlg : *fWorkerClusteringAlgs[group-1];
+    for (size_t planeIt = group * planes.size() / numGroups; planeIt < (group + 1) * planes.size() / numGroups; ++planeIt)
+      planeFinalClusters[planeIt] = ClusterPlane(blurredClusteringAlg, planes[planeIt], *planeHits[planeIt]);
+  };
+
+  if (numGroups > 1) {
+    tbb::task_arena arena(numGroups);
+    arena.execute([&] { tbb::parallel_for(size_t(0), numGroups, clusterGroup); });
+  }
+  else if (numGroups == 1)
+    clusterGroup(0);
+
+  // Loop over views
+  for (auto const& finalClusters : planeFinalClusters) {
 
     // Make the output cluster objects
     for (auto const& clusterHits : finalClusters) {
@@ -235,4 +233,54 @@ void cluster::BlurredClustering::produce(art::Event &evt)
   evt.put(std::move(associations));
 }
 
+std::vector<art::PtrVector<recob::Hit>>
+cluster::BlurredClustering::ClusterPlane(cluster::BlurredClusteringAlg& blurredClusteringAlg,
+                                         std::pair<int, int> const& plane,
+                                         std::vector<art::Ptr<recob::Hit>> const& hits) const
+{
+  std::vector<art::PtrVector<recob::Hit>> finalClusters;
+
+  // Implement the algorithm
+  if (hits.size() < blurredClusteringAlg.GetMinSize())
+    return finalClusters;
+
+  // Convert hit map to TH2 histogram and blur it
+  auto const image = blurredClusteringAlg.ConvertRecobHitsToVector(hits);
+  auto const blurred = blurredClusteringAlg.GaussianBlur(image);
+
+  // Find clusters in histogram
+  std::vector<std::vector<int>> allClusterBins; // Vector of clusters (clusters are vectors of hits)
+  int numClusters = blurredClusteringAlg.FindClusters(blurred, allClusterBins);
+  mf::LogVerbatim("Blurred Clustering") << "Found " << numClusters << " clusters" << std::endl;
+
+  // Create output clusters from the vector of clusters made in FindClusters
+  std::vector<art::PtrVector<recob::Hit>> planeClusters;
+  blurredClusteringAlg.ConvertBinsToClusters(image, allClusterBins, planeClusters);
+
+  // Use the cluster merging algorithm
+  if (fMergeClusters) {
+    int numMergedClusters = fMergeClusterAlg.MergeClusters(planeClusters, finalClusters);
+    mf::LogVerbatim("Blurred Clustering") << "After merging, there are " << numMergedClusters << " clusters" << std::endl;
+  }
+  else finalClusters = planeClusters;
+
+  // Make the debug PDF (only ever done on a single thread)
+  if (fCreateDebugPDF) {
+    std::stringstream name;
+    name << "blurred_image";
+    TH2F* imageHist = blurredClusteringAlg.MakeHistogram(image, TString{name.str()});
+    name << "_convolved";
+    TH2F* blurredHist = blurredClusteringAlg.MakeHistogram(blurred, TString{name.str()});
+    auto const [planeNo, tpc] = plane;
+    blurredClusteringAlg.SaveImage(imageHist, 1, tpc, planeNo);
+    blurredClusteringAlg.SaveImage(blurredHist, 2, tpc, planeNo);
+    blurredClusteringAlg.SaveImage(blurredHist, allClusterBins, 3, tpc, planeNo);
+    blurredClusteringAlg.SaveImage(imageHist, finalClusters, 4, tpc, planeNo);
+    imageHist->Delete();
+    blurredHist->Delete();
+  }
+
+  return finalClusters;
+}
+
 DEFINE_ART_MODULE(cluster::BlurredClustering)
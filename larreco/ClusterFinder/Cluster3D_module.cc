@@ -52,6 +52,7 @@
 #include "cetlib/cpu_timer.h"
 
 // LArSoft includes
+#include "larcore/Geometry/Geometry.h"
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
 #include "lardata/Utilities/AssociationUtil.h"
 #include "lardataobj/RecoBase/Edge.h"
@@ -63,6 +64,7 @@
 #include "lardataobj/RecoBase/Seed.h"
 
 #include "larreco/RecoAlg/Cluster3DAlgs/Cluster3D.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/PoolAllocator.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/HoughSeedFinderAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/PCASeedFinderAlg.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/ParallelHitsSeedFinderAlg.h"
@@ -86,6 +88,9 @@
 #include <iostream>
 #include <memory>
 
+// system includes
+#include <sys/resource.h>
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 namespace lar_cluster3d
@@ -474,11 +479,15 @@ private:
     float                                                     m_totalTime;             ///< Keeps track of total execution time
     float                                                     m_artHitsTime;           ///< Keeps track of time to recover hits
     float                                                     m_makeHitsTime;          ///< Keeps track of time to build 3D hits
+    std::vector<float>                                        m_makeHitsTPCTime;       ///< Time to build the 3D hits of each TPC
     float                                                     m_buildNeighborhoodTime; ///< Keeps track of time to build epsilon neighborhood
     float                                                     m_dbscanTime;            ///< Keeps track of time to run DBScan
     float                                                     m_clusterMergeTime;      ///< Keeps track of the time to merge clusters
     float                                                     m_pathFindingTime;       ///< Keeps track of the path finding time
     float                                                     m_finishTime;            ///< Keeps track of time to run output module
+    float                                                     m_allocatorTime;         ///< Time spent getting/releasing node pool blocks
+    float                                                     m_poolMemory;            ///< Peak memory (MB) held by the node pools
+    float                                                     m_peakRSS;               ///< Peak resident set size (MB) of the process
     std::string                                               m_pathInstance;          ///< Special instance for path points
     std::string                                               m_vertexInstance;        ///< Special instance name for vertex points
     std::string                                               m_extremeInstance;       ///< Instance name for the extreme points
@@ -629,16 +638,34 @@ void Cluster3D::produce(art::Event &evt)
 
     if (m_enableMonitoring) theClockFinish.stop();
 
+    // Keep the number of 3D hits for monitoring and then drop this event's hits, including the 2D
+    // hits kept by the builder, so the node pools can be given back in bulk
+    size_t numHits3D = hitPairList->size();
+
+    clusterParametersList.clear();
+    hitPairList.reset();
+    m_hit3DBuilderAlg->clearEvent();
+
+    reco::pool::ReleaseUnusedPools();
+
     // If monitoring then deal with the fallout
     if (m_enableMonitoring)
     {
         theClockTotal.stop();
 
+        reco::pool::PoolStatistics poolStatistics = reco::pool::GetPoolStatistics();
+
+        struct rusage usage;
+
+        getrusage(RUSAGE_SELF, &usage);
+
         m_run                   = evt.run();
         m_event                 = evt.id().event();
         m_totalTime             = theClockTotal.accumulated_real_time();
         m_artHitsTime           = m_hit3DBuilderAlg->getTimeToExecute(IHit3DBuilder::COLLECTARTHITS);
         m_makeHitsTime          = m_hit3DBuilderAlg->getTimeToExecute(IHit3DBuilder::BUILDTHREEDHITS);
+        for(size_t tpcIdx = 0; tpcIdx < m_makeHitsTPCTime.size(); tpcIdx++)
+            m_makeHitsTPCTime[tpcIdx] = m_hit3DBuilderAlg->getTimeToExecuteTPC(tpcIdx);
         m_buildNeighborhoodTime = m_clusterAlg->getTimeToExecute(IClusterAlg::BUILDHITTOHITMAP);
         m_dbscanTime            = m_clusterAlg->getTimeToExecute(IClusterAlg::RUNDBSCAN) +
                                   m_clusterAlg->getTimeToExecute(IClusterAlg::BUILDCLUSTERINFO);
@@ -646,11 +673,15 @@ void Cluster3D::produce(art::Event &evt)
         m_pathFindingTime       = m_clusterPathAlg->getTimeToExecute();
         m_finishTime            = theClockFinish.accumulated_real_time();
         m_hits                  = static_cast<int>(clusterHitToArtPtrMap.size());
-        m_hits3D                = static_cast<int>(hitPairList->size());
+        m_hits3D                = static_cast<int>(numHits3D);
+        m_allocatorTime         = poolStatistics.m_allocatorTime;
+        m_poolMemory            = poolStatistics.m_peakBytesReserved / (1024. * 1024.);
+        m_peakRSS               = usage.ru_maxrss / 1024.;    // ru_maxrss is in kB on Linux
         m_pRecoTree->Fill();
 
         mf::LogDebug("Cluster3D") << "*** Cluster3D total time: " << m_totalTime << ", art: " << m_artHitsTime << ", make: " << m_makeHitsTime
-        << ", build: " << m_buildNeighborhoodTime << ", clustering: " << m_dbscanTime << ", merge: " << m_clusterMergeTime << ", path: " << m_pathFindingTime << ", finish: " << m_finishTime << std::endl;
+        << ", build: " << m_buildNeighborhoodTime << ", clustering: " << m_dbscanTime << ", merge: " << m_clusterMergeTime << ", path: " << m_pathFindingTime << ", finish: " << m_finishTime
+        << ", allocator: " << m_allocatorTime << ", pool MB: " << m_poolMemory << ", peak RSS MB: " << m_peakRSS << std::endl;
     }
 
     // Will we ever get here? ;-)
@@ -670,11 +701,15 @@ void Cluster3D::InitializeMonitoring()
     m_pRecoTree->Branch("totalTime",            &m_totalTime,             "time/F");
     m_pRecoTree->Branch("artHitsTime",          &m_artHitsTime,           "time/F");
     m_pRecoTree->Branch("makeHitsTime",         &m_makeHitsTime,          "time/F");
+    m_pRecoTree->Branch("makeHitsTPCTime",      "std::vector<float>",     &m_makeHitsTPCTime);
     m_pRecoTree->Branch("buildneigborhoodTime", &m_buildNeighborhoodTime, "time/F");
     m_pRecoTree->Branch("dbscanTime",           &m_dbscanTime,            "time/F");
     m_pRecoTree->Branch("clusterMergeTime",     &m_clusterMergeTime,      "time/F");
     m_pRecoTree->Branch("pathfindingtime",      &m_pathFindingTime,       "time/F");
     m_pRecoTree->Branch("finishTime",           &m_finishTime,            "time/F");
+    m_pRecoTree->Branch("allocatorTime",        &m_allocatorTime,         "time/F");
+    m_pRecoTree->Branch("poolMemory",           &m_poolMemory,            "memory/F");
+    m_pRecoTree->Branch("peakRSS",              &m_peakRSS,               "memory/F");
 
     m_clusterPathAlg->initializeHistograms(*tfs.get());
 
@@ -692,10 +727,16 @@ void Cluster3D::PrepareEvent(const art::Event &evt)
     m_totalTime             = 0.f;
     m_artHitsTime           = 0.f;
     m_makeHitsTime          = 0.f;
+    m_makeHitsTPCTime.assign(art::ServiceHandle<geo::Geometry const>()->TotalNTPC(), 0.f);
     m_buildNeighborhoodTime = 0.f;
     m_dbscanTime            = 0.f;
     m_pathFindingTime       = 0.f;
     m_finishTime            = 0.f;
+    m_allocatorTime         = 0.f;
+    m_poolMemory            = 0.f;
+    m_peakRSS               = 0.f;
+
+    reco::pool::ResetPoolStatistics();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -28,9 +28,6 @@
 #include "TGeoMaterial.h"
 #include "TGeoMedium.h"
 #include "TGeoVolume.h"
-#include "TMatrixT.h"
-#include "TMatrixTBase.h"
-#include "TMatrixTUtils.h"
 #include "TParticlePDG.h"
 
 genf::GFMaterialEffects* genf::GFMaterialEffects::finstance = NULL;
@@ -90,8 +87,8 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
 					const double& mom,
 					const int& pdg,
 					const bool& doNoise,
-                                        TMatrixT<Double_t>* noise,
-					const TMatrixT<Double_t>* jacobian,
+                                        ROOT::Math::SMatrix<double,7,7>* noise,
+					const ROOT::Math::SMatrix<double,7,7>* jacobian,
 					const TVector3* directionBefore,
 					const TVector3* directionAfter){
 
@@ -155,7 +152,7 @@ double genf::GFMaterialEffects::effects(const std::vector<TVector3>& points,
           if (doNoise && fEnergyLossBetheBloch && fNoiseBetheBloch)
             this->noiseBetheBloch(mom, noise);
 
-          if (/*doNoise &&*/ fNoiseCoulomb) // Force it
+          if (/*doNoise &&*/ fNoiseCoulomb && noise) // Force it, unless there is no noise matrix to fill
             this->noiseCoulomb(mom, noise, jacobian, directionBefore, directionAfter);
 
           if (fEnergyLossBrems)
@@ -325,7 +322,7 @@ double genf::GFMaterialEffects::energyLossBetheBloch(const double& mom){
 
 
 void genf::GFMaterialEffects::noiseBetheBloch(const double& mom,
-                                        TMatrixT<double>* noise) const{
+                                        ROOT::Math::SMatrix<double,7,7>* noise) const{
 
 
   // ENERGY LOSS FLUCTUATIONS; calculate sigma^2(E);
@@ -383,13 +380,13 @@ void genf::GFMaterialEffects::noiseBetheBloch(const double& mom,
   sigma2E*=1.E-18; // eV -> GeV
 
   // update noise matrix
-  (*noise)[6][6] += (mom*mom+fmass*fmass)/pow(mom,6.)*sigma2E;
+  (*noise)(6,6) += (mom*mom+fmass*fmass)/pow(mom,6.)*sigma2E;
 }
 
 
 void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
-                                           TMatrixT<double>* noise,
-                                     const TMatrixT<double>* jacobian,
+                                           ROOT::Math::SMatrix<double,7,7>* noise,
+                                     const ROOT::Math::SMatrix<double,7,7>* jacobian,
                                      const TVector3* directionBefore,
                                      const TVector3* directionAfter) const{
 
@@ -398,7 +395,7 @@ void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
   double sigma2 = 225.E-6/(fbeta*fbeta*mom*mom) * fstep/fradiationLength * fmatZ/(fmatZ+1) * log(159.*pow(fmatZ,-1./3.))/log(287.*pow(fmatZ,-0.5)); // sigma^2 = 225E-6/mom^2 * XX0/fbeta^2 * Z/(Z+1) * ln(159*Z^(-1/3))/ln(287*Z^(-1/2)
 
   // noiseBefore
-    TMatrixT<double> noiseBefore(7,7);
+    ROOT::Math::SMatrix<double,7,7> noiseBefore; // zero everywhere by default
 
     // calculate euler angles theta, psi (so that directionBefore' points in z' direction)
     double psi = 0;
@@ -421,26 +418,23 @@ void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
     double noiseBefore35 = -sigma2 * costheta * sinpsi * sintheta;
     double noiseBefore45 =  sigma2 * costheta * cospsi * sintheta;
 
-    noiseBefore[3][3] = sigma2 * (cospsi*cospsi + costheta*costheta - costheta*costheta * cospsi*cospsi);
-    noiseBefore[4][3] = noiseBefore34;
-    noiseBefore[5][3] = noiseBefore35;
+    noiseBefore(3,3) = sigma2 * (cospsi*cospsi + costheta*costheta - costheta*costheta * cospsi*cospsi);
+    noiseBefore(4,3) = noiseBefore34;
+    noiseBefore(5,3) = noiseBefore35;
 
-    noiseBefore[3][4] = noiseBefore34;
-    noiseBefore[4][4] = sigma2 * (sinpsi*sinpsi + costheta*costheta * cospsi*cospsi);
-    noiseBefore[5][4] = noiseBefore45;
+    noiseBefore(3,4) = noiseBefore34;
+    noiseBefore(4,4) = sigma2 * (sinpsi*sinpsi + costheta*costheta * cospsi*cospsi);
+    noiseBefore(5,4) = noiseBefore45;
 
-    noiseBefore[3][5] = noiseBefore35;
-    noiseBefore[4][5] = noiseBefore45;
-    noiseBefore[5][5] = sigma2 * sintheta*sintheta;
+    noiseBefore(3,5) = noiseBefore35;
+    noiseBefore(4,5) = noiseBefore45;
+    noiseBefore(5,5) = sigma2 * sintheta*sintheta;
 
-    TMatrixT<double> jacobianT(7,7);
-    jacobianT = (*jacobian);
-    jacobianT.T();
-
-    noiseBefore = jacobianT*noiseBefore*(*jacobian); //propagate
+    ROOT::Math::SMatrix<double,7,7> jacTnoise = ROOT::Math::Transpose(*jacobian)*noiseBefore;
+    noiseBefore = jacTnoise*(*jacobian); //propagate
 
   // noiseAfter
-    TMatrixT<double> noiseAfter(7,7);
+    ROOT::Math::SMatrix<double,7,7> noiseAfter; // zero everywhere by default
 
     // calculate euler angles theta, psi (so that A' points in z' direction)
     psi = 0;
@@ -463,17 +457,17 @@ void genf::GFMaterialEffects::noiseCoulomb(const double& mom,
     double noiseAfter35 = -sigma2 * costheta * sinpsi * sintheta;
     double noiseAfter45 =  sigma2 * costheta * cospsi * sintheta;
 
-    noiseAfter[3][3] = sigma2 * (cospsi*cospsi + costheta*costheta - costheta*costheta * cospsi*cospsi);
-    noiseAfter[4][3] = noiseAfter34;
-    noiseAfter[5][3] = noiseAfter35;
+    noiseAfter(3,3) = sigma2 * (cospsi*cospsi + costheta*costheta - costheta*costheta * cospsi*cospsi);
+    noiseAfter(4,3) = noiseAfter34;
+    noiseAfter(5,3) = noiseAfter35;
 
-    noiseAfter[3][4] = noiseAfter34;
-    noiseAfter[4][4] = sigma2 * (sinpsi*sinpsi + costheta*costheta * cospsi*cospsi);
-    noiseAfter[5][4] = noiseAfter45;
+    noiseAfter(3,4) = noiseAfter34;
+    noiseAfter(4,4) = sigma2 * (sinpsi*sinpsi + costheta*costheta * cospsi*cospsi);
+    noiseAfter(5,4) = noiseAfter45;
 
-    noiseAfter[3][5] = noiseAfter35;
-    noiseAfter[4][5] = noiseAfter45;
-    noiseAfter[5][5] = sigma2 * sintheta*sintheta;
+    noiseAfter(3,5) = noiseAfter35;
+    noiseAfter(4,5) = noiseAfter45;
+    noiseAfter(5,5) = sigma2 * sintheta*sintheta;
 
   //calculate mean of noiseBefore and noiseAfter and update noise
     (*noise) += 0.5*noiseBefore + 0.5*noiseAfter;
@@ -644,7 +638,7 @@ double genf::GFMaterialEffects::energyLossBrems(const double& mom) const{
 
 
 void genf::GFMaterialEffects::noiseBrems(const double& mom,
-                                   TMatrixT<double>* noise) const{
+                                   ROOT::Math::SMatrix<double,7,7>* noise) const{
 
   if (fabs(fpdg)!=11) return; // only for electrons and positrons
 
@@ -655,7 +649,7 @@ void genf::GFMaterialEffects::noiseBrems(const double& mom,
   double sigma2E = DEDXB*DEDXB; //eV^2
   sigma2E*=1.E-18; // eV -> GeV
 
-  (*noise)[6][6] += (mom*mom+fmass*fmass)/pow(mom,6.)*sigma2E;
+  (*noise)(6,6) += (mom*mom+fmass*fmass)/pow(mom,6.)*sigma2E;
 }
 
 
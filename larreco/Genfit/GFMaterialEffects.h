@@ -27,6 +27,7 @@
 #include "TObject.h"
 #include <vector>
 #include "TVector3.h"
+#include "Math/SMatrix.h"
 
 class TGeoMaterial;
 
@@ -70,8 +71,8 @@ class GFMaterialEffects : public TObject{
                  const double& mom,
                  const int& pdg,
                  const bool& doNoise = false,
-                       TMatrixT<Double_t>* noise = NULL,
-                 const TMatrixT<Double_t>* jacobian = NULL,
+                       ROOT::Math::SMatrix<double,7,7>* noise = NULL,
+                 const ROOT::Math::SMatrix<double,7,7>* jacobian = NULL,
                  const TVector3* directionBefore = NULL,
                  const TVector3* directionAfter = NULL);
 
@@ -122,7 +123,7 @@ class GFMaterialEffects : public TObject{
     *  Needs fdedx, which is calculated in energyLossBetheBloch, so it has to be calles afterwards!
     */
   void noiseBetheBloch(const double& mom,
-                             TMatrixT<double>* noise) const;
+                             ROOT::Math::SMatrix<double,7,7>* noise) const;
 
   //! calculation of multiple scattering
   /**  With the calculated multiple scattering angle, two noise matrices are calculated:
@@ -315,8 +316,8 @@ class GFMaterialEffects : public TObject{
     * \n
     */
   void noiseCoulomb(const double& mom,
-                          TMatrixT<double>* noise,
-                    const TMatrixT<double>* jacobian,
+                          ROOT::Math::SMatrix<double,7,7>* noise,
+                    const ROOT::Math::SMatrix<double,7,7>* jacobian,
                     const TVector3* directionBefore,
                     const TVector3* directionAfter) const;
 
@@ -332,7 +333,7 @@ class GFMaterialEffects : public TObject{
    *
    */
   void noiseBrems(const double& mom,
-                        TMatrixT<double>* noise) const;
+                        ROOT::Math::SMatrix<double,7,7>* noise) const;
   double MeanExcEnergy_get(int Z);
   double MeanExcEnergy_get(TGeoMaterial*);
 
@@ -312,50 +312,49 @@ int genf::RKTrackRep::getPDG(){return fPdg;}
 
 TVector3 genf::RKTrackRep::getPos(const GFDetPlane& pl){
   if(pl!=fRefPlane){
-    TMatrixT<Double_t> s(5,1);
-    extrapolate(pl,s);
-    return pl.getO()+s[3][0]*pl.getU()+s[4][0]*pl.getV();
+    State5 s;
+    propagate(pl,s);
+    return pl.getO()+s[3]*pl.getU()+s[4]*pl.getV();
   }
   return fRefPlane.getO()+fState[3][0]*fRefPlane.getU()+fState[4][0]*fRefPlane.getV();
 }
 
 
 TVector3 genf::RKTrackRep::getMom(const GFDetPlane& pl){
-  TMatrixT<Double_t> statePred(fState);
+  State5 statePred(fState.GetMatrixArray(),5);
   TVector3 retmom;
   if(pl!=fRefPlane) {
-    extrapolate(pl,statePred);
-    retmom = fCacheSpu*(pl.getNormal()+statePred[1][0]*pl.getU()+statePred[2][0]*pl.getV());
+    propagate(pl,statePred);
+    retmom = fCacheSpu*(pl.getNormal()+statePred[1]*pl.getU()+statePred[2]*pl.getV());
   }
   else{
-    retmom = fSpu*(pl.getNormal()+statePred[1][0]*pl.getU()+statePred[2][0]*pl.getV());
+    retmom = fSpu*(pl.getNormal()+statePred[1]*pl.getU()+statePred[2]*pl.getV());
   }
-  retmom.SetMag(1./fabs(statePred[0][0]));
+  retmom.SetMag(1./fabs(statePred[0]));
   return retmom;
 }
 
 TVector3 genf::RKTrackRep::getMomLast(const GFDetPlane& pl){
-  TMatrixT<Double_t> statePred(fLastState);
   TVector3 retmom;
-  retmom = fSpu*(pl.getNormal()+statePred[1][0]*pl.getU()+statePred[2][0]*pl.getV());
+  retmom = fSpu*(pl.getNormal()+fLastState[1][0]*pl.getU()+fLastState[2][0]*pl.getV());
 
-  retmom.SetMag(1./fabs(statePred[0][0]));
+  retmom.SetMag(1./fabs(fLastState[0][0]));
   return retmom;
 }
 
 
 void genf::RKTrackRep::getPosMom(const GFDetPlane& pl,TVector3& pos,
                            TVector3& mom){
-  TMatrixT<Double_t> statePred(fState);
+  State5 statePred(fState.GetMatrixArray(),5);
   if(pl!=fRefPlane) {
-    extrapolate(pl,statePred);
-    mom = fCacheSpu*(pl.getNormal()+statePred[1][0]*pl.getU()+statePred[2][0]*pl.getV());
+    propagate(pl,statePred);
+    mom = fCacheSpu*(pl.getNormal()+statePred[1]*pl.getU()+statePred[2]*pl.getV());
   }
   else{
-    mom = fSpu*(pl.getNormal()+statePred[1][0]*pl.getU()+statePred[2][0]*pl.getV());
+    mom = fSpu*(pl.getNormal()+statePred[1]*pl.getU()+statePred[2]*pl.getV());
   }
-  mom.SetMag(1./fabs(statePred[0][0]));
-  pos = pl.getO()+(statePred[3][0]*pl.getU())+(statePred[4][0]*pl.getV());
+  mom.SetMag(1./fabs(statePred[0]));
+  pos = pl.getO()+(statePred[3]*pl.getU())+(statePred[4]*pl.getV());
 }
 
 
@@ -378,14 +377,14 @@ void genf::RKTrackRep::extrapolateToPoint(const TVector3& pos,
 
   TVector3 point = o + fState[3][0]*u + fState[4][0]*v;
 
-  TMatrixT<Double_t> state7(7,1);
-  state7[0][0] = point.X();
-  state7[1][0] = point.Y();
-  state7[2][0] = point.Z();
-  state7[3][0] = pTilde.X();
-  state7[4][0] = pTilde.Y();
-  state7[5][0] = pTilde.Z();
-  state7[6][0] = fState[0][0];
+  State7 state7;
+  state7[0] = point.X();
+  state7[1] = point.Y();
+  state7[2] = point.Z();
+  state7[3] = pTilde.X();
+  state7[4] = pTilde.Y();
+  state7[5] = pTilde.Z();
+  state7[6] = fState[0][0];
 
   double coveredDistance(0.);
 
@@ -393,16 +392,16 @@ void genf::RKTrackRep::extrapolateToPoint(const TVector3& pos,
   int iterations(0);
 
   while(true){
-    pl.setON(pos,TVector3(state7[3][0],state7[4][0],state7[5][0]));
-    coveredDistance =  this->Extrap(pl,&state7);
+    pl.setON(pos,TVector3(state7[3],state7[4],state7[5]));
+    coveredDistance =  this->Extrap(pl,state7);
 
     if(fabs(coveredDistance)<MINSTEP) break;
     if(++iterations == maxIt) {
       throw GFException("RKTrackRep::extrapolateToPoint==> extrapolation to point failed, maximum number of iterations reached",__LINE__,__FILE__).setFatal();
     }
   }
-  poca.SetXYZ(state7[0][0],state7[1][0],state7[2][0]);
-  dirInPoca.SetXYZ(state7[3][0],state7[4][0],state7[5][0]);
+  poca.SetXYZ(state7[0],state7[1],state7[2]);
+  dirInPoca.SetXYZ(state7[3],state7[4],state7[5]);
 }
 
 
@@ -438,14 +437,14 @@ void genf::RKTrackRep::extrapolateToLine(const TVector3& point1,
 
   TVector3 point = o + fState[3][0]*u + fState[4][0]*v;
 
-  TMatrixT<Double_t> state7(7,1);
-  state7[0][0] = point.X();
-  state7[1][0] = point.Y();
-  state7[2][0] = point.Z();
-  state7[3][0] = pTilde.X();
-  state7[4][0] = pTilde.Y();
-  state7[5][0] = pTilde.Z();
-  state7[6][0] = fState[0][0];
+  State7 state7;
+  state7[0] = point.X();
+  state7[1] = point.Y();
+  state7[2] = point.Z();
+  state7[3] = pTilde.X();
+  state7[4] = pTilde.Y();
+  state7[5] = pTilde.Z();
+  state7[6] = fState[0][0];
 
   double coveredDistance(0.);
 
@@ -454,18 +453,18 @@ void genf::RKTrackRep::extrapolateToLine(const TVector3& point1,
 
   while(true){
     pl.setO(point1);
-    TVector3 currentDir(state7[3][0],state7[4][0],state7[5][0]);
+    TVector3 currentDir(state7[3],state7[4],state7[5]);
     pl.setU(currentDir.Cross(point2-point1));
     pl.setV(point2-point1);
-    coveredDistance = this->Extrap(pl,&state7);
+    coveredDistance = this->Extrap(pl,state7);
 
     if(fabs(coveredDistance)<MINSTEP) break;
     if(++iterations == maxIt) {
       throw GFException("RKTrackRep extrapolation to point failed, maximum number of iterations reached",__LINE__,__FILE__).setFatal();
     }
   }
-  poca.SetXYZ(state7[0][0],state7[1][0],state7[2][0]);
-  dirInPoca.SetXYZ(state7[3][0],state7[4][0],state7[5][0]);
+  poca.SetXYZ(state7[0],state7[1],state7[2]);
+  dirInPoca.SetXYZ(state7[3],state7[4],state7[5]);
   poca_onwire = poca2Line(point1,point2,poca);
 }
 
@@ -476,121 +475,29 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
                                TMatrixT<Double_t>& statePred,
                                TMatrixT<Double_t>& covPred){
 
-  TMatrixT<Double_t> cov7x7(7,7);
-  TMatrixT<Double_t> J_pM(7,5);
+  State5 state5;
+  M5x5 cov5x5;
+  double coveredDistance = propagate(pl,state5,&cov5x5);
 
-  TVector3 o=fRefPlane.getO();
-  TVector3 u=fRefPlane.getU();
-  TVector3 v=fRefPlane.getV();
-  TVector3 w=u.Cross(v);
-  std::ostream* pOut = nullptr; // &std::cout if you really really want
-
-  J_pM[0][3] = u.X();J_pM[0][4]=v.X(); // dx/du
-  J_pM[1][3] = u.Y();J_pM[1][4]=v.Y();
-  J_pM[2][3] = u.Z();J_pM[2][4]=v.Z();
-
-  TVector3 pTilde = fSpu * (w + fState[1][0] * u + fState[2][0] * v);
-  double pTildeMag = pTilde.Mag();
-
-  //J_pM matrix is d(x,y,z,ax,ay,az,q/p) / d(q/p,u',v',u,v)
-
-  // da_x/du'
-  J_pM[3][1] = fSpu/pTildeMag*(u.X()-pTilde.X()/(pTildeMag*pTildeMag)*u*pTilde);
-  J_pM[4][1] = fSpu/pTildeMag*(u.Y()-pTilde.Y()/(pTildeMag*pTildeMag)*u*pTilde);
-  J_pM[5][1] = fSpu/pTildeMag*(u.Z()-pTilde.Z()/(pTildeMag*pTildeMag)*u*pTilde);
-  // da_x/dv'
-  J_pM[3][2] = fSpu/pTildeMag*(v.X()-pTilde.X()/(pTildeMag*pTildeMag)*v*pTilde);
-  J_pM[4][2] = fSpu/pTildeMag*(v.Y()-pTilde.Y()/(pTildeMag*pTildeMag)*v*pTilde);
-  J_pM[5][2] = fSpu/pTildeMag*(v.Z()-pTilde.Z()/(pTildeMag*pTildeMag)*v*pTilde);
-  // dqOp/dqOp
-  J_pM[6][0] = 1.;
-
-  TMatrixT<Double_t> J_pM_transp(J_pM);
-  J_pM_transp.T();
-
-  cov7x7 = J_pM*(fCov*J_pM_transp);
-  if (cov7x7[0][0]>=1000. || cov7x7[0][0]<1.E-50)
-    {
-      if (pOut) {
-        (*pOut)  << "RKTrackRep::extrapolate(): cov7x7[0][0] is crazy. Rescale off-diags. Try again. fCov, cov7x7 were: " << std::endl;
-        PrintROOTobject(*pOut, fCov);
-        PrintROOTobject(*pOut, cov7x7);
-      }
-      rescaleCovOffDiags();
-      cov7x7 = J_pM*(fCov*J_pM_transp);
-      if (pOut) {
-        (*pOut) << "New cov7x7 and fCov are ... " << std::endl;
-        PrintROOTobject(*pOut, cov7x7);
-        PrintROOTobject(*pOut, fCov);
-      }
-    }
-
-
-  TVector3 pos = o + fState[3][0]*u + fState[4][0]*v;
-  TMatrixT<Double_t> state7(7,1);
-  state7[0][0] = pos.X();
-  state7[1][0] = pos.Y();
-  state7[2][0] = pos.Z();
-  state7[3][0] = pTilde.X()/pTildeMag;;
-  state7[4][0] = pTilde.Y()/pTildeMag;;
-  state7[5][0] = pTilde.Z()/pTildeMag;;
-  state7[6][0] = fState[0][0];
+  covPred.ResizeTo(5,5);
+  covPred.SetMatrixArray(cov5x5.Array());
+  statePred.ResizeTo(5,1);
+  statePred.SetMatrixArray(state5.Array());
 
-  double coveredDistance = this->Extrap(pl,&state7,&cov7x7);
+  return coveredDistance;
+}
 
 
-  TVector3 O = pl.getO();
-  TVector3 U = pl.getU();
-  TVector3 V = pl.getV();
-  TVector3 W = pl.getNormal();
 
-  double X = state7[0][0];
-  double Y = state7[1][0];
-  double Z = state7[2][0];
-  double AX = state7[3][0];
-  double AY = state7[4][0];
-  double AZ = state7[5][0];
-  double QOP = state7[6][0];
-  TVector3 A(AX,AY,AZ);
-  TVector3 Point(X,Y,Z);
-  TMatrixT<Double_t> J_Mp(5,7);
-
-  // J_Mp matrix is d(q/p,u',v',u,v) / d(x,y,z,ax,ay,az,q/p)
-  J_Mp[0][6] = 1.;
-  //du'/da_x
-  double AtW = A*W;
-  J_Mp[1][3] = (U.X()*(AtW)-W.X()*(A*U))/(AtW*AtW);
-  J_Mp[1][4] = (U.Y()*(AtW)-W.Y()*(A*U))/(AtW*AtW);
-  J_Mp[1][5] = (U.Z()*(AtW)-W.Z()*(A*U))/(AtW*AtW);
-  //dv'/da_x
-  J_Mp[2][3] = (V.X()*(AtW)-W.X()*(A*V))/(AtW*AtW);
-  J_Mp[2][4] = (V.Y()*(AtW)-W.Y()*(A*V))/(AtW*AtW);
-  J_Mp[2][5] = (V.Z()*(AtW)-W.Z()*(A*V))/(AtW*AtW);
-  //du/dx
-  J_Mp[3][0] = U.X();
-  J_Mp[3][1] = U.Y();
-  J_Mp[3][2] = U.Z();
-  //dv/dx
-  J_Mp[4][0] = V.X();
-  J_Mp[4][1] = V.Y();
-  J_Mp[4][2] = V.Z();
-
-  TMatrixT<Double_t> J_Mp_transp(J_Mp);
-  J_Mp_transp.T();
 
-  covPred.ResizeTo(5,5);
-  covPred = J_Mp*(cov7x7*J_Mp_transp);
+double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
+                               TMatrixT<Double_t>& statePred){
 
+  State5 state5;
+  double coveredDistance = propagate(pl,state5);
 
   statePred.ResizeTo(5,1);
-  statePred[0][0] = QOP;
-  statePred[1][0] = (A*U)/(A*W);
-  statePred[2][0] = (A*V)/(A*W);
-  statePred[3][0] = (Point-O)*U;
-  statePred[4][0] = (Point-O)*V;
-
-  fCachePlane = pl;
-  fCacheSpu = (A*W)/fabs(A*W);
+  statePred.SetMatrixArray(state5.Array());
 
   return coveredDistance;
 }
@@ -598,52 +505,127 @@ double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
 
 
 
-double genf::RKTrackRep::extrapolate(const GFDetPlane& pl,
-                               TMatrixT<Double_t>& statePred){
+double genf::RKTrackRep::propagate(const GFDetPlane& pl,
+                             State5& statePred,
+                             M5x5* covPred){
 
   TVector3 o=fRefPlane.getO();
   TVector3 u=fRefPlane.getU();
   TVector3 v=fRefPlane.getV();
   TVector3 w=u.Cross(v);
 
-
-  TVector3 pTilde = fSpu* (w + fState[1][0] * u + fState[2][0] * v);
+  TVector3 pTilde = fSpu * (w + fState[1][0] * u + fState[2][0] * v);
   double pTildeMag = pTilde.Mag();
 
+  M7x7 cov7x7;
+  if(covPred!=NULL){
+    M7x5 J_pM;
+    std::ostream* pOut = nullptr; // &std::cout if you really really want
+
+    J_pM(0,3) = u.X();J_pM(0,4)=v.X(); // dx/du
+    J_pM(1,3) = u.Y();J_pM(1,4)=v.Y();
+    J_pM(2,3) = u.Z();J_pM(2,4)=v.Z();
+
+    //J_pM matrix is d(x,y,z,ax,ay,az,q/p) / d(q/p,u',v',u,v)
+
+    // da_x/du'
+    J_pM(3,1) = fSpu/pTildeMag*(u.X()-pTilde.X()/(pTildeMag*pTildeMag)*u*pTilde);
+    J_pM(4,1) = fSpu/pTildeMag*(u.Y()-pTilde.Y()/(pTildeMag*pTildeMag)*u*pTilde);
+    J_pM(5,1) = fSpu/pTildeMag*(u.Z()-pTilde.Z()/(pTildeMag*pTildeMag)*u*pTilde);
+    // da_x/dv'
+    J_pM(3,2) = fSpu/pTildeMag*(v.X()-pTilde.X()/(pTildeMag*pTildeMag)*v*pTilde);
+    J_pM(4,2) = fSpu/pTildeMag*(v.Y()-pTilde.Y()/(pTildeMag*pTildeMag)*v*pTilde);
+    J_pM(5,2) = fSpu/pTildeMag*(v.Z()-pTilde.Z()/(pTildeMag*pTildeMag)*v*pTilde);
+    // dqOp/dqOp
+    J_pM(6,0) = 1.;
+
+    M5x5 cov5x5(fCov.GetMatrixArray(),25);
+    M5x7 covJ_pMT = cov5x5*ROOT::Math::Transpose(J_pM);
+    cov7x7 = J_pM*covJ_pMT;
+    if (cov7x7(0,0)>=1000. || cov7x7(0,0)<1.E-50)
+      {
+        if (pOut) {
+          (*pOut)  << "RKTrackRep::extrapolate(): cov7x7[0][0] is crazy. Rescale off-diags. Try again. fCov, cov7x7 were: " << std::endl;
+          PrintROOTobject(*pOut, fCov);
+          (*pOut) << cov7x7 << std::endl;
+        }
+        rescaleCovOffDiags();
+        cov5x5.SetElements(fCov.GetMatrixArray(),fCov.GetMatrixArray()+25);
+        covJ_pMT = cov5x5*ROOT::Math::Transpose(J_pM);
+        cov7x7 = J_pM*covJ_pMT;
+        if (pOut) {
+          (*pOut) << "New cov7x7 and fCov are ... " << std::endl;
+          (*pOut) << cov7x7 << std::endl;
+          PrintROOTobject(*pOut, fCov);
+        }
+      }
+  }
+
   TVector3 pos = o + fState[3][0]*u + fState[4][0]*v;
+  State7 state7;
+  state7[0] = pos.X();
+  state7[1] = pos.Y();
+  state7[2] = pos.Z();
+  state7[3] = pTilde.X()/pTildeMag;
+  state7[4] = pTilde.Y()/pTildeMag;
+  state7[5] = pTilde.Z()/pTildeMag;
+  state7[6] = fState[0][0];
+
+  double coveredDistance = this->Extrap(pl,state7,covPred!=NULL ? &cov7x7 : NULL);
 
-  TMatrixT<Double_t> state7(7,1);
-  state7[0][0] = pos.X();
-  state7[1][0] = pos.Y();
-  state7[2][0] = pos.Z();
-  state7[3][0] = pTilde.X()/pTildeMag;
-  state7[4][0] = pTilde.Y()/pTildeMag;
-  state7[5][0] = pTilde.Z()/pTildeMag;
-  state7[6][0] = fState[0][0];
 
   TVector3 O = pl.getO();
   TVector3 U = pl.getU();
   TVector3 V = pl.getV();
   TVector3 W = pl.getNormal();
 
-  double coveredDistance = this->Extrap(pl,&state7);
-
-  double X = state7[0][0];
-  double Y = state7[1][0];
-  double Z = state7[2][0];
-  double AX = state7[3][0];
-  double AY = state7[4][0];
-  double AZ = state7[5][0];
-  double QOP = state7[6][0];
+  double X = state7[0];
+  double Y = state7[1];
+  double Z = state7[2];
+  double AX = state7[3];
+  double AY = state7[4];
+  double AZ = state7[5];
+  double QOP = state7[6];
   TVector3 A(AX,AY,AZ);
   TVector3 Point(X,Y,Z);
 
-  statePred.ResizeTo(5,1);
-  statePred[0][0] = QOP;
-  statePred[1][0] = (A*U)/(A*W);
-  statePred[2][0] = (A*V)/(A*W);
-  statePred[3][0] = (Point-O)*U;
-  statePred[4][0] = (Point-O)*V;
+  if(covPred!=NULL){
+    M5x7 J_Mp;
+
+    // J_Mp matrix is d(q/p,u',v',u,v) / d(x,y,z,ax,ay,az,q/p)
+    J_Mp(0,6) = 1.;
+    //du'/da_x
+    double AtW = A*W;
+    J_Mp(1,3) = (U.X()*(AtW)-W.X()*(A*U))/(AtW*AtW);
+    J_Mp(1,4) = (U.Y()*(AtW)-W.Y()*(A*U))/(AtW*AtW);
+    J_Mp(1,5) = (U.Z()*(AtW)-W.Z()*(A*U))/(AtW*AtW);
+    //dv'/da_x
+    J_Mp(2,3) = (V.X()*(AtW)-W.X()*(A*V))/(AtW*AtW);
+    J_Mp(2,4) = (V.Y()*(AtW)-W.Y()*(A*V))/(AtW*AtW);
+    J_Mp(2,5) = (V.Z()*(AtW)-W.Z()*(A*V))/(AtW*AtW);
+    //du/dx
+    J_Mp(3,0) = U.X();
+    J_Mp(3,1) = U.Y();
+    J_Mp(3,2) = U.Z();
+    //dv/dx
+    J_Mp(4,0) = V.X();
+    J_Mp(4,1) = V.Y();
+    J_Mp(4,2) = V.Z();
+
+    M7x5 covJ_MpT = cov7x7*ROOT::Math::Transpose(J_Mp);
+    *covPred = J_Mp*covJ_MpT;
+  }
+
+  statePred[0] = QOP;
+  statePred[1] = (A*U)/(A*W);
+  statePred[2] = (A*V)/(A*W);
+  statePred[3] = (Point-O)*U;
+  statePred[4] = (Point-O)*V;
+
+  if(covPred!=NULL){
+    fCachePlane = pl;
+    fCacheSpu = (A*W)/fabs(A*W);
+  }
 
   return coveredDistance;
 }
@@ -1055,7 +1037,7 @@ bool genf::RKTrackRep::RKutta (const GFDetPlane& plane,
 
 
 
-double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* state, TMatrixT<Double_t>* cov) const {
+double genf::RKTrackRep::Extrap( const GFDetPlane& plane, State7& state, M7x7* cov) const {
 
   static const int maxNumIt(2000);
   int numIt(0);
@@ -1067,16 +1049,19 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
 //  else {} // not needed std::fill(P, P + 7, 0);
 
   for(int i=0;i<7;++i){
-    P[i] = (*state)[i][0];
+    P[i] = state[i];
   }
 
-  TMatrixT<Double_t> jac(7,7);
-  TMatrixT<Double_t> jacT(7,7);
-  TMatrixT<Double_t> oldCov(7,7);
-  if(calcCov) oldCov=(*cov);
+  M7x7 jac;
   double coveredDistance(0.);
   double sumDistance(0.);
 
+  // points of the propagation, reused by all the iterations
+  std::vector<TVector3> points;
+  std::vector<double> pointPaths;
+  std::vector<TVector3> pointsFilt;
+  std::vector<double> pointPathsFilt;
+
   while(true){
     if(numIt++ > maxNumIt){
       throw GFException("RKTrackRep::Extrap ==> maximum number of iterations exceeded",
@@ -1088,28 +1073,13 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
       for(int i=0; i<6; ++i){
         P[(i+1)*7+i] = 1.;
       }
-      P[55] =  (*state)[6][0];
-    }
-
-//    double dir(1.);
-    {
-      TVector3 Pvect(P[0],P[1],P[2]); //position
-      TVector3 Avect(P[3],P[4],P[5]); //direction
-      TVector3 dist = plane.dist(Pvect); //from point to plane
-      //      std::cout << "RKTrackRep::Extrap(): Position, Direction, Plane, dist " << std::endl;
-      //Pvect.Print();
-      //Avect.Print();
-      //plane.Print();
-      //dist.Print();
- //     if(dist*Avect<0.) dir=-1.;
+      P[55] =  state[6];
     }
 
     TVector3 directionBefore(P[3],P[4],P[5]); // direction before propagation
     directionBefore.SetMag(1.);
 
     // propagation
-    std::vector<TVector3> points;
-    std::vector<double> pointPaths;
     if( ! this->RKutta(plane,P,coveredDistance,points,pointPaths,-1.,calcCov) ) { // maxLen currently not used
       //GFException exc("RKTrackRep::Extrap ==>  Runge Kutta propagation failed",__LINE__,__FILE__);
 
@@ -1126,8 +1096,8 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
     sumDistance+=coveredDistance;
 
     // filter Points
-    std::vector<TVector3> pointsFilt(1, points.at(0));
-    std::vector<double> pointPathsFilt(1, 0.);
+    pointsFilt.assign(1, points.at(0));
+    pointPathsFilt.assign(1, 0.);
     // only if in right direction
     for(unsigned int i=1;i<points.size();++i){
       if (pointPaths.at(i) * coveredDistance > 0.) {
@@ -1161,15 +1131,13 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
     if(calcCov){ //calculate Jacobian jac
       for(int i=0;i<7;++i){
 	      for(int j=0;j<7;++j){
-	        if(i<6) jac[i][j] = P[ (i+1)*7+j ];
-	        else jac[i][j] = P[ (i+1)*7+j ]/P[6];
+	        if(i<6) jac(i,j) = P[ (i+1)*7+j ];
+	        else jac(i,j) = P[ (i+1)*7+j ]/P[6];
 	      }
       }
-      jacT = jac;
-      jacT.T();
     }
 
-    TMatrixT<Double_t> noise(7,7); // zero everywhere by default
+    M7x7 noise; // zero everywhere by default
 
     // call MatEffects
     double momLoss; // momLoss has a sign - negative loss means momentum gain
@@ -1190,7 +1158,7 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
                                fabs(fCharge/P[6]), // momentum
                                fPdg,
                                calcCov,
-                               &noise,
+                               calcCov ? &noise : NULL, // the noise is only needed with the covariance
                                &jac,
                                &directionBefore,
                                &directionAfter);
@@ -1200,8 +1168,8 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
     }
 
     if(calcCov){ //propagate cov and add noise
-      oldCov = *cov;
-      *cov = jacT*((oldCov)*jac)+noise;
+      M7x7 covJac = (*cov)*jac;
+      *cov = ROOT::Math::Transpose(jac)*covJac+noise;
     }
 
 
@@ -1211,10 +1179,10 @@ double genf::RKTrackRep::Extrap( const GFDetPlane& plane, TMatrixT<Double_t>* st
       if(plane.distance(P[0],P[1],P[2])<MINSTEP) break;
     }
   }
-  (*state)[0][0] = P[0];  (*state)[1][0] = P[1];
-  (*state)[2][0] = P[2];  (*state)[3][0] = P[3];
-  (*state)[4][0] = P[4];  (*state)[5][0] = P[5];
-  (*state)[6][0] = P[6];
+  state[0] = P[0];  state[1] = P[1];
+  state[2] = P[2];  state[3] = P[3];
+  state[4] = P[4];  state[5] = P[5];
+  state[6] = P[6];
 
   return sumDistance;
 }
@@ -32,6 +32,8 @@
 #include "larreco/Genfit/GFAbsTrackRep.h"
 #include "larreco/Genfit/GFDetPlane.h"
 #include <TMatrixT.h>
+#include "Math/SMatrix.h"
+#include "Math/SVector.h"
 
 namespace genf { class GFTrackCand; }
 
@@ -164,6 +166,15 @@ class RKTrackRep : public GFAbsTrackRep {
 
  private:
 
+  // Fixed size state and matrices used by the propagation; the public
+  // interface above converts from and to the TMatrixT of GFAbsTrackRep
+  typedef ROOT::Math::SVector<double,5>   State5; // q/p, u', v', u, v
+  typedef ROOT::Math::SVector<double,7>   State7; // x, y, z, a_x, a_y, a_z, q/p
+  typedef ROOT::Math::SMatrix<double,5,5> M5x5;
+  typedef ROOT::Math::SMatrix<double,7,7> M7x7;
+  typedef ROOT::Math::SMatrix<double,7,5> M7x5;
+  typedef ROOT::Math::SMatrix<double,5,7> M5x7;
+
   GFDetPlane fCachePlane;
   double fCacheSpu;
   double fSpu;
@@ -206,7 +217,12 @@ class RKTrackRep : public GFAbsTrackRep {
     * Extrap() will loop until the plane is reached, unless the propagation fails or the maximum number of
     * iterations is exceeded.
     */
-  double Extrap(const GFDetPlane& plane, TMatrixT<Double_t>* state, TMatrixT<Double_t>* cov=NULL) const;
+  double Extrap(const GFDetPlane& plane, State7& state, M7x7* cov=NULL) const;
+
+  //! Implementation of both extrapolate() methods
+  /** The covariance matrix is propagated (and #fCachePlane, #fCacheSpu are set) only if #covPred is given.
+    */
+  double propagate(const GFDetPlane& plane, State5& statePred, M5x5* covPred=NULL);
 
 
   //  void setData(const TMatrixT<Double_t>& /* st */, const GFDetPlane& /* pl */, const TMatrixT<Double_t>* cov=NULL, const TMatrixT<double>* aux=NULL);
@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////
+//
+// AllocationCounter
+//
+// Replacement of the global operator new which counts the calls. It is
+// built as a separate library, never linked by anything, meant to be
+// preloaded (LD_PRELOAD) in benchmark jobs; HitFinderBenchmark looks up
+// larreco_allocation_count() at run time and reports the counts if the
+// library is there.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<unsigned long long> gAllocationCount{0};
+}
+
+extern "C" unsigned long long larreco_allocation_count()
+{
+    return gAllocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size)
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept                              {std::free(ptr);}
+void operator delete[](void* ptr) noexcept                            {std::free(ptr);}
+void operator delete(void* ptr, std::size_t) noexcept                 {std::free(ptr);}
+void operator delete[](void* ptr, std::size_t) noexcept               {std::free(ptr);}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept       {std::free(ptr);}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept     {std::free(ptr);}
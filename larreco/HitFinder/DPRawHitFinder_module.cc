@@ -35,8 +35,11 @@
 
 // C/C++ standard library
 #include <algorithm> // std::accumulate()
+#include <array>
+#include <limits>
 #include <string>
 #include <memory> // std::unique_ptr()
+#include <tuple>
 #include <utility> // std::move()
 #include <cmath>
 
@@ -49,20 +52,27 @@
 #include "art_root_io/TFileService.h"
 #include "art/Framework/Services/System/TriggerNamesService.h"
 #include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 
 // LArSoft Includes
 #include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
 #include "larcore/Geometry/Geometry.h"
+#include "larcore/CoreUtils/ServiceUtil.h" // lar::providerFrom()
 #include "lardataobj/RecoBase/Wire.h"
 #include "lardataobj/RecoBase/Hit.h"
 #include "lardata/ArtDataHelper/HitCreator.h"
 #include "lardata/ArtDataHelper/MVAWriter.h"
+#include "larreco/RecoAlg/ExponentialPulseFitter.h"
 
 // ROOT Includes
+#include "TF1.h"
 #include "TH1F.h"
 #include "TMath.h"
-#include "TF1.h"
+#include "TTree.h"
+
+// TBB Includes
+#include "tbb/parallel_for.h"
 
 namespace hit{
   class DPRawHitFinder : public art::EDProducer {
@@ -82,6 +92,50 @@ namespace hit{
     using PeakDevVec	   = std::vector<std::tuple<double,int,int,int>>;
     using ParameterVec 	   = std::vector<std::pair<double,double>>;  //< parameter/error vec
 
+    /// Fit state, one is owned by each worker
+    struct HitFinderWorker
+    {
+        ExponentialPulseFitter fitter;   ///< fitter with its reusable workspaces
+        std::vector<double>    params;   ///< starting values and results of a fit
+        std::vector<double>    parMin;   ///< lower limits of the fit parameters
+        std::vector<double>    parMax;   ///< upper limits of the fit parameters
+    };
+
+    /// One fit done again with ROOT, and the hit parameters of both fits
+    struct FitComparison
+    {
+        std::vector<double> seeds;            ///< starting values of the fit
+        int                 nPeaks;
+        double              chi2;
+        double              rootChi2;
+        int                 NDF;
+        int                 rootNDF;
+        std::vector<double> params;
+        std::vector<double> parErrors;
+        std::vector<double> rootParams;
+        std::vector<double> rootParErrors;
+        std::vector<double> peakTime;         ///< maximum of each pulse (ticks from the ROI start)
+        std::vector<double> rootPeakTime;
+        std::vector<double> peakWidth;        ///< width of each pulse, as stored in the hit
+        std::vector<double> rootPeakWidth;
+        std::vector<double> charge;           ///< charge of each pulse, as stored in the hit
+        std::vector<double> rootCharge;
+    };
+
+    /// Hits produced by one worker, kept with the index of their wire and
+    /// their fit parameters so the output can be assembled in input wire order
+    struct HitOutputBuffer
+    {
+        std::vector<std::tuple<recob::Hit,size_t,std::array<float,4>>> hitVec;
+        std::vector<double>                                            firstChi2Vec;
+        std::vector<double>                                            chi2Vec;
+    };
+
+    void ProcessWire(const art::Ptr<recob::Wire>& wire,
+                     size_t                       wireIdx,
+                     HitFinderWorker&             worker,
+                     HitOutputBuffer&             outputBuffer) const;
+
     void findCandidatePeaks(std::vector<float>::const_iterator startItr,
                             std::vector<float>::const_iterator stopItr,
                             TimeValsVec&                       timeValsVec,
@@ -91,38 +145,60 @@ namespace hit{
     int EstimateFluctuations(const std::vector<float>  fsignalVec,
                              int 		       peakStart,
 			     int		       peakMean,
-			     int		       peakEnd);
-
-    void mergeCandidatePeaks(const std::vector<float> signalVec, TimeValsVec, MergedTimeWidVec&);
-
-    // ### This function will fit N-Exponentials to a TH1D where N is set ###
-    // ###            by the number of peaks found in the pulse         ###
-
-    void FitExponentials(const std::vector<float> fSignalVector,
-                         const PeakTimeWidVec     fPeakVals,
-                         int                      fStartTime,
-                         int                      fEndTime,
-                         ParameterVec&            fparamVec,
-                         double&                  fchi2PerNDF,
-                         int&                     fNDF,
-			 bool			  fSameShape);
-
-    void FindPeakWithMaxDeviation(const std::vector<float> fSignalVector,
-			  	  int			   fNPeaks,
-                          	  int                      fStartTime,
-                          	  int                      fEndTime,
-				  bool			   fSameShape,
-                          	  ParameterVec             fparamVec,
-                         	  PeakTimeWidVec           fpeakVals,
-			  	  PeakDevVec& 		   fPeakDev);
-
-    std::string CreateFitFunction(int fNPeaks, bool fSameShape);
+			     int		       peakEnd) const;
+
+    void mergeCandidatePeaks(const std::vector<float> signalVec, TimeValsVec, MergedTimeWidVec&) const;
+
+    // ### This function will fit N-Exponentials to the samples where N is set ###
+    // ###            by the number of peaks found in the pulse              ###
+
+    void FitExponentials(const std::vector<float>& fSignalVector,
+                         const PeakTimeWidVec&     fPeakVals,
+                         int                       fStartTime,
+                         int                       fEndTime,
+                         ParameterVec&             fparamVec,
+                         double&                   fchi2PerNDF,
+                         int&                      fNDF,
+			 bool			   fSameShape,
+                         HitFinderWorker&          worker) const;
+
+    // ### Fits again with the TH1F and TF1 the fit was done with before and ###
+    // ###    fills the comparison tree with the hit parameters of both     ###
+
+    void CompareWithROOTFit(const std::vector<float>&  fSignalVector,
+                            int                        fNPeaks,
+                            int                        fStartTime,
+                            int                        fEndTime,
+                            bool                       fSameShape,
+                            const std::vector<double>& fParMin,
+                            const std::vector<double>& fParMax,
+                            const HitFinderWorker&     worker) const;
+
+    // ### Peak time, width and charge of each pulse, as they are stored in the hits ###
+
+    void FillHitParameters(const std::vector<double>& fParams,
+                           int                        fNPeaks,
+                           int                        fStartTime,
+                           int                        fEndTime,
+                           bool                       fSameShape,
+                           std::vector<double>&       fPeakTime,
+                           std::vector<double>&       fPeakWidth,
+                           std::vector<double>&       fCharge) const;
+
+    void FindPeakWithMaxDeviation(const std::vector<float>& fSignalVector,
+			  	  int			    fNPeaks,
+                          	  int                       fStartTime,
+                          	  int                       fEndTime,
+				  bool			    fSameShape,
+                          	  const ParameterVec&       fparamVec,
+                         	  const PeakTimeWidVec&     fpeakVals,
+			  	  PeakDevVec& 		    fPeakDev) const;
 
     void AddPeak(std::tuple<double,int,int,int> fPeakDevCand,
-		 PeakTimeWidVec& 		fpeakValsTemp);
+		 PeakTimeWidVec& 		fpeakValsTemp) const;
 
     void SplitPeak(std::tuple<double,int,int,int> fPeakDevCand,
-		   PeakTimeWidVec& 		  fpeakValsTemp);
+		   PeakTimeWidVec& 		  fpeakValsTemp) const;
 
     double WidthFunc(double fPeakMean,
 		     double fPeakAmp,
@@ -130,14 +206,14 @@ namespace hit{
 		     double fPeakTau2,
 		     double fStartTime,
 		     double fEndTime,
-		     double fPeakMeanTrue);
+		     double fPeakMeanTrue) const;
 
     double ChargeFunc(double fPeakMean,
 		      double fPeakAmp,
 		      double fPeakTau1,
 		      double fPeakTau2,
 		      double fChargeNormFactor,
-		      double fPeakMeanTrue);
+		      double fPeakMeanTrue) const;
 
     void FillOutHitParameterVector(const std::vector<double>& input,
 				   std::vector<double>& output);
@@ -195,6 +271,10 @@ namespace hit{
     int    fLongMaxHits;
     int    fLongPulseWidth;
     int	   fMaxFluctuations;
+    size_t fNumThreads;                     // number of workers the wires are partitioned over
+    bool   fCompareWithROOTFit;             // fit again with ROOT and fill the FitComparison tree
+
+    std::vector<HitFinderWorker> fWorkerVec; // one fit state per worker
 
     art::InputTag fNewHitsTag;              // tag of hits produced by this module, need to have it for fit parameter data products
     anab::FVectorWriter<4> fHitParamWriter; // helper for saving hit fit parameters in data products
@@ -202,6 +282,11 @@ namespace hit{
     TH1F* fFirstChi2;
     TH1F* fChi2;
 
+    TTree*                fComparisonTree = nullptr;
+    mutable FitComparison fComparison;      // the branches of fComparisonTree
+
+    const geo::GeometryCore* fGeometry = lar::providerFrom<geo::Geometry>();
+
   }; // class DPRawHitFinder
 
 
@@ -246,6 +331,24 @@ DPRawHitFinder::DPRawHitFinder(fhicl::ParameterSet const& pset) :
     fLongMaxHits                 = pset.get< double >("LongMaxHits");
     fLongPulseWidth              = pset.get< double >("LongPulseWidth");
     fMaxFluctuations		 = pset.get< double >("MaxFluctuations");
+    fNumThreads                  = std::max(pset.get< size_t >("NumThreads", 1), size_t(1));
+    fCompareWithROOTFit          = pset.get< bool >("CompareWithROOTFit", false);
+
+    // the printout of the workers would be interleaved
+    if (fNumThreads > 1 && fLogLevel > 0)
+    {
+      mf::LogWarning("DPRawHitFinder") << "LogLevel is enabled, forcing NumThreads to 1";
+      fNumThreads = 1;
+    }
+
+    // the ROOT fits and the comparison tree are not shared between workers
+    if (fNumThreads > 1 && fCompareWithROOTFit)
+    {
+      mf::LogWarning("DPRawHitFinder") << "CompareWithROOTFit is enabled, forcing NumThreads to 1";
+      fNumThreads = 1;
+    }
+
+    fWorkerVec.resize(fNumThreads);
 
     // let HitCollectionCreator declare that we are going to produce
     // hits and associations with wires and raw digits
@@ -291,23 +394,36 @@ void DPRawHitFinder::beginJob()
     // === Hit Information for Histograms ===
     fFirstChi2 = tfs->make<TH1F>("fFirstChi2", "#chi^{2}", 10000, 0, 5000);
     fChi2      = tfs->make<TH1F>("fChi2", "#chi^{2}", 10000, 0, 5000);
+
+    if (!fCompareWithROOTFit) return;
+
+    // === Every fit, done with ExponentialPulseFitter and with ROOT ===
+    fComparisonTree = tfs->make<TTree>("FitComparison", "ExponentialPulseFitter vs ROOT fits");
+    fComparisonTree->Branch("nPeaks",        &fComparison.nPeaks,   "nPeaks/I");
+    fComparisonTree->Branch("chi2",          &fComparison.chi2,     "chi2/D");
+    fComparisonTree->Branch("rootChi2",      &fComparison.rootChi2, "rootChi2/D");
+    fComparisonTree->Branch("NDF",           &fComparison.NDF,      "NDF/I");
+    fComparisonTree->Branch("rootNDF",       &fComparison.rootNDF,  "rootNDF/I");
+    fComparisonTree->Branch("params",        &fComparison.params);
+    fComparisonTree->Branch("parErrors",     &fComparison.parErrors);
+    fComparisonTree->Branch("rootParams",    &fComparison.rootParams);
+    fComparisonTree->Branch("rootParErrors", &fComparison.rootParErrors);
+    fComparisonTree->Branch("peakTime",      &fComparison.peakTime);
+    fComparisonTree->Branch("rootPeakTime",  &fComparison.rootPeakTime);
+    fComparisonTree->Branch("peakWidth",     &fComparison.peakWidth);
+    fComparisonTree->Branch("rootPeakWidth", &fComparison.rootPeakWidth);
+    fComparisonTree->Branch("charge",        &fComparison.charge);
+    fComparisonTree->Branch("rootCharge",    &fComparison.rootCharge);
 }
 
 //-------------------------------------------------
 void DPRawHitFinder::produce(art::Event& evt)
 {
   //==================================================================================================
-  TH1::AddDirectory(kFALSE);
-
   //Instantiate and Reset a stop watch
   //TStopwatch StopWatch;
   //StopWatch.Reset();
 
-  // ################################
-  // ### Calling Geometry service ###
-  // ################################
-  art::ServiceHandle<geo::Geometry const> geom;
-
   // ###############################################
   // ### Making a ptr vector to put on the event ###
   // ###############################################
@@ -328,28 +444,79 @@ void DPRawHitFinder::produce(art::Event& evt)
   // ### Reading in the RawDigit associated with these wires, too  ###
   // #################################################################
   art::FindOneP<raw::RawDigit> RawDigits(wireVecHandle, evt, fCalDataModuleLabel);
-  // Channel Number
-  raw::ChannelID_t channel = raw::InvalidChannelID;
 
   //##############################
   //### Looping over the wires ###
   //##############################
-  for(size_t wireIter = 0; wireIter < wireVecHandle->size(); wireIter++)
+  // The wires are split into contiguous blocks, one per worker, and each worker
+  // buffers its hits so the collections below are filled in input wire order
+  // independent of how many workers were used
+  size_t const nWires  = wireVecHandle->size();
+  size_t const nBlocks = std::max(std::min(fNumThreads, nWires), size_t(1));
+
+  std::vector<HitOutputBuffer> outputBufferVec(nBlocks);
+
+  auto processBlock = [&](size_t blockIdx)
   {
-    // ####################################
-    // ### Getting this particular wire ###
-    // ####################################
-    art::Ptr<recob::Wire>   wire(wireVecHandle, wireIter);
-    art::Ptr<raw::RawDigit> rawdigits = RawDigits.at(wireIter);
-    // --- Setting Channel Number and Signal type ---
-    channel = wire->Channel();
-    // get the WireID for this hit
-    std::vector<geo::WireID> wids = geom->ChannelToWire(channel);
-    // for now, just take the first option returned from ChannelToWire
-    geo::WireID wid  = wids[0];
-
-      if(fLogLevel >= 1)
-      {
+    size_t const firstWire = blockIdx * nWires / nBlocks;
+    size_t const lastWire  = (blockIdx + 1) * nWires / nBlocks;
+
+    for(size_t wireIter = firstWire; wireIter < lastWire; wireIter++)
+    {
+      // ####################################
+      // ### Getting this particular wire ###
+      // ####################################
+      art::Ptr<recob::Wire> wire(wireVecHandle, wireIter);
+
+      ProcessWire(wire, wireIter, fWorkerVec[blockIdx], outputBufferVec[blockIdx]);
+    }
+  };
+
+  if (nBlocks > 1) tbb::parallel_for(size_t(0), nBlocks, processBlock);
+  else             processBlock(0);
+
+  // Now merge the worker outputs, block order is wire order
+  for(auto& outputBuffer : outputBufferVec)
+  {
+    for(const auto& firstChi2 : outputBuffer.firstChi2Vec) fFirstChi2->Fill(firstChi2);
+    for(const auto& chi2      : outputBuffer.chi2Vec)      fChi2->Fill(chi2);
+
+    for(auto& hitTuple : outputBuffer.hitVec)
+    {
+      size_t const wireIdx = std::get<1>(hitTuple);
+
+      hcol.emplace_back(std::move(std::get<0>(hitTuple)), art::Ptr<recob::Wire>(wireVecHandle, wireIdx), RawDigits.at(wireIdx));
+      // add fit parameters associated to the hit just pushed to the collection
+      fHitParamWriter.addVector(hitID, std::get<2>(hitTuple));
+    }
+  }
+
+    //==================================================================================================
+    // End of the event
+
+    // move the hit collection and the associations into the event
+    hcol.put_into(evt);
+
+    // and put hit fit parameters together with metadata into the event
+    fHitParamWriter.saveOutputs(evt);
+
+} // End of produce()
+
+//-------------------------------------------------
+void DPRawHitFinder::ProcessWire(const art::Ptr<recob::Wire>& wire,
+                                 size_t                       wireIdx,
+                                 HitFinderWorker&             worker,
+                                 HitOutputBuffer&             outputBuffer) const
+{
+  // --- Setting Channel Number and Signal type ---
+  raw::ChannelID_t channel = wire->Channel();
+  // get the WireID for this hit
+  std::vector<geo::WireID> wids = fGeometry->ChannelToWire(channel);
+  // for now, just take the first option returned from ChannelToWire
+  geo::WireID wid  = wids[0];
+
+    if(fLogLevel >= 1)
+    {
 	std::cout << std::endl;
 	std::cout << std::endl;
 	std::cout << std::endl;
@@ -359,62 +526,62 @@ void DPRawHitFinder::produce(art::Event& evt)
 	std::cout << "TPC: " << wid.TPC << std::endl;
 	std::cout << "Plane: " << wid.Plane << std::endl;
 	std::cout << "Wire: " << wid.Wire << std::endl;
-      }
+    }
 
-      // #################################################
-      // ### Set up to loop over ROI's for this wire   ###
-      // #################################################
-      const recob::Wire::RegionsOfInterest_t& signalROI = wire->SignalROI();
+    // #################################################
+    // ### Set up to loop over ROI's for this wire   ###
+    // #################################################
+    const recob::Wire::RegionsOfInterest_t& signalROI = wire->SignalROI();
 
-      int CountROI=0;
+    int CountROI=0;
 
-      for(const auto& range : signalROI.get_ranges())
-      {
-        // #################################################
-        // ### Getting a vector of signals for this wire ###
-        // #################################################
-        const std::vector<float>& signal = range.data();
+    for(const auto& range : signalROI.get_ranges())
+    {
+      // #################################################
+      // ### Getting a vector of signals for this wire ###
+      // #################################################
+      const std::vector<float>& signal = range.data();
 
-        // ROI start time
-        raw::TDCtick_t roiFirstBinTick = range.begin_index();
-        MergedTimeWidVec mergedVec;
+      // ROI start time
+      raw::TDCtick_t roiFirstBinTick = range.begin_index();
+      MergedTimeWidVec mergedVec;
 
-        // ###########################################################
-        // ### If option set do bin averaging before finding peaks ###
-        // ###########################################################
+      // ###########################################################
+      // ### If option set do bin averaging before finding peaks ###
+      // ###########################################################
 
-        if (fNumBinsToAverage > 1)
-        {
-          std::vector<float> timeAve;
-          doBinAverage(signal, timeAve, fNumBinsToAverage);
-
-          // ###################################################################
-          // ### Search current averaged ROI for candidate peaks and widths  ###
-          // ###################################################################
-          TimeValsVec timeValsVec;
-          findCandidatePeaks(timeAve.begin(),timeAve.end(),timeValsVec,fMinSig,0);
-
-          // ####################################################
-          // ### If no startTime hit was found skip this wire ###
-          // ####################################################
-          if (timeValsVec.empty()) continue;
-
-          // #############################################################
-          // ### Merge potentially overlapping peaks and do multi fit  ###
-          // #############################################################
-          mergeCandidatePeaks(timeAve, timeValsVec, mergedVec);
-        }
+      if (fNumBinsToAverage > 1)
+      {
+        std::vector<float> timeAve;
+        doBinAverage(signal, timeAve, fNumBinsToAverage);
+
+        // ###################################################################
+        // ### Search current averaged ROI for candidate peaks and widths  ###
+        // ###################################################################
+        TimeValsVec timeValsVec;
+        findCandidatePeaks(timeAve.begin(),timeAve.end(),timeValsVec,fMinSig,0);
+
+        // ####################################################
+        // ### If no startTime hit was found skip this wire ###
+        // ####################################################
+        if (timeValsVec.empty()) continue;
+
+        // #############################################################
+        // ### Merge potentially overlapping peaks and do multi fit  ###
+        // #############################################################
+        mergeCandidatePeaks(timeAve, timeValsVec, mergedVec);
+      }
 
-        // ###########################################################
-        // ### Otherwise, operate directonly on signal vector      ###
-        // ###########################################################
-        else
-        {
-          // ##########################################################
-          // ### Search current ROI for candidate peaks and widths  ###
-          // ##########################################################
-          TimeValsVec timeValsVec;
-          findCandidatePeaks(signal.begin(),signal.end(),timeValsVec,fMinSig,0);
+      // ###########################################################
+      // ### Otherwise, operate directonly on signal vector      ###
+      // ###########################################################
+      else
+      {
+        // ##########################################################
+        // ### Search current ROI for candidate peaks and widths  ###
+        // ##########################################################
+        TimeValsVec timeValsVec;
+        findCandidatePeaks(signal.begin(),signal.end(),timeValsVec,fMinSig,0);
 
 	  if(fLogLevel >=1)
 	  {
@@ -423,55 +590,55 @@ void DPRawHitFinder::produce(art::Event& evt)
 	    std::cout << "-------------------- ROI #" << CountROI << " -------------------- " << std::endl;
 	    if(timeValsVec.size() == 1) std::cout << "ROI #" << CountROI << " (" << timeValsVec.size() << " peak):   ROIStartTick: " << range.offset << "    ROIEndTick:" << range.offset+range.size() << std::endl;
 	    else std::cout << "ROI #" << CountROI << " (" << timeValsVec.size() << " peaks):   ROIStartTick: " << range.offset << "    ROIEndTick:" << range.offset+range.size() << std::endl;
-            CountROI++;
+          CountROI++;
 	  }
 
  	  if(fLogLevel >=2)
 	  {
 	    int CountPeak=0;
-            for( auto const& timeValsTmp : timeValsVec )
+          for( auto const& timeValsTmp : timeValsVec )
 	    {
 	      std::cout << "Peak #" << CountPeak << ":   PeakStartTick: " << range.offset + std::get<0>(timeValsTmp) << "    PeakMaxTick: " << range.offset + std::get<1>(timeValsTmp) << "    PeakEndTick: " << range.offset + std::get<2>(timeValsTmp) << std::endl;
 	      CountPeak++;
 	    }
 	  }
-          // ####################################################
-          // ### If no startTime hit was found skip this wire ###
-          // ####################################################
-          if (timeValsVec.empty()) continue;
+        // ####################################################
+        // ### If no startTime hit was found skip this wire ###
+        // ####################################################
+        if (timeValsVec.empty()) continue;
 
-          // #############################################################
-          // ### Merge potentially overlapping peaks and do multi fit  ###
-          // #############################################################
-          mergeCandidatePeaks(signal, timeValsVec, mergedVec);
+        // #############################################################
+        // ### Merge potentially overlapping peaks and do multi fit  ###
+        // #############################################################
+        mergeCandidatePeaks(signal, timeValsVec, mergedVec);
 
-        }
+      }
 
-        // #######################################################
-        // ### Creating the parameter vector for the new pulse ###
-        // #######################################################
-        ParameterVec paramVec;
+      // #######################################################
+      // ### Creating the parameter vector for the new pulse ###
+      // #######################################################
+      ParameterVec paramVec;
 
-        // === Number of Exponentials to try ===
+      // === Number of Exponentials to try ===
 	int NumberOfPeaksBeforeFit=0;
-        unsigned int nExponentialsForFit=0;
-        double       chi2PerNDF=0.;
-        int          NDF=0;
+      unsigned int nExponentialsForFit=0;
+      double       chi2PerNDF=0.;
+      int          NDF=0;
 
 	unsigned int NumberOfMergedVecs = mergedVec.size();
 
-        // ################################################################
-        // ### Lets loop over the groups of peaks we found on this wire ###
-        // ################################################################
+      // ################################################################
+      // ### Lets loop over the groups of peaks we found on this wire ###
+      // ################################################################
 
-        for(unsigned int j=0; j < NumberOfMergedVecs; j++)
-        {
-          int startT = std::get<0>(mergedVec.at(j));
-          int endT   = std::get<1>(mergedVec.at(j));
+      for(unsigned int j=0; j < NumberOfMergedVecs; j++)
+      {
+        int startT = std::get<0>(mergedVec.at(j));
+        int endT   = std::get<1>(mergedVec.at(j));
 	  int width  = endT + 1 - startT;
-          PeakTimeWidVec& peakVals = std::get<2>(mergedVec.at(j));
+        PeakTimeWidVec& peakVals = std::get<2>(mergedVec.at(j));
 
-          int NFluctuations = std::get<3>(mergedVec.at(j));
+        int NFluctuations = std::get<3>(mergedVec.at(j));
 
  	  if(fLogLevel >=3)
 	  {
@@ -487,8 +654,8 @@ void DPRawHitFinder::produce(art::Event& evt)
 	    }
 	  }
 
-          // ### Getting rid of noise hits ###
-          if (width < fMinWidth || (double)std::accumulate(signal.begin()+startT, signal.begin()+endT+1, 0) < fMinADCSum || (double)std::accumulate(signal.begin()+startT, signal.begin()+endT+1, 0)/width < fMinADCSumOverWidth)
+        // ### Getting rid of noise hits ###
+        if (width < fMinWidth || (double)std::accumulate(signal.begin()+startT, signal.begin()+endT+1, 0) < fMinADCSum || (double)std::accumulate(signal.begin()+startT, signal.begin()+endT+1, 0)/width < fMinADCSumOverWidth)
 	  {
 	    if(fLogLevel >=3)
 	    {
@@ -498,9 +665,9 @@ void DPRawHitFinder::produce(art::Event& evt)
 	  }
 
 
-          // #####################################################################################################
-          // ### Only attempt to fit if number of peaks <= fMaxMultiHit and if group length <= fMaxGroupLength ###
-          // #####################################################################################################
+        // #####################################################################################################
+        // ### Only attempt to fit if number of peaks <= fMaxMultiHit and if group length <= fMaxGroupLength ###
+        // #####################################################################################################
 	  NumberOfPeaksBeforeFit = peakVals.size();
 	  nExponentialsForFit = peakVals.size();
 	  chi2PerNDF = 0.;
@@ -508,10 +675,10 @@ void DPRawHitFinder::produce(art::Event& evt)
 	  if(NumberOfPeaksBeforeFit <= fMaxMultiHit && width <= fMaxGroupLength && NFluctuations <= fMaxFluctuations)
 	  {
 	    // #####################################################
-            // ### Calling the function for fitting Exponentials ###
-            // #####################################################
+          // ### Calling the function for fitting Exponentials ###
+          // #####################################################
 	    paramVec.clear();
-	    FitExponentials(signal, peakVals, startT, endT, paramVec, chi2PerNDF, NDF, fSameShape);
+	    FitExponentials(signal, peakVals, startT, endT, paramVec, chi2PerNDF, NDF, fSameShape, worker);
 
 	    if(fLogLevel >=4)
 	    {
@@ -547,7 +714,7 @@ void DPRawHitFinder::produce(art::Event& evt)
 	    // If the chi2 is infinite then there is a real problem so we bail
 	    if (!(chi2PerNDF < std::numeric_limits<double>::infinity())) continue;
 
-	    fFirstChi2->Fill(chi2PerNDF);
+	    outputBuffer.firstChi2Vec.push_back(chi2PerNDF);
 
 	    // ########################################################
 	    // ### Trying extra Exponentials for an initial bad fit ###
@@ -579,7 +746,7 @@ void DPRawHitFinder::produce(art::Event& evt)
 		  peakValsTemp = peakVals;
 
 		  AddPeak(PeakDevCand, peakValsTemp);
-		  FitExponentials(signal, peakValsTemp, startT, endT, paramVecRefit, chi2PerNDF2, NDF2, fSameShape);
+		  FitExponentials(signal, peakValsTemp, startT, endT, paramVecRefit, chi2PerNDF2, NDF2, fSameShape, worker);
 
 		  if (chi2PerNDF2 < chi2PerNDF)
 		  {
@@ -605,7 +772,7 @@ void DPRawHitFinder::produce(art::Event& evt)
 		    peakValsTemp=peakVals;
 
 		    SplitPeak(PeakDevCand, peakValsTemp);
-		    FitExponentials(signal, peakValsTemp, startT, endT, paramVecRefit, chi2PerNDF2, NDF2, fSameShape);
+		    FitExponentials(signal, peakValsTemp, startT, endT, paramVecRefit, chi2PerNDF2, NDF2, fSameShape, worker);
 
 		    if (chi2PerNDF2 < chi2PerNDF)
 		    {
@@ -671,32 +838,32 @@ void DPRawHitFinder::produce(art::Event& evt)
 	      }
 	    }
 
-            // #######################################################
-            // ### Loop through returned peaks and make recob hits ###
-            // #######################################################
+          // #######################################################
+          // ### Loop through returned peaks and make recob hits ###
+          // #######################################################
 
-              int numHits(0);
-              for(unsigned int i = 0; i < nExponentialsForFit; i++)
-              {
-                //Extract fit parameters for this hit
+            int numHits(0);
+            for(unsigned int i = 0; i < nExponentialsForFit; i++)
+            {
+              //Extract fit parameters for this hit
 		double peakTau1;
 	        double peakTau2;
-                double peakAmp;
-                double peakMean;
+              double peakAmp;
+              double peakMean;
 
 		if(fSameShape)
 		{
 		  peakTau1 = paramVec[0].first;
 	          peakTau2 = paramVec[1].first;
-                  peakAmp  = paramVec[2*(i+1)].first;
-                  peakMean = paramVec[2*(i+1)+1].first;
+                peakAmp  = paramVec[2*(i+1)].first;
+                peakMean = paramVec[2*(i+1)+1].first;
 		}
 		else
 		{
 		  peakTau1 = paramVec[4*i].first;
 	          peakTau2 = paramVec[4*i+1].first;
-                  peakAmp  = paramVec[4*i+2].first;
-                  peakMean = paramVec[4*i+3].first;
+                peakAmp  = paramVec[4*i+2].first;
+                peakMean = paramVec[4*i+3].first;
 		}
 
 	 	//Highest ADC count in peak = peakAmpTrue
@@ -704,44 +871,38 @@ void DPRawHitFinder::produce(art::Event& evt)
 		double peakAmpErr = 1.;
 
 	 	//Determine peak position of fitted function (= peakMeanTrue)
-		TF1 Exponentials("Exponentials","( [0] * exp(0.4*(x-[1])/[2]) / ( 1 + exp(0.4*(x-[1])/[3]) ) )",startT,endT);
-        	Exponentials.SetParameter(0, peakAmp);
-        	Exponentials.SetParameter(1, peakMean);
-        	Exponentials.SetParameter(2, peakTau1);
-        	Exponentials.SetParameter(3, peakTau2);
-		double peakMeanTrue = Exponentials.GetMaximumX(startT,endT);
-		Exponentials.Delete();
+		double peakMeanTrue = ExponentialPulseFitter::PulseMaximumX(peakMean, peakTau1, peakTau2, startT, endT);
 
 		//Calculate width (=FWHM)
 		double peakWidth = WidthFunc(peakMean, peakAmp, peakTau1, peakTau2, startT, endT, peakMeanTrue);
 		peakWidth /= fWidthNormalization; //from FWHM to "standard deviation": standard deviation = FWHM/(2*sqrt(2*ln(2)))
 
 
-                // Extract fit parameter errors
-                double peakMeanErr;
+              // Extract fit parameter errors
+              double peakMeanErr;
 
 		if(fSameShape)
 		{
-                  peakMeanErr  = paramVec[2*(i+1)+1].second;
+                peakMeanErr  = paramVec[2*(i+1)+1].second;
 		}
 		else
 		{
-                  peakMeanErr  = paramVec[4*i+3].second;
+                peakMeanErr  = paramVec[4*i+3].second;
 		}
-                double peakWidthErr = 0.1*peakWidth;
+              double peakWidthErr = 0.1*peakWidth;
 
-                // ### Charge ###
-                double charge = ChargeFunc(peakMean, peakAmp, peakTau1, peakTau2, fChargeNorm, peakMeanTrue);
-                double chargeErr = std::sqrt(TMath::Pi()) * (peakAmpErr*peakWidthErr + peakWidthErr*peakAmpErr);
+              // ### Charge ###
+              double charge = ChargeFunc(peakMean, peakAmp, peakTau1, peakTau2, fChargeNorm, peakMeanTrue);
+              double chargeErr = std::sqrt(TMath::Pi()) * (peakAmpErr*peakWidthErr + peakWidthErr*peakAmpErr);
 
-                // ### limits for getting sum of ADC counts
+              // ### limits for getting sum of ADC counts
 	        int startTthisHit = std::get<2>(peakVals.at(i));
 	        int endTthisHit = std::get<3>(peakVals.at(i));
-                std::vector<float>::const_iterator sumStartItr = signal.begin() + startTthisHit;
-                std::vector<float>::const_iterator sumEndItr   = signal.begin() + endTthisHit;
+              std::vector<float>::const_iterator sumStartItr = signal.begin() + startTthisHit;
+              std::vector<float>::const_iterator sumEndItr   = signal.begin() + endTthisHit;
 
-                // ### Sum of ADC counts
-                double sumADC = std::accumulate(sumStartItr, sumEndItr + 1, 0.);
+              // ### Sum of ADC counts
+              double sumADC = std::accumulate(sumStartItr, sumEndItr + 1, 0.);
 
 
 		//Check if fit returns reasonable values and ich chi2 is below threshold
@@ -768,30 +929,30 @@ void DPRawHitFinder::produce(art::Event& evt)
 		  peakMeanTrue = std::get<0>(peakVals.at(i));
 
 		  //set the fit values to make it visible in the event display that this fit failed
-                  peakMean = peakMeanTrue;
-                  peakTau1 = 0.008;
-                  peakTau2 = 0.0065;
+                peakMean = peakMeanTrue;
+                peakTau1 = 0.008;
+                peakTau2 = 0.0065;
 		  peakAmp = 20.;
 		}
 
-                // Create the hit
+              // Create the hit
 		recob::HitCreator hitcreator(*wire,                            // wire reference
-                                             wid,                              // wire ID
-                                             startTthisHit+roiFirstBinTick,    // start_tick TODO check
-                                             endTthisHit+roiFirstBinTick,  // end_tick TODO check
-                                             peakWidth,                        // rms
-                                             peakMeanTrue+roiFirstBinTick,     // peak_time
-                                             peakMeanErr,                      // sigma_peak_time
-                                             peakAmpTrue,                      // peak_amplitude
-                                             peakAmpErr,                       // sigma_peak_amplitude
-                                             charge,                           // hit_integral
-                                             chargeErr,                        // hit_sigma_integral
-                                             sumADC,                           // summedADC FIXME
-                                             nExponentialsForFit,              // multiplicity
-                                             numHits,                          // local_index TODO check that the order is correct
-                                             chi2PerNDF,                       // goodness_of_fit
-                                             NDF                               // dof
-                                             );
+                                           wid,                              // wire ID
+                                           startTthisHit+roiFirstBinTick,    // start_tick TODO check
+                                           endTthisHit+roiFirstBinTick,  // end_tick TODO check
+                                           peakWidth,                        // rms
+                                           peakMeanTrue+roiFirstBinTick,     // peak_time
+                                           peakMeanErr,                      // sigma_peak_time
+                                           peakAmpTrue,                      // peak_amplitude
+                                           peakAmpErr,                       // sigma_peak_amplitude
+                                           charge,                           // hit_integral
+                                           chargeErr,                        // hit_sigma_integral
+                                           sumADC,                           // summedADC FIXME
+                                           nExponentialsForFit,              // multiplicity
+                                           numHits,                          // local_index TODO check that the order is correct
+                                           chi2PerNDF,                       // goodness_of_fit
+                                           NDF                               // dof
+                                           );
 
 		if(fLogLevel >=6)
 	    	{
@@ -810,42 +971,41 @@ void DPRawHitFinder::produce(art::Event& evt)
 		  std::cout << "HitNDF: " << NDF << std::endl;
 		}
 
-                const recob::Hit hit(hitcreator.move());
-
-                hcol.emplace_back(std::move(hit), wire, rawdigits);
-                // add fit parameters associated to the hit just pushed to the collection
-                std::array<float, 4> fitParams;
-                fitParams[0] = peakMean+roiFirstBinTick;
-                fitParams[1] = peakTau1;
-                fitParams[2] = peakTau2;
-                fitParams[3] = peakAmp;
-                fHitParamWriter.addVector(hitID, fitParams);
-                numHits++;
-              } // <---End loop over Exponentials
+              // keep the fit parameters associated to the hit
+              std::array<float, 4> fitParams;
+              fitParams[0] = peakMean+roiFirstBinTick;
+              fitParams[1] = peakTau1;
+              fitParams[2] = peakTau2;
+              fitParams[3] = peakAmp;
+              outputBuffer.hitVec.emplace_back(hitcreator.move(), wireIdx, fitParams);
+              numHits++;
+            } // <---End loop over Exponentials
 //            } // <---End if chi2 <= chi2Max
 	  } // <---End if(NumberOfPeaksBeforeFit <= fMaxMultiHit && width <= fMaxGroupLength), then fit
 
-          // #######################################################
-          // ### If too large then force alternate solution      ###
-          // ### - Make n hits from pulse train where n will     ###
-          // ###   depend on the fhicl parameter fLongPulseWidth ###
-          // ### Also do this if chi^2 is too large              ###
-          // #######################################################
-          if( NumberOfPeaksBeforeFit > fMaxMultiHit || (width > fMaxGroupLength) || NFluctuations > fMaxFluctuations)
-          {
+        // #######################################################
+        // ### If too large then force alternate solution      ###
+        // ### - Make n hits from pulse train where n will     ###
+        // ###   depend on the fhicl parameter fLongPulseWidth ###
+        // ### Also do this if chi^2 is too large              ###
+        // #######################################################
+        if( NumberOfPeaksBeforeFit > fMaxMultiHit || (width > fMaxGroupLength) || NFluctuations > fMaxFluctuations)
+        {
 
-            int nHitsInThisGroup = (endT - startT + 1) / fLongPulseWidth;
+          // the width is widened for this group only
+          int longPulseWidth = fLongPulseWidth;
+          int nHitsInThisGroup = (endT - startT + 1) / longPulseWidth;
 
-            if (nHitsInThisGroup > fLongMaxHits)
-            {
-              nHitsInThisGroup = fLongMaxHits;
-              fLongPulseWidth = (endT - startT + 1) / nHitsInThisGroup;
-            }
+          if (nHitsInThisGroup > fLongMaxHits)
+          {
+            nHitsInThisGroup = fLongMaxHits;
+            longPulseWidth = (endT - startT + 1) / nHitsInThisGroup;
+          }
 
-            if (nHitsInThisGroup * fLongPulseWidth < (endT - startT + 1) ) nHitsInThisGroup++;
+          if (nHitsInThisGroup * longPulseWidth < (endT - startT + 1) ) nHitsInThisGroup++;
 
-            int firstTick = startT;
-            int lastTick  = std::min(endT,firstTick+fLongPulseWidth-1);
+          int firstTick = startT;
+          int lastTick  = std::min(endT,firstTick+longPulseWidth-1);
 
 	    if(fLogLevel >= 1)
 	    {
@@ -876,54 +1036,54 @@ void DPRawHitFinder::produce(art::Event& evt)
 	      	if ( nExponentialsForFit >= 2 && chi2PerNDF > fChi2NDFMaxFactorMultiHits*fChi2NDFMax ) std::cout << "chi2/ndf of this fit (" << chi2PerNDF << ") is higher than threshold (" << fChi2NDFMaxFactorMultiHits*fChi2NDFMax << ")." << std::endl;
 	        std::cout << "---> DO NOT create hit object but split group of peaks into hits with equal length instead." << std::endl;
 	      }*/
-	      std::cout << "---> Group goes from tick " << roiFirstBinTick+startT << " to " << roiFirstBinTick+endT << ". Split group into (" << roiFirstBinTick+endT << " - " << roiFirstBinTick+startT << ")/" << fLongPulseWidth << " = " <<  (endT - startT) << "/" << fLongPulseWidth << " = " << nHitsInThisGroup << " peaks (" << fLongPulseWidth << " = LongPulseWidth), or maximum LongMaxHits = " << fLongMaxHits << " peaks." << std::endl;
+	      std::cout << "---> Group goes from tick " << roiFirstBinTick+startT << " to " << roiFirstBinTick+endT << ". Split group into (" << roiFirstBinTick+endT << " - " << roiFirstBinTick+startT << ")/" << longPulseWidth << " = " <<  (endT - startT) << "/" << longPulseWidth << " = " << nHitsInThisGroup << " peaks (" << longPulseWidth << " = LongPulseWidth), or maximum LongMaxHits = " << fLongMaxHits << " peaks." << std::endl;
 	    }
 
 
-            for(int hitIdx = 0; hitIdx < nHitsInThisGroup; hitIdx++)
-            {
-              // This hit parameters
-              double peakWidth = ( (lastTick - firstTick) /4. ) / fWidthNormalization; //~4 is the factor between FWHM and full width of the hit (last bin - first bin). no drift: 4.4, 6m drift: 3.7
+          for(int hitIdx = 0; hitIdx < nHitsInThisGroup; hitIdx++)
+          {
+            // This hit parameters
+            double peakWidth = ( (lastTick - firstTick) /4. ) / fWidthNormalization; //~4 is the factor between FWHM and full width of the hit (last bin - first bin). no drift: 4.4, 6m drift: 3.7
 	      double peakMeanTrue = (firstTick + lastTick) / 2.;
-              if( NumberOfPeaksBeforeFit == 1 && nHitsInThisGroup == 1) peakMeanTrue = std::get<0>(peakVals.at(0)); //if only one peak was found, we want the mean of this peak to be the tick with the max. ADC count
+            if( NumberOfPeaksBeforeFit == 1 && nHitsInThisGroup == 1) peakMeanTrue = std::get<0>(peakVals.at(0)); //if only one peak was found, we want the mean of this peak to be the tick with the max. ADC count
 	      double peakMeanErr = (lastTick - firstTick) / 2.;
-              double sumADC    = std::accumulate(signal.begin() + firstTick, signal.begin() + lastTick + 1, 0.);
+            double sumADC    = std::accumulate(signal.begin() + firstTick, signal.begin() + lastTick + 1, 0.);
 	      double charge = sumADC;
 	      double chargeErr = 0.1*sumADC;
 	      double peakAmpTrue = 0;
 
-              for(int tick = firstTick; tick <= lastTick; tick++)
+            for(int tick = firstTick; tick <= lastTick; tick++)
 	      {
 		if(signal[tick] > peakAmpTrue) peakAmpTrue = signal[tick];
 	      }
 
 	      double peakAmpErr = 1.;
 	      nExponentialsForFit = nHitsInThisGroup;
-              NDF         = -1;
-              chi2PerNDF  =   -1.;
+            NDF         = -1;
+            chi2PerNDF  =   -1.;
 	      //set the fit values to make it visible in the event display that this fit failed
-              double peakMean = peakMeanTrue-2;
-              double peakTau1 = 0.008;
-              double peakTau2 = 0.0065;
+            double peakMean = peakMeanTrue-2;
+            double peakTau1 = 0.008;
+            double peakTau2 = 0.0065;
 	      double peakAmp = 20.;
 
-              recob::HitCreator hitcreator(*wire,                            // wire reference
-                                           wid,                              // wire ID
-                                           firstTick+roiFirstBinTick,        // start_tick TODO check
-                                           lastTick+roiFirstBinTick,         // end_tick TODO check
-                                           peakWidth,                        // rms
-                                           peakMeanTrue+roiFirstBinTick,     // peak_time
-                                           peakMeanErr,                      // sigma_peak_time
-                                           peakAmpTrue,                          // peak_amplitude
-                                           peakAmpErr,                       // sigma_peak_amplitude
-                                           charge,                           // hit_integral
-                                           chargeErr,                        // hit_sigma_integral
-                                           sumADC,                           // summedADC FIXME
-                                           nExponentialsForFit,              // multiplicity
-                                           hitIdx,                          // local_index TODO check that the order is correct
-                                           chi2PerNDF,                       // goodness_of_fit
-                                           NDF                               // dof
-                                           );
+            recob::HitCreator hitcreator(*wire,                            // wire reference
+                                         wid,                              // wire ID
+                                         firstTick+roiFirstBinTick,        // start_tick TODO check
+                                         lastTick+roiFirstBinTick,         // end_tick TODO check
+                                         peakWidth,                        // rms
+                                         peakMeanTrue+roiFirstBinTick,     // peak_time
+                                         peakMeanErr,                      // sigma_peak_time
+                                         peakAmpTrue,                          // peak_amplitude
+                                         peakAmpErr,                       // sigma_peak_amplitude
+                                         charge,                           // hit_integral
+                                         chargeErr,                        // hit_sigma_integral
+                                         sumADC,                           // summedADC FIXME
+                                         nExponentialsForFit,              // multiplicity
+                                         hitIdx,                          // local_index TODO check that the order is correct
+                                         chi2PerNDF,                       // goodness_of_fit
+                                         NDF                               // dof
+                                         );
 
 
 	      if(fLogLevel >=6)
@@ -942,37 +1102,23 @@ void DPRawHitFinder::produce(art::Event& evt)
 	        std::cout << "Hitchi2/ndf: " << chi2PerNDF << std::endl;
 	        std::cout << "HitNDF: " << NDF << std::endl;
 	      }
-              const recob::Hit hit(hitcreator.move());
-              hcol.emplace_back(std::move(hit), wire, rawdigits);
-
-              std::array<float, 4> fitParams;
-              fitParams[0] = peakMean+roiFirstBinTick;
-              fitParams[1] = peakTau1;
-              fitParams[2] = peakTau2;
-              fitParams[3] = peakAmp;
-              fHitParamWriter.addVector(hitID, fitParams);
-
-              // set for next loop
-              firstTick = lastTick+1;
-              lastTick  = std::min(firstTick + fLongPulseWidth - 1, endT);
-
-            }//<---Hits in this group
+            std::array<float, 4> fitParams;
+            fitParams[0] = peakMean+roiFirstBinTick;
+            fitParams[1] = peakTau1;
+            fitParams[2] = peakTau2;
+            fitParams[3] = peakAmp;
+            outputBuffer.hitVec.emplace_back(hitcreator.move(), wireIdx, fitParams);
+
+            // set for next loop
+            firstTick = lastTick+1;
+            lastTick  = std::min(firstTick + longPulseWidth - 1, endT);
+
+          }//<---Hits in this group
 	  }//<---End if #peaks > MaxMultiHit
-          fChi2->Fill(chi2PerNDF);
-         }//<---End loop over merged candidate hits
-       } //<---End looping over ROI's
-     }//<---End looping over all the wires
-
-    //==================================================================================================
-    // End of the event
-
-    // move the hit collection and the associations into the event
-    hcol.put_into(evt);
-
-    // and put hit fit parameters together with metadata into the event
-    fHitParamWriter.saveOutputs(evt);
-
-} // End of produce()
+        outputBuffer.chi2Vec.push_back(chi2PerNDF);
+       }//<---End loop over merged candidate hits
+     } //<---End looping over ROI's
+} // End of ProcessWire()
 
 // --------------------------------------------------------------------------------------------
 // Initial finding of candidate peaks
@@ -1057,7 +1203,7 @@ void hit::DPRawHitFinder::findCandidatePeaks(std::vector<float>::const_iterator
 // Merging of nearby candidate peaks
 // --------------------------------------------------------------------------------------------
 
-void hit::DPRawHitFinder::mergeCandidatePeaks(const std::vector<float> signalVec, TimeValsVec timeValsVec, MergedTimeWidVec& mergedVec)
+void hit::DPRawHitFinder::mergeCandidatePeaks(const std::vector<float> signalVec, TimeValsVec timeValsVec, MergedTimeWidVec& mergedVec) const
 {
     // ################################################################
     // ### Lets loop over the candidate pulses we found in this ROI ###
@@ -1190,7 +1336,7 @@ void hit::DPRawHitFinder::mergeCandidatePeaks(const std::vector<float> signalVec
 int hit::DPRawHitFinder::EstimateFluctuations(const std::vector<float>  fsignalVec,
                           		      int 		        peakStart,
 					      int		        peakMean,
-					      int		        peakEnd)
+					      int		        peakEnd) const
 {
   int NFluctuations=0;
 
@@ -1220,14 +1366,15 @@ int hit::DPRawHitFinder::EstimateFluctuations(const std::vector<float>  fsignalV
 // --------------------------------------------------------------------------------------------
 // Fit Exponentials
 // --------------------------------------------------------------------------------------------
-void hit::DPRawHitFinder::FitExponentials(const std::vector<float>  fSignalVector,
-                                          const PeakTimeWidVec      fPeakVals,
+void hit::DPRawHitFinder::FitExponentials(const std::vector<float>& fSignalVector,
+                                          const PeakTimeWidVec&     fPeakVals,
                                           int                       fStartTime,
                                           int                       fEndTime,
                                           ParameterVec&             fparamVec,
                                           double&                   fchi2PerNDF,
                                           int&                      fNDF,
-					  bool 			    fSameShape)
+					  bool 			    fSameShape,
+                                          HitFinderWorker&          worker) const
 {
     int size = fEndTime - fStartTime + 1;
     int NPeaks = fPeakVals.size();
@@ -1237,29 +1384,22 @@ void hit::DPRawHitFinder::FitExponentials(const std::vector<float>  fSignalVecto
     // #############################################
     if(fEndTime - fStartTime < 0){size = 0;}
 
-    // --- TH1D HitSignal ---
-    TH1F hitSignal("hitSignal","",std::max(size,1),fStartTime,fEndTime+1);
-    hitSignal.Sumw2();
-
-    // #############################
-    // ### Filling the histogram ###
-    // #############################
-    for(int i = fStartTime; i < fEndTime+1; i++)
-    {
-	hitSignal.Fill(i,fSignalVector[i]);
-	hitSignal.SetBinError(i,0.288675); //1/sqrt(12)
-    }
-
-    // ################################################
-    // ### Building TFormula for basic Exponentials ###
-    // ################################################
-    std::string eqn = CreateFitFunction(NPeaks, fSameShape);
-
-    // -------------------------------------
-    // --- TF1 function for Exponentials ---
-    // -------------------------------------
-
-    TF1 Exponentials("Exponentials",eqn.c_str(),fStartTime,fEndTime+1);
+    // ##########################################################
+    // ### The samples are fitted at the center of each tick, ###
+    // ### with unit weights and skipping empty ticks         ###
+    // ##########################################################
+    worker.fitter.SetData(fSignalVector.data() + fStartTime, size, fStartTime + 0.5, true);
+
+    // ##########################################
+    // ### Parameter seeds and limits         ###
+    // ##########################################
+    const size_t nParams = ExponentialPulseFitter::NParams(NPeaks, fSameShape);
+    std::vector<double>& params = worker.params;
+    std::vector<double>& parMin = worker.parMin;
+    std::vector<double>& parMax = worker.parMax;
+    params.assign(nParams, 0.);
+    parMin.assign(nParams, 0.);
+    parMax.assign(nParams, 0.);
 
     if(fLogLevel >= 4)
     {
@@ -1268,191 +1408,209 @@ void hit::DPRawHitFinder::FitExponentials(const std::vector<float>  fSignalVecto
       std::cout << "--- Lower limits, seed, upper limit:" << std::endl;
     }
 
-    if(fSameShape)
+    double amplitude=0;
+    double peakMean=0;
+
+    double peakMeanShift=2;
+    double peakMeanSeed=0;
+    double peakMeanRangeLow=0;
+    double peakMeanRangeHi=0;
+    double peakStart=0;
+    double peakEnd=0;
+
+    for(int i = 0; i < NPeaks; i++)
     {
-      Exponentials.SetParameter(0, 0.5);
-      Exponentials.SetParameter(1, 0.5);
-      Exponentials.SetParLimits(0, fMinTau, fMaxTau);
-      Exponentials.SetParLimits(1, fMinTau, fMaxTau);
-      double amplitude=0;
-      double peakMean=0;
-
-      double peakMeanShift=2;
-      double peakMeanSeed=0;
-      double peakMeanRangeLow=0;
-      double peakMeanRangeHi=0;
-      double peakStart=0;
-      double peakEnd=0;
-
-      for(int i = 0; i < NPeaks; i++)
+      // the time constants, shared by all peaks or for each of them
+      if(!fSameShape || i == 0)
       {
-        peakMean = std::get<0>(fPeakVals.at(i));
-	peakStart = std::get<2>(fPeakVals.at(i));
-	peakEnd = std::get<3>(fPeakVals.at(i));
-        peakMeanSeed=peakMean-peakMeanShift;
-        peakMeanRangeLow = std::max(peakStart-peakMeanShift, peakMeanSeed-fFitPeakMeanRange);
-        peakMeanRangeHi = std::min(peakEnd, peakMeanSeed+fFitPeakMeanRange);
-        amplitude = fSignalVector[peakMean];
-
-	Exponentials.SetParameter(2*(i+1), 1.65*amplitude);
-	Exponentials.SetParLimits(2*(i+1), 0.3*1.65*amplitude, 2*1.65*amplitude);
-	Exponentials.SetParameter(2*(i+1)+1, peakMeanSeed);
-
-	if(NPeaks == 1)
-	{
-	  Exponentials.SetParLimits(2*(i+1)+1, peakMeanRangeLow, peakMeanRangeHi);
-	}
-	else if(NPeaks >= 2 && i == 0)
-	{
-	  double HalfDistanceToNextMean = 0.5*(std::get<0>(fPeakVals.at(i+1)) - peakMean);
-	  Exponentials.SetParLimits( 2*(i+1)+1, peakMeanRangeLow, std::min(peakMeanRangeHi, peakMeanSeed+HalfDistanceToNextMean) );
-	}
-	else if(NPeaks >= 2 && i == NPeaks-1)
-	{
-	  double HalfDistanceToPrevMean = 0.5*(peakMean - std::get<0>(fPeakVals.at(i-1)));
-	  Exponentials.SetParLimits(2*(i+1)+1, std::max(peakMeanRangeLow, peakMeanSeed-HalfDistanceToPrevMean), peakMeanRangeHi );
-	}
-	else
-	{
-	  double HalfDistanceToNextMean = 0.5*(std::get<0>(fPeakVals.at(i+1)) - peakMean);
-	  double HalfDistanceToPrevMean = 0.5*(peakMean - std::get<0>(fPeakVals.at(i-1)));
-	  Exponentials.SetParLimits(2*(i+1)+1, std::max(peakMeanRangeLow, peakMeanSeed-HalfDistanceToPrevMean), std::min(peakMeanRangeHi, peakMeanSeed+HalfDistanceToNextMean) );
-	}
-
-        if(fLogLevel >= 4)
-        {
-	  double t0low, t0high;
-	  Exponentials.GetParLimits(2*(i+1)+1, t0low, t0high);
-          std::cout << "Peak #" << i << ": A [ADC] = " << 0.3*1.65*amplitude << "  ,  " << 1.65*amplitude << "  ,  " << 2*1.65*amplitude << std::endl;
-          std::cout << "Peak #" << i << ": t0 [ticks] = " << t0low << "  ,  " << peakMeanSeed << "  ,  " << t0high << std::endl;
-        }
+        const size_t tauIdx = fSameShape ? 0 : 4*i;
+        params[tauIdx]   = 0.5;
+        params[tauIdx+1] = 0.5;
+        parMin[tauIdx]   = parMin[tauIdx+1] = fMinTau;
+        parMax[tauIdx]   = parMax[tauIdx+1] = fMaxTau;
       }
-    }
-    else
-    {
-      double amplitude=0;
-      double peakMean=0;
 
-      double peakMeanShift=2;
-      double peakMeanSeed=0;
-      double peakMeanRangeLow=0;
-      double peakMeanRangeHi=0;
-      double peakStart=0;
-      double peakEnd=0;
-
-
-      for(int i = 0; i < NPeaks; i++)
+      const size_t ampIdx = fSameShape ? 2*(i+1) : 4*i+2;
+
+      peakMean = std::get<0>(fPeakVals.at(i));
+      peakStart = std::get<2>(fPeakVals.at(i));
+      peakEnd = std::get<3>(fPeakVals.at(i));
+      peakMeanSeed=peakMean-peakMeanShift;
+      peakMeanRangeLow = std::max(peakStart-peakMeanShift, peakMeanSeed-fFitPeakMeanRange);
+      peakMeanRangeHi = std::min(peakEnd, peakMeanSeed+fFitPeakMeanRange);
+      amplitude = fSignalVector[peakMean];
+
+      params[ampIdx] = 1.65*amplitude;
+      parMin[ampIdx] = 0.3*1.65*amplitude;
+      parMax[ampIdx] = 2*1.65*amplitude;
+      params[ampIdx+1] = peakMeanSeed;
+
+      // the mean can't move more than halfway to the neighbouring peaks
+      double t0low = peakMeanRangeLow;
+      double t0high = peakMeanRangeHi;
+      if(i > 0)
       {
-        Exponentials.SetParameter(4*i, 0.5);
-        Exponentials.SetParameter(4*i+1, 0.5);
-        Exponentials.SetParLimits(4*i, fMinTau, fMaxTau);
-        Exponentials.SetParLimits(4*i+1, fMinTau, fMaxTau);
-
-        peakMean = std::get<0>(fPeakVals.at(i));
-	peakStart = std::get<2>(fPeakVals.at(i));
-	peakEnd = std::get<3>(fPeakVals.at(i));
-        peakMeanSeed=peakMean-peakMeanShift;
-        peakMeanRangeLow = std::max(peakStart-peakMeanShift, peakMeanSeed-fFitPeakMeanRange);
-        peakMeanRangeHi = std::min(peakEnd, peakMeanSeed+fFitPeakMeanRange);
-        amplitude = fSignalVector[peakMean];
-
-	Exponentials.SetParameter(4*i+2, 1.65*amplitude);
-	Exponentials.SetParLimits(4*i+2, 0.3*1.65*amplitude, 2*1.65*amplitude);
-	Exponentials.SetParameter(4*i+3, peakMeanSeed);
-
-	if(NPeaks == 1)
-	{
-	  Exponentials.SetParLimits(4*i+3, peakMeanRangeLow, peakMeanRangeHi);
-	}
-	else if(NPeaks >= 2 && i == 0)
-	{
-	  double HalfDistanceToNextMean = 0.5*(std::get<0>(fPeakVals.at(i+1)) - peakMean);
-	  Exponentials.SetParLimits( 4*i+3, peakMeanRangeLow, std::min(peakMeanRangeHi, peakMeanSeed+HalfDistanceToNextMean) );
-	}
-	else if(NPeaks >= 2 && i == NPeaks-1)
-	{
-	  double HalfDistanceToPrevMean = 0.5*(peakMean - std::get<0>(fPeakVals.at(i-1)));
-	  Exponentials.SetParLimits(4*i+3, std::max(peakMeanRangeLow, peakMeanSeed-HalfDistanceToPrevMean), peakMeanRangeHi );
-	}
-	else
-	{
-	  double HalfDistanceToNextMean = 0.5*(std::get<0>(fPeakVals.at(i+1)) - peakMean);
-	  double HalfDistanceToPrevMean = 0.5*(peakMean - std::get<0>(fPeakVals.at(i-1)));
-	  Exponentials.SetParLimits(4*i+3, std::max(peakMeanRangeLow, peakMeanSeed-HalfDistanceToPrevMean), std::min(peakMeanRangeHi, peakMeanSeed+HalfDistanceToNextMean) );
-	}
+        double HalfDistanceToPrevMean = 0.5*(peakMean - std::get<0>(fPeakVals.at(i-1)));
+        t0low = std::max(t0low, peakMeanSeed-HalfDistanceToPrevMean);
+      }
+      if(i < NPeaks-1)
+      {
+        double HalfDistanceToNextMean = 0.5*(std::get<0>(fPeakVals.at(i+1)) - peakMean);
+        t0high = std::min(t0high, peakMeanSeed+HalfDistanceToNextMean);
+      }
+      parMin[ampIdx+1] = t0low;
+      parMax[ampIdx+1] = t0high;
 
-        if(fLogLevel >= 4)
-        {
-	  double t0low, t0high;
-	  Exponentials.GetParLimits(4*i+3, t0low, t0high);
-          std::cout << "Peak #" << i << ": A [ADC] = " << 0.3*1.65*amplitude << "  ,  " << 1.65*amplitude << "  ,  " << 2*1.65*amplitude << std::endl;
-          std::cout << "Peak #" << i << ": t0 [ticks] = " << t0low << "  ,  " << peakMeanSeed << "  ,  " << t0high << std::endl;
-        }
+      if(fLogLevel >= 4)
+      {
+        std::cout << "Peak #" << i << ": A [ADC] = " << 0.3*1.65*amplitude << "  ,  " << 1.65*amplitude << "  ,  " << 2*1.65*amplitude << std::endl;
+        std::cout << "Peak #" << i << ": t0 [ticks] = " << t0low << "  ,  " << peakMeanSeed << "  ,  " << t0high << std::endl;
       }
     }
 
 
+    // the ROOT fit of the comparison starts from the same values
+    if (fCompareWithROOTFit) fComparison.seeds = params;
+
     // ###########################################
     // ### PERFORMING THE TOTAL FIT OF THE HIT ###
     // ###########################################
-    try
-      { hitSignal.Fit(&Exponentials,"QNRWM","", fStartTime, fEndTime+1);}
-    catch(...)
-      {mf::LogWarning("DPRawHitFinder") << "Fitter failed finding a hit";}
+    if (!worker.fitter.Fit(NPeaks, fSameShape, params, parMin, parMax) && fLogLevel >= 4)
+      std::cout << "Fit did not converge" << std::endl;
+
+    if (fCompareWithROOTFit)
+      CompareWithROOTFit(fSignalVector, NPeaks, fStartTime, fEndTime, fSameShape, parMin, parMax, worker);
 
     // ##################################################
     // ### Getting the fitted parameters from the fit ###
     // ##################################################
-    fchi2PerNDF = (Exponentials.GetChisquare() / Exponentials.GetNDF());
-    fNDF        = Exponentials.GetNDF();
+    fNDF        = worker.fitter.NDF();
+    fchi2PerNDF = worker.fitter.Chi2() / fNDF;
+
+    const std::vector<double>& parErrors = worker.fitter.ParErrors();
+
+    for(size_t iPar = 0; iPar < nParams; iPar++)
+      fparamVec.emplace_back(params[iPar], parErrors[iPar]);
+
+}//<----End FitExponentials
+
+
+// --------------------------------------------------------------------------------------------
+// Compare with the ROOT fit
+// --------------------------------------------------------------------------------------------
+void hit::DPRawHitFinder::CompareWithROOTFit(const std::vector<float>&  fSignalVector,
+                                             int                        fNPeaks,
+                                             int                        fStartTime,
+                                             int                        fEndTime,
+                                             bool                       fSameShape,
+                                             const std::vector<double>& fParMin,
+                                             const std::vector<double>& fParMax,
+                                             const HitFinderWorker&     worker) const
+{
+    const size_t nParams = fComparison.seeds.size();
 
-    if(fSameShape)
+    // the histogram and the options of the ROOT fit this module used to do,
+    // the samples at the center of each tick
+    TH1F hitSignal("hitSignal","",std::max(fEndTime - fStartTime + 1, 1),fStartTime,fEndTime+1);
+    hitSignal.SetDirectory(nullptr);
+    hitSignal.Sumw2();
+    for(int i = fStartTime; i < fEndTime+1; i++) hitSignal.Fill(i,fSignalVector[i]);
+
+    // the pulse shape of ExponentialPulseFitter, with the t0 of each pulse in its denominator
+    std::string eqn;
+    for(int i = 0; i < fNPeaks; i++)
     {
-      fparamVec.emplace_back(Exponentials.GetParameter(0),Exponentials.GetParError(0));
-      fparamVec.emplace_back(Exponentials.GetParameter(1),Exponentials.GetParError(1));
+      const std::string tau1 = "[" + std::to_string(fSameShape ? 0 : 4*i) + "]";
+      const std::string tau2 = "[" + std::to_string(fSameShape ? 1 : 4*i+1) + "]";
+      const std::string ampl = "[" + std::to_string(fSameShape ? 2*(i+1) : 4*i+2) + "]";
+      const std::string t0   = "[" + std::to_string(fSameShape ? 2*(i+1)+1 : 4*i+3) + "]";
+      eqn += "+( " + ampl + " * exp(0.4*(x-" + t0 + ")/" + tau1 + ") / ( 1 + exp(0.4*(x-" + t0 + ")/" + tau2 + ") ) )";
+    }
 
-      for(int i = 0; i < NPeaks; i++)
-      {
-        fparamVec.emplace_back(Exponentials.GetParameter(2*(i+1)),Exponentials.GetParError(2*(i+1)));
-        fparamVec.emplace_back(Exponentials.GetParameter(2*(i+1)+1),Exponentials.GetParError(2*(i+1)+1));
-      }
+    TF1 Exponentials("Exponentials",eqn.c_str(),fStartTime,fEndTime+1);
+    for(size_t iPar = 0; iPar < nParams; iPar++)
+    {
+      Exponentials.SetParameter(iPar, fComparison.seeds[iPar]);
+      Exponentials.SetParLimits(iPar, fParMin[iPar], fParMax[iPar]);
     }
-    else
+
+    try
+      { hitSignal.Fit(&Exponentials,"QNRWM","", fStartTime, fEndTime+1);}
+    catch(...)
+      {mf::LogWarning("DPRawHitFinder") << "ROOT fit of the comparison failed";}
+
+    fComparison.nPeaks   = fNPeaks;
+    fComparison.chi2     = worker.fitter.Chi2();
+    fComparison.rootChi2 = Exponentials.GetChisquare();
+    fComparison.NDF      = worker.fitter.NDF();
+    fComparison.rootNDF  = Exponentials.GetNDF();
+
+    fComparison.params        = worker.params;
+    fComparison.parErrors     = worker.fitter.ParErrors();
+    fComparison.rootParams.resize(nParams);
+    fComparison.rootParErrors.resize(nParams);
+    for(size_t iPar = 0; iPar < nParams; iPar++)
     {
-      for(int i = 0; i < NPeaks; i++)
-      {
-        fparamVec.emplace_back(Exponentials.GetParameter(4*i),Exponentials.GetParError(4*i));
-        fparamVec.emplace_back(Exponentials.GetParameter(4*i+1),Exponentials.GetParError(4*i+1));
-        fparamVec.emplace_back(Exponentials.GetParameter(4*i+2),Exponentials.GetParError(4*i+2));
-        fparamVec.emplace_back(Exponentials.GetParameter(4*i+3),Exponentials.GetParError(4*i+3));
-      }
+      fComparison.rootParams[iPar]    = Exponentials.GetParameter(iPar);
+      fComparison.rootParErrors[iPar] = Exponentials.GetParError(iPar);
     }
-    Exponentials.Delete();
-    hitSignal.Delete();
-}//<----End FitExponentials
+
+    FillHitParameters(fComparison.params, fNPeaks, fStartTime, fEndTime, fSameShape,
+                      fComparison.peakTime, fComparison.peakWidth, fComparison.charge);
+    FillHitParameters(fComparison.rootParams, fNPeaks, fStartTime, fEndTime, fSameShape,
+                      fComparison.rootPeakTime, fComparison.rootPeakWidth, fComparison.rootCharge);
+
+    fComparisonTree->Fill();
+}//<----End CompareWithROOTFit
 
 
 //---------------------------------------------------------------------------------------------
-void hit::DPRawHitFinder::FindPeakWithMaxDeviation(const std::vector<float> fSignalVector,
-			  	  		   int			    fNPeaks,
-                          	  		   int                      fStartTime,
-                          	  		   int                      fEndTime,
-						   bool			    fSameShape,
-                          	  		   ParameterVec             fparamVec,
-                         	  		   PeakTimeWidVec           fpeakVals,
-			  	 		   PeakDevVec& 		    fPeakDev)
+void hit::DPRawHitFinder::FillHitParameters(const std::vector<double>& fParams,
+                                            int                        fNPeaks,
+                                            int                        fStartTime,
+                                            int                        fEndTime,
+                                            bool                       fSameShape,
+                                            std::vector<double>&       fPeakTime,
+                                            std::vector<double>&       fPeakWidth,
+                                            std::vector<double>&       fCharge) const
 {
-//   int size = fEndTime - fStartTime + 1;
-//    if(fEndTime - fStartTime < 0){size = 0;}
+    fPeakTime.clear();
+    fPeakWidth.clear();
+    fCharge.clear();
 
-    std::string eqn = CreateFitFunction(fNPeaks, fSameShape);  // string for equation of Exponentials fit
+    // as in ProcessWire
+    for(int i = 0; i < fNPeaks; i++)
+    {
+      const double peakTau1 = fParams[fSameShape ? 0 : 4*i];
+      const double peakTau2 = fParams[fSameShape ? 1 : 4*i+1];
+      const double peakAmp  = fParams[fSameShape ? 2*(i+1) : 4*i+2];
+      const double peakMean = fParams[fSameShape ? 2*(i+1)+1 : 4*i+3];
+
+      const double peakMeanTrue = ExponentialPulseFitter::PulseMaximumX(peakMean, peakTau1, peakTau2, fStartTime, fEndTime);
+      fPeakTime.push_back(peakMeanTrue);
+      fPeakWidth.push_back(WidthFunc(peakMean, peakAmp, peakTau1, peakTau2, fStartTime, fEndTime, peakMeanTrue) / fWidthNormalization);
+      fCharge.push_back(ChargeFunc(peakMean, peakAmp, peakTau1, peakTau2, fChargeNorm, peakMeanTrue));
+    }
+}//<----End FillHitParameters
 
-    TF1 Exponentials("Exponentials",eqn.c_str(),fStartTime,fEndTime+1);
 
- 	for(size_t i=0; i < fparamVec.size(); i++)
-    	{
-    	Exponentials.SetParameter(i, fparamVec[i].first);
-	}
+//---------------------------------------------------------------------------------------------
+void hit::DPRawHitFinder::FindPeakWithMaxDeviation(const std::vector<float>& fSignalVector,
+			  	  		   int			     fNPeaks,
+                          	  		   int                       fStartTime,
+                          	  		   int                       fEndTime,
+						   bool			     fSameShape,
+                          	  		   const ParameterVec&       fparamVec,
+                         	  		   const PeakTimeWidVec&     fpeakVals,
+			  	 		   PeakDevVec& 		     fPeakDev) const
+{
+//   int size = fEndTime - fStartTime + 1;
+//    if(fEndTime - fStartTime < 0){size = 0;}
+
+    // the fit function with the fitted parameters
+    std::vector<double> params(fparamVec.size());
+    for(size_t i=0; i < fparamVec.size(); i++) params[i] = fparamVec[i].first;
+    auto Exponentials = [&](double x){ return ExponentialPulseFitter::Eval(fNPeaks, fSameShape, params.data(), x); };
 
     // ##########################################################################
     // ### Finding the peak with the max chi2 fit and signal ###
@@ -1493,76 +1651,12 @@ void hit::DPRawHitFinder::FindPeakWithMaxDeviation(const std::vector<float> fSig
     }
 
 std::sort(fPeakDev.begin(),fPeakDev.end(), [](std::tuple<double,int,int,int> const &t1, std::tuple<double,int,int,int> const &t2) {return std::get<0>(t1) > std::get<0>(t2);} );
-Exponentials.Delete();
-}
-
-//---------------------------------------------------------------------------------------------
-std::string hit::DPRawHitFinder::CreateFitFunction(int fNPeaks, bool fSameShape)
-{
-  std::string feqn = "";  // string holding fit formula
-  std::stringstream numConv;
-
-  if(fSameShape)
-  {
-    for(int i = 0; i < fNPeaks; i++)
-    {
-        feqn.append("+( [");
-        numConv.str("");
-        numConv << 2*(i+1);
-        feqn.append(numConv.str());
-        feqn.append("] * exp(0.4*(x-[");
-        numConv.str("");
-        numConv << 2*(i+1)+1;
-        feqn.append(numConv.str());
-        feqn.append("])/[");
-        numConv.str("");
-        numConv << 0;
-        feqn.append(numConv.str());
-        feqn.append("]) / ( 1 + exp(0.4*(x-[");
-        numConv.str("");
-        numConv << 2*(i+1)+1;
-        feqn.append(numConv.str());
-        feqn.append("])/[");
-        numConv.str("");
-        numConv << 1;
-        feqn.append(numConv.str());
-    feqn.append("]) ) )");
-    }
-  }
-  else
-  {
-    for(int i = 0; i < fNPeaks; i++)
-    {
-        feqn.append("+( [");
-        numConv.str("");
-        numConv << 4*i+2;
-        feqn.append(numConv.str());
-        feqn.append("] * exp(0.4*(x-[");
-        numConv.str("");
-        numConv << 4*i+3;
-        feqn.append(numConv.str());
-        feqn.append("])/[");
-        numConv.str("");
-        numConv << 4*i;
-        feqn.append(numConv.str());
-        feqn.append("]) / ( 1 + exp(0.4*(x-[");
-        numConv.str("");
-        numConv << 2*(i+1)+1;
-        feqn.append(numConv.str());
-        feqn.append("])/[");
-        numConv.str("");
-        numConv << 4*i+1;
-        feqn.append(numConv.str());
-    feqn.append("]) ) )");
-    }
-  }
-return feqn;
 }
 
 
 //---------------------------------------------------------------------------------------------
 void hit::DPRawHitFinder::AddPeak(std::tuple<double,int,int,int> fPeakDevCand,
-				  PeakTimeWidVec& fpeakValsTemp)
+				  PeakTimeWidVec& fpeakValsTemp) const
 {
   int PeakNumberWithNewPeak = std::get<1>(fPeakDevCand);
   int NewPeakMax = std::get<2>(fPeakDevCand);
@@ -1606,7 +1700,7 @@ void hit::DPRawHitFinder::AddPeak(std::tuple<double,int,int,int> fPeakDevCand,
 
 //---------------------------------------------------------------------------------------------
 void hit::DPRawHitFinder::SplitPeak(std::tuple<double,int,int,int> fPeakDevCand,
-				    PeakTimeWidVec& fpeakValsTemp)
+				    PeakTimeWidVec& fpeakValsTemp) const
 {
 int PeakNumberWithNewPeak = std::get<1>(fPeakDevCand);
 int OldPeakOldStart = std::get<2>(fpeakValsTemp.at(PeakNumberWithNewPeak));
@@ -1649,7 +1743,7 @@ double hit::DPRawHitFinder::WidthFunc(double fPeakMean,
 		    		      double fPeakTau2,
 				      double fStartTime,
 				      double fEndTime,
-			    	      double fPeakMeanTrue)
+			    	      double fPeakMeanTrue) const
 {
 double MaxValue = ( fPeakAmp * exp(0.4*(fPeakMeanTrue-fPeakMean)/fPeakTau1)) / ( 1 + exp(0.4*(fPeakMeanTrue-fPeakMean)/fPeakTau2) );
 double FuncValue = 0.;
@@ -1729,7 +1823,7 @@ double hit::DPRawHitFinder::ChargeFunc(double fPeakMean,
 		      		       double fPeakTau1,
 		      		       double fPeakTau2,
 				       double fChargeNormFactor,
-				       double fPeakMeanTrue)
+				       double fPeakMeanTrue) const
 
 {
 double ChargeSum = 0.;
@@ -28,6 +28,7 @@
 #include <string>
 #include <memory> // std::unique_ptr()
 #include <utility> // std::move()
+#include <vector>
 
 // Framework includes
 #include "art/Framework/Core/ModuleMacros.h"
@@ -37,10 +38,12 @@
 #include "art_root_io/TFileService.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "art/Utilities/make_tool.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 // LArSoft Includes
 #include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
 #include "larcore/Geometry/Geometry.h"
+#include "larcore/CoreUtils/ServiceUtil.h" // lar::providerFrom()
 #include "lardataobj/RecoBase/Wire.h"
 #include "lardataobj/RecoBase/Hit.h"
 #include "lardata/ArtDataHelper/HitCreator.h"
@@ -52,6 +55,10 @@
 // ROOT Includes
 #include "TH1F.h"
 #include "TMath.h"
+#include "TROOT.h" // ROOT::EnableThreadSafety()
+
+// TBB Includes
+#include "tbb/parallel_for.h"
 
 namespace hit{
 class GausHitFinder : public art::EDProducer {
@@ -67,6 +74,31 @@ private:
 
     void FillOutHitParameterVector(const std::vector<double>& input, std::vector<double>& output);
 
+    /// Tools carrying mutable fit state, one set is owned by each worker
+    struct HitFinderWorker
+    {
+        std::vector<std::unique_ptr<reco_tool::ICandidateHitFinder>> hitFinderToolVec;  ///< For finding candidate hits
+        std::unique_ptr<reco_tool::IPeakFitter>                      peakFitterTool;    ///< Perform fit to candidate peaks
+    };
+
+    /// Hits produced by one worker, kept with the index of their wire so the
+    /// output collections can be assembled in input wire order
+    struct HitOutputBuffer
+    {
+        std::vector<std::pair<recob::Hit,size_t>> allHitVec;
+        std::vector<std::pair<recob::Hit,size_t>> filteredHitVec;
+        std::vector<double>                       firstChi2Vec;
+        std::vector<double>                       chi2Vec;
+    };
+
+    using ChargeFunc = std::function<double (double,double,double,double,int,int)>;
+
+    void ProcessWire(const art::Ptr<recob::Wire>& wire,
+                     size_t                       wireIdx,
+                     const HitFinderWorker&       worker,
+                     const ChargeFunc&            chargeFunc,
+                     HitOutputBuffer&             outputBuffer) const;
+
     bool                fFilterHits;
 
     std::string         fCalDataModuleLabel;
@@ -85,14 +117,16 @@ private:
     std::vector<float>  fPulseRatioCuts;
 
     size_t              fEventCount;
+    size_t              fNumThreads;               ///<Number of workers the wires are partitioned over
 
-    std::vector<std::unique_ptr<reco_tool::ICandidateHitFinder>> fHitFinderToolVec;  ///< For finding candidate hits
-    std::unique_ptr<reco_tool::IPeakFitter>                      fPeakFitterTool;    ///< Perform fit to candidate peaks
+    std::vector<HitFinderWorker>                                 fWorkerVec;         ///< One set of tools per worker
     std::unique_ptr<HitFilterAlg>                                fHitFilterAlg;      ///< algorithm used to filter out noise hits
 
     TH1F* fFirstChi2;
     TH1F* fChi2;
 
+    const geo::GeometryCore* fGeometry = lar::providerFrom<geo::Geometry>();
+
 }; // class GausHitFinder
 
 
@@ -122,22 +156,47 @@ GausHitFinder::GausHitFinder(fhicl::ParameterSet const& pset)
     fPulseWidthCuts    = pset.get< std::vector<float>>("PulseWidthCuts",  std::vector<float>() = {2.0,  1.5,  1.0});
     fPulseRatioCuts    = pset.get< std::vector<float>>("PulseRatioCuts",  std::vector<float>() = {0.35, 0.40, 0.20});
 
+    fNumThreads        = std::max(pset.get< size_t     >("NumThreads", 1), size_t(1));
+
     // recover the tool to do the candidate hit finding
     // Recover the vector of fhicl parameters for the ROI tools
     const fhicl::ParameterSet& hitFinderTools = pset.get<fhicl::ParameterSet>("HitFinderToolVec");
+    const fhicl::ParameterSet& peakFitterPSet = pset.get<fhicl::ParameterSet>("PeakFitter");
 
-    fHitFinderToolVec.resize(hitFinderTools.get_pset_names().size());
-
-    for(const std::string& hitFinderTool : hitFinderTools.get_pset_names())
+    // The tools keep their fit state in mutable members and each copy books its own
+    // histograms, so running several workers only makes sense when none of them do
+    if (fNumThreads > 1)
     {
-        const fhicl::ParameterSet& hitFinderToolParamSet = hitFinderTools.get<fhicl::ParameterSet>(hitFinderTool);
-        size_t                     planeIdx              = hitFinderToolParamSet.get<size_t>("Plane");
+        bool toolHistograms = peakFitterPSet.get<bool>("OutputHistograms", false);
 
-        fHitFinderToolVec.at(planeIdx) = art::make_tool<reco_tool::ICandidateHitFinder>(hitFinderToolParamSet);
+        for(const std::string& hitFinderTool : hitFinderTools.get_pset_names())
+            toolHistograms |= hitFinderTools.get<fhicl::ParameterSet>(hitFinderTool).get<bool>("OutputHistograms", false);
+
+        if (toolHistograms)
+        {
+            mf::LogWarning("GausHitFinder") << "Tool histogramming is enabled, forcing NumThreads to 1";
+            fNumThreads = 1;
+        }
+        else ROOT::EnableThreadSafety();
     }
 
-    // Recover the peak fitting tool
-    fPeakFitterTool = art::make_tool<reco_tool::IPeakFitter>(pset.get<fhicl::ParameterSet>("PeakFitter"));
+    fWorkerVec.resize(fNumThreads);
+
+    for(auto& worker : fWorkerVec)
+    {
+        worker.hitFinderToolVec.resize(hitFinderTools.get_pset_names().size());
+
+        for(const std::string& hitFinderTool : hitFinderTools.get_pset_names())
+        {
+            const fhicl::ParameterSet& hitFinderToolParamSet = hitFinderTools.get<fhicl::ParameterSet>(hitFinderTool);
+            size_t                     planeIdx              = hitFinderToolParamSet.get<size_t>("Plane");
+
+            worker.hitFinderToolVec.at(planeIdx) = art::make_tool<reco_tool::ICandidateHitFinder>(hitFinderToolParamSet);
+        }
+
+        // Recover the peak fitting tool
+        worker.peakFitterTool = art::make_tool<reco_tool::IPeakFitter>(peakFitterPSet);
+    }
 
     // let HitCollectionCreator declare that we are going to produce
     // hits and associations with wires and raw digits
@@ -190,6 +249,266 @@ void GausHitFinder::beginJob()
     fChi2	        = tfs->make<TH1F>("fChi2", "#chi^{2}", 10000, 0, 5000);
 }
 
+//-------------------------------------------------
+//-------------------------------------------------
+void GausHitFinder::ProcessWire(const art::Ptr<recob::Wire>& wire,
+                                size_t                       wireIdx,
+                                const HitFinderWorker&       worker,
+                                const ChargeFunc&            chargeFunc,
+                                HitOutputBuffer&             outputBuffer) const
+{
+    // --- Setting Channel Number and Signal type ---
+    raw::ChannelID_t channel = wire->Channel();
+
+    // get the WireID for this hit
+    std::vector<geo::WireID> wids = fGeometry->ChannelToWire(channel);
+    // for now, just take the first option returned from ChannelToWire
+    geo::WireID wid  = wids[0];
+    // We need to know the plane to look up parameters
+    geo::PlaneID::PlaneID_t plane = wid.Plane;
+
+    // ----------------------------------------------------------
+    // -- Setting the appropriate signal widths and thresholds --
+    // --    for the right plane.      --
+    // ----------------------------------------------------------
+
+    // #################################################
+    // ### Set up to loop over ROI's for this wire   ###
+    // #################################################
+    const recob::Wire::RegionsOfInterest_t& signalROI = wire->SignalROI();
+
+    for(const auto& range : signalROI.get_ranges())
+    {
+        // ROI start time
+        raw::TDCtick_t roiFirstBinTick = range.begin_index();
+
+        // ###########################################################
+        // ### Scan the waveform and find candidate peaks + merge  ###
+        // ###########################################################
+
+        reco_tool::ICandidateHitFinder::HitCandidateVec      hitCandidateVec;
+        reco_tool::ICandidateHitFinder::MergeHitCandidateVec mergedCandidateHitVec;
+
+        worker.hitFinderToolVec.at(plane)->findHitCandidates(range, 0, channel, fEventCount, hitCandidateVec);
+        worker.hitFinderToolVec.at(plane)->MergeHitCandidates(range, hitCandidateVec, mergedCandidateHitVec);
+
+        // #######################################################
+        // ### Lets loop over the pulses we found on this wire ###
+        // #######################################################
+
+        for(auto& mergedCands : mergedCandidateHitVec)
+        {
+            int startT= mergedCands.front().startTick;
+            int endT  = mergedCands.back().stopTick;
+
+            // ### Putting in a protection in case things went wrong ###
+            // ### In the end, this primarily catches the case where ###
+            // ### a fake pulse is at the start of the ROI           ###
+            if (endT - startT < 5) continue;
+
+            // #######################################################
+            // ### Clearing the parameter vector for the new pulse ###
+            // #######################################################
+
+            // === Setting the number of Gaussians to try ===
+            int nGausForFit = mergedCands.size();
+
+            // ##################################################
+            // ### Calling the function for fitting Gaussians ###
+            // ##################################################
+            double                                chi2PerNDF(0.);
+            int                                   NDF(1);
+		/*stand alone
+            reco_tool::IPeakFitter::PeakParamsVec peakParamsVec(nGausForFit);
+		*/
+            reco_tool::IPeakFitter::PeakParamsVec peakParamsVec;
+
+            // #######################################################
+            // ### If # requested Gaussians is too large then punt ###
+            // #######################################################
+            if (mergedCands.size() <= fMaxMultiHit)
+            {
+                worker.peakFitterTool->findPeakParameters(range.data(), mergedCands, peakParamsVec, chi2PerNDF, NDF);
+
+                // If the chi2 is infinite then there is a real problem so we bail
+                if (!(chi2PerNDF < std::numeric_limits<double>::infinity()))
+                {
+                    chi2PerNDF = 2.*fChi2NDF;
+                    NDF        = 2;
+                }
+
+                outputBuffer.firstChi2Vec.push_back(chi2PerNDF);
+            }
+
+            // #######################################################
+            // ### If too large then force alternate solution      ###
+            // ### - Make n hits from pulse train where n will     ###
+            // ###   depend on the fhicl parameter fLongPulseWidth ###
+            // ### Also do this if chi^2 is too large              ###
+            // #######################################################
+            if (mergedCands.size() > fMaxMultiHit || nGausForFit * chi2PerNDF > fChi2NDF)
+            {
+                int longPulseWidth = fLongPulseWidthVec.at(plane);
+                int nHitsThisPulse = (endT - startT) / longPulseWidth;
+
+                if (nHitsThisPulse > fLongMaxHitsVec.at(plane))
+                {
+                    nHitsThisPulse = fLongMaxHitsVec.at(plane);
+                    longPulseWidth = (endT - startT) / nHitsThisPulse;
+                }
+
+                if (nHitsThisPulse * longPulseWidth < endT - startT) nHitsThisPulse++;
+
+                int firstTick = startT;
+                int lastTick  = std::min(firstTick + longPulseWidth, endT);
+
+                peakParamsVec.clear();
+                nGausForFit = nHitsThisPulse;
+                NDF         = 1.;
+                chi2PerNDF  =  chi2PerNDF > fChi2NDF ? chi2PerNDF : -1.;
+
+                for(int hitIdx = 0; hitIdx < nHitsThisPulse; hitIdx++)
+                {
+                    // This hit parameters
+                    double sumADC    = std::accumulate(range.begin() + firstTick, range.begin() + lastTick, 0.);
+                    double peakSigma = (lastTick - firstTick) / 3.;  // Set the width...
+                    double peakAmp   = 0.3989 * sumADC / peakSigma;  // Use gaussian formulation
+                    double peakMean  = (firstTick + lastTick) / 2.;
+
+                    // Store hit params
+                    reco_tool::IPeakFitter::PeakFitParams_t peakParams;
+
+                    peakParams.peakCenter         = peakMean;
+                    peakParams.peakCenterError    = 0.1 * peakMean;
+                    peakParams.peakSigma          = peakSigma;
+                    peakParams.peakSigmaError     = 0.1 * peakSigma;
+                    peakParams.peakAmplitude      = peakAmp;
+                    peakParams.peakAmplitudeError = 0.1 * peakAmp;
+
+                    peakParamsVec.push_back(peakParams);
+
+                    // set for next loop
+                    firstTick = lastTick;
+                    lastTick  = std::min(lastTick  + longPulseWidth, endT);
+                }
+            }
+
+            // #######################################################
+            // ### Loop through returned peaks and make recob hits ###
+            // #######################################################
+
+            int numHits(0);
+
+            // Make a container for what will be the filtered collection
+            std::vector<recob::Hit> filteredHitVec;
+
+            for(const auto& peakParams : peakParamsVec)
+            {
+                // Extract values for this hit
+                float peakAmp   = peakParams.peakAmplitude;
+                float peakMean  = peakParams.peakCenter;
+                float peakWidth = peakParams.peakSigma;
+
+                // Place one bit of protection here
+                if (std::isnan(peakAmp))
+                {
+                    std::cout << "**** hit peak amplitude is a nan! Channel: " << channel << ", start tick: " << startT << std::endl;
+                    continue;
+                }
+
+                // Extract errors
+                float peakAmpErr   = peakParams.peakAmplitudeError;
+                float peakMeanErr  = peakParams.peakCenterError;
+                float peakWidthErr = peakParams.peakSigmaError;
+
+                // ### Charge ###
+                float charge    = chargeFunc(peakMean, peakAmp, peakWidth, fAreaNormsVec[plane],startT,endT);;
+                float chargeErr = std::sqrt(TMath::Pi()) * (peakAmpErr*peakWidthErr + peakWidthErr*peakAmpErr);
+
+                // ### limits for getting sums
+                std::vector<float>::const_iterator sumStartItr = range.begin() + startT;
+                std::vector<float>::const_iterator sumEndItr   = range.begin() + endT;
+
+                // ### Sum of ADC counts
+                double sumADC = std::accumulate(sumStartItr, sumEndItr, 0.);
+
+                // ok, now create the hit
+                recob::HitCreator hitcreator(*wire,                            // wire reference
+                                             wid,                              // wire ID
+                                             startT+roiFirstBinTick,           // start_tick TODO check
+                                             endT+roiFirstBinTick,             // end_tick TODO check
+                                             peakWidth,                        // rms
+                                             peakMean+roiFirstBinTick,         // peak_time
+                                             peakMeanErr,                      // sigma_peak_time
+                                             peakAmp,                          // peak_amplitude
+                                             peakAmpErr,                       // sigma_peak_amplitude
+                                             charge,                           // hit_integral
+                                             chargeErr,                        // hit_sigma_integral
+                                             sumADC,                           // summedADC FIXME
+                                             nGausForFit,                      // multiplicity
+                                             numHits,                          // local_index TODO check that the order is correct
+                                             chi2PerNDF,                       // goodness_of_fit
+                                             NDF                               // dof
+                                             );
+
+                filteredHitVec.push_back(hitcreator.copy());
+
+                const recob::Hit hit(hitcreator.move());
+
+                // This loop will store ALL hits
+                outputBuffer.allHitVec.emplace_back(std::move(hit), wireIdx);
+                numHits++;
+            } // <---End loop over gaussians
+
+            // Should we filter hits?
+            if (fFilterHits && !filteredHitVec.empty())
+            {
+                // #######################################################################
+                // Is all this sorting really necessary?  Would it be faster to just loop
+                // through the hits and perform simple cuts on amplitude and width on a
+                // hit-by-hit basis, either here in the module (using fPulseHeightCuts and
+                // fPulseWidthCuts) or in HitFilterAlg?
+                // #######################################################################
+
+                // Sort in ascending peak height
+                std::sort(filteredHitVec.begin(),filteredHitVec.end(),[](const auto& left, const auto& right){return left.PeakAmplitude() > right.PeakAmplitude();});
+
+                // Reject if the first hit fails the PH/wid cuts
+                if (filteredHitVec.front().PeakAmplitude() < fPulseHeightCuts.at(plane) || filteredHitVec.front().RMS() < fPulseWidthCuts.at(plane)) filteredHitVec.clear();
+
+                // Now check other hits in the snippet
+                if (filteredHitVec.size() > 1)
+                {
+                    // The largest pulse height will now be at the front...
+                    float largestPH = filteredHitVec.front().PeakAmplitude();
+
+                    // Find where the pulse heights drop below threshold
+                    float threshold(fPulseRatioCuts.at(plane));
+
+                    std::vector<recob::Hit>::iterator smallHitItr = std::find_if(filteredHitVec.begin(),filteredHitVec.end(),[largestPH,threshold](const auto& hit){return hit.PeakAmplitude() < 8. && hit.PeakAmplitude() / largestPH < threshold;});
+
+                    // Shrink to fit
+                    if (smallHitItr != filteredHitVec.end()) filteredHitVec.resize(std::distance(filteredHitVec.begin(),smallHitItr));
+
+                    // Resort in time order
+                    std::sort(filteredHitVec.begin(),filteredHitVec.end(),[](const auto& left, const auto& right){return left.PeakTime() < right.PeakTime();});
+                }
+
+                // Copy the hits we want to keep to the filtered hit collection
+                for(const auto& filteredHit : filteredHitVec)
+                    if (!fHitFilterAlg || fHitFilterAlg->IsGoodHit(filteredHit))
+                        outputBuffer.filteredHitVec.emplace_back(filteredHit, wireIdx);
+            }
+
+            outputBuffer.chi2Vec.push_back(chi2PerNDF);
+
+        }//<---End loop over merged candidate hits
+
+    } //<---End looping over ROI's
+
+    return;
+}
+
 //  This algorithm uses the fact that deconvolved signals are very smooth
 //  and looks for hits as areas between local minima that have signal above
 //  threshold.
@@ -204,11 +523,6 @@ void GausHitFinder::produce(art::Event& evt)
     //TStopwatch StopWatch;
     //StopWatch.Reset();
 
-    // ################################
-    // ### Calling Geometry service ###
-    // ################################
-    art::ServiceHandle<geo::Geometry const> geom;
-
     // ###############################################
     // ### Making a ptr vector to put on the event ###
     // ###############################################
@@ -229,14 +543,11 @@ void GausHitFinder::produce(art::Event& evt)
     art::Handle< std::vector<recob::Wire> > wireVecHandle;
     evt.getByLabel(fCalDataModuleLabel,wireVecHandle);
 
-    // Channel Number
-    raw::ChannelID_t channel = raw::InvalidChannelID;
-
     //#################################################
     //###    Set the charge determination method    ###
     //### Default is to compute the normalized area ###
     //#################################################
-    std::function<double (double,double,double,double,int,int)> chargeFunc = [](double peakMean, double peakAmp, double peakWidth, double areaNorm, int low, int hi){return std::sqrt(2*TMath::Pi())*peakAmp*peakWidth/areaNorm;};
+    ChargeFunc chargeFunc = [](double peakMean, double peakAmp, double peakWidth, double areaNorm, int low, int hi){return std::sqrt(2*TMath::Pi())*peakAmp*peakWidth/areaNorm;};
 
     //##############################################
     //### Alternative is to integrate over pulse ###
@@ -253,263 +564,49 @@ void GausHitFinder::produce(art::Event& evt)
     //##############################
     //### Looping over the wires ###
     //##############################
-    for(size_t wireIter = 0; wireIter < wireVecHandle->size(); wireIter++)
-    {
-        // ####################################
-        // ### Getting this particular wire ###
-        // ####################################
-        art::Ptr<recob::Wire>   wire(wireVecHandle, wireIter);
-
-        // --- Setting Channel Number and Signal type ---
-        channel = wire->Channel();
-
-        // get the WireID for this hit
-        std::vector<geo::WireID> wids = geom->ChannelToWire(channel);
-        // for now, just take the first option returned from ChannelToWire
-        geo::WireID wid  = wids[0];
-        // We need to know the plane to look up parameters
-        geo::PlaneID::PlaneID_t plane = wid.Plane;
-
-        // ----------------------------------------------------------
-        // -- Setting the appropriate signal widths and thresholds --
-        // --    for the right plane.      --
-        // ----------------------------------------------------------
-
-        // #################################################
-        // ### Set up to loop over ROI's for this wire   ###
-        // #################################################
-        const recob::Wire::RegionsOfInterest_t& signalROI = wire->SignalROI();
-
-        for(const auto& range : signalROI.get_ranges())
-        {
-            // ROI start time
-            raw::TDCtick_t roiFirstBinTick = range.begin_index();
-
-            // ###########################################################
-            // ### Scan the waveform and find candidate peaks + merge  ###
-            // ###########################################################
-
-            reco_tool::ICandidateHitFinder::HitCandidateVec      hitCandidateVec;
-            reco_tool::ICandidateHitFinder::MergeHitCandidateVec mergedCandidateHitVec;
+    // The wires are split into contiguous blocks, one per worker, and each worker
+    // buffers its hits so the collections below are filled in input wire order
+    // independent of how many workers were used
+    size_t const nWires  = wireVecHandle->size();
+    size_t const nBlocks = std::max(std::min(fNumThreads, nWires), size_t(1));
 
-            fHitFinderToolVec.at(plane)->findHitCandidates(range, 0, channel, fEventCount, hitCandidateVec);
-            fHitFinderToolVec.at(plane)->MergeHitCandidates(range, hitCandidateVec, mergedCandidateHitVec);
+    std::vector<HitOutputBuffer> outputBufferVec(nBlocks);
 
-            // #######################################################
-            // ### Lets loop over the pulses we found on this wire ###
-            // #######################################################
-
-            for(auto& mergedCands : mergedCandidateHitVec)
-            {
-                int startT= mergedCands.front().startTick;
-                int endT  = mergedCands.back().stopTick;
-
-                // ### Putting in a protection in case things went wrong ###
-                // ### In the end, this primarily catches the case where ###
-                // ### a fake pulse is at the start of the ROI           ###
-                if (endT - startT < 5) continue;
-
-                // #######################################################
-                // ### Clearing the parameter vector for the new pulse ###
-                // #######################################################
-
-                // === Setting the number of Gaussians to try ===
-                int nGausForFit = mergedCands.size();
-
-                // ##################################################
-                // ### Calling the function for fitting Gaussians ###
-                // ##################################################
-                double                                chi2PerNDF(0.);
-                int                                   NDF(1);
-		/*stand alone
-                reco_tool::IPeakFitter::PeakParamsVec peakParamsVec(nGausForFit);
-		*/
-                reco_tool::IPeakFitter::PeakParamsVec peakParamsVec;
-
-                // #######################################################
-                // ### If # requested Gaussians is too large then punt ###
-                // #######################################################
-                if (mergedCands.size() <= fMaxMultiHit)
-                {
-                    fPeakFitterTool->findPeakParameters(range.data(), mergedCands, peakParamsVec, chi2PerNDF, NDF);
-
-                    // If the chi2 is infinite then there is a real problem so we bail
-                    if (!(chi2PerNDF < std::numeric_limits<double>::infinity()))
-                    {
-                        chi2PerNDF = 2.*fChi2NDF;
-                        NDF        = 2;
-                    }
-
-                    fFirstChi2->Fill(chi2PerNDF);
-                }
-
-                // #######################################################
-                // ### If too large then force alternate solution      ###
-                // ### - Make n hits from pulse train where n will     ###
-                // ###   depend on the fhicl parameter fLongPulseWidth ###
-                // ### Also do this if chi^2 is too large              ###
-                // #######################################################
-                if (mergedCands.size() > fMaxMultiHit || nGausForFit * chi2PerNDF > fChi2NDF)
-                {
-                    int longPulseWidth = fLongPulseWidthVec.at(plane);
-                    int nHitsThisPulse = (endT - startT) / longPulseWidth;
-
-                    if (nHitsThisPulse > fLongMaxHitsVec.at(plane))
-                    {
-                        nHitsThisPulse = fLongMaxHitsVec.at(plane);
-                        longPulseWidth = (endT - startT) / nHitsThisPulse;
-                    }
-
-                    if (nHitsThisPulse * longPulseWidth < endT - startT) nHitsThisPulse++;
-
-                    int firstTick = startT;
-                    int lastTick  = std::min(firstTick + longPulseWidth, endT);
-
-                    peakParamsVec.clear();
-                    nGausForFit = nHitsThisPulse;
-                    NDF         = 1.;
-                    chi2PerNDF  =  chi2PerNDF > fChi2NDF ? chi2PerNDF : -1.;
-
-                    for(int hitIdx = 0; hitIdx < nHitsThisPulse; hitIdx++)
-                    {
-                        // This hit parameters
-                        double sumADC    = std::accumulate(range.begin() + firstTick, range.begin() + lastTick, 0.);
-                        double peakSigma = (lastTick - firstTick) / 3.;  // Set the width...
-                        double peakAmp   = 0.3989 * sumADC / peakSigma;  // Use gaussian formulation
-                        double peakMean  = (firstTick + lastTick) / 2.;
-
-                        // Store hit params
-                        reco_tool::IPeakFitter::PeakFitParams_t peakParams;
-
-                        peakParams.peakCenter         = peakMean;
-                        peakParams.peakCenterError    = 0.1 * peakMean;
-                        peakParams.peakSigma          = peakSigma;
-                        peakParams.peakSigmaError     = 0.1 * peakSigma;
-                        peakParams.peakAmplitude      = peakAmp;
-                        peakParams.peakAmplitudeError = 0.1 * peakAmp;
-
-                        peakParamsVec.push_back(peakParams);
-
-                        // set for next loop
-                        firstTick = lastTick;
-                        lastTick  = std::min(lastTick  + longPulseWidth, endT);
-                    }
-                }
-
-                // #######################################################
-                // ### Loop through returned peaks and make recob hits ###
-                // #######################################################
-
-                int numHits(0);
-
-                // Make a container for what will be the filtered collection
-                std::vector<recob::Hit> filteredHitVec;
-
-                for(const auto& peakParams : peakParamsVec)
-                {
-                    // Extract values for this hit
-                    float peakAmp   = peakParams.peakAmplitude;
-                    float peakMean  = peakParams.peakCenter;
-                    float peakWidth = peakParams.peakSigma;
-
-                    // Place one bit of protection here
-                    if (std::isnan(peakAmp))
-                    {
-                        std::cout << "**** hit peak amplitude is a nan! Channel: " << channel << ", start tick: " << startT << std::endl;
-                        continue;
-                    }
-
-                    // Extract errors
-                    float peakAmpErr   = peakParams.peakAmplitudeError;
-                    float peakMeanErr  = peakParams.peakCenterError;
-                    float peakWidthErr = peakParams.peakSigmaError;
-
-                    // ### Charge ###
-                    float charge    = chargeFunc(peakMean, peakAmp, peakWidth, fAreaNormsVec[plane],startT,endT);;
-                    float chargeErr = std::sqrt(TMath::Pi()) * (peakAmpErr*peakWidthErr + peakWidthErr*peakAmpErr);
-
-                    // ### limits for getting sums
-                    std::vector<float>::const_iterator sumStartItr = range.begin() + startT;
-                    std::vector<float>::const_iterator sumEndItr   = range.begin() + endT;
-
-                    // ### Sum of ADC counts
-                    double sumADC = std::accumulate(sumStartItr, sumEndItr, 0.);
-
-                    // ok, now create the hit
-                    recob::HitCreator hitcreator(*wire,                            // wire reference
-                                                 wid,                              // wire ID
-                                                 startT+roiFirstBinTick,           // start_tick TODO check
-                                                 endT+roiFirstBinTick,             // end_tick TODO check
-                                                 peakWidth,                        // rms
-                                                 peakMean+roiFirstBinTick,         // peak_time
-                                                 peakMeanErr,                      // sigma_peak_time
-                                                 peakAmp,                          // peak_amplitude
-                                                 peakAmpErr,                       // sigma_peak_amplitude
-                                                 charge,                           // hit_integral
-                                                 chargeErr,                        // hit_sigma_integral
-                                                 sumADC,                           // summedADC FIXME
-                                                 nGausForFit,                      // multiplicity
-                                                 numHits,                          // local_index TODO check that the order is correct
-                                                 chi2PerNDF,                       // goodness_of_fit
-                                                 NDF                               // dof
-                                                 );
-
-                    filteredHitVec.push_back(hitcreator.copy());
-
-                    const recob::Hit hit(hitcreator.move());
-
-                    // This loop will store ALL hits
-                    allHitCol.emplace_back(std::move(hit), wire);
-                    numHits++;
-                } // <---End loop over gaussians
-
-                // Should we filter hits?
-                if (filteredHitCol && !filteredHitVec.empty())
-                {
-                    // #######################################################################
-                    // Is all this sorting really necessary?  Would it be faster to just loop
-                    // through the hits and perform simple cuts on amplitude and width on a
-                    // hit-by-hit basis, either here in the module (using fPulseHeightCuts and
-                    // fPulseWidthCuts) or in HitFilterAlg?
-                    // #######################################################################
-
-                    // Sort in ascending peak height
-                    std::sort(filteredHitVec.begin(),filteredHitVec.end(),[](const auto& left, const auto& right){return left.PeakAmplitude() > right.PeakAmplitude();});
-
-                    // Reject if the first hit fails the PH/wid cuts
-                    if (filteredHitVec.front().PeakAmplitude() < fPulseHeightCuts.at(plane) || filteredHitVec.front().RMS() < fPulseWidthCuts.at(plane)) filteredHitVec.clear();
-
-                    // Now check other hits in the snippet
-                    if (filteredHitVec.size() > 1)
-                    {
-                        // The largest pulse height will now be at the front...
-                        float largestPH = filteredHitVec.front().PeakAmplitude();
-
-                        // Find where the pulse heights drop below threshold
-                        float threshold(fPulseRatioCuts.at(plane));
-
-                        std::vector<recob::Hit>::iterator smallHitItr = std::find_if(filteredHitVec.begin(),filteredHitVec.end(),[largestPH,threshold](const auto& hit){return hit.PeakAmplitude() < 8. && hit.PeakAmplitude() / largestPH < threshold;});
+    auto processBlock = [&](size_t blockIdx)
+    {
+        size_t const firstWire = blockIdx * nWires / nBlocks;
+        size_t const lastWire  = (blockIdx + 1) * nWires / nBlocks;
 
-                        // Shrink to fit
-                        if (smallHitItr != filteredHitVec.end()) filteredHitVec.resize(std::distance(filteredHitVec.begin(),smallHitItr));
+        for(size_t wireIter = firstWire; wireIter < lastWire; wireIter++)
+        {
+            // ####################################
+            // ### Getting this particular wire ###
+            // ####################################
+            art::Ptr<recob::Wire> wire(wireVecHandle, wireIter);
 
-                        // Resort in time order
-                        std::sort(filteredHitVec.begin(),filteredHitVec.end(),[](const auto& left, const auto& right){return left.PeakTime() < right.PeakTime();});
-                    }
+            ProcessWire(wire, wireIter, fWorkerVec[blockIdx], chargeFunc, outputBufferVec[blockIdx]);
+        }
+    };
 
-                    // Copy the hits we want to keep to the filtered hit collection
-                    for(const auto& filteredHit : filteredHitVec)
-                        if (!fHitFilterAlg || fHitFilterAlg->IsGoodHit(filteredHit))
-                            filteredHitCol->emplace_back(filteredHit, wire);
-                }
+    if (nBlocks > 1) tbb::parallel_for(size_t(0), nBlocks, processBlock);
+    else             processBlock(0);
 
-                fChi2->Fill(chi2PerNDF);
+    // Now merge the worker outputs, block order is wire order
+    for(const auto& outputBuffer : outputBufferVec)
+    {
+        for(const auto& firstChi2 : outputBuffer.firstChi2Vec) fFirstChi2->Fill(firstChi2);
+        for(const auto& chi2      : outputBuffer.chi2Vec)      fChi2->Fill(chi2);
 
-            }//<---End loop over merged candidate hits
+        for(const auto& hitPair : outputBuffer.allHitVec)
+            allHitCol.emplace_back(hitPair.first, art::Ptr<recob::Wire>(wireVecHandle, hitPair.second));
 
-        } //<---End looping over ROI's
+        if (filteredHitCol)
+        {
+            for(const auto& hitPair : outputBuffer.filteredHitVec)
+                filteredHitCol->emplace_back(hitPair.first, art::Ptr<recob::Wire>(wireVecHandle, hitPair.second));
+        }
+    }
 
-   }//<---End looping over all the wires
 
 
     //==================================================================================================
@@ -0,0 +1,322 @@
+////////////////////////////////////////////////////////////////////////
+// Class:       HitFinderBenchmark
+// Module Type: analyzer
+// File:        HitFinderBenchmark_module.cc
+//
+// Replays the regions of interest of recorded recob::Wire collections
+// through every combination of the configured candidate hit finder and
+// peak fitter tools and reports, for each combination:
+//   - the time per ROI and the number of fits per second
+//   - the number of heap allocations per ROI
+//   - the fit differences with respect to the first peak fitter (in
+//     name order, as fhicl returns the table keys)
+//
+// Heap allocations are only counted when the job runs with the
+// larreco_HitFinder_AllocationCounter library preloaded, e.g.
+//   LD_PRELOAD=liblarreco_HitFinder_AllocationCounter.so lar -c ...
+// otherwise they are reported as unavailable.
+////////////////////////////////////////////////////////////////////////
+
+// C/C++ standard library
+#include <algorithm>
+#include <cmath>
+#include <dlfcn.h> // dlsym()
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Framework includes
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Utilities/make_tool.h"
+#include "cetlib/cpu_timer.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+// LArSoft Includes
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h" // raw::ChannelID_t
+#include "lardataobj/RecoBase/Wire.h"
+#include "larreco/HitFinder/HitFinderTools/ICandidateHitFinder.h"
+#include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+
+namespace hit {
+
+class HitFinderBenchmark : public art::EDAnalyzer {
+public:
+    explicit HitFinderBenchmark(fhicl::ParameterSet const& pset);
+
+private:
+    void analyze(art::Event const& evt) override;
+    void endJob() override;
+
+    using AllocationCountFunc = unsigned long long (*)();
+
+    /// Accumulated results for one candidate finder/peak fitter combination
+    struct BenchmarkStats
+    {
+        std::string        name;
+        size_t             numROIs          = 0;
+        size_t             numFits          = 0;
+        size_t             numFailedFits    = 0;
+        double             candidateTime    = 0.;  ///< seconds in candidate finding and merging
+        double             fitTime          = 0.;  ///< seconds in peak fitting
+        unsigned long long numAllocations   = 0;
+        size_t             numCompared      = 0;   ///< peaks compared to the reference fitter
+        double             sumDeltaCenter   = 0.;
+        double             sumDeltaSigma    = 0.;
+        double             sumRelDeltaAmp   = 0.;
+        double             sumDeltaChi2NDF  = 0.;
+        size_t             numComparedFits  = 0;
+    };
+
+    /// Result of fitting one merged candidate group
+    struct FitResult
+    {
+        bool                                  good;
+        double                                chi2PerNDF;
+        reco_tool::IPeakFitter::PeakParamsVec peakParamsVec;
+    };
+
+    using FitResultVec = std::vector<FitResult>;
+
+    unsigned long long AllocationCount() const { return fAllocationCount ? fAllocationCount() : 0; }
+
+    std::string                                                  fWireModuleLabel;
+    size_t                                                       fMaxMultiHit;     ///< Larger groups are not fit, as in GausHitFinder
+    size_t                                                       fNumRepetitions;  ///< Number of replays of each event, to stabilize timing
+
+    std::vector<std::string>                                     fHitFinderNames;
+    std::vector<std::unique_ptr<reco_tool::ICandidateHitFinder>> fHitFinderToolVec;
+    std::vector<std::string>                                     fPeakFitterNames;
+    std::vector<std::unique_ptr<reco_tool::IPeakFitter>>         fPeakFitterToolVec;
+
+    std::vector<BenchmarkStats>                                  fStatsVec;        ///< Indexed by finder * num fitters + fitter
+
+    AllocationCountFunc                                          fAllocationCount;
+    size_t                                                       fEventCount;
+};
+
+//-------------------------------------------------
+HitFinderBenchmark::HitFinderBenchmark(fhicl::ParameterSet const& pset)
+  : EDAnalyzer{pset},
+    fEventCount(0)
+{
+    fWireModuleLabel = pset.get< std::string >("WireModuleLabel");
+    fMaxMultiHit     = pset.get< size_t      >("MaxMultiHit",    10);
+    fNumRepetitions  = std::max(pset.get< size_t >("NumRepetitions", 1), size_t(1));
+
+    const fhicl::ParameterSet& hitFinderTools = pset.get<fhicl::ParameterSet>("HitFinderTools");
+
+    for(const std::string& hitFinderTool : hitFinderTools.get_pset_names())
+    {
+        fHitFinderNames.push_back(hitFinderTool);
+        fHitFinderToolVec.push_back(art::make_tool<reco_tool::ICandidateHitFinder>(hitFinderTools.get<fhicl::ParameterSet>(hitFinderTool)));
+    }
+
+    const fhicl::ParameterSet& peakFitterTools = pset.get<fhicl::ParameterSet>("PeakFitterTools");
+
+    for(const std::string& peakFitterTool : peakFitterTools.get_pset_names())
+    {
+        fPeakFitterNames.push_back(peakFitterTool);
+        fPeakFitterToolVec.push_back(art::make_tool<reco_tool::IPeakFitter>(peakFitterTools.get<fhicl::ParameterSet>(peakFitterTool)));
+    }
+
+    for(const auto& hitFinderName : fHitFinderNames)
+    {
+        for(const auto& peakFitterName : fPeakFitterNames)
+        {
+            fStatsVec.emplace_back();
+            fStatsVec.back().name = hitFinderName + "/" + peakFitterName;
+        }
+    }
+
+    // The counter is only there if the allocation counting library was preloaded
+    fAllocationCount = reinterpret_cast<AllocationCountFunc>(dlsym(RTLD_DEFAULT, "larreco_allocation_count"));
+
+    if (!fAllocationCount)
+        mf::LogInfo("HitFinderBenchmark") << "Allocation counter library not preloaded, allocations will not be reported";
+}
+
+//-------------------------------------------------
+void HitFinderBenchmark::analyze(art::Event const& evt)
+{
+    art::Handle< std::vector<recob::Wire> > wireVecHandle;
+    evt.getByLabel(fWireModuleLabel, wireVecHandle);
+
+    // Collect the ROIs (with their channel) of this event
+    using ROI = recob::Wire::RegionsOfInterest_t::datarange_t;
+
+    std::vector<std::pair<const ROI*,raw::ChannelID_t>> roiVec;
+
+    for(const auto& wire : *wireVecHandle)
+    {
+        for(const auto& range : wire.SignalROI().get_ranges()) roiVec.emplace_back(&range, wire.Channel());
+    }
+
+    for(size_t finderIdx = 0; finderIdx < fHitFinderToolVec.size(); finderIdx++)
+    {
+        const auto& hitFinderTool = fHitFinderToolVec[finderIdx];
+
+        // The candidates are recomputed on each repetition, the last ones are kept for the fits
+        std::vector<reco_tool::ICandidateHitFinder::MergeHitCandidateVec> mergedCandidatesVec(roiVec.size());
+
+        cet::cpu_timer     candidateTimer;
+        unsigned long long candidateAllocations(0);
+
+        for(size_t repetition = 0; repetition < fNumRepetitions; repetition++)
+        {
+            unsigned long long startAllocations = AllocationCount();
+
+            candidateTimer.start();
+
+            for(size_t roiIdx = 0; roiIdx < roiVec.size(); roiIdx++)
+            {
+                reco_tool::ICandidateHitFinder::HitCandidateVec hitCandidateVec;
+
+                mergedCandidatesVec[roiIdx].clear();
+
+                hitFinderTool->findHitCandidates(*roiVec[roiIdx].first, 0, roiVec[roiIdx].second, fEventCount, hitCandidateVec);
+                hitFinderTool->MergeHitCandidates(*roiVec[roiIdx].first, hitCandidateVec, mergedCandidatesVec[roiIdx]);
+            }
+
+            candidateTimer.stop();
+
+            candidateAllocations += AllocationCount() - startAllocations;
+        }
+
+        std::vector<FitResultVec> referenceResults;
+
+        for(size_t fitterIdx = 0; fitterIdx < fPeakFitterToolVec.size(); fitterIdx++)
+        {
+            const auto&     peakFitterTool = fPeakFitterToolVec[fitterIdx];
+            BenchmarkStats& stats          = fStatsVec[finderIdx * fPeakFitterToolVec.size() + fitterIdx];
+
+            std::vector<FitResultVec> fitResults(roiVec.size());
+
+            cet::cpu_timer     fitTimer;
+            unsigned long long fitAllocations(0);
+
+            for(size_t repetition = 0; repetition < fNumRepetitions; repetition++)
+            {
+                unsigned long long startAllocations = AllocationCount();
+
+                fitTimer.start();
+
+                for(size_t roiIdx = 0; roiIdx < roiVec.size(); roiIdx++)
+                {
+                    FitResultVec& roiResults = fitResults[roiIdx];
+
+                    roiResults.clear();
+
+                    for(const auto& mergedCands : mergedCandidatesVec[roiIdx])
+                    {
+                        // Same selection as GausHitFinder
+                        if (int(mergedCands.back().stopTick) - int(mergedCands.front().startTick) < 5 || mergedCands.size() > fMaxMultiHit) continue;
+
+                        FitResult fitResult;
+                        int       NDF(1);
+
+                        fitResult.chi2PerNDF = 0.;
+
+                        peakFitterTool->findPeakParameters(roiVec[roiIdx].first->data(), mergedCands, fitResult.peakParamsVec, fitResult.chi2PerNDF, NDF);
+
+                        fitResult.good = fitResult.chi2PerNDF < std::numeric_limits<double>::infinity() && fitResult.peakParamsVec.size() == mergedCands.size();
+
+                        roiResults.emplace_back(std::move(fitResult));
+                    }
+                }
+
+                fitTimer.stop();
+
+                fitAllocations += AllocationCount() - startAllocations;
+            }
+
+            stats.numROIs        += roiVec.size();
+            stats.candidateTime  += candidateTimer.accumulated_real_time() / fNumRepetitions;
+            stats.fitTime        += fitTimer.accumulated_real_time() / fNumRepetitions;
+            stats.numAllocations += (candidateAllocations + fitAllocations) / fNumRepetitions;
+
+            for(size_t roiIdx = 0; roiIdx < roiVec.size(); roiIdx++)
+            {
+                for(size_t groupIdx = 0; groupIdx < fitResults[roiIdx].size(); groupIdx++)
+                {
+                    const FitResult& fitResult = fitResults[roiIdx][groupIdx];
+
+                    stats.numFits++;
+
+                    if (!fitResult.good)
+                    {
+                        stats.numFailedFits++;
+                        continue;
+                    }
+
+                    if (fitterIdx == 0) continue;
+
+                    // Compare with the reference fitter, the peaks come from the same candidates
+                    const FitResult& refResult = referenceResults[roiIdx][groupIdx];
+
+                    if (!refResult.good) continue;
+
+                    stats.numComparedFits++;
+                    stats.sumDeltaChi2NDF += fitResult.chi2PerNDF - refResult.chi2PerNDF;
+
+                    for(size_t peakIdx = 0; peakIdx < fitResult.peakParamsVec.size(); peakIdx++)
+                    {
+                        const auto& peak    = fitResult.peakParamsVec[peakIdx];
+                        const auto& refPeak = refResult.peakParamsVec[peakIdx];
+
+                        stats.numCompared++;
+                        stats.sumDeltaCenter += std::abs(peak.peakCenter - refPeak.peakCenter);
+                        stats.sumDeltaSigma  += std::abs(peak.peakSigma  - refPeak.peakSigma);
+                        stats.sumRelDeltaAmp += std::abs(peak.peakAmplitude - refPeak.peakAmplitude) / std::max(std::abs(refPeak.peakAmplitude), float(1.e-3));
+                    }
+                }
+            }
+
+            if (fitterIdx == 0) referenceResults = std::move(fitResults);
+        }
+    }
+
+    fEventCount++;
+}
+
+//-------------------------------------------------
+void HitFinderBenchmark::endJob()
+{
+    mf::LogInfo log("HitFinderBenchmark");
+
+    log << "Hit finding benchmark over " << fEventCount << " events, " << fNumRepetitions << " repetitions, fit differences relative to "
+        << (fPeakFitterNames.empty() ? std::string("-") : fPeakFitterNames.front()) << "\n";
+
+    log << std::setw(40) << "finder/fitter" << std::setw(12) << "ns/ROI" << std::setw(12) << "fits/s" << std::setw(12) << "allocs/ROI"
+        << std::setw(10) << "failed" << std::setw(12) << "<|dT|>" << std::setw(12) << "<|dRMS|>" << std::setw(12) << "<|dA|/A>"
+        << std::setw(12) << "<dchi2/NDF>" << "\n";
+
+    for(const auto& stats : fStatsVec)
+    {
+        double const numROIs  = std::max(stats.numROIs,     size_t(1));
+        double const numPeaks = std::max(stats.numCompared, size_t(1));
+
+        log << std::setw(40) << stats.name
+            << std::setw(12) << 1.e9 * (stats.candidateTime + stats.fitTime) / numROIs
+            << std::setw(12) << (stats.fitTime > 0. ? stats.numFits / stats.fitTime : 0.);
+
+        if (fAllocationCount) log << std::setw(12) << stats.numAllocations / numROIs;
+        else                  log << std::setw(12) << "n/a";
+
+        log << std::setw(10) << stats.numFailedFits
+            << std::setw(12) << stats.sumDeltaCenter / numPeaks
+            << std::setw(12) << stats.sumDeltaSigma  / numPeaks
+            << std::setw(12) << stats.sumRelDeltaAmp / numPeaks
+            << std::setw(12) << stats.sumDeltaChi2NDF / std::max(stats.numComparedFits, size_t(1))
+            << "\n";
+    }
+}
+
+DEFINE_ART_MODULE(HitFinderBenchmark)
+
+} // end of hit namespace
@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////
+/// \file   PeakFitterGaussianLM.cc
+/// \brief  Multi-Gaussian peak fitter without ROOT on the fitting path
+////////////////////////////////////////////////////////////////////////
+
+#include "larreco/HitFinder/HitFinderTools/IPeakFitter.h"
+#include "larreco/RecoAlg/GausLMFitter.h" // hit::GausLMFitter
+
+#include "art/Utilities/ToolMacros.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace reco_tool
+{
+
+/// Performs the same fit as PeakFitterGaussian (same starting values, limits,
+/// unit weights and treatment of the baseline) but with hit::GausLMFitter
+/// working directly on the ROI samples: no TH1, TF1 or Minuit involved.
+/// The fitter keeps its workspaces between calls, so one instance of this tool
+/// must not be used by more than one thread at a time.
+class PeakFitterGaussianLM : IPeakFitter
+{
+public:
+    explicit PeakFitterGaussianLM(const fhicl::ParameterSet& pset);
+
+    void configure(const fhicl::ParameterSet& pset) override;
+
+    void findPeakParameters(const std::vector<float>&,
+                            const ICandidateHitFinder::HitCandidateVec&,
+                            PeakParamsVec&,
+                            double&,
+                            int&) const override;
+
+private:
+    // Member variables from the fhicl file
+    double                      fMinWidth;          ///< minimum initial width for gaussian fit
+    double                      fMaxWidthMult;      ///< multiplier for max width for gaussian fit
+    double                      fPeakRange;         ///< set range limits for peak center
+    double                      fAmpRange;          ///< set range limit for peak amplitude
+    bool                        fFloatBaseline;     ///< Allow baseline to "float" away from zero
+
+    mutable hit::GausLMFitter   fFitter;            ///< The fitter with its preallocated workspaces
+    mutable std::vector<double> fParams;            ///< Parameter values
+    mutable std::vector<double> fParMin;            ///< Parameter lower limits
+    mutable std::vector<double> fParMax;            ///< Parameter upper limits
+};
+
+//----------------------------------------------------------------------
+// Constructor.
+PeakFitterGaussianLM::PeakFitterGaussianLM(const fhicl::ParameterSet& pset)
+{
+    configure(pset);
+}
+
+void PeakFitterGaussianLM::configure(const fhicl::ParameterSet& pset)
+{
+    // Start by recovering the parameters
+    fMinWidth         = pset.get<double>("MinWidth",         0.5);
+    fMaxWidthMult     = pset.get<double>("MaxWidthMult",     3.);
+    fPeakRange        = pset.get<double>("PeakRangeFact",    2.);
+    fAmpRange         = pset.get<double>("PeakAmpRange",     2.);
+    fFloatBaseline    = pset.get< bool >("FloatBaseline",    false);
+
+    // The batched kernel is the one CompiledGausFitCache::EvalBatch() uses
+    fFitter = hit::GausLMFitter(pset.get<unsigned int>("MaxIterations",  100),
+                                pset.get<double      >("Tolerance",      1e-6),
+                                pset.get<bool        >("UseBatchKernel", false));
+
+    return;
+}
+
+// --------------------------------------------------------------------------------------------
+void PeakFitterGaussianLM::findPeakParameters(const std::vector<float>&                   roiSignalVec,
+                                              const ICandidateHitFinder::HitCandidateVec& hitCandidateVec,
+                                              PeakParamsVec&                              peakParamsVec,
+                                              double&                                     chi2PerNDF,
+                                              int&                                        NDF) const
+{
+    // *** NOTE: this algorithm assumes the reference time for input hit candidates is to
+    //           the first tick of the input waveform (ie 0)
+    //
+    if (hitCandidateVec.empty()) return;
+
+    // in case of a fit failure, set the chi-square to infinity
+    chi2PerNDF = std::numeric_limits<double>::infinity();
+
+    int startTime = hitCandidateVec.front().startTick;
+    int endTime   = hitCandidateVec.back().stopTick;
+    int roiSize   = endTime - startTime;
+
+    // Samples sit at the bin centers, as they do in the histogram PeakFitterGaussian fills
+    fFitter.SetData(roiSignalVec.data() + startTime, roiSize, 0.5, true);
+
+    size_t const nGaus   = hitCandidateVec.size();
+    size_t const nParams = 3 * nGaus + 1;
+
+    fParams.resize(nParams);
+    fParMin.resize(nParams);
+    fParMax.resize(nParams);
+
+    // Set the baseline if so desired, it is always the last parameter
+    float baseline(0.);
+
+    if (fFloatBaseline) baseline = roiSignalVec[startTime];
+
+    fParams[3 * nGaus] = baseline;
+    fParMin[3 * nGaus] = baseline - 12.;
+    fParMax[3 * nGaus] = baseline + 12.;
+
+    // ### Setting the parameters for the Gaussian Fit ###
+    int parIdx{0};
+    for(auto const& candidateHit : hitCandidateVec)
+    {
+        double const peakMean   = candidateHit.hitCenter - float(startTime);
+        double const peakWidth  = candidateHit.hitSigma;
+        double const amplitude  = candidateHit.hitHeight - baseline;
+        double const meanLowLim = std::max(peakMean - fPeakRange * peakWidth,              0.);
+        double const meanHiLim  = std::min(peakMean + fPeakRange * peakWidth, double(roiSize));
+
+        fParams[  parIdx] = amplitude;
+        fParams[1+parIdx] = peakMean;
+        fParams[2+parIdx] = peakWidth;
+        fParMin[  parIdx] = 0.1 * amplitude;
+        fParMax[  parIdx] = fAmpRange * amplitude;
+        fParMin[1+parIdx] = meanLowLim;
+        fParMax[1+parIdx] = meanHiLim;
+        fParMin[2+parIdx] = std::max(fMinWidth, 0.1 * peakWidth);
+        fParMax[2+parIdx] = fMaxWidthMult * peakWidth;
+
+        parIdx += 3;
+    }
+
+    if (!fFitter.Fit(nGaus, fParams, fParMin, fParMax, fFloatBaseline)) return;
+
+    // ##################################################
+    // ### Getting the fitted parameters from the fit ###
+    // ##################################################
+    NDF        = fFitter.NDF();
+    chi2PerNDF = fFitter.Chi2() / NDF;
+
+    const std::vector<double>& parErrors = fFitter.ParErrors();
+
+    parIdx = 0;
+    for(size_t idx = 0; idx < nGaus; idx++)
+    {
+        PeakFitParams_t peakParams;
+
+        peakParams.peakAmplitude      = fParams[parIdx];
+        peakParams.peakAmplitudeError = parErrors[parIdx];
+        peakParams.peakCenter         = fParams[parIdx + 1] + float(startTime);
+        peakParams.peakCenterError    = parErrors[parIdx + 1];
+        peakParams.peakSigma          = fParams[parIdx + 2];
+        peakParams.peakSigmaError     = parErrors[parIdx + 2];
+
+        peakParamsVec.emplace_back(peakParams);
+
+        parIdx += 3;
+    }
+
+    return;
+}
+
+DEFINE_ART_CLASS_TOOL(PeakFitterGaussianLM)
+}
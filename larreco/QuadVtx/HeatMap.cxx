@@ -34,4 +34,21 @@ namespace quad
 
     return h;
   }
+
+  // -------------------------------------------------------------------------
+  TiledHeatMap::TiledHeatMap(const HeatMap& hm)
+    : fNTilesX((hm.Nx+kTileSize-1)/kTileSize),
+      fBins(size_t((hm.Nz+kTileSize-1)/kTileSize)*fNTilesX*kTileArea, 0)
+  {
+  }
+
+  // -------------------------------------------------------------------------
+  void TiledHeatMap::AddTo(HeatMap& hm) const
+  {
+    for(int iz = 0; iz < hm.Nz; ++iz){
+      for(int ix = 0; ix < hm.Nx; ++ix){
+        hm.map[iz*hm.Nx + ix] += fBins[Index(iz, ix)];
+      }
+    }
+  }
 }
@@ -30,6 +30,37 @@ namespace quad
     // The rounding functions in std:: are surprisingly slow
     inline int fast_floor(double x) const {return int(x+100000)-100000;}
   };
+
+  /// Accumulation buffer for a HeatMap with the bins grouped in square tiles,
+  /// so that bins close in both z and x share cache lines. The points filled
+  /// from one line all lie along it, which a row-major map scatters over many
+  /// rows.
+  class TiledHeatMap
+  {
+  public:
+    explicit TiledHeatMap(const HeatMap& hm);
+
+    /// Position of bin (iz, ix) of the HeatMap in the tiled storage
+    int Index(int iz, int ix) const
+    {
+      return ((iz >> kLog2Tile)*fNTilesX + (ix >> kLog2Tile))*kTileArea +
+        ((iz & kTileMask) << kLog2Tile) + (ix & kTileMask);
+    }
+
+    void Add(int idx, float w){fBins[idx] += w;}
+
+    /// Add the contents into the (row-major) map of hm
+    void AddTo(HeatMap& hm) const;
+
+  private:
+    static constexpr int kLog2Tile = 4; // 16x16 bins = 1kB tiles
+    static constexpr int kTileSize = 1 << kLog2Tile;
+    static constexpr int kTileArea = kTileSize*kTileSize;
+    static constexpr int kTileMask = kTileSize-1;
+
+    int fNTilesX;
+    std::vector<float> fBins;
+  };
 }
 
 #endif
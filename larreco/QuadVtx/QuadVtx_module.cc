@@ -7,6 +7,9 @@
 #include <iostream>
 #include <random>
 
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 // framework libraries
 #include "fhiclcpp/ParameterSet.h"
 #include "art/Framework/Core/ModuleMacros.h"
@@ -74,10 +77,17 @@ private:
                TVector3& vtx,
                int evt) const;
 
+  /// Call func(view) for the three views, each on its own thread if allowed
+  template<class F> void ForEachView(const F& func) const;
+
   std::string fHitLabel;
 
   bool fSavePlots;
 
+  size_t fMaxLines; ///< Cap on lines per view, 0 to use all pairs of hits
+  size_t fMaxPts; ///< Cap on line intersections per view, 0 to use all
+  unsigned int fNumThreads;
+
   const detinfo::DetectorProperties* detprop;
   const geo::GeometryCore* geom;
 };
@@ -88,7 +98,10 @@ DEFINE_ART_MODULE(QuadVtx)
 QuadVtx::QuadVtx(const fhicl::ParameterSet& pset) :
   EDProducer(pset),
   fHitLabel(pset.get<std::string>("HitLabel")),
-  fSavePlots(pset.get<bool>("SavePlots"))
+  fSavePlots(pset.get<bool>("SavePlots")),
+  fMaxLines(pset.get<size_t>("MaxLines", 10*1000*1000)),
+  fMaxPts(pset.get<size_t>("MaxPts", 10*1000*1000)),
+  fNumThreads(pset.get<unsigned int>("NumThreads", 1))
 {
   produces<std::vector<recob::Vertex>>();
 }
@@ -134,11 +147,11 @@ bool IntersectsCircle(float m, float c,
 // ---------------------------------------------------------------------------
 void LinesFromPoints(const std::vector<Pt2D>& pts,
                      std::vector<Line2D>& lines,
+                     size_t maxLines, // 10M lines is 150MB...
                      float z0 = 0, float x0 = 0, float R = -1)
 {
-  constexpr size_t kMaxLines = 10*1000*1000; // This is 150MB of lines...
-
   const size_t product = (pts.size()*(pts.size()-1))/2;
+  const size_t kMaxLines = (maxLines > 0) ? maxLines : std::max(product, size_t(1));
   const int stride = product / kMaxLines + 1;
 
   lines.reserve(std::min(product, kMaxLines));
@@ -182,11 +195,30 @@ inline bool CloseAngles(float ma, float mb)
 }
 
 // ---------------------------------------------------------------------------
-void MapFromLines(const std::vector<Line2D>& lines, HeatMap& hm)
+// One array per line parameter, for the vectorized loop in MapFromLines
+struct LineArrays
 {
-  // This maximum is driven by runtime
-  constexpr size_t kMaxPts = 10*1000*1000;
+  explicit LineArrays(const std::vector<Line2D>& lines)
+  {
+    m.reserve(lines.size());
+    c.reserve(lines.size());
+    minz.reserve(lines.size());
+    maxz.reserve(lines.size());
+    for(const Line2D& l: lines){
+      m.push_back(l.m);
+      c.push_back(l.c);
+      minz.push_back(l.minz);
+      maxz.push_back(l.maxz);
+    }
+  }
+
+  std::vector<float> m, c, minz, maxz;
+};
 
+// ---------------------------------------------------------------------------
+void MapFromLines(const std::vector<Line2D>& lines, HeatMap& hm,
+                  size_t maxPts) // This maximum is driven by runtime
+{
   unsigned int j0 = 0;
   unsigned int jmax = 0;
 
@@ -203,12 +235,23 @@ void MapFromLines(const std::vector<Line2D>& lines, HeatMap& hm)
   }
 
   const size_t product = (lines.size()*(lines.size()-1))/2;
-  const int stride = npts / kMaxPts + 1;
+  const int stride = (maxPts > 0) ? npts / maxPts + 1 : 1;
 
   mf::LogInfo() << "Combining lines to points with stride " << stride << std::endl;
 
   mf::LogInfo() << npts << " cf " << product << " ie " << double(npts)/product << std::endl;
 
+  const LineArrays ls(lines);
+  TiledHeatMap tiled(hm);
+
+  // The pairs are handled in batches: first the bins of all the
+  // intersections, with no dependency between pairs so that the compiler can
+  // vectorize it, then the (scattered) filling.
+  constexpr unsigned int kBatch = 256;
+  int bins[kBatch]; // -1 for no fill
+  const int Nz = hm.Nz;
+  const int Nx = hm.Nx;
+
   j0 = 0;
   jmax = 0;
 
@@ -220,23 +263,34 @@ void MapFromLines(const std::vector<Line2D>& lines, HeatMap& hm)
     jmax = std::max(jmax, j0);
     while(jmax < lines.size() && !CloseAngles(a.m, lines[jmax].m)) ++jmax;
 
-    for(unsigned int j = j0; j < jmax; j += stride){
-      const Line2D& b = lines[j];
+    for(unsigned int jb = j0; jb < jmax; jb += kBatch*stride){
+      const unsigned int nb = std::min(kBatch, (jmax-jb+stride-1)/stride);
+
+      for(unsigned int k = 0; k < nb; ++k){
+        const unsigned int j = jb + k*stride;
 
-      // x = mA * z + cA = mB * z + cB
-      const float z = (b.c-a.c)/(a.m-b.m);
-      const float x = a.m*z+a.c;
+        // x = mA * z + cA = mB * z + cB
+        const float z = (ls.c[j]-a.c)/(a.m-ls.m[j]);
+        const float x = a.m*z+a.c;
 
-      // No solutions within a line
-      if((z < a.minz || z > a.maxz) && (z < b.minz || z > b.maxz)){
         const int iz = hm.ZToBin(z);
         const int ix = hm.XToBin(x);
-        if(iz >= 0 && iz < hm.Nz && ix >= 0 && ix < hm.Nx){
-          hm.map[iz*hm.Nx + ix] += stride;
-        }
+
+        // No solutions within a line. Bitwise operators, so that there are
+        // no branches in the loop
+        const bool outside = ((z < a.minz) | (z > a.maxz)) & ((z < ls.minz[j]) | (z > ls.maxz[j]));
+        const bool inmap = (iz >= 0) & (iz < Nz) & (ix >= 0) & (ix < Nx);
+
+        bins[k] = (outside & inmap) ? tiled.Index(iz, ix) : -1;
       }
-    } // end for i
-  }
+
+      for(unsigned int k = 0; k < nb; ++k){
+        if(bins[k] >= 0) tiled.Add(bins[k], stride);
+      }
+    } // end for jb
+  } // end for i
+
+  tiled.AddTo(hm);
 }
 
 // ---------------------------------------------------------------------------
@@ -428,16 +482,23 @@ bool QuadVtx::FindVtx(const std::vector<recob::Hit>& hits,
   for(int view = 0; view < 3; ++view){
     if(pts[view].empty()) return false;
 
-    std::vector<Line2D> lines;
-    LinesFromPoints(pts[view], lines);
-
-    if(lines.empty()) return false;
-
     // Approximately cm bins
     hms.emplace_back(maxz[view]-minz[view], minz[view], maxz[view],
                      maxx-minx, minx, maxx);
-    MapFromLines(lines, hms.back());
-  } // end for view
+  }
+
+  bool ok[3] = {true, true, true};
+
+  ForEachView([&](int view){
+      std::vector<Line2D> lines;
+      LinesFromPoints(pts[view], lines, fMaxLines);
+
+      if(lines.empty()){ok[view] = false; return;}
+
+      MapFromLines(lines, hms[view], fMaxPts);
+    });
+
+  if(!ok[0] || !ok[1] || !ok[2]) return false;
 
   vtx = FindPeak3D(hms, dirs);
 
@@ -447,18 +508,25 @@ bool QuadVtx::FindVtx(const std::vector<recob::Hit>& hits,
     const double x0 = vtx.X();
     const double z0 = vtx.Dot(dirs[view]);
 
-    std::vector<Line2D> lines;
-    LinesFromPoints(pts[view], lines, z0, x0, 2.5);
-
-    if(lines.empty()) return false; // How does this happen??
-
     // mm granularity
     hms_zoom.emplace_back(50, z0-2.5, z0+2.5,
                           50, x0-2.5, x0+2.5);
-
-    MapFromLines(lines, hms_zoom.back());
   }
 
+  ForEachView([&](int view){
+      const double x0 = vtx.X();
+      const double z0 = vtx.Dot(dirs[view]);
+
+      std::vector<Line2D> lines;
+      LinesFromPoints(pts[view], lines, fMaxLines, z0, x0, 2.5);
+
+      if(lines.empty()){ok[view] = false; return;} // How does this happen??
+
+      MapFromLines(lines, hms_zoom[view], fMaxPts);
+    });
+
+  if(!ok[0] || !ok[1] || !ok[2]) return false;
+
   vtx = FindPeak3D(hms_zoom, dirs);
 
   if(fSavePlots){
@@ -483,6 +551,18 @@ bool QuadVtx::FindVtx(const std::vector<recob::Hit>& hits,
   return true;
 }
 
+// ---------------------------------------------------------------------------
+template<class F> void QuadVtx::ForEachView(const F& func) const
+{
+  if(fNumThreads < 2){
+    for(int view = 0; view < 3; ++view) func(view);
+    return;
+  }
+
+  tbb::task_arena arena(std::min(fNumThreads, 3u));
+  arena.execute([&]{tbb::parallel_for(0, 3, func);});
+}
+
 // ---------------------------------------------------------------------------
 void QuadVtx::produce(art::Event& evt)
 {
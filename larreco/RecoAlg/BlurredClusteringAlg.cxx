@@ -30,8 +30,10 @@
 #include "TVector2.h"
 #include "TVirtualPad.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <utility>
 
 cluster::BlurredClusteringAlg::BlurredClusteringAlg(fhicl::ParameterSet const& pset)
   : fDebug{pset.get<bool>("Debug",false)}
@@ -49,6 +51,7 @@ cluster::BlurredClusteringAlg::BlurredClusteringAlg(fhicl::ParameterSet const& p
   , fMinSeed{pset.get<double>("MinSeed")}
   , fTimeThreshold{pset.get<double>("TimeThreshold")}
   , fChargeThreshold{pset.get<double>("ChargeThreshold")}
+  , fSeparableBlur{pset.get<bool>("SeparableBlur", false)}
   , fKernelWidth{2 * fBlurWire + 1}
   , fKernelHeight{2 * fBlurTick*fMaxTickWidthBlur + 1}
   , fAllKernels{MakeKernels()}
@@ -420,11 +423,12 @@ cluster::BlurredClusteringAlg::GaussianBlur(std::vector<std::vector<double>> con
   if (fSigmaWire == 0 and fSigmaTick == 0)
     return image;
 
-  auto const [blur_wire, blur_tick, sigma_wire, sigma_tick] = FindBlurringParameters();
+  if (fSeparableBlur)
+    return SeparableGaussianBlur(image);
+
+  auto const blurParams = FindBlurringParameters();
 
   // Convolve the Gaussian
-  int width = 2 * blur_wire + 1;
-  int height = 2 * blur_tick + 1;
   int nbinsx = image.size();
   int nbinsy = image.at(0).size();
 
@@ -438,35 +442,8 @@ cluster::BlurredClusteringAlg::GaussianBlur(std::vector<std::vector<double>> con
       if (image[x][y] == 0)
         continue;
 
-      // Scale the tick blurring based on the width of the hit
-      int tick_scale = std::sqrt(cet::square(fHitMap[x][y]->RMS()) + cet::square(sigma_tick)) / (double)sigma_tick;
-      tick_scale = std::max(std::min(tick_scale, fMaxTickWidthBlur), 1);
-      auto const& correct_kernel = fAllKernels[sigma_wire][sigma_tick*tick_scale];
-
-      // Find any dead wires in the potential blurring region
-      auto const [lower_bin_dead, upper_bin_dead] = DeadWireCount(x, width);
-
-      // Note of how many dead wires we have passed whilst blurring in the wire direction
-      // If blurring below the seed hit, need to keep a note of how many dead wires to come
-      // If blurring above, need to keep a note of how many dead wires have passed
-      auto dead_wires_passed{lower_bin_dead};
-
-      // Loop over the blurring region around this hit
-      for (int blurx = -(width/2+lower_bin_dead); blurx < (width+1)/2+upper_bin_dead; ++blurx) {
-        if (x + blurx < 0) continue;
-        for (int blury = -height/2*tick_scale; blury < ((((height+1)/2)-1)*tick_scale)+1; ++blury) {
-          if (blurx < 0 and fDeadWires[x+blurx])
-            dead_wires_passed -= 1;
-
-          // Smear the charge of this hit
-          double const weight = correct_kernel[fKernelWidth * (fKernelHeight / 2 + blury) + (fKernelWidth / 2 + (blurx - dead_wires_passed))];
-          if (x + blurx >= 0 and x + blurx < nbinsx and y + blury >= 0 and y + blury < nbinsy)
-            copy[x+blurx][y+blury] += weight * image[x][y];
-
-          if (blurx > 0 and fDeadWires[x+blurx])
-            dead_wires_passed += 1;
-        }
-      } // blurring region
+      BlurHit(image, x, y, blurParams,
+              [&copy](int const blurredx, int const blurredy, double const charge) { copy[blurredx][blurredy] += charge; });
 
     }
   } // hits to blur
@@ -608,6 +585,51 @@ cluster::BlurredClusteringAlg::SaveImage(TH2F* image,
 
 // Private member functions
 
+template <typename AddCharge>
+void
+cluster::BlurredClusteringAlg::BlurHit(std::vector<std::vector<double>> const& image,
+                                       int const x,
+                                       int const y,
+                                       std::array<int, 4> const& blurParams,
+                                       AddCharge add) const
+{
+  auto const [blur_wire, blur_tick, sigma_wire, sigma_tick] = blurParams;
+
+  int width = 2 * blur_wire + 1;
+  int height = 2 * blur_tick + 1;
+  int nbinsx = image.size();
+  int nbinsy = image.at(0).size();
+
+  // Scale the tick blurring based on the width of the hit
+  int const tick_scale = TickScale(x, y, sigma_tick);
+  auto const& correct_kernel = fAllKernels[sigma_wire][sigma_tick*tick_scale];
+
+  // Find any dead wires in the potential blurring region
+  auto const [lower_bin_dead, upper_bin_dead] = DeadWireCount(x, width);
+
+  // Note of how many dead wires we have passed whilst blurring in the wire direction
+  // If blurring below the seed hit, need to keep a note of how many dead wires to come
+  // If blurring above, need to keep a note of how many dead wires have passed
+  auto dead_wires_passed{lower_bin_dead};
+
+  // Loop over the blurring region around this hit
+  for (int blurx = -(width/2+lower_bin_dead); blurx < (width+1)/2+upper_bin_dead; ++blurx) {
+    if (x + blurx < 0) continue;
+    for (int blury = -height/2*tick_scale; blury < ((((height+1)/2)-1)*tick_scale)+1; ++blury) {
+      if (blurx < 0 and fDeadWires[x+blurx])
+        dead_wires_passed -= 1;
+
+      // Smear the charge of this hit
+      double const weight = correct_kernel[fKernelWidth * (fKernelHeight / 2 + blury) + (fKernelWidth / 2 + (blurx - dead_wires_passed))];
+      if (x + blurx >= 0 and x + blurx < nbinsx and y + blury >= 0 and y + blury < nbinsy)
+        add(x + blurx, y + blury, weight * image[x][y]);
+
+      if (blurx > 0 and fDeadWires[x+blurx])
+        dead_wires_passed += 1;
+    }
+  } // blurring region
+}
+
 art::PtrVector<recob::Hit>
 cluster::BlurredClusteringAlg::ConvertBinsToRecobHits(std::vector<std::vector<double>> const& image,
                                                       std::vector<int> const& bins) const
@@ -788,3 +810,113 @@ cluster::BlurredClusteringAlg::PassesTimeCut(std::vector<double> const& times,
   }
   return false;
 }
+
+std::vector<std::vector<double>>
+cluster::BlurredClusteringAlg::SeparableGaussianBlur(std::vector<std::vector<double>> const& image) const
+{
+  auto const blurParams = FindBlurringParameters();
+  auto const [blur_wire, blur_tick, sigma_wire, sigma_tick] = blurParams;
+
+  int const width = 2 * blur_wire + 1;
+  int const nbinsx = image.size();
+  int const nbinsy = image.at(0).size();
+
+  // The 2D kernels are the product of a Gaussian in wire and one in tick.
+  // Away from dead wires the blurring can therefore be done along the ticks
+  // first, each hit using the tick kernel for its own width, and then along
+  // the wires with the same kernel for all of the hits.
+  auto const gaus = [](int const i, int const sigma) {
+    double const sig2 = 2. * sigma * sigma;
+    return static_cast<float>(1. / std::sqrt(sig2 * M_PI) * std::exp(-i * i / sig2));
+  };
+
+  std::vector<float> wireKernel(width);
+  for (int i = -blur_wire; i <= blur_wire; ++i)
+    wireKernel[i + blur_wire] = gaus(i, sigma_wire);
+
+  std::vector<std::vector<float>> tickKernels(std::max(fMaxTickWidthBlur, 1) + 1);
+  for (unsigned int tick_scale = 1; tick_scale < tickKernels.size(); ++tick_scale) {
+    int const halfHeight = blur_tick * tick_scale;
+    tickKernels[tick_scale].resize(2 * halfHeight + 1);
+    for (int j = -halfHeight; j <= halfHeight; ++j)
+      tickKernels[tick_scale][j + halfHeight] = gaus(j, sigma_tick * tick_scale);
+  }
+
+  // Flat images with the ticks of each wire contiguous
+  std::vector<float> tickBlurred(static_cast<size_t>(nbinsx) * nbinsy, 0.f);
+  std::vector<float> blurred(tickBlurred.size(), 0.f);
+
+  // Range of ticks filled on each wire by the first pass
+  std::vector<int> firstTick(nbinsx, nbinsy), lastTick(nbinsx, 0);
+
+  // Hits with dead wires in their blurring region are smeared with the 2D kernels, as in GaussianBlur
+  std::vector<std::pair<int, int>> deadRegionHits;
+
+  // Blur along the ticks
+  for (int x = 0; x < nbinsx; ++x) {
+    float* const wireTicks = tickBlurred.data() + static_cast<size_t>(x) * nbinsy;
+
+    for (int y = 0; y < nbinsy; ++y) {
+
+      if (image[x][y] == 0)
+        continue;
+
+      if (auto const [lower_bin_dead, upper_bin_dead] = DeadWireCount(x, width); lower_bin_dead or upper_bin_dead) {
+        deadRegionHits.emplace_back(x, y);
+        continue;
+      }
+
+      int const tick_scale = TickScale(x, y, sigma_tick);
+      int const halfHeight = blur_tick * tick_scale;
+      int const first = std::max(y - halfHeight, 0);
+      int const last = std::min(y + halfHeight + 1, nbinsy);
+
+      float const charge = image[x][y];
+      float const* const kernel = tickKernels[tick_scale].data() + (first - (y - halfHeight));
+      float* const ticks = wireTicks + first;
+      for (int tick = 0; tick < last - first; ++tick)
+        ticks[tick] += charge * kernel[tick];
+
+      firstTick[x] = std::min(firstTick[x], first);
+      lastTick[x] = std::max(lastTick[x], last);
+    }
+  }
+
+  // Blur along the wires
+  for (int x = 0; x < nbinsx; ++x) {
+    if (firstTick[x] >= lastTick[x])
+      continue;
+
+    int const first = firstTick[x];
+    int const numTicks = lastTick[x] - first;
+    float const* const wireTicks = tickBlurred.data() + static_cast<size_t>(x) * nbinsy + first;
+
+    for (int blurx = std::max(-blur_wire, -x); blurx <= std::min(blur_wire, nbinsx - 1 - x); ++blurx) {
+      float const weight = wireKernel[blurx + blur_wire];
+      float* const ticks = blurred.data() + static_cast<size_t>(x + blurx) * nbinsy + first;
+      for (int tick = 0; tick < numTicks; ++tick)
+        ticks[tick] += weight * wireTicks[tick];
+    }
+  }
+
+  for (auto const& [x, y] : deadRegionHits)
+    BlurHit(image, x, y, blurParams,
+            [&blurred, nbinsy](int const blurredx, int const blurredy, double const charge) {
+              blurred[static_cast<size_t>(blurredx) * nbinsy + blurredy] += charge;
+            });
+
+  std::vector<std::vector<double>> copy(nbinsx);
+  for (int x = 0; x < nbinsx; ++x) {
+    auto const wireTicks = blurred.cbegin() + static_cast<size_t>(x) * nbinsy;
+    copy[x].assign(wireTicks, wireTicks + nbinsy);
+  }
+
+  return copy;
+}
+
+int
+cluster::BlurredClusteringAlg::TickScale(int const x, int const y, int const sigma_tick) const
+{
+  int const tick_scale = std::sqrt(cet::square(fHitMap[x][y]->RMS()) + cet::square(sigma_tick)) / (double)sigma_tick;
+  return std::max(std::min(tick_scale, fMaxTickWidthBlur), 1);
+}
@@ -102,6 +102,17 @@ private:
   /// Dynamically find the blurring radii and Gaussian sigma in each dimension
   std::array<int, 4> FindBlurringParameters() const;
 
+  /// Smears the charge in bin (x, y) over the blurring region with the 2D kernels, stepping over dead wires
+  /// The smeared charge is handed to add(wire bin, tick bin, charge)
+  template <typename AddCharge>
+  void BlurHit(std::vector<std::vector<double>> const& image, int x, int y, std::array<int, 4> const& blurParams, AddCharge add) const;
+
+  /// Same as GaussianBlur, blurring along the ticks then along the wires with 1D kernels on a contiguous float image
+  std::vector<std::vector<double>> SeparableGaussianBlur(std::vector<std::vector<double>> const& image) const;
+
+  /// Returns the factor by which the tick blurring is scaled for the hit in bin (x, y), based on its width
+  int TickScale(int x, int y, int sigma_tick) const;
+
   /// Returns the hit time of a hit in a particular bin
   double GetTimeOfBin(std::vector<std::vector<double>> const& image, int bin) const;
 
@@ -131,6 +142,7 @@ private:
   double       fMinSeed;                  // minimum seed after blurring needed before clustering proceeds
   double       fTimeThreshold;            // time threshold for clustering
   double       fChargeThreshold;          // charge threshold for clustering
+  bool         fSeparableBlur;            // blur with 1D kernels on a float image (same result within float precision)
 
   // Blurring stuff
   int fKernelWidth, fKernelHeight;
@@ -18,10 +18,15 @@
 #include <cmath> // std::sqrt(), std::abs()
 #include <iostream>
 #include <iomanip>
-#include <sstream>
 #include <array>
 #include <utility> // std::pair<>, std::make_pair()
-#include <algorithm> // std::sort(), std::copy()
+#include <algorithm> // std::sort(), std::copy(), std::min()
+#include <iterator> // std::make_move_iterator()
+#include <numeric> // std::iota()
+
+// TBB
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
 
 // framework libraries
 #include "messagefacility/MessageLogger/MessageLogger.h"
@@ -32,25 +37,37 @@
 #include "larevt/CalibrationDBI/Interface/ChannelStatusService.h"
 #include "larevt/CalibrationDBI/Interface/ChannelStatusProvider.h"
 
-// ROOT Includes
-#include "TGraph.h"
-#include "TF1.h"
+
+namespace {
+
+  // sum of the first nGaus Gaussians (amplitude, mean, sigma) at x
+  double EvalGaussians
+    (std::vector<double> const& params, unsigned short nGaus, double x)
+  {
+    double sum = 0.;
+    for(unsigned short ii = 0; ii < nGaus; ++ii) {
+      const unsigned short index = 3 * ii;
+      const double arg = (x - params[index + 1]) / params[index + 2];
+      sum += params[index] * std::exp(-0.5 * arg * arg);
+    }
+    return sum;
+  } // EvalGaussians()
+
+} // local namespace
 
 
 namespace hit {
 
   constexpr unsigned int CCHitFinderAlg::MaxGaussians; // definition
+  constexpr unsigned short CCHitFinderAlg::MaxTicks; // definition
 
 //------------------------------------------------------------------------------
   CCHitFinderAlg::CCHitFinderAlg(fhicl::ParameterSet const& pset):
-    FitCache(new
-      GausFitCache // run-time, on demand TFormula cache
-    //  CompiledGausFitCache<MaxGaussians> // precompiled Gaussian set
-    //  CompiledTruncatedGausFitCache<MaxGaussians, 4> // precompiled truncated Gaussian set
-    //  CompiledTruncatedGausFitCache<MaxGaussians, 5> // precompiled truncated Gaussian set
-      ("GausFitCache_CCHitFinderAlg")
-      )
+    fTicks(MaxTicks),
+    fSignl(MaxTicks)
   {
+    // define the ticks array used for fitting
+    std::iota(fTicks.begin(), fTicks.end(), 0.F);
     this->reconfigure(pset);
   }
 
@@ -59,6 +76,8 @@ namespace hit {
     if(pset.has_key("MinSigInd")) throw art::Exception(art::errors::Configuration)
       << "CCHitFinderAlg: Using no-longer-valid fcl input: MinSigInd, MinSigCol, etc";
 
+    fWorkers.clear();
+
     fMinPeak            = pset.get<std::vector<float>>("MinPeak");
     fMinRMS             = pset.get<std::vector<float>>("MinRMS");
     fMaxBumps           = pset.get<unsigned short>("MaxBumps");
@@ -67,6 +86,7 @@ namespace hit {
     fChiNorms           = pset.get<std::vector< float > >("ChiNorms");
     fUseFastFit         = pset.get<bool>("UseFastFit", false);
     fUseChannelFilter   = pset.get<bool>("UseChannelFilter", true);
+    fNumThreads         = pset.get<unsigned int>("NumThreads", 1);
     fStudyHits          = pset.get<bool>("StudyHits", false);
     // The following variables are only used in StudyHits mode
     fUWireRange         = pset.get< std::vector< short >>("UWireRange");
@@ -108,6 +128,12 @@ namespace hit {
       }
     } // fStudyHits
 
+    // each worker is a copy of this algorithm with its own fit workspaces
+    if(fNumThreads > 1) {
+      std::vector<CCHitFinderAlg> workers(fNumThreads, *this);
+      fWorkers = std::move(workers);
+    }
+
   }
 
 //------------------------------------------------------------------------------
@@ -123,153 +149,213 @@ namespace hit {
 
     allhits.clear();
 
-    unsigned short maxticks = 1000;
-    float *ticks = new float[maxticks];
-    // define the ticks array used for fitting
-    for(unsigned short ii = 0; ii < maxticks; ++ii) {
-      ticks[ii] = ii;
-    }
-    float *signl = new float[maxticks];
-    float adcsum = 0;
-    // initialize the vectors for the hit study
-    if(fStudyHits) StudyHits(0);
-    bool first;
-
 //    prt = false;
     lariov::ChannelStatusProvider const& channelStatus
       = art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
 
+    // the hit study accumulates over the wires in order, so it runs serially
+    if(!fWorkers.empty() && !fStudyHits) {
+      RunConcurrently(Wires, channelStatus);
+      return;
+    }
+
+    // initialize the vectors for the hit study
+    if(fStudyHits) StudyHits(0);
+
     for(size_t wireIter = 0; wireIter < Wires.size(); wireIter++){
+      if(!FindWireHits(Wires[wireIter], channelStatus)) return;
+    } // wireIter
+
+    // print out
+    if(fStudyHits) StudyHits(4);
+
+  } //RunCCHitFinder
+
+
+//------------------------------------------------------------------------------
+  void CCHitFinderAlg::RunConcurrently(std::vector<recob::Wire> const& Wires,
+    lariov::ChannelStatusProvider const& channelStatus)
+  {
+    const size_t numGroups = std::min(fWorkers.size(), Wires.size());
+    if(numGroups == 0) return;
+
+    // the wires are dealt out in turn to the workers
+    auto findGroup = [&](const size_t group) {
+      CCHitFinderAlg& worker = fWorkers[group];
+      worker.allhits.clear();
+      worker.fHitsPerWire.clear();
+      worker.FinalFitStats.Reset(MaxGaussians);
+      worker.TriedFitStats.Reset(MaxGaussians);
+      for(size_t wireIter = group; wireIter < Wires.size(); wireIter += numGroups) {
+        const size_t nHitsBefore = worker.allhits.size();
+        // stop where the serial loop would stop
+        if(!worker.FindWireHits(Wires[wireIter], channelStatus)) break;
+        worker.fHitsPerWire.push_back(worker.allhits.size() - nHitsBefore);
+      }
+    };
+    tbb::task_arena arena(numGroups);
+    arena.execute([&]{ tbb::parallel_for(size_t(0), numGroups, findGroup); });
+
+    // collect the hits in the order of the wires, up to the first wire that
+    // a worker did not complete
+    size_t nHits = 0;
+    for(size_t group = 0; group < numGroups; ++group) {
+      nHits += fWorkers[group].allhits.size();
+      FinalFitStats.Add(fWorkers[group].FinalFitStats);
+      TriedFitStats.Add(fWorkers[group].TriedFitStats);
+    }
+    allhits.reserve(nHits);
+    std::vector<size_t> nextHit(numGroups, 0);
+    for(size_t wireIter = 0; wireIter < Wires.size(); ++wireIter) {
+      const size_t group = wireIter % numGroups;
+      CCHitFinderAlg& worker = fWorkers[group];
+      const size_t iWire = wireIter / numGroups;
+      if(iWire >= worker.fHitsPerWire.size()) break;
+      auto firstHit = worker.allhits.begin() + nextHit[group];
+      auto lastHit = firstHit + worker.fHitsPerWire[iWire];
+      allhits.insert(allhits.end(),
+        std::make_move_iterator(firstHit), std::make_move_iterator(lastHit));
+      nextHit[group] += worker.fHitsPerWire[iWire];
+    } // wireIter
+    for(auto& worker: fWorkers) worker.allhits.clear();
+
+  } // RunConcurrently
+
 
-      recob::Wire const& theWire = Wires[wireIter];
-      theChannel = theWire.Channel();
-      // ignore bad channels
-      if(channelStatus.IsBad(theChannel)) continue;
+//------------------------------------------------------------------------------
+  bool CCHitFinderAlg::FindWireHits(recob::Wire const& theWire,
+    lariov::ChannelStatusProvider const& channelStatus)
+  {
+    float adcsum = 0;
+    bool first;
+
+    theChannel = theWire.Channel();
+    // ignore bad channels
+    if(channelStatus.IsBad(theChannel)) return true;
 /*
-      geo::SigType_t SigType = geom->SignalType(theChannel);
-      minSig = 0.;
-      minRMS = 0.;
-      if(SigType == geo::kInduction){
-        minSig = fMinSigInd;
-        minRMS = fMinRMSInd;
-      }//<-- End if Induction Plane
-      else if(SigType == geo::kCollection){
-        minSig = fMinSigCol;
-        minRMS  = fMinRMSCol;
-      }//<-- End if Collection Plane
+    geo::SigType_t SigType = geom->SignalType(theChannel);
+    minSig = 0.;
+    minRMS = 0.;
+    if(SigType == geo::kInduction){
+      minSig = fMinSigInd;
+      minRMS = fMinRMSInd;
+    }//<-- End if Induction Plane
+    else if(SigType == geo::kCollection){
+      minSig = fMinSigCol;
+      minRMS  = fMinRMSCol;
+    }//<-- End if Collection Plane
 */
 
-      std::vector<geo::WireID> wids = geom->ChannelToWire(theChannel);
-      thePlane = wids[0].Plane;
-      if(thePlane > fMinPeak.size() - 1) {
-        mf::LogError("CCHF")<<"MinPeak vector too small for plane "<<thePlane;
-        return;
-      }
-      theWireNum = wids[0].Wire;
-      HitChannelInfo_t WireInfo(&theWire, wids[0], *geom);
+    std::vector<geo::WireID> wids = geom->ChannelToWire(theChannel);
+    thePlane = wids[0].Plane;
+    if(thePlane > fMinPeak.size() - 1) {
+      mf::LogError("CCHF")<<"MinPeak vector too small for plane "<<thePlane;
+      return false;
+    }
+    theWireNum = wids[0].Wire;
+    HitChannelInfo_t WireInfo(&theWire, wids[0], *geom);
 
-      // minimum number of time samples
-      unsigned short minSamples = 2 * fMinRMS[thePlane];
+    // minimum number of time samples
+    unsigned short minSamples = 2 * fMinRMS[thePlane];
 
-      // factor used to normalize the chi/dof fits for each plane
-      chinorm = fChiNorms[thePlane];
+    // factor used to normalize the chi/dof fits for each plane
+    chinorm = fChiNorms[thePlane];
 
-      // edit this line to debug hit fitting on a particular plane/wire
+    // edit this line to debug hit fitting on a particular plane/wire
 //      prt = (thePlane == 1 && theWireNum == 839);
-      std::vector<float> signal(theWire.Signal());
-
-      unsigned short nabove = 0;
-      unsigned short tstart = 0;
-      unsigned short maxtime = signal.size() - 2;
-      // find the min time when the signal is below threshold
-      unsigned short mintime = 3;
-      for(unsigned short time = 3; time < maxtime; ++time) {
-        if(signal[time] < fMinPeak[thePlane]) {
-          mintime = time;
-          break;
-        }
+    // expand the regions of interest into the reused signal buffer
+    recob::Wire::RegionsOfInterest_t const& signalROI = theWire.SignalROI();
+    fSignal.assign(signalROI.size(), 0.F);
+    for(auto const& range: signalROI.get_ranges())
+      std::copy(range.begin(), range.end(), fSignal.begin() + range.begin_index());
+    std::vector<float> const& signal = fSignal;
+
+    unsigned short nabove = 0;
+    unsigned short tstart = 0;
+    unsigned short maxtime = signal.size() - 2;
+    // find the min time when the signal is below threshold
+    unsigned short mintime = 3;
+    for(unsigned short time = 3; time < maxtime; ++time) {
+      if(signal[time] < fMinPeak[thePlane]) {
+        mintime = time;
+        break;
       }
-      for(unsigned short time = mintime; time < maxtime; ++time) {
-        if(signal[time] > fMinPeak[thePlane]) {
-          if(nabove == 0) tstart = time;
-          ++nabove;
-        } else {
-          // check for a wide enough signal above threshold
-          if(nabove > minSamples) {
-            // skip this wire if the RAT is too long
-            if(nabove > maxticks) mf::LogError("CCHitFinder")
-              <<"Long RAT "<<nabove<<" "<<maxticks
-              <<" No signal on wire "<<theWireNum<<" after time "<<time;
-            if(nabove > maxticks) break;
-            unsigned short npt = 0;
-            // look for bumps to inform the fit
-            bumps.clear();
-            adcsum = 0;
-            for(unsigned short ii = tstart; ii < time; ++ii) {
-              signl[npt] = signal[ii];
-              adcsum += signl[npt];
-              if(signal[ii    ] > signal[ii - 1] &&
-                 signal[ii - 1] > signal[ii - 2] &&
-                 signal[ii    ] > signal[ii + 1] &&
-                 signal[ii + 1] > signal[ii + 2]) bumps.push_back(npt);
-//  if(prt) mf::LogVerbatim("CCHitFinder")<<"signl "<<ii<<" "<<signl[npt];
-              ++npt;
-            }
-            // decide if this RAT should be studied
-            if(fStudyHits) StudyHits(1, npt, ticks, signl, tstart);
-            // just make a crude hit if too many bumps
-            if(bumps.size() > fMaxBumps) {
-              MakeCrudeHit(npt, ticks, signl);
-              StoreHits(tstart, npt, WireInfo, adcsum);
-              nabove = 0;
-              continue;
+    }
+    for(unsigned short time = mintime; time < maxtime; ++time) {
+      if(signal[time] > fMinPeak[thePlane]) {
+        if(nabove == 0) tstart = time;
+        ++nabove;
+      } else {
+        // check for a wide enough signal above threshold
+        if(nabove > minSamples) {
+          // skip this wire if the RAT is too long
+          if(nabove > MaxTicks) mf::LogError("CCHitFinder")
+            <<"Long RAT "<<nabove<<" "<<MaxTicks
+            <<" No signal on wire "<<theWireNum<<" after time "<<time;
+          if(nabove > MaxTicks) break;
+          unsigned short npt = 0;
+          // look for bumps to inform the fit
+          bumps.clear();
+          adcsum = 0;
+          for(unsigned short ii = tstart; ii < time; ++ii) {
+            fSignl[npt] = signal[ii];
+            adcsum += fSignl[npt];
+            if(signal[ii    ] > signal[ii - 1] &&
+               signal[ii - 1] > signal[ii - 2] &&
+               signal[ii    ] > signal[ii + 1] &&
+               signal[ii + 1] > signal[ii + 2]) bumps.push_back(npt);
+//  if(prt) mf::LogVerbatim("CCHitFinder")<<"signl "<<ii<<" "<<fSignl[npt];
+            ++npt;
+          }
+          // decide if this RAT should be studied
+          if(fStudyHits) StudyHits(1, npt, fTicks.data(), fSignl.data(), tstart);
+          // just make a crude hit if too many bumps
+          if(bumps.size() > fMaxBumps) {
+            MakeCrudeHit(npt, fTicks.data(), fSignl.data());
+            StoreHits(tstart, npt, WireInfo, adcsum);
+            nabove = 0;
+            continue;
+          }
+          // start looking for hits with the found bumps
+          unsigned short nHitsFit = bumps.size();
+          unsigned short nfit = 0;
+          chidof = 0.;
+          dof = -1;
+          bool HitStored = false;
+          unsigned short nMaxFit = bumps.size() + fMaxXtraHits;
+          // only used in StudyHits mode
+          first = true;
+          while(nHitsFit <= nMaxFit) {
+
+            FitNG(nHitsFit, npt, fTicks.data(), fSignl.data());
+            if(fStudyHits && first && SelRAT) {
+              first = false;
+              StudyHits(2, npt, fTicks.data(), fSignl.data(), tstart);
             }
-            // start looking for hits with the found bumps
-            unsigned short nHitsFit = bumps.size();
-            unsigned short nfit = 0;
-            chidof = 0.;
-            dof = -1;
-            bool HitStored = false;
-            unsigned short nMaxFit = bumps.size() + fMaxXtraHits;
-            // only used in StudyHits mode
-            first = true;
-            while(nHitsFit <= nMaxFit) {
-
-              FitNG(nHitsFit, npt, ticks, signl);
-              if(fStudyHits && first && SelRAT) {
-                first = false;
-                StudyHits(2, npt, ticks, signl, tstart);
-              }
-              // good chisq so store it
-              if(chidof < fChiSplit) {
-                StoreHits(tstart, npt, WireInfo, adcsum);
-                HitStored = true;
-                break;
-              }
-              // the previous fit was better, so revert to it and
-              // store it
-              ++nHitsFit;
-              ++nfit;
-            } // nHitsFit < fMaxXtraHits
-            if( !HitStored && npt < maxticks) {
-              // failed all fitting. Make a crude hit
-              MakeCrudeHit(npt, ticks, signl);
+            // good chisq so store it
+            if(chidof < fChiSplit) {
               StoreHits(tstart, npt, WireInfo, adcsum);
+              HitStored = true;
+              break;
             }
-            else if (nHitsFit > 0) FinalFitStats.AddMultiGaus(nHitsFit);
-          } // nabove > minSamples
-          nabove = 0;
-        } // signal < fMinPeak
-      } // time
-    } // wireIter
-
-    // print out
-    if(fStudyHits) StudyHits(4);
-
-    delete[] ticks;
-    delete[] signl;
+            // the previous fit was better, so revert to it and
+            // store it
+            ++nHitsFit;
+            ++nfit;
+          } // nHitsFit < fMaxXtraHits
+          if( !HitStored && npt < MaxTicks) {
+            // failed all fitting. Make a crude hit
+            MakeCrudeHit(npt, fTicks.data(), fSignl.data());
+            StoreHits(tstart, npt, WireInfo, adcsum);
+          }
+          else if (nHitsFit > 0) FinalFitStats.AddMultiGaus(nHitsFit);
+        } // nabove > minSamples
+        nabove = 0;
+      } // signal < fMinPeak
+    } // time
 
-  } //RunCCHitFinder
+    return true;
+  } // FindWireHits
 
 
 /////////////////////////////////////////
@@ -334,17 +420,17 @@ namespace hit {
     if(dof < 3) return;
     if(bumps.size() == 0) return;
 
-    // load the fit into a temp vector
-    std::vector<double> partmp;
-    std::vector<double> partmperr;
+    // the fit results go to reused workspaces
+    fParTmp.clear();
+    fParTmpErr.clear();
 
     //
     // if it is possible, we try first with the quick single Gaussian fit
     //
     TriedFitStats.AddMultiGaus(nGaus);
 
-    bool bNeedROOTfit = (nGaus > 1) || !fUseFastFit;
-    if (!bNeedROOTfit) {
+    bool bNeedFullFit = (nGaus > 1) || !fUseFastFit;
+    if (!bNeedFullFit) {
       // so, we need only one puny Gaussian;
       std::array<double, 3> params, paramerrors;
 
@@ -352,40 +438,24 @@ namespace hit {
 
       if (FastGaussianFit(npt, ticks, signl, params, paramerrors, chidof)) {
         // success? copy the results in the proper structures
-        partmp.resize(3);
-        std::copy(params.begin(), params.end(), partmp.begin());
-        partmperr.resize(3);
-        std::copy(paramerrors.begin(), paramerrors.end(), partmperr.begin());
+        fParTmp.assign(params.begin(), params.end());
+        fParTmpErr.assign(paramerrors.begin(), paramerrors.end());
       }
-      else bNeedROOTfit = true; // if we fail, let's schedule ROOT to back us up
+      else bNeedFullFit = true; // if we fail, let's schedule the full fit
 
-      if (!bNeedROOTfit) FinalFitStats.AddFast();
+      if (!bNeedFullFit) FinalFitStats.AddFast();
 
-    } // if we don't need ROOT to fit
+    } // if we don't need the full fit
 
-    if (bNeedROOTfit) {
+    if (bNeedFullFit) {
       // we may land here either because the simple Gaussian fit did not work
       // (either failed, or we chose not to trust it)
-      // or because the fit is multi-Gaussian
-
-      // define the fit string to pass to TF1
-
-      std::stringstream numConv;
-      std::string eqn = "gaus";
-      if(nGaus > 1) eqn = "gaus(0)";
-      for(unsigned short ii = 3; ii < nGaus*3; ii+=3){
-        eqn.append(" + gaus(");
-        numConv.str("");
-        numConv << ii;
-        eqn.append(numConv.str());
-        eqn.append(")");
-      }
-
-      auto Gn = std::make_unique<TF1>("gn",eqn.c_str());
-      /*
-      TF1* Gn = FitCache->Get(nGaus);
-      */
-      TGraph *fitn = new TGraph(npt, ticks, signl);
+      // or because the fit is multi-Gaussian.
+      // GausLMFitter takes the baseline as last parameter: it is kept at 0
+      const unsigned short nPars = 3 * nGaus;
+      fParTmp.assign(nPars + 1, 0.);
+      parmin.assign(nPars + 1, 0.);
+      parmax.assign(nPars + 1, 0.);
   /*
     if(prt) mf::LogVerbatim("CCHitFinder")
       <<"FitNG nGaus "<<nGaus<<" nBumps "<<bumps.size();
@@ -395,12 +465,15 @@ namespace hit {
         unsigned short index = ii * 3;
         unsigned short bumptime = bumps[ii];
         double amp = signl[bumptime];
-        Gn->SetParameter(index    , amp);
-        Gn->SetParLimits(index, 0., 9999.);
-        Gn->SetParameter(index + 1, (double)bumptime);
-        Gn->SetParLimits(index + 1, 0, (double)npt);
-        Gn->SetParameter(index + 2, (double)fMinRMS[thePlane]);
-        Gn->SetParLimits(index + 2, 1., 3*(double)fMinRMS[thePlane]);
+        fParTmp[index    ] = amp;
+        parmin[index    ] = 0.;
+        parmax[index    ] = 9999.;
+        fParTmp[index + 1] = bumptime;
+        parmin[index + 1] = 0.;
+        parmax[index + 1] = npt;
+        fParTmp[index + 2] = fMinRMS[thePlane];
+        parmin[index + 2] = 1.;
+        parmax[index + 2] = 3 * (double)fMinRMS[thePlane];
   /*
     if(prt) mf::LogVerbatim("CCHitFinder")<<"Bump params "<<ii<<" "<<(short)amp
       <<" "<<(int)bumptime<<" "<<(int)fMinRMS[thePlane];
@@ -413,85 +486,93 @@ namespace hit {
         float big = fMinPeak[thePlane];
         unsigned short imbig = 0;
         for(unsigned short jj = 0; jj < npt; ++jj) {
-          float diff = signl[jj] - Gn->Eval((Double_t)jj, 0, 0, 0);
+          float diff = signl[jj] - EvalGaussians(fParTmp, ii, jj);
           if(diff > big) {
             big = diff;
             imbig = jj;
           }
         } // jj
-        if(imbig > 0) {
+        // No hidden bump above fMinPeak: the fit is given up as failed. Fits
+        // with more Gaussians fail the same way, so FindWireHits() ends up
+        // making a crude hit (no hit at all for MaxTicks samples or more).
+        // The ROOT fit used to go on instead, with this Gaussian left at the
+        // zero parameters of the newly made TF1 and without limits, and kept
+        // the result if its chisq passed fChiSplit.
+        if(imbig == 0) {
+          chidof = 9999.;
+          dof = -1;
+          return;
+        }
   /*
     if(prt) mf::LogVerbatim("CCHitFinder")<<"Found bump "<<ii<<" "<<(short)big
       <<" "<<imbig;
   */
-          // set the parameters for the bump
-          unsigned short index = ii * 3;
-          Gn->SetParameter(index    , (double)big);
-          Gn->SetParLimits(index, 0., 9999.);
-          Gn->SetParameter(index + 1, (double)imbig);
-          Gn->SetParLimits(index + 1, 0, (double)npt);
-          Gn->SetParameter(index + 2, (double)fMinRMS[thePlane]);
-          Gn->SetParLimits(index + 2, 1., 5*(double)fMinRMS[thePlane]);
-        } // imbig > 0
+        // set the parameters for the bump
+        unsigned short index = ii * 3;
+        fParTmp[index    ] = big;
+        parmin[index    ] = 0.;
+        parmax[index    ] = 9999.;
+        fParTmp[index + 1] = imbig;
+        parmin[index + 1] = 0.;
+        parmax[index + 1] = npt;
+        fParTmp[index + 2] = fMinRMS[thePlane];
+        parmin[index + 2] = 1.;
+        parmax[index + 2] = 5 * (double)fMinRMS[thePlane];
       } // ii
 
-      // W = set weights to 1, N = no drawing or storing, Q = quiet
-      // B = bounded parameters
-      fitn->Fit(&*Gn,"WNQB");
+      // unit weights and bounded parameters, as the former ROOT "WB" fit
+      fFitter.SetData(signl, npt, ticks[0], false);
+      fFitter.Fit(nGaus, fParTmp, parmin, parmax, false);
 
-      for(unsigned short ipar = 0; ipar < 3 * nGaus; ++ipar) {
-        partmp.push_back(Gn->GetParameter(ipar));
-        partmperr.push_back(Gn->GetParError(ipar));
-      }
-      chidof = Gn->GetChisquare() / ( dof * chinorm);
-
-      delete fitn;
-    //  delete Gn;
+      fParTmp.resize(nPars);
+      fParTmpErr.assign
+        (fFitter.ParErrors().begin(), fFitter.ParErrors().begin() + nPars);
+      chidof = fFitter.Chi2() / ( dof * chinorm);
 
-    } // if ROOT fit
+    } // if full fit
 
     // Sort by increasing time if necessary
     if(nGaus > 1) {
-      std::vector< std::pair<unsigned short, unsigned short> > times;
+      fTimeOrder.clear();
       // fill the sort vector
       for(unsigned short ii = 0; ii < nGaus; ++ii) {
         unsigned short index = ii * 3;
-        times.push_back(std::make_pair(partmp[index + 1],ii));
+        fTimeOrder.push_back(std::make_pair(fParTmp[index + 1],ii));
       } // ii
-      std::sort(times.begin(), times.end());
+      std::sort(fTimeOrder.begin(), fTimeOrder.end());
       // see if re-arranging is necessary
       bool sortem = false;
       for(unsigned short ii = 0; ii < nGaus; ++ii) {
-        if(times[ii].second != ii) {
+        if(fTimeOrder[ii].second != ii) {
           sortem = true;
           break;
         }
       } // ii
       if(sortem) {
-        // temp temp vectors for putting things in the right time order
-        std::vector<double> partmpt;
-        std::vector<double> partmperrt;
+        // temp vectors for putting things in the right time order
+        fParSort.clear();
+        fParSortErr.clear();
         for(unsigned short ii = 0; ii < nGaus; ++ii) {
-          unsigned short index = times[ii].second * 3;
-          partmpt.push_back(partmp[index]);
-          partmpt.push_back(partmp[index+1]);
-          partmpt.push_back(partmp[index+2]);
-          partmperrt.push_back(partmperr[index]);
-          partmperrt.push_back(partmperr[index+1]);
-          partmperrt.push_back(partmperr[index+2]);
+          unsigned short index = fTimeOrder[ii].second * 3;
+          fParSort.push_back(fParTmp[index]);
+          fParSort.push_back(fParTmp[index+1]);
+          fParSort.push_back(fParTmp[index+2]);
+          fParSortErr.push_back(fParTmpErr[index]);
+          fParSortErr.push_back(fParTmpErr[index+1]);
+          fParSortErr.push_back(fParTmpErr[index+2]);
         } // ii
-        partmp = partmpt;
-        partmperr = partmperrt;
+        fParTmp.swap(fParSort);
+        fParTmpErr.swap(fParSortErr);
       } // sortem
     } // nGaus > 1
 /*
   if(prt) {
     mf::LogVerbatim("CCHitFinder")<<"Fit "<<nGaus<<" chi "<<chidof
-      <<" npars "<<partmp.size();
+      <<" npars "<<fParTmp.size();
     mf::LogVerbatim("CCHitFinder")<<"pars    errs ";
-    for(unsigned short ii = 0; ii < partmp.size(); ++ii) {
-      mf::LogVerbatim("CCHitFinder")<<ii<<" "<<partmp[ii]<<" "
-        <<partmperr[ii];
+    for(unsigned short ii = 0; ii < fParTmp.size(); ++ii) {
+      mf::LogVerbatim("CCHitFinder")<<ii<<" "<<fParTmp[ii]<<" "
+        <<fParTmpErr[ii];
     }
   }
 */
@@ -500,18 +581,18 @@ namespace hit {
     for(unsigned short ii = 0; ii < nGaus; ++ii) {
       unsigned short index = ii * 3;
       // ensure that the fitted time is within the signal bounds
-      short fittime = partmp[index + 1];
+      short fittime = fParTmp[index + 1];
       if(fittime < 0 || fittime > npt - 1) {
         fitok = false;
         break;
       }
       // ensure that the signal peak is large enough
-      if(partmp[index] < fMinPeak[thePlane]) {
+      if(fParTmp[index] < fMinPeak[thePlane]) {
         fitok = false;
         break;
       }
       // ensure that the RMS is large enough but not too large
-      float rms = partmp[index + 2];
+      float rms = fParTmp[index + 2];
       if(rms < 0.5 * fMinRMS[thePlane] || rms > 5 * fMinRMS[thePlane]) {
         fitok = false;
         break;
@@ -520,7 +601,7 @@ namespace hit {
       for(unsigned short jj = 0; jj < nGaus; ++jj) {
         if(jj == ii) continue;
         unsigned short jndex = jj * 3;
-        float timediff = std::abs(partmp[jndex + 1] - partmp[index + 1]);
+        float timediff = std::abs(fParTmp[jndex + 1] - fParTmp[index + 1]);
         if(timediff < 2.) {
           fitok = false;
           break;
@@ -530,8 +611,8 @@ namespace hit {
     }
 
     if(fitok) {
-      par = partmp;
-      parerr = partmperr;
+      par = fParTmp;
+      parerr = fParTmpErr;
     } else {
       chidof = 9999.;
       dof = -1;
@@ -848,4 +929,11 @@ namespace hit {
   } // CCHitFinderAlg::FitStats_t::AddMultiGaus()
 
 
+  void CCHitFinderAlg::FitStats_t::Add(FitStats_t const& other) {
+    FastFits += other.FastFits;
+    for(size_t iFit = 0; iFit < other.MultiGausFits.size(); ++iFit)
+      MultiGausFits[iFit] += other.MultiGausFits[iFit];
+  } // CCHitFinderAlg::FitStats_t::Add()
+
+
 } // namespace hit
@@ -11,7 +11,7 @@
 
 // C/C++ standard libraries
 #include <vector>
-#include <memory> // std::unique_ptr<>
+#include <utility> // std::pair<>
 #include <ostream> // std::endl
 
 // framework libraries
@@ -23,7 +23,9 @@ namespace fhicl { class ParameterSet; }
 #include "larcore/Geometry/Geometry.h"
 #include "lardataobj/RecoBase/Wire.h"
 #include "lardataobj/RecoBase/Hit.h"
-#include "larreco/RecoAlg/GausFitCache.h"
+#include "larreco/RecoAlg/GausLMFitter.h"
+
+namespace lariov { class ChannelStatusProvider; }
 
 
 namespace hit {
@@ -119,10 +121,24 @@ namespace hit {
 
     bool fUseChannelFilter;
 
+    unsigned int fNumThreads; ///< wires are processed on this many threads
+    /// copies of this algorithm, each finding the hits of a share of the wires
+    std::vector<CCHitFinderAlg> fWorkers;
+    /// number of hits found on each wire processed by a worker, in order
+    std::vector<size_t> fHitsPerWire;
+
 //    bool prt;
 
     art::ServiceHandle<geo::Geometry const> geom;
 
+    /// finds the hits of one wire; false if the configuration does not cover it
+    bool FindWireHits(recob::Wire const& theWire,
+      lariov::ChannelStatusProvider const& channelStatus);
+    /// runs FindWireHits on all the wires with the workers, keeping the
+    /// order of the serial loop
+    void RunConcurrently(std::vector<recob::Wire> const& Wires,
+      lariov::ChannelStatusProvider const& channelStatus);
+
     // fit n Gaussians possibly with bounds setting (parmin, parmax)
     void FitNG(unsigned short nGaus, unsigned short npt, float *ticks,
        float *signl);
@@ -131,6 +147,17 @@ namespace hit {
     std::vector<double> parerr;
     std::vector<double> parmin;
     std::vector<double> parmax;
+    // workspaces for the fit, reused from one fit to the next
+    static constexpr unsigned short MaxTicks = 1000;
+    std::vector<float> fTicks; ///< tick of each sample of a RAT, 0 to MaxTicks
+    std::vector<float> fSignl; ///< samples of the RAT being fitted
+    std::vector<float> fSignal; ///< signal of the current wire
+    std::vector<double> fParTmp;
+    std::vector<double> fParTmpErr;
+    std::vector<double> fParSort;
+    std::vector<double> fParSortErr;
+    std::vector< std::pair<unsigned short, unsigned short> > fTimeOrder;
+    GausLMFitter fFitter; ///< multi-Gaussian fit with its own workspaces
     float chidof;
     int dof;
     std::vector<unsigned short> bumps;
@@ -175,8 +202,6 @@ namespace hit {
 
     bool fUseFastFit; ///< whether to attempt using a fast fit on single gauss.
 
-    std::unique_ptr<GausFitCache> FitCache; ///< a set of functions ready to be used
-
 
     typedef struct {
       unsigned int FastFits; ///< count of single-Gaussian fast fits
@@ -188,6 +213,8 @@ namespace hit {
 
       void AddFast() { ++FastFits; }
 
+      void Add(FitStats_t const& other);
+
     } FitStats_t;
 
     FitStats_t FinalFitStats; ///< counts of the good fits
@@ -0,0 +1,105 @@
+#include "CMCandidateIndex.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "lardata/Utilities/PxUtils.h"
+#include "larreco/RecoAlg/ClusterRecoUtil/ClusterParamsAlg.h"
+
+namespace cmtool {
+
+  CMCandidateIndex::CMCandidateIndex()
+  {
+    _wire_margin = -1;
+    _time_margin = -1;
+  }
+
+  void CMCandidateIndex::SetMargins(double wire_margin, double time_margin)
+  {
+    _wire_margin = wire_margin;
+    _time_margin = time_margin;
+  }
+
+  void CMCandidateIndex::Build(const std::vector<cluster::ClusterParamsAlg>& clusters)
+  {
+    _boxes.clear();
+    _by_time.clear();
+
+    if(!Enabled()) return;
+
+    double const inf = std::numeric_limits<double>::infinity();
+
+    _boxes.reserve(clusters.size());
+
+    for(size_t index=0; index<clusters.size(); ++index) {
+
+      auto const& hits = clusters[index].GetHitVector();
+
+      // A cluster without hits is compatible with anything
+      Box_t box { -inf, inf, -inf, inf, clusters[index].Plane() };
+
+      if(hits.size()) {
+	box.w_min = box.t_min = inf;
+	box.w_max = box.t_max = -inf;
+	for(auto const& hit : hits) {
+	  box.w_min = std::min<double>(box.w_min, hit.w);
+	  box.w_max = std::max<double>(box.w_max, hit.w);
+	  box.t_min = std::min<double>(box.t_min, hit.t);
+	  box.t_max = std::max<double>(box.t_max, hit.t);
+	}
+      }
+      _boxes.push_back(box);
+
+      _by_time[box.plane].push_back(index);
+    }
+
+    for(auto& plane_indexes : _by_time) {
+      auto& indexes = plane_indexes.second;
+      std::stable_sort(indexes.begin(), indexes.end(),
+		       [this](size_t a, size_t b) { return _boxes[a].t_min < _boxes[b].t_min; });
+    }
+  }
+
+  bool CMCandidateIndex::TimeCompatible(size_t index1, size_t index2) const
+  {
+    if(!Enabled()) return true;
+
+    auto const& box1 = _boxes[index1];
+    auto const& box2 = _boxes[index2];
+
+    return box1.t_min - _time_margin <= box2.t_max && box2.t_min - _time_margin <= box1.t_max;
+  }
+
+  bool CMCandidateIndex::Compatible(size_t index1, size_t index2) const
+  {
+    if(!Enabled()) return true;
+
+    auto const& box1 = _boxes[index1];
+    auto const& box2 = _boxes[index2];
+
+    return TimeCompatible(index1, index2)
+      && (_wire_margin < 0
+	  || (box1.w_min - _wire_margin <= box2.w_max && box2.w_min - _wire_margin <= box1.w_max));
+  }
+
+  void CMCandidateIndex::SamePlaneCandidates(size_t index, std::vector<size_t>& candidates) const
+  {
+    candidates.clear();
+
+    if(!Enabled()) return;
+
+    double const t_max = _boxes[index].t_max + _time_margin;
+
+    auto const& indexes = _by_time.at(_boxes[index].plane);
+
+    // Only the clusters starting before this one ends can overlap with it
+    auto const end = std::upper_bound(indexes.begin(), indexes.end(), t_max,
+				      [this](double t, size_t i) { return t < _boxes[i].t_min; });
+
+    for(auto iter = indexes.begin(); iter != end; ++iter) {
+      if(*iter == index) continue;
+      if(Compatible(index, *iter)) candidates.push_back(*iter);
+    }
+  }
+
+}
@@ -0,0 +1,96 @@
+/**
+ * \file CMCandidateIndex.h
+ *
+ * \ingroup CMTool
+ *
+ * \brief Class def header for a class CMCandidateIndex
+ */
+
+/** \addtogroup CMTool
+
+    @{*/
+#ifndef RECOTOOL_CMCANDIDATEINDEX_H
+#define RECOTOOL_CMCANDIDATEINDEX_H
+
+#include <map>
+#include <stddef.h>
+#include <vector>
+
+namespace cluster { class ClusterParamsAlg; }
+
+namespace cmtool {
+
+  /**
+     \class CMCandidateIndex
+     A utility class for the managers to hand to the algorithms only clusters close
+     enough to be related. It keeps the bounding box (wire and time, in cm) of the hits
+     of each cluster. Two clusters are candidates if their boxes, widened by the wire and
+     time margins, overlap. Clusters on different planes are compared in time only.
+     Clusters with no hits are candidates of any other cluster.
+     The index is disabled (every pair is a candidate) while the time margin is negative.
+  */
+  class CMCandidateIndex {
+
+  public:
+
+    /// Default constructor: the index is disabled
+    CMCandidateIndex();
+
+    /// Setter for the margins (cm) the boxes are widened by; negative time margin disables
+    void SetMargins(double wire_margin, double time_margin);
+
+    /// Whether any pair is pruned at all
+    bool Enabled() const { return _time_margin >= 0; }
+
+    /// Method to compute the boxes of the clusters
+    void Build(const std::vector<cluster::ClusterParamsAlg>& clusters);
+
+    /// Number of clusters in the last Build() (0 while disabled)
+    size_t NClusters() const { return _boxes.size(); }
+
+    /// Whether the time ranges of two clusters are within the time margin
+    bool TimeCompatible(size_t index1, size_t index2) const;
+
+    /// Whether the boxes of two clusters on the same plane are within the margins
+    bool Compatible(size_t index1, size_t index2) const;
+
+    /**
+       Method to fill candidates with the other clusters on the same plane as the given
+       one whose boxes are within the margins. The candidates are not sorted.
+    */
+    void SamePlaneCandidates(size_t index, std::vector<size_t>& candidates) const;
+
+    /**
+       Start and end of the time range of a cluster, each widened by half the time margin,
+       so that clusters are time compatible if and only if their ranges intersect. A set of
+       clusters is then pairwise time compatible if the intersection of all the ranges is
+       not empty.
+    */
+    double TimeMin(size_t index) const { return _boxes[index].t_min - 0.5 * _time_margin; }
+    double TimeMax(size_t index) const { return _boxes[index].t_max + 0.5 * _time_margin; }
+
+  private:
+
+    /// Bounding box of the hits of a cluster
+    struct Box_t {
+      double w_min, w_max, t_min, t_max;
+      int plane;
+    };
+
+    /// Box of each cluster
+    std::vector<Box_t> _boxes;
+
+    /// Cluster indexes on each plane, sorted by start time
+    std::map<int, std::vector<size_t> > _by_time;
+
+    /// Margin on the wire coordinate
+    double _wire_margin;
+
+    /// Margin on the time coordinate
+    double _time_margin;
+
+  };
+}
+
+#endif
+/** @} */ // end of doxygen group
@@ -4,6 +4,9 @@
 #include "TStopwatch.h"
 #include "TString.h"
 
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 #include <cstddef>
 #include <iostream>
 #include <set>
@@ -20,6 +23,7 @@ namespace cmtool {
     _priority_algo = nullptr;
     _min_nhits = 0;
     _merge_till_converge = false;
+    _num_threads = 1;
     Reset();
     _time_report=false;
   }
@@ -152,6 +156,12 @@ namespace cmtool {
 
   }
 
+  void CMManagerBase::ForEachConcurrently(size_t n, const std::function<void(size_t)>& func) const
+  {
+    tbb::task_arena arena(_num_threads);
+    arena.execute([&]{ tbb::parallel_for(size_t(0), n, func); });
+  }
+
   void CMManagerBase::ComputePriority(const std::vector<cluster::ClusterParamsAlg> &clusters) {
 
     TStopwatch localWatch;
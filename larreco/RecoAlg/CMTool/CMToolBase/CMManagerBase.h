@@ -14,6 +14,7 @@
 #ifndef RECOTOOL_CMMANAGERBASE_H
 #define RECOTOOL_CMMANAGERBASE_H
 
+#include <functional>
 #include <map>
 #include <stddef.h>
 #include <set>
@@ -24,6 +25,7 @@ class TFile;
 
 #include "lardata/Utilities/PxUtils.h"
 #include "larreco/RecoAlg/ClusterRecoUtil/ClusterParamsAlg.h"
+#include "CMCandidateIndex.h"
 
 namespace cmtool {
 
@@ -93,6 +95,24 @@ namespace cmtool {
     /// A setter for an analysis output file
     void SetAnaFile(TFile* fout) { _fout = fout; }
 
+    /**
+       A setter for the margins (cm) within which the bounding boxes of two clusters must be
+       for the pair to be handed to the algorithms. Pairs further apart are assumed not to be
+       related. A negative time margin (default) hands every pair to the algorithms, and a
+       negative wire margin only compares the time ranges. Clusters on different planes are
+       compared in time only, and separation algorithms still inspect every pair.
+    */
+    void SetCandidateMargins(double wire_margin, double time_margin)
+    { _candidates.SetMargins(wire_margin,time_margin); }
+
+    /**
+       A setter for the number of threads the pairs of clusters are evaluated on, in batches.
+       The algorithms must be safe to call concurrently. Their results are applied in the same
+       order as with one thread (default), but they may be called on pairs that a previous
+       result in the same batch made irrelevant.
+    */
+    void SetNumThreads(size_t n) { _num_threads = (n ? n : 1); }
+
   protected:
 
     /// Function to compute priority
@@ -113,6 +133,12 @@ namespace cmtool {
     /// FMWK function called @ end of Process()
     virtual void EventEnd(){}
 
+    /// Whether the pairs are to be evaluated concurrently (never with per-merging couts)
+    bool RunConcurrently() const { return _num_threads > 1 && _debug_mode > kPerMerging; }
+
+    /// Function to call func(i) for i in [0, n) on _num_threads threads
+    void ForEachConcurrently(size_t n, const std::function<void(size_t)>& func) const;
+
   protected:
 
     /// Timing verbosity flag
@@ -142,6 +168,15 @@ namespace cmtool {
     /// A holder for # of unique planes in the clusters, computed in ComputePriority() function
     std::set<UChar_t> _planes;
 
+    /// Bounding boxes of the clusters being processed, to select the pairs to evaluate
+    CMCandidateIndex _candidates;
+
+    /// Number of threads to evaluate pairs on
+    size_t _num_threads;
+
+    /// Number of pairs evaluated concurrently before their results are applied
+    static constexpr size_t kPairBatchSize = 1024;
+
   };
 }
 
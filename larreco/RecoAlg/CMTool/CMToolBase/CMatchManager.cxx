@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <stdlib.h>
 #include <string>
@@ -10,6 +11,7 @@
 
 #include "TStopwatch.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CFloatAlgoBase.h"
+#include "larreco/RecoAlg/CMTool/CMToolBase/CMCandidateIndex.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CMManagerBase.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CMTException.h"
 #include "larreco/RecoAlg/CMTool/CMToolBase/CMatchBookKeeper.h"
@@ -166,6 +168,57 @@ namespace cmtool {
 
   }
 
+  void AddTimeCompatibleCombinations(const std::vector<size_t>& plane_comb,
+				     const std::vector<std::vector<size_t> >& cluster_array,
+				     const CMCandidateIndex& candidates,
+				     double t_min, double t_max,
+				     std::vector<std::pair<size_t,size_t> >& comb,
+				     std::vector<std::vector<std::pair<size_t,size_t> > >& result)
+  {
+    if(comb.size() == plane_comb.size()) {
+      result.push_back(comb);
+      return;
+    }
+
+    size_t const plane = plane_comb.at(comb.size());
+    auto const& clusters = cluster_array.at(plane);
+
+    for(size_t i=0; i<clusters.size(); ++i) {
+
+      // The clusters are pairwise compatible as long as their time ranges intersect
+      double const comb_t_min = std::max(t_min, candidates.TimeMin(clusters[i]));
+      double const comb_t_max = std::min(t_max, candidates.TimeMax(clusters[i]));
+      if(comb_t_min > comb_t_max) continue;
+
+      comb.push_back(std::make_pair(plane,i));
+      AddTimeCompatibleCombinations(plane_comb, cluster_array, candidates, comb_t_min, comb_t_max, comb, result);
+      comb.pop_back();
+    }
+  }
+
+  std::vector<std::vector<std::pair<size_t,size_t> > > TimeCompatibleCombinations(const std::vector<std::vector<size_t> >& cluster_array,
+										   const CMCandidateIndex& candidates)
+  {
+    // Same combinations in the same order as PlaneClusterCombinations(), leaving out the
+    // ones with clusters not compatible in time
+    std::vector<std::vector<std::pair<size_t,size_t> > > result;
+
+    std::vector<std::pair<size_t,size_t> > comb;
+
+    double const inf = std::numeric_limits<double>::infinity();
+
+    // Loop over N-planes: start from max number of planes => down to 2 planes
+    for(size_t i=0; i<cluster_array.size(); ++i) {
+
+      if(cluster_array.size() < 2+i) break;
+
+      for(auto const& plane_comb : SimpleCombination(cluster_array.size(),cluster_array.size()-i))
+
+	AddTimeCompatibleCombinations(plane_comb, cluster_array, candidates, -inf, inf, comb, result);
+    }
+    return result;
+  }
+
   bool CMatchManager::IterationProcess()
   {
 
@@ -178,6 +231,8 @@ namespace cmtool {
 
     if(_planes.size()<2) return false;
 
+    _candidates.Build(_in_clusters);
+
     if(_planes.size() > _nplanes)
 
       throw CMTException("Found more plane IDs than specified number of planes!");
@@ -216,51 +271,82 @@ namespace cmtool {
 
       seed.push_back(clusters_per_plane.size());
 
-    auto const& combinations = PlaneClusterCombinations(seed);
+    auto const& combinations = _candidates.Enabled()
+      ? TimeCompatibleCombinations(cluster_array,_candidates)
+      : PlaneClusterCombinations(seed);
+
+    // Clusters of a combination
+    auto comb_clusters = [&](std::vector<std::pair<size_t,size_t> > const& comb,
+			     std::vector<unsigned int>& tmp_index_v,
+			     std::vector<const cluster::ClusterParamsAlg*>& ptr_v)
+      {
+	tmp_index_v.clear();
+	ptr_v.clear();
 
-    // Loop over combinations and call algorithm
-    for(auto const& comb : combinations) {
+	tmp_index_v.reserve(comb.size());
 
-      std::vector<const cluster::ClusterParamsAlg*> ptr_v;
+	ptr_v.reserve(comb.size());
 
-      std::vector<unsigned int> tmp_index_v;
+	for(auto const& plane_cluster : comb) {
 
-      tmp_index_v.reserve(comb.size());
+	  auto const& in_cluster_index = cluster_array.at(plane_cluster.first).at(plane_cluster.second);
 
-      ptr_v.reserve(comb.size());
+	  tmp_index_v.push_back(in_cluster_index);
 
-      for(auto const& plane_cluster : comb) {
+	  ptr_v.push_back(&(_in_clusters.at(in_cluster_index)));
 
-	auto const& in_cluster_index = cluster_array.at(plane_cluster.first).at(plane_cluster.second);
+	}
+      };
+
+    // Loop over combinations and call algorithm, a batch at a time
+    std::vector<float> score_v;
+    for(size_t first = 0; first < combinations.size(); first += kPairBatchSize) {
+
+      size_t const last = std::min(first + kPairBatchSize, combinations.size());
+
+      bool const concurrent = RunConcurrently();
+      if(concurrent) {
+	score_v.assign(last - first, 0);
+	ForEachConcurrently(last - first, [&](size_t i) {
+	    std::vector<const cluster::ClusterParamsAlg*> ptr_v;
+	    std::vector<unsigned int> tmp_index_v;
+	    comb_clusters(combinations[first + i], tmp_index_v, ptr_v);
+	    score_v[i] = _match_algo->Float(ptr_v);
+	  });
+      }
 
-	tmp_index_v.push_back(in_cluster_index);
+      for(size_t icomb = first; icomb < last; ++icomb) {
 
-	ptr_v.push_back(&(_in_clusters.at(in_cluster_index)));
+	std::vector<const cluster::ClusterParamsAlg*> ptr_v;
 
-      }
+	std::vector<unsigned int> tmp_index_v;
 
-      if(_debug_mode <= kPerMerging){
+	comb_clusters(combinations[icomb], tmp_index_v, ptr_v);
 
-	std::cout
-	  << "    \033[93m"
-	  << "Inspecting a pair (";
-	for(auto const& index : tmp_index_v)
-	  std::cout << index << " ";
-	std::cout<<") \033[00m" << std::flush;
+	if(_debug_mode <= kPerMerging){
 
-	localWatch.Start();
+	  std::cout
+	    << "    \033[93m"
+	    << "Inspecting a pair (";
+	  for(auto const& index : tmp_index_v)
+	    std::cout << index << " ";
+	  std::cout<<") \033[00m" << std::flush;
 
-      }
+	  localWatch.Start();
 
-      auto const& score = _match_algo->Float(ptr_v);
+	}
+
+	auto const score = concurrent ? score_v[icomb - first] : _match_algo->Float(ptr_v);
 
-      if(_debug_mode <= kPerMerging)
+	if(_debug_mode <= kPerMerging)
 
-	std::cout << " ... Time taken = " << localWatch.RealTime() << " [s]" << std::endl;
+	  std::cout << " ... Time taken = " << localWatch.RealTime() << " [s]" << std::endl;
 
-      if(score>0)
+	if(score>0)
 
-	_book_keeper.Match(tmp_index_v,score);
+	  _book_keeper.Match(tmp_index_v,score);
+
+      }
 
     }
 
@@ -2,6 +2,7 @@
 
 #include "RtypesCore.h"
 #include "TString.h"
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <set>
@@ -185,6 +186,8 @@ namespace cmtool {
 
     ComputePriority(_tmp_merged_clusters);
 
+    _candidates.Build(_tmp_merged_clusters);
+
     // Run separation algorithm
     if(_separate_algo)
 
@@ -274,37 +277,42 @@ namespace cmtool {
     // Merging
     //
 
-    // Run over clusters and execute merging algorithms
-    for(auto citer1 = _priority.rbegin();
-	citer1 != _priority.rend();
-	++citer1) {
+    // Pairs to inspect, in the order of priority
+    std::vector<std::pair<size_t,size_t> > pairs;
+    MergeCandidates(in_clusters,merge_flag,pairs);
 
-      auto citer2 = citer1;
+    // Run over pairs and execute merging algorithms, a batch at a time
+    std::vector<char> merge_v;
+    for(size_t first = 0; first < pairs.size(); first += kPairBatchSize) {
 
-      UChar_t plane1 = in_clusters.at((*citer1).second).Plane();
+      size_t const last = std::min(first + kPairBatchSize, pairs.size());
 
-      while(1) {
-	citer2++;
-	if(citer2 == _priority.rend()) break;
+      bool const concurrent = RunConcurrently();
+      if(concurrent) {
+	merge_v.assign(last - first, false);
+	ForEachConcurrently(last - first, [&](size_t i) {
+	    auto const& pair = pairs[first + i];
+	    merge_v[i] = _merge_algo->Bool(in_clusters.at(pair.first),in_clusters.at(pair.second));
+	  });
+      }
 
-	// Skip if not on the same plane
-	UChar_t plane2 = in_clusters.at((*citer2).second).Plane();
-	if(plane1 != plane2) continue;
+      for(size_t ipair = first; ipair < last; ++ipair) {
 
-	// Skip if this combination is not meant to be compared
-	if(!(merge_flag.at((*citer2).second)) && !(merge_flag.at((*citer1).second)) ) continue;
+	size_t const cindex1 = pairs[ipair].first;
+	size_t const cindex2 = pairs[ipair].second;
 
 	// Skip if this combination is not allowed to merge
-	if(!(book_keeper.MergeAllowed((*citer1).second,(*citer2).second))) continue;
+	if(!(book_keeper.MergeAllowed(cindex1,cindex2))) continue;
 
 	if(_debug_mode <= kPerMerging){
 
 	  std::cout
-	    << Form("    \033[93mInspecting a pair (%zu, %zu) for merging... \033[00m",(*citer1).second, (*citer2).second)
+	    << Form("    \033[93mInspecting a pair (%zu, %zu) for merging... \033[00m",cindex1, cindex2)
 	    << std::endl;
 	}
 
-	bool merge = _merge_algo->Bool(in_clusters.at((*citer1).second),in_clusters.at((*citer2).second));
+	bool merge = concurrent ? merge_v[ipair - first]
+	  : _merge_algo->Bool(in_clusters.at(cindex1),in_clusters.at(cindex2));
 
 	if(_debug_mode <= kPerMerging) {
 
@@ -322,11 +330,11 @@ namespace cmtool {
 
 	if(merge)
 
-	  book_keeper.Merge((*citer1).second,(*citer2).second);
+	  book_keeper.Merge(cindex1,cindex2);
 
-      } // end looping over all cluster pairs for citer1
+      } // end looping over pairs of this batch
 
-    } // end looping over clusters
+    } // end looping over batches
 
     if(_debug_mode <= kPerIteration && book_keeper.GetResult().size() != in_clusters.size()) {
 
@@ -345,6 +353,65 @@ namespace cmtool {
 
   }
 
+  void CMergeManager::MergeCandidates(const std::vector<cluster::ClusterParamsAlg> &in_clusters,
+				      const std::vector<bool> &merge_flag,
+				      std::vector<std::pair<size_t,size_t> > &pairs) const
+  {
+    pairs.clear();
+
+    // Clusters in the order of priority
+    std::vector<size_t> order;
+    order.reserve(_priority.size());
+    for(auto citer = _priority.rbegin(); citer != _priority.rend(); ++citer)
+
+      order.push_back((*citer).second);
+
+    // Position of each cluster in that order (order.size() if not there)
+    std::vector<size_t> rank(in_clusters.size(),order.size());
+    for(size_t pos = 0; pos < order.size(); ++pos)
+
+      rank.at(order[pos]) = pos;
+
+    // The candidate index describes the clusters of the current iteration
+    bool const pruned = _candidates.Enabled() && _candidates.NClusters() == in_clusters.size();
+
+    std::vector<size_t> candidates;
+    std::vector<size_t> candidate_ranks;
+
+    for(size_t pos1 = 0; pos1 < order.size(); ++pos1) {
+
+      size_t const cindex1 = order[pos1];
+
+      UChar_t plane1 = in_clusters.at(cindex1).Plane();
+
+      // Clusters to compare with, which come later in the order of priority
+      candidate_ranks.clear();
+      if(pruned) {
+	_candidates.SamePlaneCandidates(cindex1,candidates);
+	for(auto const& cindex2 : candidates)
+	  if(rank[cindex2] > pos1 && rank[cindex2] < order.size()) candidate_ranks.push_back(rank[cindex2]);
+	std::sort(candidate_ranks.begin(),candidate_ranks.end());
+      }
+      else {
+	for(size_t pos2 = pos1+1; pos2 < order.size(); ++pos2) candidate_ranks.push_back(pos2);
+      }
+
+      for(auto const& pos2 : candidate_ranks) {
+
+	size_t const cindex2 = order[pos2];
+
+	// Skip if not on the same plane
+	UChar_t plane2 = in_clusters.at(cindex2).Plane();
+	if(plane1 != plane2) continue;
+
+	// Skip if this combination is not meant to be compared
+	if(!(merge_flag.at(cindex2)) && !(merge_flag.at(cindex1)) ) continue;
+
+	pairs.emplace_back(cindex1,cindex2);
+      }
+    }
+  }
+
   void CMergeManager::RunSeparate(const std::vector<cluster::ClusterParamsAlg> &in_clusters,
 				  CMergeBookKeeper &book_keeper) const
   {
@@ -368,7 +435,9 @@ namespace cmtool {
     // Separation
     //
 
-    // Run over clusters and execute merging algorithms
+    // Every pair on the same plane is inspected: a pair is separated irrespective of
+    // the clusters it is merged with later, so it is not pruned by the candidate index
+    std::vector<std::pair<size_t,size_t> > pairs;
     for(size_t cindex1 = 0; cindex1 < in_clusters.size(); ++cindex1) {
 
       UChar_t plane1 = in_clusters.at(cindex1).Plane();
@@ -382,6 +451,30 @@ namespace cmtool {
 	// Skip if this combination is not meant to be compared
 	//if(!(separate_flag.at(cindex2))) continue;
 
+	pairs.emplace_back(cindex1,cindex2);
+      }
+    }
+
+    // Run over pairs and execute separation algorithms, a batch at a time
+    std::vector<char> separate_v;
+    for(size_t first = 0; first < pairs.size(); first += kPairBatchSize) {
+
+      size_t const last = std::min(first + kPairBatchSize, pairs.size());
+
+      bool const concurrent = RunConcurrently();
+      if(concurrent) {
+	separate_v.assign(last - first, false);
+	ForEachConcurrently(last - first, [&](size_t i) {
+	    auto const& pair = pairs[first + i];
+	    separate_v[i] = _separate_algo->Bool(in_clusters.at(pair.first),in_clusters.at(pair.second));
+	  });
+      }
+
+      for(size_t ipair = first; ipair < last; ++ipair) {
+
+	size_t const cindex1 = pairs[ipair].first;
+	size_t const cindex2 = pairs[ipair].second;
+
 	if(_debug_mode <= kPerMerging){
 
 	  std::cout
@@ -389,7 +482,8 @@ namespace cmtool {
 	    << std::endl;
 	}
 
-	bool separate = _separate_algo->Bool(in_clusters.at(cindex1),in_clusters.at(cindex2));
+	bool separate = concurrent ? separate_v[ipair - first]
+	  : _separate_algo->Bool(in_clusters.at(cindex1),in_clusters.at(cindex2));
 
 	if(_debug_mode <= kPerMerging) {
 
@@ -409,9 +503,9 @@ namespace cmtool {
 
 	  book_keeper.ProhibitMerge(cindex1,cindex2);
 
-      } // end looping over all cluster pairs for citer1
+      } // end looping over pairs of this batch
 
-    } // end looping over clusters
+    } // end looping over batches
 
   }
 
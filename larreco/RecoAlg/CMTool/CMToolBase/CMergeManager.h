@@ -18,6 +18,7 @@
 #include "CMergeBookKeeper.h"
 
 #include "larreco/RecoAlg/ClusterRecoUtil/ClusterParamsAlg.h"
+#include <utility>
 #include <vector>
 
 namespace cmtool {
@@ -87,6 +88,11 @@ namespace cmtool {
     void RunSeparate(const std::vector<cluster::ClusterParamsAlg > &in_clusters,
 		     CMergeBookKeeper &book_keeper) const;
 
+    /// Fills pairs with the pairs of clusters to inspect for merging, in the order of priority
+    void MergeCandidates(const std::vector<cluster::ClusterParamsAlg > &in_clusters,
+			 const std::vector<bool> &merge_flag,
+			 std::vector<std::pair<size_t,size_t> > &pairs) const;
+
   protected:
 
     /// Output clusters
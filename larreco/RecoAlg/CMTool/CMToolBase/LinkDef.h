@@ -17,6 +17,7 @@
 #pragma link C++ class cmtool::CMTException+;
 #pragma link C++ class cmtool::CMergeBookKeeper+;
 #pragma link C++ class cmtool::CMatchBookKeeper+;
+#pragma link C++ class cmtool::CMCandidateIndex+;
 #pragma link C++ class cmtool::CMAlgoBase+;
 #pragma link C++ class cmtool::CBoolAlgoBase+;
 #pragma link C++ class cmtool::CFloatAlgoBase+;
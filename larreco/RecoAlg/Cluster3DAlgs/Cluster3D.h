@@ -24,6 +24,7 @@
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "lardataobj/RecoBase/Hit.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/Voronoi/DCEL.h"
+#include "larreco/RecoAlg/Cluster3DAlgs/PoolAllocator.h"
 namespace recob { class Hit; }
 
 // Eigen
@@ -332,17 +333,17 @@ public:
  *  @brief export some data structure definitions
  */
 using Hit2DListPtr             = std::list<const reco::ClusterHit2D*>;
-using HitPairListPtr           = std::list<const reco::ClusterHit3D*>;
+using HitPairListPtr           = std::list<const reco::ClusterHit3D*, pool::PoolAllocator<const reco::ClusterHit3D*>>;
 using HitPairSetPtr            = std::set<const reco::ClusterHit3D*>;
 using HitPairListPtrList       = std::list<HitPairListPtr>;
 using HitPairClusterMap        = std::map<int, HitPairListPtr>;
-using HitPairList              = std::list<reco::ClusterHit3D>;
+using HitPairList              = std::list<reco::ClusterHit3D, pool::PoolAllocator<reco::ClusterHit3D>>;
 //using HitPairList              = std::list<std::unique_ptr<reco::ClusterHit3D>>;
 
 using PCAHitPairClusterMapPair = std::pair<reco::PrincipalComponents, reco::HitPairClusterMap::iterator>;
 using PlaneToClusterParamsMap  = std::map<size_t, RecobClusterParameters>;
 using EdgeTuple                = std::tuple<const reco::ClusterHit3D*,const reco::ClusterHit3D*,double>;
-using EdgeList                 = std::list<EdgeTuple>;
+using EdgeList                 = std::list<EdgeTuple, pool::PoolAllocator<EdgeTuple>>;
 using Hit3DToEdgePair          = std::pair<const reco::ClusterHit3D*, reco::EdgeList>;
 using Hit3DToEdgeMap           = std::unordered_map<const reco::ClusterHit3D*, reco::EdgeList>;
 using Hit2DToHit3DListMap      = std::unordered_map<const reco::ClusterHit2D*, reco::HitPairListPtr>;
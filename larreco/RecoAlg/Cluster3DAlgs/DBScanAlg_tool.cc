@@ -20,7 +20,14 @@
 #include "larreco/RecoAlg/Cluster3DAlgs/IClusterParamsBuilder.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
 
+// TBB includes
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 // std includes
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <memory>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -81,11 +88,28 @@ private:
                        reco::ClusterParameters&,
                        size_t) const;
 
+    /**
+     *  @brief DBScan driven by the neighbor table of the flat kd tree
+     */
+    void clusterWithNeighborTable(const kdTree::Hit3DVec&, reco::ClusterParametersList&) const;
+
+    /**
+     *  @brief DBScan on the neighbor table, one hit at a time
+     */
+    void runDBScan(const kdTree::Hit3DVec&, const kdTree::NeighborTable&, reco::ClusterParametersList&) const;
+
+    /**
+     *  @brief Same clusters as runDBScan() found with a concurrent union-find over the core hits
+     */
+    void runParallelDBScan(const kdTree::Hit3DVec&, const kdTree::NeighborTable&, reco::ClusterParametersList&) const;
+
     /**
      *  @brief Data members to follow
      */
     bool                                                      m_enableMonitoring;      ///<
     size_t                                                    m_minPairPts;
+    bool                                                      m_useNeighborTable;      ///< Find all neighborhoods up front with the flat kd tree
+    unsigned int                                              m_numThreads;            ///< Number of threads for the neighbor table and clustering
     mutable std::vector<float>                                m_timeVector;            ///<
 
     std::unique_ptr<lar_cluster3d::IClusterParametersBuilder> m_clusterBuilder;        ///<  Common cluster builder tool
@@ -109,6 +133,8 @@ void DBScanAlg::configure(fhicl::ParameterSet const &pset)
 {
     m_enableMonitoring  = pset.get<bool>  ("EnableMonitoring",  true  );
     m_minPairPts        = pset.get<size_t>("MinPairPts",        2     );
+    m_useNeighborTable  = pset.get<bool>  ("UseNeighborTable",  false );
+    m_numThreads        = pset.get<unsigned int>("NumThreads",  1     );
 
     m_clusterBuilder    = art::make_tool<lar_cluster3d::IClusterParametersBuilder>(pset.get<fhicl::ParameterSet>("ClusterParamsBuilder"));
 
@@ -143,6 +169,19 @@ void DBScanAlg::Cluster3DHits(reco::HitPairList&           hitPairList,
 
     m_timeVector.resize(NUMTIMEVALUES, 0.);
 
+    if (m_useNeighborTable)
+    {
+        kdTree::Hit3DVec hit3DVec;
+
+        hit3DVec.reserve(hitPairList.size());
+
+        for(const auto& hit : hitPairList) hit3DVec.emplace_back(&hit);
+
+        clusterWithNeighborTable(hit3DVec, clusterParametersList);
+
+        return;
+    }
+
     // DBScan is driven of its "epsilon neighborhood". Computing adjacency within DBScan can be time
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // We'll employ a kdTree to implement this scheme
@@ -226,6 +265,26 @@ void DBScanAlg::Cluster3DHits(reco::HitPairListPtr&        hitPairList,
 
     m_timeVector.resize(NUMTIMEVALUES, 0.);
 
+    if (m_useNeighborTable)
+    {
+        kdTree::Hit3DVec hit3DVec;
+
+        hit3DVec.reserve(hitPairList.size());
+
+        for(const auto& hit3D : hitPairList)
+        {
+            // Make sure all the bits used by the clustering stage have been cleared (as BuildKdTree does)
+            hit3D->clearStatusBits(~(reco::ClusterHit3D::HITINVIEW0 | reco::ClusterHit3D::HITINVIEW1 | reco::ClusterHit3D::HITINVIEW2));
+            for(const auto& hit2D : hit3D->getHits())
+                if (hit2D) hit2D->clearStatusBits(0xFFFFFFFF);
+            hit3DVec.emplace_back(hit3D);
+        }
+
+        clusterWithNeighborTable(hit3DVec, clusterParametersList);
+
+        return;
+    }
+
     // DBScan is driven of its "epsilon neighborhood". Computing adjacency within DBScan can be time
     // consuming so the idea is the prebuild the adjaceny map and then run DBScan.
     // We'll employ a kdTree to implement this scheme
@@ -345,5 +404,302 @@ void DBScanAlg::expandCluster(const kdTree::KdTreeNode& topNode,
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+void DBScanAlg::clusterWithNeighborTable(const kdTree::Hit3DVec&      hit3DVec,
+                                         reco::ClusterParametersList& clusterParametersList) const
+{
+    // Here all of the epsilon neighborhoods are found at once, possibly over several threads,
+    // and DBScan then only has to look them up
+    cet::cpu_timer theClockBuildNeighborhood;
+    cet::cpu_timer theClockDBScan;
+
+    if (m_enableMonitoring) theClockBuildNeighborhood.start();
+
+    kdTree::FlatKdTree    flatKdTree;
+    kdTree::NeighborTable neighborTable;
+
+    m_kdTree.BuildFlatKdTree(hit3DVec, flatKdTree);
+    m_kdTree.FindAllNeighbors(flatKdTree, neighborTable, m_numThreads);
+
+    if (m_enableMonitoring)
+    {
+        theClockBuildNeighborhood.stop();
+
+        m_timeVector[BUILDHITTOHITMAP] = theClockBuildNeighborhood.accumulated_real_time();
+
+        theClockDBScan.start();
+    }
+
+    if (m_numThreads > 1) runParallelDBScan(hit3DVec, neighborTable, clusterParametersList);
+    else                  runDBScan(hit3DVec, neighborTable, clusterParametersList);
+
+    if (m_enableMonitoring)
+    {
+        theClockDBScan.stop();
+
+        m_timeVector[RUNDBSCAN] = theClockDBScan.accumulated_real_time();
+    }
+
+    // Initial clustering is done, now trim the list and get output parameters
+    cet::cpu_timer theClockBuildClusters;
+
+    // Start clocks if requested
+    if (m_enableMonitoring) theClockBuildClusters.start();
+
+    m_clusterBuilder->BuildClusterInfo(clusterParametersList);
+
+    if (m_enableMonitoring)
+    {
+        theClockBuildClusters.stop();
+
+        m_timeVector[BUILDCLUSTERINFO] = theClockBuildClusters.accumulated_real_time();
+    }
+
+    mf::LogDebug("Cluster3D") << ">>>>> DBScan (neighbor table) done, found " << clusterParametersList.size() << " clusters" << std::endl;
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void DBScanAlg::runDBScan(const kdTree::Hit3DVec&      hit3DVec,
+                          const kdTree::NeighborTable& neighborTable,
+                          reco::ClusterParametersList& clusterParametersList) const
+{
+    std::vector<unsigned> candidateVec;
+
+    for(size_t hitIdx = 0; hitIdx < hit3DVec.size(); hitIdx++)
+    {
+        const reco::ClusterHit3D* hit = hit3DVec[hitIdx];
+
+        // Check if the hit has already been visited
+        if (hit->getStatusBits() & reco::ClusterHit3D::CLUSTERVISITED) continue;
+
+        // Mark as visited
+        hit->setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
+
+        if (neighborTable.numNeighbors(hitIdx) < m_minPairPts)
+        {
+            hit->setStatusBit(reco::ClusterHit3D::CLUSTERNOISE);
+            continue;
+        }
+
+        // "Create" a new cluster and get a reference to it
+        clusterParametersList.push_back(reco::ClusterParameters());
+
+        reco::ClusterParameters& curCluster = clusterParametersList.back();
+
+        hit->setStatusBit(reco::ClusterHit3D::CLUSTERATTACHED);
+        curCluster.addHit3D(hit);
+
+        // expand the cluster, as expandCluster() does but with the neighborhoods from the table
+        candidateVec.assign(neighborTable.m_neighbors.begin() + neighborTable.m_first[hitIdx],
+                            neighborTable.m_neighbors.begin() + neighborTable.m_first[hitIdx + 1]);
+
+        for(size_t candIdx = 0; candIdx < candidateVec.size(); candIdx++)
+        {
+            unsigned                  neighborIdx = candidateVec[candIdx];
+            const reco::ClusterHit3D* neighborHit = hit3DVec[neighborIdx];
+
+            // Process if we've not been here before
+            if (!(neighborHit->getStatusBits() & reco::ClusterHit3D::CLUSTERVISITED))
+            {
+                // set as visited
+                neighborHit->setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
+
+                // If the epsilon neighborhood of this point is large enough then add its points to our list
+                if (neighborTable.numNeighbors(neighborIdx) >= m_minPairPts)
+                    candidateVec.insert(candidateVec.end(),
+                                        neighborTable.m_neighbors.begin() + neighborTable.m_first[neighborIdx],
+                                        neighborTable.m_neighbors.begin() + neighborTable.m_first[neighborIdx + 1]);
+            }
+
+            // If the point is not yet in a cluster then we now add
+            if (!(neighborHit->getStatusBits() & reco::ClusterHit3D::CLUSTERATTACHED))
+            {
+                neighborHit->setStatusBit(reco::ClusterHit3D::CLUSTERATTACHED);
+                curCluster.addHit3D(neighborHit);
+            }
+        }
+    }
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void DBScanAlg::runParallelDBScan(const kdTree::Hit3DVec&      hit3DVec,
+                                  const kdTree::NeighborTable& neighborTable,
+                                  reco::ClusterParametersList& clusterParametersList) const
+{
+    // DBScan clusters are the connected components of the "core" hits (those with at least
+    // m_minPairPts neighbors) plus the border hits next to them. The components are found with
+    // a concurrent union-find, always linking to the lower index so the root of a component is
+    // its first core hit: exactly the hit the serial loop starts that cluster from. The serial
+    // loop also gives a border hit to the earliest started of the clusters next to it, and fills
+    // each cluster in breadth first order; both are reproduced below, so the clusters, their
+    // order and the order of their hits are those of runDBScan().
+    size_t numHits = hit3DVec.size();
+
+    std::vector<char>                  isCore(numHits, 0);
+    std::vector<std::atomic<unsigned>> parent(numHits);
+
+    tbb::task_arena arena(m_numThreads);
+
+    auto findRoot = [&parent](unsigned hitIdx)
+    {
+        unsigned root = parent[hitIdx].load();
+
+        while(root != hitIdx)
+        {
+            hitIdx = root;
+            root   = parent[hitIdx].load();
+        }
+
+        return root;
+    };
+
+    arena.execute([&]
+    {
+        tbb::parallel_for(size_t(0), numHits, [&](size_t hitIdx)
+        {
+            parent[hitIdx].store(hitIdx);
+            isCore[hitIdx] = neighborTable.numNeighbors(hitIdx) >= m_minPairPts;
+        });
+
+        tbb::parallel_for(size_t(0), numHits, [&](size_t hitIdx)
+        {
+            if (!isCore[hitIdx]) return;
+
+            for(size_t entry = neighborTable.m_first[hitIdx]; entry < neighborTable.m_first[hitIdx + 1]; entry++)
+            {
+                unsigned neighborIdx = neighborTable.m_neighbors[entry];
+
+                if (!isCore[neighborIdx]) continue;
+
+                // Link the higher root below the lower one, retrying if another thread got there first
+                while(true)
+                {
+                    unsigned rootA = findRoot(hitIdx);
+                    unsigned rootB = findRoot(neighborIdx);
+
+                    if (rootA == rootB) break;
+                    if (rootA < rootB) std::swap(rootA, rootB);
+                    if (parent[rootA].compare_exchange_strong(rootA, rootB)) break;
+                }
+            }
+        });
+    });
+
+    // The clusters in the order the serial loop starts them
+    std::vector<unsigned> clusterIndex(numHits, std::numeric_limits<unsigned>::max());
+    std::vector<unsigned> clusterRoots;
+
+    for(size_t hitIdx = 0; hitIdx < numHits; hitIdx++)
+    {
+        if (isCore[hitIdx] && findRoot(hitIdx) == hitIdx)
+        {
+            clusterIndex[hitIdx] = clusterRoots.size();
+            clusterRoots.push_back(hitIdx);
+        }
+    }
+
+    // Each hit goes to the earliest cluster among its own (if core) and those of its core neighbors
+    std::vector<unsigned> owner(numHits, std::numeric_limits<unsigned>::max());
+    std::vector<char>     isNoise(numHits, 0);
+
+    arena.execute([&]
+    {
+        tbb::parallel_for(size_t(0), numHits, [&](size_t hitIdx)
+        {
+            if (isCore[hitIdx])
+            {
+                owner[hitIdx] = clusterIndex[findRoot(hitIdx)];
+                return;
+            }
+
+            unsigned firstRoot = std::numeric_limits<unsigned>::max();
+
+            for(size_t entry = neighborTable.m_first[hitIdx]; entry < neighborTable.m_first[hitIdx + 1]; entry++)
+            {
+                unsigned neighborIdx = neighborTable.m_neighbors[entry];
+
+                if (isCore[neighborIdx]) firstRoot = std::min(firstRoot, findRoot(neighborIdx));
+            }
+
+            if (firstRoot < std::numeric_limits<unsigned>::max()) owner[hitIdx] = clusterIndex[firstRoot];
+
+            // The serial loop marks as noise a border hit it meets before any of its clusters starts
+            isNoise[hitIdx] = !(firstRoot < hitIdx);
+        });
+    });
+
+    // Now walk each cluster breadth first, as expandCluster() does
+    std::vector<std::vector<unsigned>> clusterHits(clusterRoots.size());
+    std::vector<char>                  visited(numHits, 0);
+    std::vector<char>                  attached(numHits, 0);
+
+    arena.execute([&]
+    {
+        tbb::parallel_for(size_t(0), clusterRoots.size(), [&](size_t clusterIdx)
+        {
+            std::vector<unsigned>& hitVec    = clusterHits[clusterIdx];
+            unsigned               rootIdx   = clusterRoots[clusterIdx];
+            std::vector<unsigned>  candidateVec(neighborTable.m_neighbors.begin() + neighborTable.m_first[rootIdx],
+                                                neighborTable.m_neighbors.begin() + neighborTable.m_first[rootIdx + 1]);
+
+            // Only the core hits of this cluster are ever marked visited here, and only the hits
+            // this cluster owns are added, so the threads never write to the same element
+            visited[rootIdx]  = 1;
+            attached[rootIdx] = 1;
+            hitVec.push_back(rootIdx);
+
+            for(size_t candIdx = 0; candIdx < candidateVec.size(); candIdx++)
+            {
+                unsigned neighborIdx = candidateVec[candIdx];
+
+                if (isCore[neighborIdx] && !visited[neighborIdx])
+                {
+                    visited[neighborIdx] = 1;
+
+                    candidateVec.insert(candidateVec.end(),
+                                        neighborTable.m_neighbors.begin() + neighborTable.m_first[neighborIdx],
+                                        neighborTable.m_neighbors.begin() + neighborTable.m_first[neighborIdx + 1]);
+                }
+
+                if (owner[neighborIdx] == clusterIdx && !attached[neighborIdx])
+                {
+                    attached[neighborIdx] = 1;
+                    hitVec.push_back(neighborIdx);
+                }
+            }
+        });
+    });
+
+    // Output the clusters and leave the hits with the status bits the serial loop would have set
+    for(const auto& hitVec : clusterHits)
+    {
+        clusterParametersList.push_back(reco::ClusterParameters());
+
+        reco::ClusterParameters& curCluster = clusterParametersList.back();
+
+        for(const auto& hitIdx : hitVec) curCluster.addHit3D(hit3DVec[hitIdx]);
+    }
+
+    for(size_t hitIdx = 0; hitIdx < numHits; hitIdx++)
+    {
+        const reco::ClusterHit3D* hit = hit3DVec[hitIdx];
+
+        hit->setStatusBit(reco::ClusterHit3D::CLUSTERVISITED);
+
+        if (!isCore[hitIdx] && isNoise[hitIdx]) hit->setStatusBit(reco::ClusterHit3D::CLUSTERNOISE);
+
+        if (owner[hitIdx] != std::numeric_limits<unsigned>::max()) hit->setStatusBit(reco::ClusterHit3D::CLUSTERATTACHED);
+    }
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 DEFINE_ART_CLASS_TOOL(DBScanAlg)
 } // namespace lar_cluster3d
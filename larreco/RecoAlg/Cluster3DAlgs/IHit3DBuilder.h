@@ -77,6 +77,18 @@ public:
      */
     virtual float getTimeToExecute(TimeValues index) const = 0;
 
+    /**
+     *  @brief If monitoring, recover the time to build the 3D hits of one TPC (index runs
+     *         over the TPCs of each cryostat in turn). Zero if the builder does not keep it
+     */
+    virtual float getTimeToExecuteTPC(size_t) const {return 0.;}
+
+    /**
+     *  @brief Drop the 2D hits kept for the event, called once the 3D hits referring to them
+     *         are no longer in use so their node pools can be released
+     */
+    virtual void clearEvent() {}
+
 };
 
 } // namespace lar_cluster3d
@@ -0,0 +1,258 @@
+////////////////////////////////////////////////////////////////////////////
+//
+// \brief Pooled node storage for the 3D clustering containers
+//
+////////////////////////////////////////////////////////////////////////////
+
+#include "larreco/RecoAlg/Cluster3DAlgs/PoolAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace reco {
+namespace pool {
+
+namespace {
+
+// The nodes of a block start after its header, keeping the maximum alignment
+constexpr size_t alignment   = alignof(std::max_align_t);
+constexpr size_t headerBytes = (2 * sizeof(void*) + alignment - 1) / alignment * alignment;
+
+std::mutex     statisticsMutex;
+PoolStatistics statistics;
+
+void recordBlocks(long deltaBytes, size_t numBlocks, double time)
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+
+    statistics.m_bytesReserved     += deltaBytes;
+    statistics.m_peakBytesReserved  = std::max(statistics.m_peakBytesReserved, statistics.m_bytesReserved);
+    statistics.m_numBlocks         += numBlocks;
+    statistics.m_allocatorTime     += time;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Every pool of every thread, so they outlive the threads (nodes may still be in use)
+// and can be released at the end of the event. Only touched when a thread creates a
+// pool and by ReleaseUnusedPools()
+std::mutex                             poolListMutex;
+std::vector<std::unique_ptr<NodePool>> poolList;
+
+void addAtomic(std::atomic<size_t>& counter, size_t delta)
+{
+    // Only ever written by one thread, no need for a read-modify-write
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+NodePool::NodePool(size_t nodeSize) :
+    m_nodeSize(nodeSize),
+    m_blocks(nullptr),
+    m_numBlocks(0),
+    m_freeList(nullptr),
+    m_remoteFreeList(nullptr),
+    m_nextNode(nullptr),
+    m_blockEnd(nullptr),
+    m_numAllocated(0),
+    m_numFreedLocal(0),
+    m_numFreedRemote(0)
+{
+    // Every node must be able to hold the free list link and keep the next node aligned
+    m_nodeSize = std::max(m_nodeSize, sizeof(FreeNode));
+    m_nodeSize = (m_nodeSize + alignment - 1) / alignment * alignment;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+NodePool::~NodePool()
+{
+    while(m_blocks)
+    {
+        BlockHeader* next = m_blocks->m_next;
+
+        ::operator delete(m_blocks, std::align_val_t(PoolBlockBytes));
+
+        m_blocks = next;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void* NodePool::allocate()
+{
+    void* node(nullptr);
+
+    // Pick up the nodes other threads gave back only once our own are used up
+    if (!m_freeList) m_freeList = m_remoteFreeList.exchange(nullptr, std::memory_order_acquire);
+
+    if (m_freeList)
+    {
+        node       = m_freeList;
+        m_freeList = m_freeList->m_next;
+    }
+    else
+    {
+        if (m_nextNode == m_blockEnd) addBlock();
+
+        node        = m_nextNode;
+        m_nextNode += m_nodeSize;
+    }
+
+    addAtomic(m_numAllocated, 1);
+
+    return node;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void NodePool::deallocate(void* node)
+{
+    // The block, and so the pool, of a node is found from its address
+    const uintptr_t blockAddress = reinterpret_cast<uintptr_t>(node) & ~uintptr_t(PoolBlockBytes - 1);
+    NodePool*       owner        = reinterpret_cast<BlockHeader*>(blockAddress)->m_owner;
+    FreeNode*       freeNode     = static_cast<FreeNode*>(node);
+
+    if (owner == this)
+    {
+        freeNode->m_next = m_freeList;
+        m_freeList       = freeNode;
+
+        addAtomic(m_numFreedLocal, 1);
+    }
+    else
+    {
+        freeNode->m_next = owner->m_remoteFreeList.load(std::memory_order_relaxed);
+
+        while(!owner->m_remoteFreeList.compare_exchange_weak(freeNode->m_next, freeNode, std::memory_order_release, std::memory_order_relaxed));
+
+        owner->m_numFreedRemote.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool NodePool::release()
+{
+    if (getNumInUse() > 0 || !m_blocks) return false;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    long releasedBytes = static_cast<long>(getBytesReserved());
+
+    while(m_blocks)
+    {
+        BlockHeader* next = m_blocks->m_next;
+
+        ::operator delete(m_blocks, std::align_val_t(PoolBlockBytes));
+
+        m_blocks = next;
+    }
+
+    m_numBlocks.store(0, std::memory_order_relaxed);
+
+    m_freeList = nullptr;
+    m_remoteFreeList.store(nullptr, std::memory_order_relaxed);
+    m_nextNode = nullptr;
+    m_blockEnd = nullptr;
+
+    recordBlocks(-releasedBytes, 0, secondsSince(start));
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+size_t NodePool::getNumInUse() const
+{
+    return m_numAllocated.load(std::memory_order_relaxed)
+         - m_numFreedLocal.load(std::memory_order_relaxed)
+         - m_numFreedRemote.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void NodePool::addBlock()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    BlockHeader* block = static_cast<BlockHeader*>(::operator new(PoolBlockBytes, std::align_val_t(PoolBlockBytes)));
+
+    block->m_owner = this;
+    block->m_next  = m_blocks;
+    m_blocks       = block;
+
+    addAtomic(m_numBlocks, 1);
+
+    // Whole nodes only; the node size never exceeds MaxPoolNodeBytes, well below the block size
+    char* firstNode = reinterpret_cast<char*>(block) + headerBytes;
+
+    m_nextNode = firstNode;
+    m_blockEnd = firstNode + (PoolBlockBytes - headerBytes) / m_nodeSize * m_nodeSize;
+
+    recordBlocks(static_cast<long>(PoolBlockBytes), 1, secondsSince(start));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+NodePool& GetThreadNodePool(size_t nodeSize)
+{
+    // Allocators of different types with the same size share the pool
+    static thread_local std::map<size_t, NodePool*> threadPoolMap;
+
+    NodePool*& nodePool = threadPoolMap[nodeSize];
+
+    if (!nodePool)
+    {
+        std::lock_guard<std::mutex> lock(poolListMutex);
+
+        poolList.emplace_back(new NodePool(nodeSize));
+
+        nodePool = poolList.back().get();
+    }
+
+    return *nodePool;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ReleaseUnusedPools()
+{
+    std::lock_guard<std::mutex> lock(poolListMutex);
+
+    for(auto& nodePool : poolList) nodePool->release();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PoolStatistics GetPoolStatistics()
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+
+    return statistics;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ResetPoolStatistics()
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+
+    statistics.m_peakBytesReserved = statistics.m_bytesReserved;
+    statistics.m_numBlocks         = 0;
+    statistics.m_allocatorTime     = 0.;
+}
+
+} // namespace pool
+} // namespace reco
@@ -0,0 +1,173 @@
+/**
+ *
+ *  @brief Pooled node storage for the node based containers used by the 3D clustering
+ *
+ *         The 3D clustering builds (and then throws away) very large numbers of
+ *         std::list and std::set nodes each event: the 2D and 3D hits themselves,
+ *         the per wire hit sets, the kd tree nodes, the neighbour candidate lists
+ *         and the edge lists. Rather than going back to the general purpose heap for
+ *         every node, the PoolAllocator hands out nodes carved out of large blocks
+ *         owned by a NodePool and keeps returned nodes on a free list. The blocks are
+ *         given back to the system in bulk, by ReleaseUnusedPools(), once all of the
+ *         nodes of a pool are returned, typically at the end of the event.
+ *
+ *         Each thread has its own pool for each node size, so the parallel builders
+ *         never wait on each other: allocating and freeing on the owning thread take
+ *         no lock. A node may be freed by another thread (e.g. a list filled by a
+ *         worker and spliced into the event list); it then goes on a lock free list
+ *         of its owning pool, found from the block header, and the owner picks it up
+ *         when its own free list runs out.
+ *
+ */
+
+#ifndef RECO_CLUSTER3D_POOLALLOCATOR_H
+#define RECO_CLUSTER3D_POOLALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace reco {
+namespace pool {
+
+/**
+ *  @brief Statistics accumulated by the pools, used for monitoring
+ */
+struct PoolStatistics
+{
+    size_t m_bytesReserved     = 0;   ///< Bytes currently held in blocks by all pools
+    size_t m_peakBytesReserved = 0;   ///< Largest value of the above since the last reset
+    size_t m_numBlocks         = 0;   ///< Number of blocks requested from the system since the last reset
+    double m_allocatorTime     = 0.;  ///< Time spent (s) requesting and releasing blocks since the last reset
+};
+
+/**
+ *  @brief Size of the blocks the nodes are carved from; blocks are aligned to it so the
+ *         pool owning a node is found from the node address
+ */
+constexpr size_t PoolBlockBytes = 64 * 1024;
+
+/**
+ *  @brief Largest node handed out by the pools, larger objects go to the heap
+ */
+constexpr size_t MaxPoolNodeBytes = 1024;
+
+/**
+ *  @brief A free list of fixed size nodes carved out of large blocks, used by one thread
+ */
+class NodePool
+{
+public:
+    explicit NodePool(size_t nodeSize);
+    ~NodePool();
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /**
+     *  @brief Get a node; only the thread owning the pool may call this
+     */
+    void*  allocate();
+
+    /**
+     *  @brief Give back a node from any pool of the same node size; called by the thread
+     *         owning this pool, the node goes back to the pool it came from
+     */
+    void   deallocate(void* node);
+
+    /**
+     *  @brief Return all blocks to the system if none of the nodes is in use. The pool
+     *         must not be in use by its owner while this is called
+     *
+     *  @return true if the blocks were released
+     */
+    bool   release();
+
+    size_t getNodeSize()      const {return m_nodeSize;}
+    size_t getNumInUse()      const;
+    size_t getBytesReserved() const {return m_numBlocks.load(std::memory_order_relaxed) * PoolBlockBytes;}
+
+private:
+    struct FreeNode    {FreeNode* m_next;};
+    struct BlockHeader {NodePool* m_owner; BlockHeader* m_next;};
+
+    void   addBlock();
+
+    size_t                 m_nodeSize;
+    BlockHeader*           m_blocks;              ///< Singly linked list of the blocks
+    std::atomic<size_t>    m_numBlocks;
+    FreeNode*              m_freeList;            ///< Nodes freed by the owner
+    std::atomic<FreeNode*> m_remoteFreeList;      ///< Nodes freed by other threads
+    char*                  m_nextNode;            ///< Next never used node in the last block
+    char*                  m_blockEnd;            ///< End of the last block
+    std::atomic<size_t>    m_numAllocated;        ///< Written by the owner only
+    std::atomic<size_t>    m_numFreedLocal;       ///< Written by the owner only
+    std::atomic<size_t>    m_numFreedRemote;
+};
+
+/**
+ *  @brief Recover the pool of the calling thread handing out nodes of the given size
+ *         (created on first use)
+ */
+NodePool&      GetThreadNodePool(size_t nodeSize);
+
+/**
+ *  @brief Release the blocks of every pool, of every thread, which has no node in use.
+ *         To be called between events, when no container using the pools is modified
+ */
+void           ReleaseUnusedPools();
+
+PoolStatistics GetPoolStatistics();
+void           ResetPoolStatistics();
+
+/**
+ *  @brief Standard allocator drawing single objects from the NodePool of their size
+ *
+ *         Node based containers only ever ask for one object at a time, larger
+ *         requests (and over-aligned or very large types) go straight to the heap.
+ */
+template <typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        if (n == 1 && pooled) return static_cast<T*>(getPool().allocate());
+
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (n == 1 && pooled) getPool().deallocate(p);
+        else ::operator delete(p);
+    }
+
+private:
+    static constexpr bool pooled = alignof(T) <= alignof(std::max_align_t) && sizeof(T) <= MaxPoolNodeBytes;
+
+    static NodePool& getPool()
+    {
+        static thread_local NodePool& nodePool = GetThreadNodePool(sizeof(T));
+
+        return nodePool;
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {return true;}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {return false;}
+
+} // namespace pool
+} // namespace reco
+
+#endif
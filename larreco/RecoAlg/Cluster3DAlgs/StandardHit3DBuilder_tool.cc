@@ -34,6 +34,10 @@
 // Eigen
 #include <Eigen/Core>
 
+// TBB
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 // std includes
 #include <string>
 #include <iostream>
@@ -62,8 +66,8 @@ struct Hit2DSetCompare
 using HitVector                   = std::vector<const reco::ClusterHit2D*>;
 using PlaneToHitVectorMap         = std::map<geo::PlaneID, HitVector>;
 using TPCToPlaneToHitVectorMap    = std::map<geo::TPCID, PlaneToHitVectorMap>;
-using Hit2DList                   = std::list<reco::ClusterHit2D>;
-using Hit2DSet                    = std::set<const reco::ClusterHit2D*, Hit2DSetCompare>;
+using Hit2DList                   = std::list<reco::ClusterHit2D, reco::pool::PoolAllocator<reco::ClusterHit2D>>;
+using Hit2DSet                    = std::set<const reco::ClusterHit2D*, Hit2DSetCompare, reco::pool::PoolAllocator<const reco::ClusterHit2D*>>;
 using WireToHitSetMap             = std::map<unsigned int, Hit2DSet>;
 using PlaneToWireToHitSetMap      = std::map<geo::PlaneID, WireToHitSetMap>;
 using TPCToPlaneToWireToHitSetMap = std::map<geo::TPCID, PlaneToWireToHitSetMap>;
@@ -110,6 +114,19 @@ public:
      */
     virtual float getTimeToExecute(IHit3DBuilder::TimeValues index) const override {return m_timeVector[index];}
 
+    /**
+     *  @brief If monitoring, recover the time to build the 3D hits of a given TPC
+     */
+    virtual float getTimeToExecuteTPC(size_t tpcIndex) const override
+    {
+        return NUMTIMEVALUES + tpcIndex < m_timeVector.size() ? m_timeVector[NUMTIMEVALUES + tpcIndex] : 0.;
+    }
+
+    /**
+     *  @brief Drop the 2D hits of the event, the 3D hits point to them
+     */
+    virtual void clearEvent() override;
+
 private:
 
     /**
@@ -238,10 +255,11 @@ private:
     float                                m_wirePitchScaleFactor;  ///< Scaling factor to determine max distance allowed between candidate pairs
     float                                m_maxHit3DChiSquare;     ///< Provide ability to select hits based on "chi square"
     bool                                 m_outputHistograms;      ///< Take the time to create and fill some histograms for diagnostics
+    size_t                               m_numThreads;            ///< Number of TPCs processed concurrently
 
     bool                                 m_enableMonitoring;      ///<
     float                                m_wirePitch[3];
-    mutable std::vector<float>           m_timeVector;            ///<
+    mutable std::vector<float>           m_timeVector;            ///< NUMTIMEVALUES entries, then one per TPC
 
     float                                m_zPosOffset;
 
@@ -312,6 +330,16 @@ void StandardHit3DBuilder::configure(fhicl::ParameterSet const &pset)
     m_wirePitchScaleFactor = pset.get<float                     >("WirePitchScaleFactor", 1.9 );
     m_maxHit3DChiSquare    = pset.get<float                     >("MaxHitChiSquare",      6.0 );
     m_outputHistograms     = pset.get<bool                      >("OutputHistograms",     false );
+    m_numThreads           = pset.get<size_t                    >("NumThreads",           1 );
+
+    // The diagnostic tuple vectors are shared by all TPCs
+    if (m_outputHistograms && m_numThreads > 1)
+    {
+        mf::LogWarning("Cluster3D") << "StandardHit3DBuilder: histogramming is enabled, forcing NumThreads to 1";
+        m_numThreads = 1;
+    }
+
+    m_numThreads = std::max(m_numThreads, size_t(1));
 
     m_geometry = art::ServiceHandle<geo::Geometry const>{}.get();
     m_detector = lar::providerFrom<detinfo::DetectorPropertiesService>();
@@ -368,6 +396,16 @@ void StandardHit3DBuilder::clear()
     return;
 }
 
+void StandardHit3DBuilder::clearEvent()
+{
+    // Give the nodes back to their pools
+    m_clusterHit2DMasterList.clear();
+    m_planeToHitVectorMap.clear();
+    m_planeToWireToHitSetMap.clear();
+
+    return;
+}
+
 void StandardHit3DBuilder::BuildChannelStatusVec(PlaneToWireToHitSetMap& planeToWireToHitSetMap) const
 {
     // This is called each event, clear out the previous version and start over
@@ -440,7 +478,7 @@ void StandardHit3DBuilder::Hit3DBuilder(art::Event& evt, reco::HitPairList& hitP
     m_planeToHitVectorMap.clear();
     m_planeToWireToHitSetMap.clear();
 
-    m_timeVector.resize(NUMTIMEVALUES, 0.);
+    m_timeVector.assign(NUMTIMEVALUES + m_geometry->TotalNTPC(), 0.);
     
     // Get a hit refiner
     std::unique_ptr<std::vector<recob::Hit>> outputHitPtrVec(new std::vector<recob::Hit>);
@@ -588,10 +626,28 @@ size_t StandardHit3DBuilder::BuildHitPairMap(PlaneToHitVectorMap& planeToHitVect
     size_t nTriplets(0);
     size_t nDeadChanHits(0);
 
-    // Set up to loop over cryostats and tpcs...
+    // The TPCs are independent: each one has its own 2D hits and builds its 3D hits into
+    // its own buffer. The buffers are then spliced in TPC order, which gives the same
+    // list the sequential loop would
+    struct TPCHitBuilder
+    {
+        size_t             tpcIndex;     ///< Index over cryostats then TPCs, as in m_timeVector
+        HitVector*         hitVector[3]; ///< The 2D hits of each plane
+        reco::HitPairList  hitPairList;  ///< Output 3D hits
+        size_t             numHits;
+    };
+
+    std::vector<TPCHitBuilder> tpcBuilderVec;
+
+    // Set up to loop over cryostats and tpcs... the cryostats need not have the same
+    // number of TPCs, so the index keeps a running offset
+    size_t tpcOffset(0);
+
     for(size_t cryoIdx = 0; cryoIdx < m_geometry->Ncryostats(); cryoIdx++)
     {
-        for(size_t tpcIdx = 0; tpcIdx < m_geometry->NTPC(); tpcIdx++)
+        const size_t nTPCs = m_geometry->NTPC(cryoIdx);
+
+        for(size_t tpcIdx = 0; tpcIdx < nTPCs; tpcIdx++)
         {
             PlaneToHitVectorMap::iterator mapItr0 = planeToHitVectorMap.find(geo::PlaneID(cryoIdx,tpcIdx,0));
             PlaneToHitVectorMap::iterator mapItr1 = planeToHitVectorMap.find(geo::PlaneID(cryoIdx,tpcIdx,1));
@@ -603,21 +659,60 @@ size_t StandardHit3DBuilder::BuildHitPairMap(PlaneToHitVectorMap& planeToHitVect
 
             if (nPlanesWithHits < 2) continue;
 
-            HitVector& hitVector0 = mapItr0->second;
-            HitVector& hitVector1 = mapItr1->second;
-            HitVector& hitVector2 = mapItr2->second;
+            tpcBuilderVec.push_back({tpcOffset + tpcIdx, {&mapItr0->second, &mapItr1->second, &mapItr2->second}, {}, 0});
+        }
+
+        tpcOffset += nTPCs;
+    }
+
+    auto buildTPC = [this](TPCHitBuilder& builder)
+    {
+        cet::cpu_timer theClockTPC;
+
+        if (m_enableMonitoring) theClockTPC.start();
+
+        HitVector& hitVector0 = *builder.hitVector[0];
+        HitVector& hitVector1 = *builder.hitVector[1];
+        HitVector& hitVector2 = *builder.hitVector[2];
+
+        // We are going to resort the hits into "start time" order...
+        std::sort(hitVector0.begin(), hitVector0.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
+        std::sort(hitVector1.begin(), hitVector1.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
+        std::sort(hitVector2.begin(), hitVector2.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
+
+        PlaneHitVectorItrPairVec hitItrVec = {HitVectorItrPair(hitVector0.begin(),hitVector0.end()),
+                                              HitVectorItrPair(hitVector1.begin(),hitVector1.end()),
+                                              HitVectorItrPair(hitVector2.begin(),hitVector2.end())};
 
-            // We are going to resort the hits into "start time" order...
-            std::sort(hitVector0.begin(), hitVector0.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
-            std::sort(hitVector1.begin(), hitVector1.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
-            std::sort(hitVector2.begin(), hitVector2.end(), SetHitEarliestTimeOrder(m_numSigmaPeakTime)); //SetHitStartTimeOrder);
+        builder.numHits = BuildHitPairMapByTPC(hitItrVec, builder.hitPairList);
 
-            PlaneHitVectorItrPairVec hitItrVec = {HitVectorItrPair(hitVector0.begin(),hitVector0.end()),
-                                                  HitVectorItrPair(hitVector1.begin(),hitVector1.end()),
-                                                  HitVectorItrPair(hitVector2.begin(),hitVector2.end())};
+        if (m_enableMonitoring)
+        {
+            theClockTPC.stop();
 
-            totalNumHits += BuildHitPairMapByTPC(hitItrVec, hitPairList);
+            m_timeVector[NUMTIMEVALUES + builder.tpcIndex] = theClockTPC.accumulated_real_time();
         }
+    };
+
+    if (m_numThreads > 1 && tpcBuilderVec.size() > 1)
+    {
+        tbb::task_arena arena(m_numThreads);
+
+        arena.execute([&]{tbb::parallel_for(size_t(0), tpcBuilderVec.size(), [&](size_t idx){buildTPC(tpcBuilderVec[idx]);});});
+    }
+    else
+    {
+        for(auto& builder : tpcBuilderVec) buildTPC(builder);
+    }
+
+    for(auto& builder : tpcBuilderVec)
+    {
+        totalNumHits += builder.numHits;
+
+        hitPairList.splice(hitPairList.end(), builder.hitPairList);
+
+        if (m_enableMonitoring)
+            mf::LogDebug("Cluster3D") << "TPC index " << builder.tpcIndex << " built " << builder.numHits << " 3D hits in " << m_timeVector[NUMTIMEVALUES + builder.tpcIndex] << " s" << std::endl;
     }
 
     // Return the hit pair list but sorted by z and y positions (faster traversal in next steps)
@@ -1469,7 +1564,7 @@ void StandardHit3DBuilder::CollectArtHits(const art::Event& evt) const
     // Initialize the plane to hit vector map
     for(size_t cryoIdx = 0; cryoIdx < m_geometry->Ncryostats(); cryoIdx++)
     {
-        for(size_t tpcIdx = 0; tpcIdx < m_geometry->NTPC(); tpcIdx++)
+        for(size_t tpcIdx = 0; tpcIdx < m_geometry->NTPC(cryoIdx); tpcIdx++)
         {
             m_planeToHitVectorMap[geo::PlaneID(cryoIdx,tpcIdx,0)] = HitVector();
             m_planeToHitVectorMap[geo::PlaneID(cryoIdx,tpcIdx,1)] = HitVector();
@@ -13,8 +13,14 @@
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "larreco/RecoAlg/Cluster3DAlgs/kdTree.h"
 
+// TBB includes
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 // std includes
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // implementation follows
@@ -40,6 +46,7 @@ void kdTree::configure(fhicl::ParameterSet const &pset)
     fPairSigmaPeakTime = pset.get<float>("PairSigmaPeakTime", 3.  );
     fRefLeafBestDist   = pset.get<float>("RefLeafBestDist",   0.5 );
     fMaxWireDeltas     = pset.get<int>  ("MaxWireDeltas",     3   );
+    fLeafSize          = pset.get<size_t>("LeafSize",         16  );
 
     fTimeToBuild = 0;
 
@@ -167,6 +174,211 @@ kdTree::KdTreeNode& kdTree::BuildKdTree(Hit3DVec::iterator first,
     return kdTreeNodeContainer.back();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void kdTree::BuildFlatKdTree(const Hit3DVec& hit3DVec, FlatKdTree& flatKdTree) const
+{
+    cet::cpu_timer theClockBuildNeighborhood;
+
+    if (fEnableMonitoring) theClockBuildNeighborhood.start();
+
+    size_t numHits = hit3DVec.size();
+
+    flatKdTree.m_hitIndex.resize(numHits);
+
+    std::iota(flatKdTree.m_hitIndex.begin(), flatKdTree.m_hitIndex.end(), 0);
+
+    // Enough leaves to keep the buckets within the leaf size
+    size_t numLeaves(1);
+
+    while(numLeaves * std::max(fLeafSize, size_t(1)) < numHits) numLeaves *= 2;
+
+    size_t numNodes(2 * numLeaves - 1);
+
+    flatKdTree.m_nodes.assign(numNodes, FlatKdTree::Node{-1, 0., 0, 0});
+    flatKdTree.m_nodes.front().m_last = numHits;
+
+    // Parents come before their children so a single pass splits the whole tree
+    for(size_t nodeIdx = 0; nodeIdx < numLeaves - 1; nodeIdx++)
+    {
+        FlatKdTree::Node& node  = flatKdTree.m_nodes[nodeIdx];
+        auto              first = flatKdTree.m_hitIndex.begin() + node.m_first;
+        auto              last  = flatKdTree.m_hitIndex.begin() + node.m_last;
+        unsigned          split = (node.m_first + node.m_last) / 2;
+
+        // Split along whichever of Y and Z has the larger range
+        node.m_axis = 1;
+
+        if (first != last)
+        {
+            auto minMaxYPair = std::minmax_element(first,last,[&hit3DVec](unsigned left, unsigned right){return hit3DVec[left]->getPosition()[1] < hit3DVec[right]->getPosition()[1];});
+            auto minMaxZPair = std::minmax_element(first,last,[&hit3DVec](unsigned left, unsigned right){return hit3DVec[left]->getPosition()[2] < hit3DVec[right]->getPosition()[2];});
+
+            float rangeY = hit3DVec[*minMaxYPair.second]->getPosition()[1] - hit3DVec[*minMaxYPair.first]->getPosition()[1];
+            float rangeZ = hit3DVec[*minMaxZPair.second]->getPosition()[2] - hit3DVec[*minMaxZPair.first]->getPosition()[2];
+
+            if (rangeZ > rangeY) node.m_axis = 2;
+        }
+
+        int  axis     = node.m_axis;
+        auto splitItr = flatKdTree.m_hitIndex.begin() + split;
+
+        if (splitItr != last)
+        {
+            std::nth_element(first, splitItr, last, [&hit3DVec,axis](unsigned left, unsigned right)
+                {
+                    float leftPos  = hit3DVec[left]->getPosition()[axis];
+                    float rightPos = hit3DVec[right]->getPosition()[axis];
+
+                    return leftPos < rightPos || (!(rightPos < leftPos) && left < right);
+                });
+
+            node.m_axisValue = hit3DVec[*splitItr]->getPosition()[axis];
+        }
+
+        flatKdTree.m_nodes[2 * nodeIdx + 1].m_first = node.m_first;
+        flatKdTree.m_nodes[2 * nodeIdx + 1].m_last  = split;
+        flatKdTree.m_nodes[2 * nodeIdx + 2].m_first = split;
+        flatKdTree.m_nodes[2 * nodeIdx + 2].m_last  = node.m_last;
+    }
+
+    // Now lay the hits out in tree order
+    flatKdTree.m_hits.resize(numHits);
+
+    for(size_t hitIdx = 0; hitIdx < numHits; hitIdx++) flatKdTree.m_hits[hitIdx] = hit3DVec[flatKdTree.m_hitIndex[hitIdx]];
+
+    if (fEnableMonitoring)
+    {
+        theClockBuildNeighborhood.stop();
+        fTimeToBuild = theClockBuildNeighborhood.accumulated_real_time();
+    }
+
+    return;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void kdTree::FindAllNeighbors(const FlatKdTree& flatKdTree, NeighborTable& neighborTable, unsigned int numThreads) const
+{
+    size_t numHits = flatKdTree.size();
+
+    // The queries are independent so the hits are handed out in contiguous blocks, each filling
+    // its own piece of the table which are then joined in order
+    struct TableBlock
+    {
+        std::vector<size_t>   m_numNeighbors;
+        std::vector<unsigned> m_neighbors;
+        std::vector<float>    m_separations;
+    };
+
+    size_t                  blockSize = 1024;
+    size_t                  numBlocks = (numHits + blockSize - 1) / blockSize;
+    std::vector<TableBlock> tableBlocks(numBlocks);
+
+    // Hit index in the input vector -> position in the tree
+    std::vector<unsigned> treeIndex(numHits);
+
+    for(size_t hitIdx = 0; hitIdx < numHits; hitIdx++) treeIndex[flatKdTree.m_hitIndex[hitIdx]] = hitIdx;
+
+    float radius = fRefLeafBestDist;
+
+    auto findBlock = [&](size_t blockIdx)
+    {
+        TableBlock&                                tableBlock = tableBlocks[blockIdx];
+        std::vector<size_t>                        nodeStack;
+        std::vector<std::pair<unsigned,float>>     candidates;
+
+        size_t firstHit = blockIdx * blockSize;
+        size_t lastHit  = std::min(firstHit + blockSize, numHits);
+
+        tableBlock.m_numNeighbors.reserve(lastHit - firstHit);
+
+        for(size_t hitIdx = firstHit; hitIdx < lastHit; hitIdx++)
+        {
+            const reco::ClusterHit3D* refHit = flatKdTree.m_hits[treeIndex[hitIdx]];
+
+            candidates.clear();
+            nodeStack.assign(1, 0);
+
+            while(!nodeStack.empty())
+            {
+                size_t nodeIdx = nodeStack.back();
+
+                nodeStack.pop_back();
+
+                const FlatKdTree::Node& node = flatKdTree.m_nodes[nodeIdx];
+
+                if (flatKdTree.isLeaf(nodeIdx))
+                {
+                    for(unsigned treeIdx = node.m_first; treeIdx < node.m_last; treeIdx++)
+                    {
+                        const reco::ClusterHit3D* hit3D = flatKdTree.m_hits[treeIdx];
+
+                        if (hit3D == refHit) continue;
+
+                        float hitSeparation(radius);
+
+                        if (consistentPairs(refHit, hit3D, hitSeparation)) candidates.emplace_back(flatKdTree.m_hitIndex[treeIdx], hitSeparation);
+                    }
+                }
+                else
+                {
+                    float refPosition = refHit->getPosition()[node.m_axis];
+
+                    if (refPosition - radius <= node.m_axisValue) nodeStack.push_back(2 * nodeIdx + 1);
+                    if (refPosition + radius >= node.m_axisValue) nodeStack.push_back(2 * nodeIdx + 2);
+                }
+            }
+
+            std::sort(candidates.begin(), candidates.end());
+
+            tableBlock.m_numNeighbors.push_back(candidates.size());
+
+            for(const auto& candidate : candidates)
+            {
+                tableBlock.m_neighbors.push_back(candidate.first);
+                tableBlock.m_separations.push_back(candidate.second);
+            }
+        }
+    };
+
+    if (numThreads > 1 && numBlocks > 1)
+    {
+        tbb::task_arena arena(numThreads);
+
+        arena.execute([&]{tbb::parallel_for(size_t(0), numBlocks, findBlock);});
+    }
+    else
+    {
+        for(size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) findBlock(blockIdx);
+    }
+
+    // Join the blocks
+    size_t numEntries(0);
+
+    for(const auto& tableBlock : tableBlocks) numEntries += tableBlock.m_neighbors.size();
+
+    neighborTable.m_first.clear();
+    neighborTable.m_neighbors.clear();
+    neighborTable.m_separations.clear();
+
+    neighborTable.m_first.reserve(numHits + 1);
+    neighborTable.m_neighbors.reserve(numEntries);
+    neighborTable.m_separations.reserve(numEntries);
+
+    neighborTable.m_first.push_back(0);
+
+    for(const auto& tableBlock : tableBlocks)
+    {
+        for(const auto& numNeighbors : tableBlock.m_numNeighbors) neighborTable.m_first.push_back(neighborTable.m_first.back() + numNeighbors);
+
+        neighborTable.m_neighbors.insert(neighborTable.m_neighbors.end(), tableBlock.m_neighbors.begin(), tableBlock.m_neighbors.end());
+        neighborTable.m_separations.insert(neighborTable.m_separations.end(), tableBlock.m_separations.begin(), tableBlock.m_separations.end());
+    }
+
+    return;
+}
+
 size_t kdTree::FindNearestNeighbors(const reco::ClusterHit3D* refHit, const KdTreeNode& node, CandPairList& CandPairList, float& bestDist) const
 {
     // If at a leaf then time to decide to add hit or not
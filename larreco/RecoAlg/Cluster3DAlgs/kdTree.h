@@ -37,7 +37,8 @@ public:
                fTimeToBuild(0.),
                fPairSigmaPeakTime(0.),
                fRefLeafBestDist(0.),
-               fMaxWireDeltas(0) {}
+               fMaxWireDeltas(0),
+               fLeafSize(16) {}
 
     /**
      *  @brief  Constructor
@@ -64,7 +65,7 @@ public:
     class KdTreeNode;
 
     using KdTreeNodeVec  = std::vector<KdTreeNode>;
-    using KdTreeNodeList = std::list<KdTreeNode>;
+    using KdTreeNodeList = std::list<KdTreeNode, reco::pool::PoolAllocator<KdTreeNode>>;
     using Hit3DVec       = std::vector<const reco::ClusterHit3D*>;
 
     /**
@@ -76,7 +77,7 @@ public:
     KdTreeNode& BuildKdTree(Hit3DVec::iterator, Hit3DVec::iterator, KdTreeNodeList&, int depth=0) const;
 
     using CandPair     = std::pair<double,const reco::ClusterHit3D*>;
-    using CandPairList = std::list<CandPair>;
+    using CandPairList = std::list<CandPair, reco::pool::PoolAllocator<CandPair>>;
 
     size_t FindNearestNeighbors(const reco::ClusterHit3D*, const KdTreeNode&, CandPairList&, float&) const;
     bool   FindEntry(const reco::ClusterHit3D*, const KdTreeNode&, CandPairList&, float&, bool&, int) const;
@@ -92,6 +93,33 @@ public:
      */
     KdTreeNode BuildKdTree(const reco::HitPairListPtr&, KdTreeNodeList&) const;
 
+    /**
+     *  @brief Define the flat version of the kd tree and the table of neighbors it produces
+     */
+    class FlatKdTree;
+    class NeighborTable;
+
+    /**
+     *  @brief Given an input vector of 3D hits, build the flat kd tree
+     *
+     *  @param hit3DVec              The input 3D hits, the tree refers to them by their index in this vector
+     *  @param flatKdTree            The tree to fill
+     */
+    void BuildFlatKdTree(const Hit3DVec& hit3DVec, FlatKdTree& flatKdTree) const;
+
+    /**
+     *  @brief Find the neighbors of every hit in the flat kd tree in one go
+     *
+     *  A hit is a neighbor if it passes consistentPairs() within a fixed separation of
+     *  RefLeafBestDist. The rows of the table are in the order of the input hits and each
+     *  row is in increasing hit index, whatever the number of threads.
+     *
+     *  @param flatKdTree            The tree built by BuildFlatKdTree
+     *  @param neighborTable         The table to fill
+     *  @param numThreads            Number of threads to spread the queries over
+     */
+    void FindAllNeighbors(const FlatKdTree& flatKdTree, NeighborTable& neighborTable, unsigned int numThreads = 1) const;
+
     float getTimeToExecute() const {return fTimeToBuild;}
 
 private:
@@ -109,7 +137,52 @@ private:
     float          fPairSigmaPeakTime;     ///< Consider hits consistent if "significance" less than this
     float          fRefLeafBestDist;       ///< Set neighborhood distance to this when ref leaf found
     int            fMaxWireDeltas;          ///< Maximum total number of delta wires
+    size_t         fLeafSize;              ///< Maximum number of hits in a leaf of the flat kd tree
+
+};
+
+/**
+ *  @brief define the flat kd tree
+ *
+ *         The nodes live in a contiguous vector as an implicit binary tree: the children of
+ *         node i are nodes 2i+1 and 2i+2 and the last half of the nodes are the leaves. The
+ *         hits are reordered so that those of a node are contiguous, a leaf holding a bucket
+ *         of at most LeafSize hits. Since consistentPairs() measures the separation in the
+ *         Y-Z plane only those two axes are split.
+ */
+class kdTree::FlatKdTree
+{
+public:
+    struct Node
+    {
+        int      m_axis;                      ///< Split axis (1 = Y, 2 = Z), -1 for leaves
+        float    m_axisValue;                 ///< Hits of the left (right) child are below (above) this
+        unsigned m_first;                     ///< First hit of the node
+        unsigned m_last;                      ///< One past the last hit of the node
+    };
+
+    size_t                     size()                 const {return m_hits.size();}
+    bool                       isLeaf(size_t nodeIdx) const {return 2 * nodeIdx + 1 >= m_nodes.size();}
+
+    std::vector<Node>          m_nodes;       ///< The nodes, root first
+    Hit3DVec                   m_hits;        ///< The hits in tree order
+    std::vector<unsigned>      m_hitIndex;    ///< Index of each of the above in the input vector
+};
+
+/**
+ *  @brief define the table of neighbors, in compressed sparse row form
+ *
+ *         The neighbors of input hit i are entries [m_first[i], m_first[i+1]) of m_neighbors
+ *         (the index of the neighbor in the input vector) and m_separations.
+ */
+class kdTree::NeighborTable
+{
+public:
+    size_t                     numNeighbors(size_t hitIdx) const {return m_first[hitIdx + 1] - m_first[hitIdx];}
 
+    std::vector<size_t>        m_first;
+    std::vector<unsigned>      m_neighbors;
+    std::vector<float>         m_separations;
 };
 
 /**
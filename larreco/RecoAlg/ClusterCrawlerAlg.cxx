@@ -15,6 +15,10 @@
 #include <iomanip>
 #include <algorithm> // std::fill(), std::find(), std::sort()...
 
+// TBB
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 // framework libraries
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
@@ -102,6 +106,8 @@ namespace cluster {
     fDebugPlane         = pset.get< int  >("DebugPlane", -1);
     fDebugWire          = pset.get< int  >("DebugWire", -1);
     fDebugHit           = pset.get< int  >("DebugHit", -1);
+    fNumThreads         = pset.get< unsigned int >("NumThreads", 1);
+    fCompareWithSerial  = pset.get< bool >("CompareWithSerial", false);
 
 
     // some error checking
@@ -124,6 +130,13 @@ namespace cluster {
     if(badinput) throw art::Exception(art::errors::Configuration)
       << "ClusterCrawlerAlg: Bad input from fcl file";
 
+    // the workers are copies of this configuration
+    fIndependentPlanes = (fNumThreads > 1);
+    fWorkers.clear();
+    if(fNumThreads > 1) {
+      std::vector<ClusterCrawlerAlg> workers(fNumThreads, *this);
+      fWorkers = std::move(workers);
+    }
 
   } // reconfigure
 
@@ -155,13 +168,19 @@ namespace cluster {
 
 //------------------------------------------------------------------------------
   void ClusterCrawlerAlg::CrawlInit() {
-    prt = false; vtxprt = false;
-    NClusters = 0;  clBeginSlp = 0; clBeginSlpErr = 0; clBeginTim = 0;
-    clBeginWir = 0; clBeginChg = 0; clBeginChgNear = 0; clEndSlp = 0;      clEndSlpErr = 0;
-    clEndTim = 0;   clEndWir = 0;   clEndChg = 0; clEndChgNear = 0; clChisq = 0;
-    clStopCode = 0; clProcCode = 0; fFirstWire = 0;
-    fLastWire = 0; fAveChg = 0.; fChgSlp = 0.; pass = 0;
-    fScaleF = 0; WireHitRange.clear();
+    if(fIndependentPlanes) {
+      ResetCrawlState();
+    } else {
+      prt = false; vtxprt = false;
+      clBeginSlp = 0; clBeginSlpErr = 0; clBeginTim = 0;
+      clBeginWir = 0; clBeginChg = 0; clBeginChgNear = 0; clEndSlp = 0;      clEndSlpErr = 0;
+      clEndTim = 0;   clEndWir = 0;   clEndChg = 0; clEndChgNear = 0; clChisq = 0;
+      clStopCode = 0; clProcCode = 0; fFirstWire = 0;
+      fLastWire = 0; fAveChg = 0.; fChgSlp = 0.; pass = 0;
+      WireHitRange.clear();
+    }
+    NClusters = 0;
+    fScaleF = 0;
     // unMergedHits.clear();
 
     ClearResults();
@@ -212,62 +231,19 @@ namespace cluster {
        mergeAvailable[iht] = false;
      }
 
-    const detinfo::DetectorProperties* detprop = lar::providerFrom<detinfo::DetectorPropertiesService>();
+    fChannelStatus = &art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
 
-    for (geo::TPCID const& tpcid: geom->IterateTPCIDs()) {
-      geo::TPCGeo const& TPC = geom->TPC(tpcid);
-      for(plane = 0; plane < TPC.Nplanes(); ++plane){
-        WireHitRange.clear();
-        // define a code to ensure clusters are compared within the same plane
-        clCTP = EncodeCTP(tpcid.Cryostat, tpcid.TPC, plane);
-        cstat = tpcid.Cryostat;
-        tpc = tpcid.TPC;
-        // fill the WireHitRange vector with first/last hit on each wire
-        // dead wires and wires with no hits are flagged < 0
-        GetHitRange(clCTP);
+    // the workers only have the hits of their plane
+    if(fIndependentPlanes) SetCrawlConstants(fHits[0].Channel());
 
-// sanity check
-/*
-  std::cout<<"Plane "<<plane<<" sanity check. Wire range "<<fFirstWire<<" "<<fLastWire;
-  unsigned int nhts = 0;
-  for(unsigned int wire = fFirstWire; wire < fLastWire; ++wire) {
-    if(WireHitRange[wire].first < 0) continue;
-    unsigned int fhit = WireHitRange[wire].first;
-    unsigned int lhit = WireHitRange[wire].second;
-    for(unsigned int hit = fhit; hit < lhit; ++hit) {
-      ++nhts;
-      if(fHits[hit].WireID().Wire != wire) {
-        std::cout<<"Bad wire "<<hit<<" "<<fHits[hit].WireID().Wire<<" "<<wire<<"\n";
-        return;
-      } // check wire
-      if(fHits[hit].WireID().Plane != plane) {
-        std::cout<<"Bad plane "<<hit<<" "<<fHits[hit].WireID().Plane<<" "<<plane<<"\n";
-        return;
-      } // check plane
-      if(fHits[hit].WireID().TPC != tpc) {
-        std::cout<<"Bad tpc "<<hit<<" "<<fHits[hit].WireID().TPC<<" "<<tpc<<"\n";
-        return;
-      } // check tpc
-    } // hit
-  } // wire
-  std::cout<<" is OK. nhits "<<nhts<<"\n";
-*/
-        if (WireHitRange.empty()||(fFirstWire == fLastWire)) continue;
-        raw::ChannelID_t channel = fHits[fFirstHit].Channel();
-        // get the scale factor to convert dTick/dWire to dX/dU. This is used
-        // to make the kink and merging cuts
-        float wirePitch = geom->WirePitch(geom->View(channel));
-        float tickToDist = detprop->DriftVelocity(detprop->Efield(),detprop->Temperature());
-        tickToDist *= 1.e-3 * detprop->SamplingRate(); // 1e-3 is conversion of 1/us to 1/ns
-        fScaleF = tickToDist / wirePitch;
-        // convert Large Angle Cluster crawling cut to a slope cut
-        if(fLAClusAngleCut > 0)
-          fLAClusSlopeCut = std::tan(3.142 * fLAClusAngleCut / 180.) / fScaleF;
-        fMaxTime = detprop->NumberTimeSamples();
-        fNumWires = geom->Nwires(plane, tpc, cstat);
-        // look for clusters
-        if(fNumPass > 0) ClusterLoop();
-      } // plane
+    // With more than one thread the planes are crawled independently up to the
+    // 3D vertex matching: all of them first, then merged TPC by TPC below
+    std::vector<CTPStore> stores;
+    if(!fWorkers.empty()) CrawlPlanesConcurrently(stores);
+    size_t iStore = 0;
+
+    for (geo::TPCID const& tpcid: geom->IterateTPCIDs()) {
+      if(stores.empty() || !MergeCTPStores(tpcid, stores, iStore)) CrawlTPC(tpcid);
       if(fVertex3DCut > 0) {
         // Match vertices in 3 planes
         VtxMatch(tpcid);
@@ -328,8 +304,260 @@ namespace cluster {
     // remove the hits that have become obsolete
     RemoveObsoleteHits();
 
+    if(fCompareWithSerial && !fWorkers.empty()) CompareWithSerial(srchits);
+
   } // RunCrawler
 
+  ////////////////////////////////////////////////
+  void ClusterCrawlerAlg::CrawlTPC(geo::TPCID const& tpcid)
+  {
+    geo::TPCGeo const& TPC = geom->TPC(tpcid);
+    for(plane = 0; plane < TPC.Nplanes(); ++plane) {
+      CrawlPlane(EncodeCTP(tpcid.Cryostat, tpcid.TPC, plane));
+    } // plane
+  } // CrawlTPC
+
+  ////////////////////////////////////////////////
+  bool ClusterCrawlerAlg::CrawlPlane(CTP_t inCTP)
+  {
+    // independent planes carry nothing over from the previous plane
+    if(fIndependentPlanes) ResetCrawlState();
+    else WireHitRange.clear();
+    // define a code to ensure clusters are compared within the same plane
+    clCTP = inCTP;
+    geo::PlaneID planeID = DecodeCTP(inCTP);
+    cstat = planeID.Cryostat;
+    tpc = planeID.TPC;
+    plane = planeID.Plane;
+    if(fIndependentPlanes) fNumWires = geom->Nwires(plane, tpc, cstat);
+    // fill the WireHitRange vector with first/last hit on each wire
+    // dead wires and wires with no hits are flagged < 0
+    GetHitRange(clCTP);
+
+// sanity check
+/*
+  std::cout<<"Plane "<<plane<<" sanity check. Wire range "<<fFirstWire<<" "<<fLastWire;
+  unsigned int nhts = 0;
+  for(unsigned int wire = fFirstWire; wire < fLastWire; ++wire) {
+    if(WireHitRange[wire].first < 0) continue;
+    unsigned int fhit = WireHitRange[wire].first;
+    unsigned int lhit = WireHitRange[wire].second;
+    for(unsigned int hit = fhit; hit < lhit; ++hit) {
+      ++nhts;
+      if(fHits[hit].WireID().Wire != wire) {
+        std::cout<<"Bad wire "<<hit<<" "<<fHits[hit].WireID().Wire<<" "<<wire<<"\n";
+        return;
+      } // check wire
+      if(fHits[hit].WireID().Plane != plane) {
+        std::cout<<"Bad plane "<<hit<<" "<<fHits[hit].WireID().Plane<<" "<<plane<<"\n";
+        return;
+      } // check plane
+      if(fHits[hit].WireID().TPC != tpc) {
+        std::cout<<"Bad tpc "<<hit<<" "<<fHits[hit].WireID().TPC<<" "<<tpc<<"\n";
+        return;
+      } // check tpc
+    } // hit
+  } // wire
+  std::cout<<" is OK. nhits "<<nhts<<"\n";
+*/
+    if (WireHitRange.empty()||(fFirstWire == fLastWire)) return false;
+    if(!fIndependentPlanes) {
+      SetCrawlConstants(fHits[fFirstHit].Channel());
+      fNumWires = geom->Nwires(plane, tpc, cstat);
+    }
+    // look for clusters
+    if(fNumPass > 0) ClusterLoop();
+    return true;
+  } // CrawlPlane
+
+  ////////////////////////////////////////////////
+  void ClusterCrawlerAlg::SetCrawlConstants(raw::ChannelID_t channel)
+  {
+    const detinfo::DetectorProperties* detprop = lar::providerFrom<detinfo::DetectorPropertiesService>();
+    // get the scale factor to convert dTick/dWire to dX/dU. This is used
+    // to make the kink and merging cuts
+    float wirePitch = geom->WirePitch(geom->View(channel));
+    float tickToDist = detprop->DriftVelocity(detprop->Efield(),detprop->Temperature());
+    tickToDist *= 1.e-3 * detprop->SamplingRate(); // 1e-3 is conversion of 1/us to 1/ns
+    fScaleF = tickToDist / wirePitch;
+    // convert Large Angle Cluster crawling cut to a slope cut
+    if(fLAClusAngleCut > 0)
+      fLAClusSlopeCut = std::tan(3.142 * fLAClusAngleCut / 180.) / fScaleF;
+    fMaxTime = detprop->NumberTimeSamples();
+  } // SetCrawlConstants
+
+  ////////////////////////////////////////////////
+  void ClusterCrawlerAlg::CrawlPlanesConcurrently(std::vector<CTPStore>& stores)
+  {
+    // Each worker gets a copy of the hits of the plane, which are contiguous in the sorted fHits
+    unsigned int firstHit = 0;
+    for (geo::TPCID const& tpcid: geom->IterateTPCIDs()) {
+      unsigned int nPlanes = geom->TPC(tpcid).Nplanes();
+      for(unsigned int ipl = 0; ipl < nPlanes; ++ipl) {
+        CTPStore store;
+        store.CTP = EncodeCTP(tpcid.Cryostat, tpcid.TPC, ipl);
+        while(firstHit < fHits.size() && EncodeCTP(fHits[firstHit].WireID()) < store.CTP) ++firstHit;
+        unsigned int lastHit = firstHit;
+        while(lastHit < fHits.size() && EncodeCTP(fHits[lastHit].WireID()) == store.CTP) ++lastHit;
+        store.firstHit = firstHit;
+        store.lastPlane = (ipl == nPlanes - 1);
+        store.hits.assign(fHits.begin() + firstHit, fHits.begin() + lastHit);
+        stores.push_back(std::move(store));
+        firstHit = lastHit;
+      } // ipl
+    } // tpcid
+    if(stores.empty()) return;
+
+    // the planes are dealt out in turn to the workers
+    const size_t numGroups = std::min(fWorkers.size(), stores.size());
+    auto crawlGroup = [&](const size_t group) {
+      ClusterCrawlerAlg& worker = fWorkers[group];
+      worker.CrawlInit();
+      worker.fChannelStatus = fChannelStatus;
+      worker.fScaleF = fScaleF;
+      worker.fLAClusSlopeCut = fLAClusSlopeCut;
+      worker.fMaxTime = fMaxTime;
+      for(size_t ist = group; ist < stores.size(); ist += numGroups) worker.CrawlStore(stores[ist]);
+    };
+    tbb::task_arena arena(numGroups);
+    arena.execute([&]{ tbb::parallel_for(size_t(0), numGroups, crawlGroup); });
+  } // CrawlPlanesConcurrently
+
+  ////////////////////////////////////////////////
+  void ClusterCrawlerAlg::CrawlStore(CTPStore& store)
+  {
+    // The state left by the last plane of a TPC is used by the 3D vertex
+    // matching, even if the plane has no hits
+    if(store.hits.empty() && !store.lastPlane) return;
+
+    // the hits of the plane stand in for the event hits; only the 2D vertices
+    // of the plane itself are looked at while crawling it
+    fHits.swap(store.hits);
+    inClus.assign(fHits.size(), 0);
+    mergeAvailable.assign(fHits.size(), false);
+    tcl.clear();
+    vtx.clear();
+    NClusters = 0;
+    CrawlPlane(store.CTP);
+    fHits.swap(store.hits);
+    inClus.swap(store.inClus);
+    mergeAvailable.swap(store.mergeAvailable);
+    tcl.swap(store.tcl);
+    vtx.swap(store.vtx);
+
+    if(store.lastPlane) store.state = static_cast<details::CrawlState const&>(*this);
+  } // CrawlStore
+
+  ////////////////////////////////////////////////
+  bool ClusterCrawlerAlg::MergeCTPStores(geo::TPCID const& tpcid, std::vector<CTPStore>& stores, size_t& iStore)
+  {
+    // Adds the results of the planes of a TPC as if they were crawled here one
+    // after the other: the cluster IDs, vertex indices and hit indices of each
+    // plane are shifted by the number of clusters, vertices and hits before it.
+    const size_t begin = iStore;
+    const size_t end = iStore + geom->TPC(tpcid).Nplanes();
+    iStore = end;
+    if(begin == end) return true;
+
+    // The serial crawl stops making clusters at SHRT_MAX. Crawl the TPC again
+    // if the planes made more than that; its hits are still untouched
+    unsigned int nNew = 0;
+    for(size_t ist = begin; ist < end; ++ist) nNew += stores[ist].tcl.size();
+    if(NClusters + nNew > SHRT_MAX) return false;
+
+    for(size_t ist = begin; ist < end; ++ist) {
+      CTPStore& store = stores[ist];
+      if(store.inClus.empty()) continue;
+      const short clOffset = NClusters;
+      const short vtxOffset = vtx.size();
+      for(unsigned int iht = 0; iht < store.hits.size(); ++iht) {
+        unsigned int jht = store.firstHit + iht;
+        fHits[jht] = std::move(store.hits[iht]);
+        // 0 = free, -1 = obsolete
+        inClus[jht] = store.inClus[iht] > 0 ? store.inClus[iht] + clOffset : store.inClus[iht];
+        mergeAvailable[jht] = store.mergeAvailable[iht];
+      } // iht
+      for(auto& clstr : store.tcl) {
+        // obsolete clusters have ID < 0
+        clstr.ID = clstr.ID > 0 ? clstr.ID + clOffset : clstr.ID - clOffset;
+        if(clstr.BeginVtx >= 0) clstr.BeginVtx += vtxOffset;
+        if(clstr.EndVtx >= 0) clstr.EndVtx += vtxOffset;
+        for(auto& iht : clstr.tclhits) iht += store.firstHit;
+        tcl.push_back(std::move(clstr));
+      } // clstr
+      vtx.insert(vtx.end(), store.vtx.begin(), store.vtx.end());
+      NClusters = tcl.size();
+    } // ist
+
+    // Each plane starts from a reset state, so the serial crawl leaves the
+    // state of the last plane
+    CTPStore& last = stores[end - 1];
+    static_cast<details::CrawlState&>(*this) = std::move(last.state);
+    OffsetHits(last.firstHit);
+    // as left by the plane loop of CrawlTPC
+    plane = geom->TPC(tpcid).Nplanes();
+    for(size_t ist = begin; ist < end; ++ist) stores[ist] = CTPStore();
+    return true;
+  } // MergeCTPStores
+
+  ////////////////////////////////////////////////
+  void details::CrawlState::OffsetHits(unsigned int offset)
+  {
+    for(auto& range : WireHitRange) {
+      if(range.first < 0) continue;
+      range.first += offset;
+      range.second += offset;
+    } // range
+    for(auto& iht : fcl2hits) iht += offset;
+  } // CrawlState::OffsetHits
+
+  ////////////////////////////////////////////////
+  void ClusterCrawlerAlg::CompareWithSerial(std::vector<recob::Hit> const& srchits)
+  {
+    // The workers have no workers of their own, so they crawl serially
+    ClusterCrawlerAlg& serial = fWorkers.front();
+    serial.RunCrawler(srchits);
+
+    auto sameHit = [](recob::Hit const& a, recob::Hit const& b) {
+      return a.Channel() == b.Channel() && a.WireID() == b.WireID()
+        && a.StartTick() == b.StartTick() && a.EndTick() == b.EndTick()
+        && a.PeakTime() == b.PeakTime() && a.RMS() == b.RMS()
+        && a.PeakAmplitude() == b.PeakAmplitude() && a.Integral() == b.Integral()
+        && a.Multiplicity() == b.Multiplicity() && a.LocalIndex() == b.LocalIndex()
+        && a.GoodnessOfFit() == b.GoodnessOfFit();
+    };
+    auto sameCluster = [](ClusterStore const& a, ClusterStore const& b) {
+      return a.ID == b.ID && a.ProcCode == b.ProcCode && a.StopCode == b.StopCode && a.CTP == b.CTP
+        && a.BeginSlp == b.BeginSlp && a.BeginSlpErr == b.BeginSlpErr && a.BeginAng == b.BeginAng
+        && a.BeginWir == b.BeginWir && a.BeginTim == b.BeginTim && a.BeginChg == b.BeginChg
+        && a.BeginChgNear == b.BeginChgNear && a.BeginVtx == b.BeginVtx
+        && a.EndSlp == b.EndSlp && a.EndAng == b.EndAng && a.EndSlpErr == b.EndSlpErr
+        && a.EndWir == b.EndWir && a.EndTim == b.EndTim && a.EndChg == b.EndChg
+        && a.EndChgNear == b.EndChgNear && a.EndVtx == b.EndVtx && a.tclhits == b.tclhits;
+    };
+    auto sameVtx = [](VtxStore const& a, VtxStore const& b) {
+      return a.Wire == b.Wire && a.WireErr == b.WireErr && a.Time == b.Time && a.TimeErr == b.TimeErr
+        && a.NClusters == b.NClusters && a.ChiDOF == b.ChiDOF && a.Topo == b.Topo
+        && a.CTP == b.CTP && a.Fixed == b.Fixed;
+    };
+    auto sameVtx3 = [](Vtx3Store const& a, Vtx3Store const& b) {
+      return a.Ptr2D == b.Ptr2D && a.X == b.X && a.XErr == b.XErr && a.Y == b.Y && a.YErr == b.YErr
+        && a.Z == b.Z && a.ZErr == b.ZErr && a.Wire == b.Wire && a.CStat == b.CStat
+        && a.TPC == b.TPC && a.ProcCode == b.ProcCode;
+    };
+
+    std::string what;
+    if(!std::equal(fHits.begin(), fHits.end(), serial.fHits.begin(), serial.fHits.end(), sameHit)) what = "hits";
+    else if(inClus != serial.inClus) what = "hit cluster assignments";
+    else if(!std::equal(tcl.begin(), tcl.end(), serial.tcl.begin(), serial.tcl.end(), sameCluster)) what = "clusters";
+    else if(!std::equal(vtx.begin(), vtx.end(), serial.vtx.begin(), serial.vtx.end(), sameVtx)) what = "2D vertices";
+    else if(!std::equal(vtx3.begin(), vtx3.end(), serial.vtx3.begin(), serial.vtx3.end(), sameVtx3)) what = "3D vertices";
+    serial.ClearResults();
+
+    if(!what.empty()) throw art::Exception(art::errors::LogicError)
+      <<"ClusterCrawlerAlg: the "<<what<<" found with NumThreads "<<fNumThreads<<" differ from the serial ones";
+  } // CompareWithSerial
+
   ////////////////////////////////////////////////
     void ClusterCrawlerAlg::ClusterLoop()
     {
@@ -2486,6 +2714,7 @@ namespace cluster {
           dwjb = 999; dwje = 999;
           for(jv = 0; jv < vtx.size(); ++jv) {
             if(iv == jv) continue;
+            if(fIndependentPlanes && vtx[jv].CTP != clCTP) continue;
             if(std::abs(vtx[jv].Time - tcl[it].BeginTim) < 50) {
               if(std::abs(vtx[jv].Wire - tcl[it].BeginWir) < dwjb)
                 dwjb = std::abs(vtx[jv].Wire - tcl[it].BeginWir);
@@ -5036,6 +5265,7 @@ namespace cluster {
     if(lastClHit != UINT_MAX && fAveHitWidth > 0 && fHitMergeChiCut > 0 && hit.Multiplicity() == 2) {
       bool doMerge = true;
       for(unsigned short ivx = 0; ivx < vtx.size(); ++ivx) {
+        if(fIndependentPlanes && vtx[ivx].CTP != clCTP) continue;
         if(std::abs(kwire - vtx[ivx].Wire) < 10 &&
            std::abs(int(hit.PeakTime() - vtx[ivx].Time)) < 20 )
         {
@@ -6122,8 +6352,7 @@ namespace cluster {
         ++nHitInPlane;
       }
       // overwrite with the "dead wires" condition
-      lariov::ChannelStatusProvider const& channelStatus
-        = art::ServiceHandle<lariov::ChannelStatusService const>()->GetProvider();
+      lariov::ChannelStatusProvider const& channelStatus = *fChannelStatus;
 
       flag.first = -1; flag.second = -1;
       unsigned int nbad = 0;
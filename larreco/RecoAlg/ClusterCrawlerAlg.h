@@ -18,6 +18,7 @@
 // framework libraries
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 namespace geo { class Geometry; }
+namespace lariov { class ChannelStatusProvider; }
 
 // LArSoft libraries
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
@@ -28,7 +29,95 @@ namespace geo { class Geometry; }
 
 namespace cluster {
 
-  class ClusterCrawlerAlg {
+  namespace details {
+
+    /// The state of the crawl in a plane: the cluster being crawled and the
+    /// hits of the plane. With independent planes each plane starts from the
+    /// default state, and the 3D vertex matching of a TPC starts from the state
+    /// left by its last plane
+    struct CrawlState {
+
+      // these variables define the cluster used during crawling
+      float clpar[3] = {};    ///< cluster parameters for the current fit with
+                              ///< origin at the US wire on the cluster (in clpar[2])
+      float clparerr[2] = {}; ///< cluster parameter errors
+      float clChisq = 0;      ///< chisq of the current fit
+      float fAveChg = 0;      ///< average charge at leading edge of cluster
+      float fChgSlp = 0;      ///< slope of the  charge vs wire
+      float fAveHitWidth = 0; ///< average width (EndTick - StartTick) of hits
+
+      bool prt = false;
+      bool vtxprt = false;
+
+      float clBeginSlp = 0;  ///< begin slope (= DS end = high wire number)
+      float clBeginAng = 0;
+      float clBeginSlpErr = 0;
+      unsigned int clBeginWir = 0;  ///< begin wire
+      float clBeginTim = 0;  ///< begin time
+      float clBeginChg = 0;  ///< begin average charge
+      float clBeginChgNear = 0; ///< nearby charge
+      float clEndSlp = 0;    ///< slope at the end   (= US end = low  wire number)
+      float clEndAng = 0;
+      float clEndSlpErr = 0;
+      unsigned int clEndWir = 0;    ///< begin wire
+      float clEndTim = 0;    ///< begin time
+      float clEndChg = 0;    ///< end average charge
+      float clEndChgNear = 0;  ///< nearby charge
+      short clStopCode = 0;     ///< code for the reason for stopping cluster tracking
+                          ///< 0 = no signal on the next wire
+                          ///< 1 = skipped too many occupied/dead wires
+                          ///< 2 = failed the fMinWirAfterSkip cut
+                          ///< 3 = ended on a kink. Fails fKinkChiRat
+                          ///< 4 = failed the fChiCut cut
+                          ///< 5 = cluster split by VtxClusterSplit
+                          ///< 6 = stop at a vertex
+                          ///< 7 = LA crawl stopped due to slope cut
+                          ///< 8 = SPECIAL CODE FOR STEP CRAWLING
+      short clProcCode = 0;     ///< Processor code = pass number
+                          ///< +   10 ChkMerge
+                          ///< +   20 ChkMerge with overlapping hits
+                          ///< +  100 ChkMerge12
+                          ///< +  200 ClusterFix
+                          ///< +  300 LACrawlUS
+                          ///< +  500 MergeOverlap
+                          ///< +  666 KillGarbageClusters
+                          ///< + 1000 VtxClusterSplit
+                          ///< + 2000 failed pass N cuts but passes pass N=1 cuts
+                          ///< + 5000 ChkClusterDS
+                          ///< +10000 Vtx3ClusterSplit
+      unsigned int clCTP = 0;  ///< Cryostat/TPC/Plane code
+      bool clLA = false;       ///< using Large Angle crawling code
+
+      unsigned int fFirstWire = 0;    ///< the first wire with a hit
+      unsigned int fFirstHit = 0;     ///< first hit used
+      unsigned int fLastWire = 0;      ///< the last wire with a hit
+      unsigned int cstat = 0;         // the current cryostat
+      unsigned int tpc = 0;         // the current TPC
+      unsigned int plane = 0;         // the current plane
+      unsigned int fNumWires = 0;   // number of wires in the current plane
+
+      unsigned short pass = 0;
+
+      // vector of pairs of first (.first) and last+1 (.second) hit on each wire
+      // in the range fFirstWire to fLastWire. A value of -2 indicates that there
+      // are no hits on the wire. A value of -1 indicates that the wire is dead
+      std::vector< std::pair<int, int> > WireHitRange;
+
+      std::vector<unsigned int> fcl2hits;  ///< vector of hits used in the cluster
+      std::vector<float> chifits;   ///< fit chisq for monitoring kinks, etc
+      std::vector<short> hitNear;   ///< Number of nearby
+                                    ///< hits that were merged have hitnear < 0
+
+      std::vector<float> chgNear; ///< charge near a cluster on each wire
+
+      /// Shifts the hit indices by offset, for a plane crawled on its own hits
+      void OffsetHits(unsigned int offset);
+
+    }; // CrawlState
+
+  } // namespace details
+
+  class ClusterCrawlerAlg: private details::CrawlState {
     public:
 
     // some functions to handle the CTP_t type
@@ -190,21 +279,16 @@ namespace cluster {
     int fDebugWire;  ///< set to the Begin Wire and Hit of a cluster to print
     int fDebugHit;   ///< out detailed information while crawling
 
+    unsigned int fNumThreads; ///< planes crawled concurrently
+    bool fCompareWithSerial;  ///< check the concurrent crawl against the serial one
+    bool fIndependentPlanes = false; ///< each plane starts from a reset state and only
+                                     ///< looks at its own 2D vertices (if fNumThreads > 1)
+    std::vector<ClusterCrawlerAlg> fWorkers; ///< crawl the planes if fNumThreads > 1
+    lariov::ChannelStatusProvider const* fChannelStatus = nullptr;
+
     // Wires that have been determined by some filter (e.g. NoiseFilter) to be good
     std::vector<geo::WireID> fFilteredWires;
 
-    // these variables define the cluster used during crawling
-    float clpar[3];     ///< cluster parameters for the current fit with
-                        ///< origin at the US wire on the cluster (in clpar[2])
-    float clparerr[2];  ///< cluster parameter errors
-    float clChisq;     ///< chisq of the current fit
-    float fAveChg;  ///< average charge at leading edge of cluster
-  //  float fChgRMS;  ///< average charge RMS at leading edge of cluster
-    float fChgSlp;  ///< slope of the  charge vs wire
-    float fAveHitWidth; ///< average width (EndTick - StartTick) of hits
-
-    bool prt;
-    bool vtxprt;
     unsigned short NClusters;
 
     art::ServiceHandle<geo::Geometry const> geom;
@@ -218,68 +302,9 @@ namespace cluster {
 
     trkf::LinFitAlg fLinFitAlg;
 
-    float clBeginSlp;  ///< begin slope (= DS end = high wire number)
-    float clBeginAng;
-    float clBeginSlpErr;
-    unsigned int clBeginWir;  ///< begin wire
-    float clBeginTim;  ///< begin time
-    float clBeginChg;  ///< begin average charge
-		float clBeginChgNear; ///< nearby charge
-    float clEndSlp;    ///< slope at the end   (= US end = low  wire number)
-    float clEndAng;
-    float clEndSlpErr;
-    unsigned int clEndWir;    ///< begin wire
-    float clEndTim;    ///< begin time
-    float clEndChg;    ///< end average charge
-		float clEndChgNear;  ///< nearby charge
-    short clStopCode;     ///< code for the reason for stopping cluster tracking
-                        ///< 0 = no signal on the next wire
-                        ///< 1 = skipped too many occupied/dead wires
-                        ///< 2 = failed the fMinWirAfterSkip cut
-                        ///< 3 = ended on a kink. Fails fKinkChiRat
-                        ///< 4 = failed the fChiCut cut
-                        ///< 5 = cluster split by VtxClusterSplit
-                        ///< 6 = stop at a vertex
-												///< 7 = LA crawl stopped due to slope cut
-                        ///< 8 = SPECIAL CODE FOR STEP CRAWLING
-    short clProcCode;     ///< Processor code = pass number
-                        ///< +   10 ChkMerge
-                        ///< +   20 ChkMerge with overlapping hits
-                        ///< +  100 ChkMerge12
-                        ///< +  200 ClusterFix
-                        ///< +  300 LACrawlUS
-                        ///< +  500 MergeOverlap
-                        ///< +  666 KillGarbageClusters
-                        ///< + 1000 VtxClusterSplit
-                        ///< + 2000 failed pass N cuts but passes pass N=1 cuts
-                        ///< + 5000 ChkClusterDS
-                        ///< +10000 Vtx3ClusterSplit
-    CTP_t clCTP;        ///< Cryostat/TPC/Plane code
-		bool clLA;					///< using Large Angle crawling code
-
-    unsigned int fFirstWire;    ///< the first wire with a hit
-    unsigned int fFirstHit;     ///< first hit used
-    unsigned int fLastWire;      ///< the last wire with a hit
-    unsigned int cstat;         // the current cryostat
-    unsigned int tpc;         // the current TPC
-    unsigned int plane;         // the current plane
-    unsigned int fNumWires;   // number of wires in the current plane
-    unsigned int fMaxTime;    // number of time samples in the current plane
+    unsigned int fMaxTime;    // number of time samples
     float fScaleF;     ///< scale factor from Tick/Wire to dx/du
 
-    unsigned short pass;
-
-    // vector of pairs of first (.first) and last+1 (.second) hit on each wire
-    // in the range fFirstWire to fLastWire. A value of -2 indicates that there
-    // are no hits on the wire. A value of -1 indicates that the wire is dead
-    std::vector< std::pair<int, int> > WireHitRange;
-
-    std::vector<unsigned int> fcl2hits;  ///< vector of hits used in the cluster
-    std::vector<float> chifits;   ///< fit chisq for monitoring kinks, etc
-    std::vector<short> hitNear;   ///< Number of nearby
-                                  ///< hits that were merged have hitnear < 0
-
-    std::vector<float> chgNear; ///< charge near a cluster on each wire
 		float fChgNearWindow; 		///< window (ticks) for finding nearby charge
 		float fChgNearCut;				///< cut on ratio of nearby/cluster charge to
 															///< to define a shower-like cluster
@@ -287,6 +312,39 @@ namespace cluster {
     std::string fhitsModuleLabel;
     // ******** crawling routines *****************
 
+    /// Hits of one plane and the results of crawling them on one of the fWorkers
+    struct CTPStore {
+      CTP_t CTP;
+      unsigned int firstHit;  ///< index of the first hit of the plane in fHits
+      bool lastPlane = false; ///< the last plane of the TPC
+      std::vector<recob::Hit> hits;
+      std::vector<short> inClus;
+      std::vector<bool> mergeAvailable;
+      std::vector<ClusterStore> tcl;
+      std::vector<VtxStore> vtx;
+      details::CrawlState state; ///< state at the end of the plane, if lastPlane
+    };
+
+    // Resets the crawling state, as at the start of each plane
+    void ResetCrawlState() { static_cast<details::CrawlState&>(*this) = details::CrawlState(); }
+    // Crawls all of the planes of a TPC
+    void CrawlTPC(geo::TPCID const& tpcid);
+    // Crawls the hits in one plane. Returns false if there is nothing to crawl
+    bool CrawlPlane(CTP_t inCTP);
+    // Sets the scale factor, the large angle slope cut and the number of time
+    // samples, with the wire pitch of the view of channel
+    void SetCrawlConstants(raw::ChannelID_t channel);
+    // Crawls every plane on the fWorkers, one store per plane in the order of the TPCs
+    void CrawlPlanesConcurrently(std::vector<CTPStore>& stores);
+    // Crawls the plane of a store (on a worker)
+    void CrawlStore(CTPStore& store);
+    // Adds the stores of the planes of a TPC to the results. Returns false if the
+    // planes must be crawled again, see the implementation
+    bool MergeCTPStores(geo::TPCID const& tpcid, std::vector<CTPStore>& stores, size_t& iStore);
+    // Crawls the event again serially on a worker, with the same independent
+    // planes, and throws if the results differ
+    void CompareWithSerial(std::vector<recob::Hit> const& srchits);
+
     // Loops over wires looking for seed clusters
     void ClusterLoop();
     // Returns true if the hits on a cluster have a consistent width
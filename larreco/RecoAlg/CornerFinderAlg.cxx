@@ -22,6 +22,10 @@
 //  CornerScore_algorithm options:
 //     Noble  --- determinant / (trace + Noble_epsilon)
 //     Harris --- determinant - (trace)^2 * Harris_kappa
+//
+//  The images are processed on contiguous arrays binned like the TH2s they
+//  replace (ImageArray), one plane (or trimmed image) per task on NumThreads
+//  threads. ExportHistograms copies the intermediate images into TH2s.
 ////////////////////////////////////////////////////////////////////////
 
 
@@ -34,9 +38,34 @@
 #include "larcorealg/Geometry/TPCGeo.h"
 #include "larcorealg/Geometry/PlaneGeo.h"
 
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include <cmath>
+
 // NOTE: In the .h file I assumed this would belong in the cluster class....if
 // we decide otherwise we will need to search and replace for this
 
+namespace {
+
+  //this is just a double Gaussian
+  constexpr float func_blur[11][11] = {
+    { 0.000000, 0.000000, 0.000000, 0.000001, 0.000002, 0.000004, 0.000002, 0.000001, 0.000000, 0.000000, 0.000000 },
+    { 0.000000, 0.000000, 0.000004, 0.000045, 0.000203, 0.000335, 0.000203, 0.000045, 0.000004, 0.000000, 0.000000 },
+    { 0.000000, 0.000004, 0.000123, 0.001503, 0.006738, 0.011109, 0.006738, 0.001503, 0.000123, 0.000004, 0.000000 },
+    { 0.000001, 0.000045, 0.001503, 0.018316, 0.082085, 0.135335, 0.082085, 0.018316, 0.001503, 0.000045, 0.000001 },
+    { 0.000002, 0.000203, 0.006738, 0.082085, 0.367879, 0.606531, 0.367879, 0.082085, 0.006738, 0.000203, 0.000002 },
+    { 0.000004, 0.000335, 0.011109, 0.135335, 0.606531, 1.000000, 0.606531, 0.135335, 0.011109, 0.000335, 0.000004 },
+    { 0.000002, 0.000203, 0.006738, 0.082085, 0.367879, 0.606531, 0.367879, 0.082085, 0.006738, 0.000203, 0.000002 },
+    { 0.000001, 0.000045, 0.001503, 0.018316, 0.082085, 0.135335, 0.082085, 0.018316, 0.001503, 0.000045, 0.000001 },
+    { 0.000000, 0.000004, 0.000123, 0.001503, 0.006738, 0.011109, 0.006738, 0.001503, 0.000123, 0.000004, 0.000000 },
+    { 0.000000, 0.000000, 0.000004, 0.000045, 0.000203, 0.000335, 0.000203, 0.000045, 0.000004, 0.000000, 0.000000 },
+    { 0.000000, 0.000000, 0.000000, 0.000001, 0.000002, 0.000004, 0.000002, 0.000001, 0.000000, 0.000000, 0.000000 }
+  };
+  constexpr int func_blur_neighborhood = 5;
+
+}
+
 
 //-----------------------------------------------------------------------------
 corner::CornerFinderAlg::CornerFinderAlg(fhicl::ParameterSet const& pset)
@@ -65,9 +94,9 @@ void corner::CornerFinderAlg::CleanCornerFinderAlg()
   WireData_histos_ProjectionX.clear();
   WireData_histos_ProjectionY.clear();
   WireData_IDs.clear();
+  WireData_images.clear();
 
-  //for (auto wd_histo : WireData_trimmed_histos) delete std::get<1>(wd_histo);
-  WireData_trimmed_histos.clear();
+  WireData_trimmed_images.clear();
 
 }
 
@@ -96,6 +125,21 @@ void corner::CornerFinderAlg::reconfigure(fhicl::ParameterSet const& p)
   fMaxSuppress_threshold		 = p.get< int		 >("MaxSuppress_threshold");
   fIntegral_bin_threshold                = p.get< float          >("Integral_bin_threshold");
   fIntegral_fraction_threshold           = p.get< float          >("Integral_fraction_threshold");
+  fNumThreads                            = std::max(p.get< unsigned int >("NumThreads",1),1u);
+  fExportHistograms                      = p.get< bool           >("ExportHistograms",false);
+
+  if(fDerivative_BlurNeighborhood>func_blur_neighborhood){
+    mf::LogWarning("CornerFinderAlg") << "WARNING...BlurNeighborhoods>" << func_blur_neighborhood
+				      << " not currently allowed. Shrinking to " << func_blur_neighborhood << ".";
+    fDerivative_BlurNeighborhood=func_blur_neighborhood;
+  }
+
+  // The conversion function only ever gets evaluated on the neighborhood of a bin
+  const TF2 fConversion_TF2("fConversion_func",fConversion_func.c_str(),-20,20,-20,20);
+  fConversion_weights.clear();
+  for(int dx=-fConversion_func_neighborhood; dx<=fConversion_func_neighborhood; dx++)
+    for(int dy=-fConversion_func_neighborhood; dy<=fConversion_func_neighborhood; dy++)
+      fConversion_weights.push_back(fConversion_TF2.Eval(dx,dy));
 
   int neighborhoods[] = { fConversion_func_neighborhood,
 			  fDerivative_neighborhood,
@@ -116,11 +160,7 @@ void corner::CornerFinderAlg::InitializeGeometry(geo::Geometry const& my_geometr
   WireData_histos.resize(nPlanes);
   WireData_histos_ProjectionX.resize(nPlanes);
   WireData_histos_ProjectionY.resize(nPlanes);
-  //  fConversion_histos.resize(nPlanes);
-  //  fDerivativeX_histos.resize(nPlanes);
-  //  fDerivativeY_histos.resize(nPlanes);
-  //  fCornerScore_histos.resize(nPlanes);
-  //  fMaxSuppress_histos.resize(nPlanes);
+  WireData_images.resize(nPlanes);
 
   /* For now, we need something to associate each wire in the histogram with a wire_id.
      This is not a beautiful way of handling this, but for now it should work. */
@@ -128,7 +168,7 @@ void corner::CornerFinderAlg::InitializeGeometry(geo::Geometry const& my_geometr
   for(unsigned int i_plane=0; i_plane < nPlanes; ++i_plane)
     WireData_IDs.at(i_plane).resize(my_geometry.Nwires(i_plane));
 
-  WireData_trimmed_histos.resize(0);
+  WireData_trimmed_images.resize(0);
 
 }
 
@@ -161,6 +201,9 @@ void corner::CornerFinderAlg::GrabWires( std::vector<recob::Wire> const& wireVec
 					 nTimeTicks,
 					 0,
 					 nTimeTicks);
+
+    WireData_images.at(i_plane).Reset(my_geometry.Nwires(i_plane),0,my_geometry.Nwires(i_plane),
+				      nTimeTicks,0,nTimeTicks);
   }
 
 
@@ -177,8 +220,13 @@ void corner::CornerFinderAlg::GrabWires( std::vector<recob::Wire> const& wireVec
 
     WireData_IDs.at(i_plane).at(i_wire) = this_wireID;
 
+    // Signal() uncompresses the regions of interest each time, do it once
+    const std::vector<float> signal = iwire->Signal();
+    float* image_ticks = WireData_images.at(i_plane).Column(i_wire);
+
     for(unsigned int i_time = 0; i_time < nTimeTicks; i_time++){
-      WireData_histos.at(i_plane).SetBinContent(i_wire,i_time,(iwire->Signal()).at(i_time));
+      WireData_histos.at(i_plane).SetBinContent(i_wire,i_time,signal.at(i_time));
+      image_ticks[i_time] = signal[i_time];
     }//<---End time loop
 
   }//<-- End loop over wires
@@ -198,14 +246,26 @@ void corner::CornerFinderAlg::GrabWires( std::vector<recob::Wire> const& wireVec
 void corner::CornerFinderAlg::get_feature_points(std::vector<recob::EndPoint2D> & corner_vector,
 						 geo::Geometry const& my_geometry){
 
+  std::vector<geo::PlaneID> planeIDs;
+  for(auto const& pid : my_geometry.IteratePlaneIDs()) planeIDs.push_back(pid);
 
+  std::vector< std::vector<recob::EndPoint2D> > plane_corners(planeIDs.size());
+  std::vector<ImageSet> imageSets(fExportHistograms ? planeIDs.size() : 0);
 
-  for(auto const& pid : my_geometry.IteratePlaneIDs()){
-    attach_feature_points(WireData_histos.at(pid.Plane),
-			  WireData_IDs.at(pid.Plane),
-			  my_geometry.View(pid),
-			  corner_vector);
-  }
+  run_concurrently(planeIDs.size(), [&](size_t i_pid){
+      ImageSet images;
+      auto const& pid = planeIDs[i_pid];
+      attach_feature_points(WireData_images.at(pid.Plane),
+			    WireData_IDs.at(pid.Plane),
+			    my_geometry.View(pid),
+			    plane_corners[i_pid],
+			    fExportHistograms ? imageSets[i_pid] : images);
+    });
+
+  for(auto const& corners : plane_corners)
+    corner_vector.insert(corner_vector.end(),corners.begin(),corners.end());
+
+  export_histograms(imageSets);
 
 }
 
@@ -218,29 +278,44 @@ void corner::CornerFinderAlg::get_feature_points_fast(std::vector<recob::EndPoin
 
   create_smaller_histos(my_geometry);
 
+  // (cryostat, tpc, trimmed image) in the order the points are collected
+  std::vector< std::tuple<unsigned int,unsigned int,size_t> > jobs;
   for(unsigned int cstat = 0; cstat < my_geometry.Ncryostats(); ++cstat){
     for(unsigned int tpc = 0; tpc < my_geometry.Cryostat(cstat).NTPC(); ++tpc){
-      for(size_t histos=0; histos!= WireData_trimmed_histos.size(); histos++){
+      for(size_t histos=0; histos!= WireData_trimmed_images.size(); histos++)
+	jobs.emplace_back(cstat,tpc,histos);
+    }
+  }
 
-	int plane = std::get<0>(WireData_trimmed_histos.at(histos));
-	int startx = std::get<2>(WireData_trimmed_histos.at(histos));
-	int starty = std::get<3>(WireData_trimmed_histos.at(histos));
+  std::vector< std::vector<recob::EndPoint2D> > job_corners(jobs.size());
+  std::vector<ImageSet> imageSets(fExportHistograms ? jobs.size() : 0);
 
-	MF_LOG_DEBUG("CornerFinderAlg")
-	  << "Doing histogram " << histos
-	  << ", of plane " << plane
-	  << " with start points " << startx << " " << starty;
+  run_concurrently(jobs.size(), [&](size_t i_job){
+      auto const [cstat, tpc, histos] = jobs[i_job];
 
-	attach_feature_points(std::get<1>(WireData_trimmed_histos.at(histos)),
-			      WireData_IDs.at(plane),my_geometry.Cryostat(cstat).TPC(tpc).Plane(plane).View(),corner_vector,startx,starty);
+      int plane = std::get<0>(WireData_trimmed_images.at(histos));
+      int startx = std::get<2>(WireData_trimmed_images.at(histos));
+      int starty = std::get<3>(WireData_trimmed_images.at(histos));
 
-	MF_LOG_DEBUG("CornerFinderAlg") << "Total feature points now is " << corner_vector.size();
-      }
+      MF_LOG_DEBUG("CornerFinderAlg")
+	<< "Doing histogram " << histos
+	<< ", of plane " << plane
+	<< " with start points " << startx << " " << starty;
 
-      //remove_duplicates(corner_vector);
+      ImageSet images;
+      attach_feature_points(std::get<1>(WireData_trimmed_images.at(histos)),
+			    WireData_IDs.at(plane),my_geometry.Cryostat(cstat).TPC(tpc).Plane(plane).View(),job_corners[i_job],
+			    fExportHistograms ? imageSets[i_job] : images,startx,starty);
 
-    }
-  }
+      MF_LOG_DEBUG("CornerFinderAlg") << "Feature points in this histogram " << job_corners[i_job].size();
+    });
+
+  for(auto const& corners : job_corners)
+    corner_vector.insert(corner_vector.end(),corners.begin(),corners.end());
+
+  MF_LOG_DEBUG("CornerFinderAlg") << "Total feature points now is " << corner_vector.size();
+
+  export_histograms(imageSets);
 
 }
 
@@ -250,13 +325,67 @@ void corner::CornerFinderAlg::get_feature_points_fast(std::vector<recob::EndPoin
 void corner::CornerFinderAlg::get_feature_points_LineIntegralScore(std::vector<recob::EndPoint2D> & corner_vector,
 								   geo::Geometry const& my_geometry){
 
+  std::vector<geo::PlaneID> planeIDs;
+  for(auto const& pid : my_geometry.IteratePlaneIDs()) planeIDs.push_back(pid);
+
+  std::vector< std::vector<recob::EndPoint2D> > plane_corners(planeIDs.size());
+  std::vector<ImageSet> imageSets(fExportHistograms ? planeIDs.size() : 0);
+
+  run_concurrently(planeIDs.size(), [&](size_t i_pid){
+      ImageSet images;
+      auto const& pid = planeIDs[i_pid];
+      attach_feature_points_LineIntegralScore(WireData_images.at(pid.Plane),
+					      WireData_histos.at(pid.Plane),
+					      WireData_IDs.at(pid.Plane),
+					      my_geometry.View(pid),
+					      plane_corners[i_pid],
+					      fExportHistograms ? imageSets[i_pid] : images);
+    });
+
+  for(auto const& corners : plane_corners)
+    corner_vector.insert(corner_vector.end(),corners.begin(),corners.end());
+
+  export_histograms(imageSets);
+
+}
+
+//-----------------------------------------------------------------------------------
+template <typename Func>
+void corner::CornerFinderAlg::run_concurrently(size_t n, Func const& func) const {
+
+  if(fNumThreads<2 || n<2){
+    for(size_t i=0; i<n; i++) func(i);
+    return;
+  }
+
+  tbb::task_arena arena(std::min(size_t(fNumThreads),n));
+  arena.execute([&]{ tbb::parallel_for(size_t(0),n,func); });
 
+}
 
-  for(auto const& pid : my_geometry.IteratePlaneIDs()){
-    attach_feature_points_LineIntegralScore(WireData_histos.at(pid.Plane),
-					    WireData_IDs.at(pid.Plane),
-					    my_geometry.View(pid),
-					    corner_vector);
+//-----------------------------------------------------------------------------------
+// ROOT objects get made here, after the (possibly concurrent) image processing
+void corner::CornerFinderAlg::export_histograms(std::vector<ImageSet> const& imageSets){
+
+  fConversion_histos.clear();
+  fDerivativeX_histos.clear();
+  fDerivativeY_histos.clear();
+  fCornerScore_histos.clear();
+  fMaxSuppress_histos.clear();
+
+  for(auto const& images : imageSets){
+
+    std::stringstream conversion_name;  conversion_name  << "h_conversion_"   << images.view << "_" << run_number << "_" << event_number;
+    std::stringstream dx_name;          dx_name          << "h_derivative_x_" << images.view << "_" << run_number << "_" << event_number;
+    std::stringstream dy_name;          dy_name          << "h_derivative_y_" << images.view << "_" << run_number << "_" << event_number;
+    std::stringstream cornerScore_name; cornerScore_name << "h_cornerScore_"  << images.view << "_" << run_number << "_" << event_number;
+    std::stringstream maxSuppress_name; maxSuppress_name << "h_maxSuppress_"  << images.view << "_" << run_number << "_" << event_number;
+
+    fConversion_histos.push_back(images.conversion.MakeHistogram<TH2F>(conversion_name.str(),"Image Conversion Histogram"));
+    fDerivativeX_histos.push_back(images.derivativeX.MakeHistogram<TH2F>(dx_name.str(),"Partial Derivatives (x)"));
+    fDerivativeY_histos.push_back(images.derivativeY.MakeHistogram<TH2F>(dy_name.str(),"Partial Derivatives (y)"));
+    fCornerScore_histos.push_back(images.cornerScore.MakeHistogram<TH2D>(cornerScore_name.str(),"Corner Score"));
+    fMaxSuppress_histos.push_back(images.maxSuppress.MakeHistogram<TH2D>(maxSuppress_name.str(),"Corner Points (Maximum Suppressed)"));
   }
 
 }
@@ -481,19 +610,17 @@ void corner::CornerFinderAlg::create_smaller_histos(geo::Geometry const& my_geom
 
     for(size_t il=0; il<x_low.size(); il++){
 
-      std::stringstream h_name;
-      h_name << "h_" << pid.Cryostat << "_" << pid.TPC << "_" << pid.Plane << "_sub" << il;
-      TH2F h_tmp( (h_name.str()).c_str(),"",
-		  x_high.at(il)-x_low.at(il)+1,x_low.at(il),x_high.at(il),
-		  y_high.at(il)-y_low.at(il)+1,y_low.at(il),y_high.at(il));
+      ImageArray<float> image_tmp;
+      image_tmp.Reset(x_high.at(il)-x_low.at(il)+1,x_low.at(il),x_high.at(il),
+		      y_high.at(il)-y_low.at(il)+1,y_low.at(il),y_high.at(il));
 
       for(int ix=1; ix<=(x_high.at(il)-x_low.at(il)+1); ix++){
 	for(int iy=1; iy<=(y_high.at(il)-y_low.at(il)+1); iy++){
-	  h_tmp.SetBinContent(ix,iy,WireData_histos.at(pid.Plane).GetBinContent(x_low.at(il)+(ix-1),y_low.at(il)+(iy-1)));
+	  image_tmp(ix,iy) = WireData_images.at(pid.Plane).GetBinContent(x_low.at(il)+(ix-1),y_low.at(il)+(iy-1));
 	}
       }
 
-      WireData_trimmed_histos.push_back(std::make_tuple(pid.Plane,h_tmp,x_low.at(il)-1,y_low.at(il)-1));
+      WireData_trimmed_images.push_back(std::make_tuple(pid.Plane,std::move(image_tmp),x_low.at(il)-1,y_low.at(il)-1));
     }
 
   }// end loop over PlaneIDs
@@ -502,175 +629,125 @@ void corner::CornerFinderAlg::create_smaller_histos(geo::Geometry const& my_geom
 }
 
 //-----------------------------------------------------------------------------
-// This puts on all the feature points in a given view, using a given data histogram
-void corner::CornerFinderAlg::attach_feature_points( TH2F const& h_wire_data,
-						     std::vector<geo::WireID> wireIDs,
+// This puts on all the feature points in a given view, using a given data image
+void corner::CornerFinderAlg::attach_feature_points( ImageArray<float> const& wire_data,
+						     std::vector<geo::WireID> const& wireIDs,
 						     geo::View_t view,
 						     std::vector<recob::EndPoint2D> & corner_vector,
+						     ImageSet& images,
 						     int startx,
-						     int starty){
+						     int starty) const {
 
 
-  const int x_bins = h_wire_data.GetNbinsX();
-  const float x_min = h_wire_data.GetXaxis()->GetBinLowEdge(1);
-  const float x_max = h_wire_data.GetXaxis()->GetBinUpEdge(x_bins);
+  const int x_bins = wire_data.NBinsX();
+  const float x_min = wire_data.XMin();
+  const float x_max = wire_data.XMax();
 
-  const int y_bins = h_wire_data.GetNbinsY();
-  const float y_min = h_wire_data.GetYaxis()->GetBinLowEdge(1);
-  const float y_max = h_wire_data.GetYaxis()->GetBinUpEdge(y_bins);
+  const int y_bins = wire_data.NBinsY();
+  const float y_min = wire_data.YMin();
+  const float y_max = wire_data.YMax();
 
   const int converted_y_bins = y_bins/fConversion_bins_per_input_y;
   const int converted_x_bins = x_bins/fConversion_bins_per_input_x;
 
-  std::stringstream conversion_name;  conversion_name  << "h_conversion_"   << view << "_" << run_number << "_" << event_number;
-  std::stringstream dx_name;          dx_name          << "h_derivative_x_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream dy_name;          dy_name          << "h_derivative_y_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream cornerScore_name; cornerScore_name << "h_cornerScore_"  << view << "_" << run_number << "_" << event_number;
-  std::stringstream maxSuppress_name; maxSuppress_name << "h_maxSuppress_"  << view << "_" << run_number << "_" << event_number;
-
-  TH2F conversion_histo(conversion_name.str().c_str(),"Image Conversion Histogram",
-			 converted_x_bins,x_min,x_max,
-			 converted_y_bins,y_min,y_max);
-
-  TH2F derivativeX_histo(dx_name.str().c_str(),"Partial Derivatives (x)",
-			  converted_x_bins,x_min,x_max,
-			  converted_y_bins,y_min,y_max);
-
-  TH2F derivativeY_histo(dy_name.str().c_str(),"Partial Derivatives (y)",
-			  converted_x_bins,x_min,x_max,
-			  converted_y_bins,y_min,y_max);
-
-  TH2D cornerScore_histo(cornerScore_name.str().c_str(),"Corner Score",
-			 converted_x_bins,x_min,x_max,
-			 converted_y_bins,y_min,y_max);
-
-  TH2D maxSuppress_histo(maxSuppress_name.str().c_str(),"Corner Points (Maximum Suppressed)",
-			 converted_x_bins,x_min,x_max,
-			 converted_y_bins,y_min,y_max);
-
-  create_image_histo(h_wire_data,conversion_histo);
-  create_derivative_histograms(conversion_histo,derivativeX_histo,derivativeY_histo);
-  create_cornerScore_histogram(derivativeX_histo,derivativeY_histo,cornerScore_histo);
-  perform_maximum_suppression(cornerScore_histo,corner_vector,wireIDs,view,maxSuppress_histo,startx,starty);
+  images.view = view;
+  images.conversion.Reset(converted_x_bins,x_min,x_max,converted_y_bins,y_min,y_max);
+  images.derivativeX.Reset(converted_x_bins,x_min,x_max,converted_y_bins,y_min,y_max);
+  images.derivativeY.Reset(converted_x_bins,x_min,x_max,converted_y_bins,y_min,y_max);
+  images.cornerScore.Reset(converted_x_bins,x_min,x_max,converted_y_bins,y_min,y_max);
+  images.maxSuppress.Reset(converted_x_bins,x_min,x_max,converted_y_bins,y_min,y_max);
+
+  create_image(wire_data,images.conversion);
+  create_derivatives(images.conversion,images.derivativeX,images.derivativeY);
+  create_cornerScore(images.derivativeX,images.derivativeY,images.cornerScore);
+  perform_maximum_suppression(images.cornerScore,corner_vector,wireIDs,view,images.maxSuppress,startx,starty);
 }
 
 
 //-----------------------------------------------------------------------------
-// This puts on all the feature points in a given view, using a given data histogram
-void corner::CornerFinderAlg::attach_feature_points_LineIntegralScore(TH2F const& h_wire_data,
-								       std::vector<geo::WireID> wireIDs,
+// This puts on all the feature points in a given view, using a given data image
+void corner::CornerFinderAlg::attach_feature_points_LineIntegralScore(ImageArray<float> const& wire_data,
+								       TH2F const& h_wire_data,
+								       std::vector<geo::WireID> const& wireIDs,
 								       geo::View_t view,
-								       std::vector<recob::EndPoint2D> & corner_vector){
-
-
-  const int   x_bins = h_wire_data.GetNbinsX();
-  const float x_min  = h_wire_data.GetXaxis()->GetBinLowEdge(1);
-  const float x_max  = h_wire_data.GetXaxis()->GetBinUpEdge(x_bins);
-
-  const int   y_bins = h_wire_data.GetNbinsY();
-  const float y_min  = h_wire_data.GetYaxis()->GetBinLowEdge(1);
-  const float y_max  = h_wire_data.GetYaxis()->GetBinUpEdge(y_bins);
-
-  const int converted_y_bins = y_bins/fConversion_bins_per_input_y;
-  const int converted_x_bins = x_bins/fConversion_bins_per_input_x;
-
-  std::stringstream conversion_name;  conversion_name  << "h_conversion_"   << view << "_" << run_number << "_" << event_number;
-  std::stringstream dx_name;          dx_name          << "h_derivative_x_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream dy_name;          dy_name          << "h_derivative_y_" << view << "_" << run_number << "_" << event_number;
-  std::stringstream cornerScore_name; cornerScore_name << "h_cornerScore_"  << view << "_" << run_number << "_" << event_number;
-  std::stringstream maxSuppress_name; maxSuppress_name << "h_maxSuppress_"  << view << "_" << run_number << "_" << event_number;
-
-  TH2F h_conversion  ((conversion_name.str()).c_str(),
-		      "Image Conversion Histogram",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-  TH2F h_derivative_x((dx_name.str()).c_str(),
-		      "Partial Derivatives (x)",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-  TH2F h_derivative_y((dy_name.str()).c_str(),
-		      "Partial Derivatives (y)",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-  TH2D h_cornerScore ((cornerScore_name.str()).c_str(),
-		      "Feature Point Corner Score",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-  TH2D h_maxSuppress ((maxSuppress_name.str()).c_str(),
-		      "Corner Points (Maximum Suppressed)",
-		      converted_x_bins,x_min,x_max,
-		      converted_y_bins,y_min,y_max);
-
-  create_image_histo(h_wire_data,h_conversion);
-  create_derivative_histograms(h_conversion,h_derivative_x,h_derivative_y);
-  create_cornerScore_histogram(h_derivative_x,h_derivative_y,h_cornerScore);
+								       std::vector<recob::EndPoint2D> & corner_vector,
+								       ImageSet& images) const {
 
   std::vector<recob::EndPoint2D> corner_vector_tmp;
-  perform_maximum_suppression(h_cornerScore,corner_vector_tmp,wireIDs,view,h_maxSuppress);
+  attach_feature_points(wire_data,wireIDs,view,corner_vector_tmp,images);
 
-  std::stringstream LI_name; LI_name << "h_lineIntegralScore_" << view << "_" << run_number << "_" << event_number;
-  TH2F h_lineIntegralScore((LI_name.str()).c_str(),
-			   "Line Integral Score",
-			   x_bins,x_min,x_max,
-			   y_bins,y_min,y_max);
-  calculate_line_integral_score(h_wire_data,corner_vector_tmp,corner_vector,h_lineIntegralScore);
+  calculate_line_integral_score(h_wire_data,corner_vector_tmp,corner_vector);
 
 }
 
 
 //-----------------------------------------------------------------------------
 // Convert to pixel
-void corner::CornerFinderAlg::create_image_histo(TH2F const& h_wire_data, TH2F & h_conversion) const {
+void corner::CornerFinderAlg::create_image(ImageArray<float> const& wire_data, ImageArray<float> & conversion) const {
 
-  double temp_integral=0;
+  const int x_bins = conversion.NBinsX();
+  const int y_bins = conversion.NBinsY();
+  const int n = fConversion_func_neighborhood;
 
-  const TF2 fConversion_TF2("fConversion_func",fConversion_func.c_str(),-20,20,-20,20);
+  // The common conversions are a threshold on each bin, done a wire at a time
+  if(fConversion_algorithm.compare("standard")==0 || fConversion_algorithm.compare("binary")==0){
 
-  for(int ix=1; ix<=h_conversion.GetNbinsX(); ix++){
-    for(int iy=1; iy<=h_conversion.GetNbinsY(); iy++){
+    const bool binary = (fConversion_algorithm.compare("binary")==0);
+    const float above = 10*fConversion_threshold;
 
-      temp_integral = h_wire_data.Integral(ix,ix,iy,iy);
+    for(int ix=1; ix<=x_bins; ix++){
+      const float* data = wire_data.Column(ix);
+      float* converted = conversion.Column(ix);
+      for(int iy=1; iy<=y_bins; iy++){
+	const float value = data[iy];
+	converted[iy] = (value > fConversion_threshold) ? (binary ? above : value) : fConversion_threshold;
+      }
+    }
+    return;
+  }
 
-      if( temp_integral > fConversion_threshold){
+  double temp_integral=0;
 
-	if(fConversion_algorithm.compare("binary")==0)
-	  h_conversion.SetBinContent(ix,iy,10*fConversion_threshold);
-	else if(fConversion_algorithm.compare("standard")==0)
-	  h_conversion.SetBinContent(ix,iy,temp_integral);
+  for(int ix=1; ix<=x_bins; ix++){
+    for(int iy=1; iy<=y_bins; iy++){
+
+      temp_integral = wire_data(ix,iy);
+
+      if( temp_integral > fConversion_threshold){
 
-	else if(fConversion_algorithm.compare("function")==0){
+	if(fConversion_algorithm.compare("function")==0){
 
 	  temp_integral = 0;
-	  for(int jx=ix-fConversion_func_neighborhood; jx<=ix+fConversion_func_neighborhood; jx++){
-	    for(int jy=iy-fConversion_func_neighborhood; jy<=iy+fConversion_func_neighborhood; jy++){
-	      temp_integral += h_wire_data.GetBinContent(jx,jy)*fConversion_TF2.Eval(ix-jx,iy-jy);
+	  for(int jx=ix-n; jx<=ix+n; jx++){
+	    for(int jy=iy-n; jy<=iy+n; jy++){
+	      temp_integral += wire_data.GetBinContent(jx,jy)*fConversion_weights[(ix-jx+n)*(2*n+1)+(iy-jy+n)];
 	    }
 	  }
-	  h_conversion.SetBinContent(ix,iy,temp_integral);
+	  conversion(ix,iy) = temp_integral;
 	}
 
 	else if(fConversion_algorithm.compare("skeleton")==0){
 
-	  if( (temp_integral > h_wire_data.GetBinContent(ix-1,iy) && temp_integral > h_wire_data.GetBinContent(ix+1,iy))
-	      || (temp_integral > h_wire_data.GetBinContent(ix,iy-1) && temp_integral > h_wire_data.GetBinContent(ix,iy+1)))
-	    h_conversion.SetBinContent(ix,iy,temp_integral);
+	  if( (temp_integral > wire_data.GetBinContent(ix-1,iy) && temp_integral > wire_data.GetBinContent(ix+1,iy))
+	      || (temp_integral > wire_data.GetBinContent(ix,iy-1) && temp_integral > wire_data.GetBinContent(ix,iy+1)))
+	    conversion(ix,iy) = temp_integral;
 	  else
-	    h_conversion.SetBinContent(ix,iy,fConversion_threshold);
+	    conversion(ix,iy) = fConversion_threshold;
 	}
 	else if(fConversion_algorithm.compare("sk_bin")==0){
 
-	  if( (temp_integral > h_wire_data.GetBinContent(ix-1,iy) && temp_integral > h_wire_data.GetBinContent(ix+1,iy))
-	      || (temp_integral > h_wire_data.GetBinContent(ix,iy-1) && temp_integral > h_wire_data.GetBinContent(ix,iy+1)))
-	    h_conversion.SetBinContent(ix,iy,10*fConversion_threshold);
+	  if( (temp_integral > wire_data.GetBinContent(ix-1,iy) && temp_integral > wire_data.GetBinContent(ix+1,iy))
+	      || (temp_integral > wire_data.GetBinContent(ix,iy-1) && temp_integral > wire_data.GetBinContent(ix,iy+1)))
+	    conversion(ix,iy) = 10*fConversion_threshold;
 	  else
-	    h_conversion.SetBinContent(ix,iy,fConversion_threshold);
+	    conversion(ix,iy) = fConversion_threshold;
 	}
 	else
-	  h_conversion.SetBinContent(ix,iy,temp_integral);
+	  conversion(ix,iy) = temp_integral;
       }
 
       else
-	h_conversion.SetBinContent(ix,iy,fConversion_threshold);
+	conversion(ix,iy) = fConversion_threshold;
 
     }
   }
@@ -679,242 +756,136 @@ void corner::CornerFinderAlg::create_image_histo(TH2F const& h_wire_data, TH2F &
 
 //-----------------------------------------------------------------------------
 // Derivative
+// The masks are applied a wire at a time, over contiguous runs of ticks
 
-void corner::CornerFinderAlg::create_derivative_histograms(TH2F const& h_conversion, TH2F & h_derivative_x, TH2F & h_derivative_y){
+void corner::CornerFinderAlg::create_derivatives(ImageArray<float> const& conversion, ImageArray<float> & derivative_x, ImageArray<float> & derivative_y) const {
 
-  const int x_bins = h_conversion.GetNbinsX();
-  const int y_bins = h_conversion.GetNbinsY();
+  const int x_bins = conversion.NBinsX();
+  const int y_bins = conversion.NBinsY();
+  const int n = fDerivative_neighborhood;
 
-  for(int iy=1+fDerivative_neighborhood; iy<=(y_bins-fDerivative_neighborhood); iy++){
-    for(int ix=1+fDerivative_neighborhood; ix<=(x_bins-fDerivative_neighborhood); ix++){
+  const int iy_first = 1+n;
+  const int iy_last = y_bins-n;
 
-      if(fDerivative_method.compare("Sobel")==0){
-
-	if(fDerivative_neighborhood==1){
-	  h_derivative_x.SetBinContent(ix,iy,
-					0.5*(h_conversion.GetBinContent(ix+1,iy)-h_conversion.GetBinContent(ix-1,iy))
-					+ 0.25*(h_conversion.GetBinContent(ix+1,iy+1)-h_conversion.GetBinContent(ix-1,iy+1))
-					+ 0.25*(h_conversion.GetBinContent(ix+1,iy-1)-h_conversion.GetBinContent(ix-1,iy-1)));
-	  h_derivative_y.SetBinContent(ix,iy,
-					0.5*(h_conversion.GetBinContent(ix,iy+1)-h_conversion.GetBinContent(ix,iy-1))
-					+ 0.25*(h_conversion.GetBinContent(ix-1,iy+1)-h_conversion.GetBinContent(ix-1,iy-1))
-					+ 0.25*(h_conversion.GetBinContent(ix+1,iy+1)-h_conversion.GetBinContent(ix+1,iy-1)));
-	}
-	else if(fDerivative_neighborhood==2){
-	  h_derivative_x.SetBinContent(ix,iy,
-					12*(h_conversion.GetBinContent(ix+1,iy)-h_conversion.GetBinContent(ix-1,iy))
-					+ 8*(h_conversion.GetBinContent(ix+1,iy+1)-h_conversion.GetBinContent(ix-1,iy+1))
-					+ 8*(h_conversion.GetBinContent(ix+1,iy-1)-h_conversion.GetBinContent(ix-1,iy-1))
-					+ 2*(h_conversion.GetBinContent(ix+1,iy+2)-h_conversion.GetBinContent(ix-1,iy+2))
-					+ 2*(h_conversion.GetBinContent(ix+1,iy-2)-h_conversion.GetBinContent(ix-1,iy-2))
-					  + 6*(h_conversion.GetBinContent(ix+2,iy)-h_conversion.GetBinContent(ix-2,iy))
-					+ 4*(h_conversion.GetBinContent(ix+2,iy+1)-h_conversion.GetBinContent(ix-2,iy+1))
-					+ 4*(h_conversion.GetBinContent(ix+2,iy-1)-h_conversion.GetBinContent(ix-2,iy-1))
-					+ 1*(h_conversion.GetBinContent(ix+2,iy+2)-h_conversion.GetBinContent(ix-2,iy+2))
-					  + 1*(h_conversion.GetBinContent(ix+2,iy-2)-h_conversion.GetBinContent(ix-2,iy-2)));
-	  h_derivative_y.SetBinContent(ix,iy,
-					12*(h_conversion.GetBinContent(ix,iy+1)-h_conversion.GetBinContent(ix,iy-1))
-					+ 8*(h_conversion.GetBinContent(ix-1,iy+1)-h_conversion.GetBinContent(ix-1,iy-1))
-					+ 8*(h_conversion.GetBinContent(ix+1,iy+1)-h_conversion.GetBinContent(ix+1,iy-1))
-					+ 2*(h_conversion.GetBinContent(ix-2,iy+1)-h_conversion.GetBinContent(ix-2,iy-1))
-					+ 2*(h_conversion.GetBinContent(ix+2,iy+1)-h_conversion.GetBinContent(ix+2,iy-1))
-					+ 6*(h_conversion.GetBinContent(ix,iy+2)-h_conversion.GetBinContent(ix,iy-2))
-					+ 4*(h_conversion.GetBinContent(ix-1,iy+2)-h_conversion.GetBinContent(ix-1,iy-2))
-					+ 4*(h_conversion.GetBinContent(ix+1,iy+2)-h_conversion.GetBinContent(ix+1,iy-2))
-					+ 1*(h_conversion.GetBinContent(ix-2,iy+2)-h_conversion.GetBinContent(ix-2,iy-2))
-					+ 1*(h_conversion.GetBinContent(ix+2,iy+2)-h_conversion.GetBinContent(ix+2,iy-2)));
-	}
-	else{
-	  mf::LogError("CornerFinderAlg") << "Sobel derivative not supported for neighborhoods > 2.";
-	  return;
-	}
+  if(iy_first<=iy_last && 1+n<=x_bins-n){
+    if(fDerivative_method.compare("Sobel")==0){
+      if(n!=1 && n!=2){
+	mf::LogError("CornerFinderAlg") << "Sobel derivative not supported for neighborhoods > 2.";
+	return;
+      }
+    }
+    else if(fDerivative_method.compare("local")==0){
+      if(n!=1){
+	mf::LogError("CornerFinderAlg") << "Local derivative not yet supported for neighborhoods > 1.";
+	return;
+      }
+    }
+    else{
+      mf::LogError("CornerFinderAlg") << "Bad derivative algorithm! " << fDerivative_method;
+      return;
+    }
+  }
 
-	} //end if Sobel
+  const bool sobel = (fDerivative_method.compare("Sobel")==0);
 
-      else if(fDerivative_method.compare("local")==0){
+  for(int ix=1+n; ix<=(x_bins-n); ix++){
 
-	if(fDerivative_neighborhood==1){
-	  h_derivative_x.SetBinContent(ix,iy,
-					(h_conversion.GetBinContent(ix+1,iy)-h_conversion.GetBinContent(ix-1,iy)));
-	  h_derivative_y.SetBinContent(ix,iy,
-					(h_conversion.GetBinContent(ix,iy+1)-h_conversion.GetBinContent(ix,iy-1)));
-	}
-	else{
-	  mf::LogError("CornerFinderAlg") << "Local derivative not yet supported for neighborhoods > 1.";
-	  return;
-	}
-      } //end if local
+    const float* cm = conversion.Column(ix-1);
+    const float* c0 = conversion.Column(ix);
+    const float* cp = conversion.Column(ix+1);
+    float* dx = derivative_x.Column(ix);
+    float* dy = derivative_y.Column(ix);
 
-      else{
-	mf::LogError("CornerFinderAlg") << "Bad derivative algorithm! " << fDerivative_method;
-	return;
+    if(sobel && n==1){
+      for(int iy=iy_first; iy<=iy_last; iy++){
+	dx[iy] = 0.5*((double)cp[iy]-(double)cm[iy])
+	  + 0.25*((double)cp[iy+1]-(double)cm[iy+1])
+	  + 0.25*((double)cp[iy-1]-(double)cm[iy-1]);
+	dy[iy] = 0.5*((double)c0[iy+1]-(double)c0[iy-1])
+	  + 0.25*((double)cm[iy+1]-(double)cm[iy-1])
+	  + 0.25*((double)cp[iy+1]-(double)cp[iy-1]);
+      }
+    }
+    else if(sobel){
+      const float* cmm = conversion.Column(ix-2);
+      const float* cpp = conversion.Column(ix+2);
+      for(int iy=iy_first; iy<=iy_last; iy++){
+	dx[iy] = 12*((double)cp[iy]-(double)cm[iy])
+	  + 8*((double)cp[iy+1]-(double)cm[iy+1])
+	  + 8*((double)cp[iy-1]-(double)cm[iy-1])
+	  + 2*((double)cp[iy+2]-(double)cm[iy+2])
+	  + 2*((double)cp[iy-2]-(double)cm[iy-2])
+	  + 6*((double)cpp[iy]-(double)cmm[iy])
+	  + 4*((double)cpp[iy+1]-(double)cmm[iy+1])
+	  + 4*((double)cpp[iy-1]-(double)cmm[iy-1])
+	  + 1*((double)cpp[iy+2]-(double)cmm[iy+2])
+	  + 1*((double)cpp[iy-2]-(double)cmm[iy-2]);
+	dy[iy] = 12*((double)c0[iy+1]-(double)c0[iy-1])
+	  + 8*((double)cm[iy+1]-(double)cm[iy-1])
+	  + 8*((double)cp[iy+1]-(double)cp[iy-1])
+	  + 2*((double)cmm[iy+1]-(double)cmm[iy-1])
+	  + 2*((double)cpp[iy+1]-(double)cpp[iy-1])
+	  + 6*((double)c0[iy+2]-(double)c0[iy-2])
+	  + 4*((double)cm[iy+2]-(double)cm[iy-2])
+	  + 4*((double)cp[iy+2]-(double)cp[iy-2])
+	  + 1*((double)cmm[iy+2]-(double)cmm[iy-2])
+	  + 1*((double)cpp[iy+2]-(double)cpp[iy-2]);
+      }
+    }
+    else{
+      for(int iy=iy_first; iy<=iy_last; iy++){
+	dx[iy] = ((double)cp[iy]-(double)cm[iy]);
+	dy[iy] = ((double)c0[iy+1]-(double)c0[iy-1]);
       }
-
     }
+
   }
 
+  const int blur = fDerivative_BlurNeighborhood;
 
-  //this is just a double Gaussian
-  float func_blur[11][11];
-  func_blur[0][0] = 0.000000;
-  func_blur[0][1] = 0.000000;
-  func_blur[0][2] = 0.000000;
-  func_blur[0][3] = 0.000001;
-  func_blur[0][4] = 0.000002;
-  func_blur[0][5] = 0.000004;
-  func_blur[0][6] = 0.000002;
-  func_blur[0][7] = 0.000001;
-  func_blur[0][8] = 0.000000;
-  func_blur[0][9] = 0.000000;
-  func_blur[0][10] = 0.000000;
-  func_blur[1][0] = 0.000000;
-  func_blur[1][1] = 0.000000;
-  func_blur[1][2] = 0.000004;
-  func_blur[1][3] = 0.000045;
-  func_blur[1][4] = 0.000203;
-  func_blur[1][5] = 0.000335;
-  func_blur[1][6] = 0.000203;
-  func_blur[1][7] = 0.000045;
-  func_blur[1][8] = 0.000004;
-  func_blur[1][9] = 0.000000;
-  func_blur[1][10] = 0.000000;
-  func_blur[2][0] = 0.000000;
-  func_blur[2][1] = 0.000004;
-  func_blur[2][2] = 0.000123;
-  func_blur[2][3] = 0.001503;
-  func_blur[2][4] = 0.006738;
-  func_blur[2][5] = 0.011109;
-  func_blur[2][6] = 0.006738;
-  func_blur[2][7] = 0.001503;
-  func_blur[2][8] = 0.000123;
-  func_blur[2][9] = 0.000004;
-  func_blur[2][10] = 0.000000;
-  func_blur[3][0] = 0.000001;
-  func_blur[3][1] = 0.000045;
-  func_blur[3][2] = 0.001503;
-  func_blur[3][3] = 0.018316;
-  func_blur[3][4] = 0.082085;
-  func_blur[3][5] = 0.135335;
-  func_blur[3][6] = 0.082085;
-  func_blur[3][7] = 0.018316;
-  func_blur[3][8] = 0.001503;
-  func_blur[3][9] = 0.000045;
-  func_blur[3][10] = 0.000001;
-  func_blur[4][0] = 0.000002;
-  func_blur[4][1] = 0.000203;
-  func_blur[4][2] = 0.006738;
-  func_blur[4][3] = 0.082085;
-  func_blur[4][4] = 0.367879;
-  func_blur[4][5] = 0.606531;
-  func_blur[4][6] = 0.367879;
-  func_blur[4][7] = 0.082085;
-  func_blur[4][8] = 0.006738;
-  func_blur[4][9] = 0.000203;
-  func_blur[4][10] = 0.000002;
-  func_blur[5][0] = 0.000004;
-  func_blur[5][1] = 0.000335;
-  func_blur[5][2] = 0.011109;
-  func_blur[5][3] = 0.135335;
-  func_blur[5][4] = 0.606531;
-  func_blur[5][5] = 1.000000;
-  func_blur[5][6] = 0.606531;
-  func_blur[5][7] = 0.135335;
-  func_blur[5][8] = 0.011109;
-  func_blur[5][9] = 0.000335;
-  func_blur[5][10] = 0.000004;
-  func_blur[6][0] = 0.000002;
-  func_blur[6][1] = 0.000203;
-  func_blur[6][2] = 0.006738;
-  func_blur[6][3] = 0.082085;
-  func_blur[6][4] = 0.367879;
-  func_blur[6][5] = 0.606531;
-  func_blur[6][6] = 0.367879;
-  func_blur[6][7] = 0.082085;
-  func_blur[6][8] = 0.006738;
-  func_blur[6][9] = 0.000203;
-  func_blur[6][10] = 0.000002;
-  func_blur[7][0] = 0.000001;
-  func_blur[7][1] = 0.000045;
-  func_blur[7][2] = 0.001503;
-  func_blur[7][3] = 0.018316;
-  func_blur[7][4] = 0.082085;
-  func_blur[7][5] = 0.135335;
-  func_blur[7][6] = 0.082085;
-  func_blur[7][7] = 0.018316;
-  func_blur[7][8] = 0.001503;
-  func_blur[7][9] = 0.000045;
-  func_blur[7][10] = 0.000001;
-  func_blur[8][0] = 0.000000;
-  func_blur[8][1] = 0.000004;
-  func_blur[8][2] = 0.000123;
-  func_blur[8][3] = 0.001503;
-  func_blur[8][4] = 0.006738;
-  func_blur[8][5] = 0.011109;
-  func_blur[8][6] = 0.006738;
-  func_blur[8][7] = 0.001503;
-  func_blur[8][8] = 0.000123;
-  func_blur[8][9] = 0.000004;
-  func_blur[8][10] = 0.000000;
-  func_blur[9][0] = 0.000000;
-  func_blur[9][1] = 0.000000;
-  func_blur[9][2] = 0.000004;
-  func_blur[9][3] = 0.000045;
-  func_blur[9][4] = 0.000203;
-  func_blur[9][5] = 0.000335;
-  func_blur[9][6] = 0.000203;
-  func_blur[9][7] = 0.000045;
-  func_blur[9][8] = 0.000004;
-  func_blur[9][9] = 0.000000;
-  func_blur[9][10] = 0.000000;
-  func_blur[10][0] = 0.000000;
-  func_blur[10][1] = 0.000000;
-  func_blur[10][2] = 0.000000;
-  func_blur[10][3] = 0.000001;
-  func_blur[10][4] = 0.000002;
-  func_blur[10][5] = 0.000004;
-  func_blur[10][6] = 0.000002;
-  func_blur[10][7] = 0.000001;
-  func_blur[10][8] = 0.000000;
-  func_blur[10][9] = 0.000000;
-  func_blur[10][10] = 0.000000;
-
-  double temp_integral_x = 0;
-  double temp_integral_y = 0;
-
-  if(fDerivative_BlurNeighborhood>0){
-
-    if(fDerivative_BlurNeighborhood>10){
-      mf::LogWarning("CornerFinderAlg") << "WARNING...BlurNeighborhoods>10 not currently allowed. Shrinking to 10.";
-      fDerivative_BlurNeighborhood=10;
+  if(blur>0){
+
+    // Copies of the derivatives with empty bins all around, so the blurring
+    // never needs to look out of range
+    const int stride = y_bins+2+2*blur;
+    std::vector<float> padded_x(size_t(x_bins+2+2*blur)*stride,0.);
+    std::vector<float> padded_y(padded_x.size(),0.);
+    for(int ix=1; ix<=x_bins; ix++){
+      std::copy(derivative_x.Column(ix)+1,derivative_x.Column(ix)+y_bins+1,padded_x.begin()+size_t(ix+blur)*stride+1+blur);
+      std::copy(derivative_y.Column(ix)+1,derivative_y.Column(ix)+y_bins+1,padded_y.begin()+size_t(ix+blur)*stride+1+blur);
     }
 
-    TH2F *h_clone_derivative_x = (TH2F*)h_derivative_x.Clone("h_clone_derivative_x");
-    TH2F *h_clone_derivative_y = (TH2F*)h_derivative_y.Clone("h_clone_derivative_y");
+    std::vector<double> temp_integral_x(y_bins+1);
+    std::vector<double> temp_integral_y(y_bins+1);
+
+    for(int ix=1; ix<=x_bins; ix++){
 
-    temp_integral_x = 0;
-    temp_integral_y = 0;
+      std::fill(temp_integral_x.begin(),temp_integral_x.end(),0.);
+      std::fill(temp_integral_y.begin(),temp_integral_y.end(),0.);
 
-    for(int ix=1; ix<=h_derivative_x.GetNbinsX(); ix++){
-      for(int iy=1; iy<=h_derivative_y.GetNbinsY(); iy++){
+      // Same order of the sums as bin by bin: jx, then jy, for every bin of the wire at once
+      for(int jx=ix-blur; jx<=ix+blur; jx++){
+	for(int ky=-blur; ky<=blur; ky++){
 
-	temp_integral_x = 0;
-	temp_integral_y = 0;
+	  const double weight = func_blur[(ix-jx)+func_blur_neighborhood][-ky+func_blur_neighborhood];
+	  const float* source_x = padded_x.data() + size_t(jx+blur)*stride + blur + ky;
+	  const float* source_y = padded_y.data() + size_t(jx+blur)*stride + blur + ky;
 
-	for(int jx=ix-fDerivative_BlurNeighborhood; jx<=ix+fDerivative_BlurNeighborhood; jx++){
-	  for(int jy=iy-fDerivative_BlurNeighborhood; jy<=iy+fDerivative_BlurNeighborhood; jy++){
-	    temp_integral_x += h_clone_derivative_x->GetBinContent(jx,jy)*func_blur[(ix-jx)+5][(iy-jy)+5];
-	    temp_integral_y += h_clone_derivative_y->GetBinContent(jx,jy)*func_blur[(ix-jx)+5][(iy-jy)+5];
+	  for(int iy=1; iy<=y_bins; iy++){
+	    temp_integral_x[iy] += source_x[iy]*weight;
+	    temp_integral_y[iy] += source_y[iy]*weight;
 	  }
 	}
-	h_derivative_x.SetBinContent(ix,iy,temp_integral_x);
-	h_derivative_y.SetBinContent(ix,iy,temp_integral_y);
-
       }
-    }
 
-    delete h_clone_derivative_x;
-    delete h_clone_derivative_y;
+      float* dx = derivative_x.Column(ix);
+      float* dy = derivative_y.Column(ix);
+      for(int iy=1; iy<=y_bins; iy++){
+	dx[iy] = temp_integral_x[iy];
+	dy[iy] = temp_integral_y[iy];
+      }
 
+    }
 
   } //end if blur
 
@@ -924,78 +895,99 @@ void corner::CornerFinderAlg::create_derivative_histograms(TH2F const& h_convers
 
 //-----------------------------------------------------------------------------
 // Corner Score
+// The structure tensor is summed with a window sliding along the wires, for
+// all of the ticks of a wire at once
+
+void corner::CornerFinderAlg::create_cornerScore(ImageArray<float> const& derivative_x, ImageArray<float> const& derivative_y, ImageArray<double> & cornerScore) const {
 
-void corner::CornerFinderAlg::create_cornerScore_histogram(TH2F const& h_derivative_x, TH2F const& h_derivative_y, TH2D & h_cornerScore){
+  const int x_bins = derivative_x.NBinsX();
+  const int y_bins = derivative_y.NBinsY();
+  const int n = fCornerScore_neighborhood;
 
-  const int x_bins = h_derivative_x.GetNbinsX();
-  const int y_bins = h_derivative_y.GetNbinsY();
+  const int iy_first = 1+n;
+  const int iy_last = y_bins-n;
 
-  //the structure tensor elements
-  double st_xx = 0., st_xy = 0., st_yy = 0.;
+  if(iy_first>iy_last || 1+n>x_bins-n) return;
 
-  for(int iy=1+fCornerScore_neighborhood; iy<=(y_bins-fCornerScore_neighborhood); iy++){
-    for(int ix=1+fCornerScore_neighborhood; ix<=(x_bins-fCornerScore_neighborhood); ix++){
+  const bool noble = (fCornerScore_algorithm.compare("Noble")==0);
+  if(!noble && fCornerScore_algorithm.compare("Harris")!=0){
+    mf::LogError("CornerFinderAlg") << "BAD CORNER ALGORITHM: " << fCornerScore_algorithm;
+    return;
+  }
 
-      if(ix==1+fCornerScore_neighborhood){
-	st_xx=0.; st_xy=0.; st_yy=0.;
+  const double epsilon = fCornerScore_Noble_epsilon;
+  const double kappa = fCornerScore_Harris_kappa;
 
-	for(int jx=ix-fCornerScore_neighborhood; jx<=ix+fCornerScore_neighborhood; jx++){
-	  for(int jy=iy-fCornerScore_neighborhood; jy<=iy+fCornerScore_neighborhood; jy++){
+  //the structure tensor elements, for every tick
+  std::vector<double> st_xx(y_bins+1,0.), st_xy(y_bins+1,0.), st_yy(y_bins+1,0.);
 
-	    st_xx += h_derivative_x.GetBinContent(jx,jy)*h_derivative_x.GetBinContent(jx,jy);
-	    st_yy += h_derivative_y.GetBinContent(jx,jy)*h_derivative_y.GetBinContent(jx,jy);
-	    st_xy += h_derivative_x.GetBinContent(jx,jy)*h_derivative_y.GetBinContent(jx,jy);
+  for(int ix=1+n; ix<=(x_bins-n); ix++){
 
+    if(ix==1+n){
+      for(int jx=ix-n; jx<=ix+n; jx++){
+	const float* gx = derivative_x.Column(jx);
+	const float* gy = derivative_y.Column(jx);
+	for(int ky=-n; ky<=n; ky++){
+	  for(int iy=iy_first; iy<=iy_last; iy++){
+	    const double gxv = gx[iy+ky], gyv = gy[iy+ky];
+	    st_xx[iy] += gxv*gxv;
+	    st_yy[iy] += gyv*gyv;
+	    st_xy[iy] += gxv*gyv;
 	  }
 	}
       }
+    }
 
-      // we do it this way to reduce computation time
-      else{
-	for(int jy=iy-fCornerScore_neighborhood; jy<=iy+fCornerScore_neighborhood; jy++){
-
-	  st_xx -= h_derivative_x.GetBinContent(ix-fCornerScore_neighborhood-1,jy)*h_derivative_x.GetBinContent(ix-fCornerScore_neighborhood-1,jy);
-	  st_xx += h_derivative_x.GetBinContent(ix+fCornerScore_neighborhood,jy)*h_derivative_x.GetBinContent(ix+fCornerScore_neighborhood,jy);
-
-	  st_yy -= h_derivative_y.GetBinContent(ix-fCornerScore_neighborhood-1,jy)*h_derivative_y.GetBinContent(ix-fCornerScore_neighborhood-1,jy);
-	  st_yy += h_derivative_y.GetBinContent(ix+fCornerScore_neighborhood,jy)*h_derivative_y.GetBinContent(ix+fCornerScore_neighborhood,jy);
-
-	  st_xy -= h_derivative_x.GetBinContent(ix-fCornerScore_neighborhood-1,jy)*h_derivative_y.GetBinContent(ix-fCornerScore_neighborhood-1,jy);
-	  st_xy += h_derivative_x.GetBinContent(ix+fCornerScore_neighborhood,jy)*h_derivative_y.GetBinContent(ix+fCornerScore_neighborhood,jy);
+    // we do it this way to reduce computation time
+    else{
+      const float* gx_out = derivative_x.Column(ix-n-1);
+      const float* gy_out = derivative_y.Column(ix-n-1);
+      const float* gx_in = derivative_x.Column(ix+n);
+      const float* gy_in = derivative_y.Column(ix+n);
+      for(int ky=-n; ky<=n; ky++){
+	for(int iy=iy_first; iy<=iy_last; iy++){
+	  const double gxo = gx_out[iy+ky], gyo = gy_out[iy+ky];
+	  const double gxi = gx_in[iy+ky], gyi = gy_in[iy+ky];
+
+	  st_xx[iy] -= gxo*gxo;
+	  st_xx[iy] += gxi*gxi;
+
+	  st_yy[iy] -= gyo*gyo;
+	  st_yy[iy] += gyi*gyi;
+
+	  st_xy[iy] -= gxo*gyo;
+	  st_xy[iy] += gxi*gyi;
 	}
       }
+    }
 
-      if( fCornerScore_algorithm.compare("Noble")==0 ) {
-	h_cornerScore.SetBinContent(ix,iy,
-				     (st_xx*st_yy-st_xy*st_xy) / (st_xx+st_yy + fCornerScore_Noble_epsilon));
-      }
-	else if( fCornerScore_algorithm.compare("Harris")==0 ) {
-	  h_cornerScore.SetBinContent(ix,iy,
-				       (st_xx*st_yy-st_xy*st_xy) - ((st_xx+st_yy)*(st_xx+st_yy)*fCornerScore_Harris_kappa));
-	}
-	else{
-	  mf::LogError("CornerFinderAlg") << "BAD CORNER ALGORITHM: " << fCornerScore_algorithm;
-	  return;
-	}
+    double* score = cornerScore.Column(ix);
+    if(noble){
+      for(int iy=iy_first; iy<=iy_last; iy++)
+	score[iy] = (st_xx[iy]*st_yy[iy]-st_xy[iy]*st_xy[iy]) / (st_xx[iy]+st_yy[iy] + epsilon);
+    }
+    else{
+      for(int iy=iy_first; iy<=iy_last; iy++)
+	score[iy] = (st_xx[iy]*st_yy[iy]-st_xy[iy]*st_xy[iy]) - ((st_xx[iy]+st_yy[iy])*(st_xx[iy]+st_yy[iy])*kappa);
+    }
 
-    } // end for loop over x bins
-  } // end for loop over y bins
+  } // end for loop over x bins
 
 }
 
 
 //-----------------------------------------------------------------------------
 // Max Supress
-size_t corner::CornerFinderAlg::perform_maximum_suppression(TH2D const& h_cornerScore,
+size_t corner::CornerFinderAlg::perform_maximum_suppression(ImageArray<double> const& cornerScore,
 							    std::vector<recob::EndPoint2D> & corner_vector,
-							    std::vector<geo::WireID> wireIDs,
+							    std::vector<geo::WireID> const& wireIDs,
 							    geo::View_t view,
-							    TH2D & h_maxSuppress,
+							    ImageArray<double> & maxSuppress,
 							    int startx,
                                                             int starty) const {
 
-  const int x_bins = h_cornerScore.GetNbinsX();
-  const int y_bins = h_cornerScore.GetNbinsY();
+  const int x_bins = cornerScore.NBinsX();
+  const int y_bins = cornerScore.NBinsY();
 
   double temp_max;
   bool temp_center_bin;
@@ -1003,7 +995,7 @@ size_t corner::CornerFinderAlg::perform_maximum_suppression(TH2D const& h_corner
   for(int iy=1; iy<=y_bins; iy++){
     for(int ix=1; ix<=x_bins; ix++){
 
-      if(h_cornerScore.GetBinContent(ix,iy) < fMaxSuppress_threshold)
+      if(cornerScore(ix,iy) < fMaxSuppress_threshold)
 	continue;
 
       temp_max = -1000;
@@ -1012,8 +1004,8 @@ size_t corner::CornerFinderAlg::perform_maximum_suppression(TH2D const& h_corner
       for(int jx=ix-fMaxSuppress_neighborhood; jx<=ix+fMaxSuppress_neighborhood; jx++){
 	for(int jy=iy-fMaxSuppress_neighborhood; jy<=iy+fMaxSuppress_neighborhood; jy++){
 
-	  if(h_cornerScore.GetBinContent(jx,jy) > temp_max){
-	    temp_max = h_cornerScore.GetBinContent(jx,jy);
+	  if(cornerScore.GetBinContent(jx,jy) > temp_max){
+	    temp_max = cornerScore.GetBinContent(jx,jy);
 	    if(jx==ix && jy==iy) temp_center_bin=true;
 	    else{ temp_center_bin=false; }
 	  }
@@ -1029,13 +1021,13 @@ size_t corner::CornerFinderAlg::perform_maximum_suppression(TH2D const& h_corner
 	int id = 0;
 	recob::EndPoint2D corner(time_tick,
 				 wireIDs[wire_number],
-				 h_cornerScore.GetBinContent(ix,iy),
+				 cornerScore(ix,iy),
 				 id,
 				 view,
 				 totalQ);
 	corner_vector.push_back(corner);
 
-	h_maxSuppress.SetBinContent(ix,iy,h_cornerScore.GetBinContent(ix,iy));
+	maxSuppress(ix,iy) = cornerScore(ix,iy);
       }
 
     }
@@ -1121,8 +1113,7 @@ float corner::CornerFinderAlg::line_integral(TH2F const& hist, int begin_x, floa
 // Do the silly little line integral score thing
 size_t corner::CornerFinderAlg::calculate_line_integral_score( TH2F const& h_wire_data,
 								std::vector<recob::EndPoint2D> const & corner_vector,
-								std::vector<recob::EndPoint2D> & corner_lineIntegralScore_vector,
-                                                                TH2F & h_lineIntegralScore) const {
+								std::vector<recob::EndPoint2D> & corner_lineIntegralScore_vector) const {
 
   float score;
 
@@ -1152,11 +1143,6 @@ size_t corner::CornerFinderAlg::calculate_line_integral_score( TH2F const& h_wir
 
     corner_lineIntegralScore_vector.push_back(corner);
 
-
-    h_lineIntegralScore.SetBinContent(h_wire_data.GetXaxis()->FindBin(i_corner.WireID().Wire),
-				      h_wire_data.GetYaxis()->FindBin(i_corner.DriftTime()),
-				      score);
-
   }
 
   return corner_lineIntegralScore_vector.size();
@@ -1167,54 +1153,24 @@ size_t corner::CornerFinderAlg::calculate_line_integral_score( TH2F const& h_wir
 TH2F const& corner::CornerFinderAlg::GetWireDataHist(unsigned int i_plane) const {
   return WireData_histos.at(i_plane);
 }
-/*
-TH2F* corner::CornerFinderAlg::GetConversionHist(unsigned int i_plane){
-
-  if(i_plane >= fConversion_histos.size()){
-    mf::LogWarning("CornerFinderAlg") << "WARNING:  Requested plane does not exist.";
-    return NULL;
-  }
 
-  return fConversion_histos.at(i_plane);
+// These throw (std::out_of_range) if the histograms were not exported
+TH2F const& corner::CornerFinderAlg::GetConversionHist(unsigned int i_image) const {
+  return fConversion_histos.at(i_image);
 }
 
-TH2F* corner::CornerFinderAlg::GetDerivativeXHist(unsigned int i_plane){
-
-  if(i_plane >= fDerivativeX_histos.size()){
-    mf::LogWarning("CornerFinderAlg") << "WARNING:  Requested plane does not exist.";
-    return NULL;
-  }
-
-  return fDerivativeX_histos.at(i_plane);
+TH2F const& corner::CornerFinderAlg::GetDerivativeXHist(unsigned int i_image) const {
+  return fDerivativeX_histos.at(i_image);
 }
 
-TH2F* corner::CornerFinderAlg::GetDerivativeYHist(unsigned int i_plane){
-
-  if(i_plane >= fDerivativeY_histos.size()){
-    mf::LogWarning("CornerFinderAlg") << "WARNING:  Requested plane does not exist.";
-    return NULL;
-  }
-
-  return fDerivativeY_histos.at(i_plane);
+TH2F const& corner::CornerFinderAlg::GetDerivativeYHist(unsigned int i_image) const {
+  return fDerivativeY_histos.at(i_image);
 }
 
-TH2D* corner::CornerFinderAlg::GetCornerScoreHist(unsigned int i_plane){
-
-  if(i_plane >= fCornerScore_histos.size()){
-    mf::LogWarning("CornerFinderAlg") << "WARNING:  Requested plane does not exist.";
-    return NULL;
-  }
-
-  return fCornerScore_histos.at(i_plane);
+TH2D const& corner::CornerFinderAlg::GetCornerScoreHist(unsigned int i_image) const {
+  return fCornerScore_histos.at(i_image);
 }
 
-TH2D* corner::CornerFinderAlg::GetMaxSuppressHist(unsigned int i_plane){
-
-  if(i_plane >= fMaxSuppress_histos.size()){
-    mf::LogWarning("CornerFinderAlg") << "WARNING:  Requested plane does not exist.";
-    return NULL;
-  }
-
-  return fMaxSuppress_histos.at(i_plane);
+TH2D const& corner::CornerFinderAlg::GetMaxSuppressHist(unsigned int i_image) const {
+  return fMaxSuppress_histos.at(i_image);
 }
-*/
@@ -13,8 +13,10 @@
 #include "TH2.h"
 #include "TF2.h"
 #include "TH1D.h"
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <tuple>
 #include "lardataobj/RecoBase/Wire.h"
 #include "lardataobj/RecoBase/EndPoint2D.h"
 #include "larcore/Geometry/Geometry.h"
@@ -22,6 +24,59 @@
 
 namespace corner { //<---Not sure if this is the right namespace
 
+   /// Image on a contiguous array, binned like a TH2: bins 1 to NBins in each
+   /// direction plus an underflow (0) and an overflow (NBins+1) bin, with the
+   /// y (time) bins of each x (wire) bin next to each other.
+   template <typename T>
+   class ImageArray {
+
+   public:
+
+     void Reset(int nBinsX, double xMin, double xMax, int nBinsY, double yMin, double yMax){
+       fNBinsX = nBinsX; fXMin = xMin; fXMax = xMax;
+       fNBinsY = nBinsY; fYMin = yMin; fYMax = yMax;
+       fBins.assign(size_t(nBinsX+2)*(nBinsY+2), T(0));
+     }
+
+     int NBinsX() const { return fNBinsX; }
+     int NBinsY() const { return fNBinsY; }
+     double XMin() const { return fXMin; }
+     double XMax() const { return fXMax; }
+     double YMin() const { return fYMin; }
+     double YMax() const { return fYMax; }
+
+     T& operator()(int ix, int iy) { return fBins[Index(ix,iy)]; }
+     T  operator()(int ix, int iy) const { return fBins[Index(ix,iy)]; }
+
+     /// Out of range bins read as the underflow/overflow bin, like TH2::GetBinContent
+     T GetBinContent(int ix, int iy) const {
+       return fBins[Index(std::clamp(ix,0,fNBinsX+1),std::clamp(iy,0,fNBinsY+1))];
+     }
+
+     /// The y bins of x bin ix, indexed by iy
+     T*       Column(int ix)       { return fBins.data() + Index(ix,0); }
+     T const* Column(int ix) const { return fBins.data() + Index(ix,0); }
+
+     /// Copy into a histogram (TH2F or TH2D), underflow and overflow included
+     template <typename Hist>
+     Hist MakeHistogram(std::string const& name, std::string const& title) const {
+       Hist hist(name.c_str(),title.c_str(),fNBinsX,fXMin,fXMax,fNBinsY,fYMin,fYMax);
+       for(int ix=0; ix<=fNBinsX+1; ix++)
+         for(int iy=0; iy<=fNBinsY+1; iy++)
+           hist.SetBinContent(ix,iy,(*this)(ix,iy));
+       return hist;
+     }
+
+   private:
+
+     size_t Index(int ix, int iy) const { return size_t(ix)*(fNBinsY+2) + iy; }
+
+     int fNBinsX = 0, fNBinsY = 0;
+     double fXMin = 0., fXMax = 0., fYMin = 0., fYMax = 0.;
+     std::vector<T> fBins;
+
+   };
+
    class CornerFinderAlg {
 
    public:
@@ -48,14 +103,27 @@ namespace corner { //<---Not sure if this is the right namespace
      float line_integral(TH2F const& hist, int x1, float y1, int x2, float y2, float threshold) const;
 
      TH2F const& GetWireDataHist(unsigned int) const;
-     // TH2F const& GetConversionHist(unsigned int);
-     // TH2F const& GetDerivativeXHist(unsigned int);
-     // TH2F const& GetDerivativeYHist(unsigned int);
-     // TH2D const& GetCornerScoreHist(unsigned int);
-     // TH2D const& GetMaxSuppressHist(unsigned int);
+
+     // Intermediate images of the last call to get_feature_points*, by image processed
+     // (plane, or trimmed image for get_feature_points_fast). Only filled with ExportHistograms.
+     TH2F const& GetConversionHist(unsigned int) const;
+     TH2F const& GetDerivativeXHist(unsigned int) const;
+     TH2F const& GetDerivativeYHist(unsigned int) const;
+     TH2D const& GetCornerScoreHist(unsigned int) const;
+     TH2D const& GetMaxSuppressHist(unsigned int) const;
 
     private:
 
+     /// Working images of the corner finding for one input image
+     struct ImageSet {
+       ImageArray<float>  conversion;
+       ImageArray<float>  derivativeX;
+       ImageArray<float>  derivativeY;
+       ImageArray<double> cornerScore;
+       ImageArray<double> maxSuppress;
+       geo::View_t        view;
+     };
+
      void CleanCornerFinderAlg();
      void InitializeGeometry(geo::Geometry const&);
 
@@ -83,47 +151,63 @@ namespace corner { //<---Not sure if this is the right namespace
      int            fMaxSuppress_threshold;
      float          fIntegral_bin_threshold;
      float          fIntegral_fraction_threshold;
+     unsigned int   fNumThreads;                   // images processed concurrently
+     bool           fExportHistograms;             // keep the intermediate images as histograms
+
+     std::vector<double> fConversion_weights;      // Conversion_function on the (2n+1)x(2n+1) neighborhood
 
      // Making a vector of histograms
      std::vector<TH2F> WireData_histos;
      std::vector<TH1D> WireData_histos_ProjectionX;
      std::vector<TH1D> WireData_histos_ProjectionY;
-     std::vector< std::tuple<int,TH2F,int,int> > WireData_trimmed_histos;
      std::vector< std::vector<geo::WireID> > WireData_IDs;
-     // std::vector<TH2F> fConversion_histos;
-     // std::vector<TH2F> fDerivativeX_histos;
-     // std::vector<TH2F> fDerivativeY_histos;
-     // std::vector<TH2D> fCornerScore_histos;
-     // std::vector<TH2D> fMaxSuppress_histos;
-
-     unsigned int event_number;
-     unsigned int run_number;
-
-     void create_image_histo(TH2F const& h_wire_data, TH2F & h_conversion) const;
-     void create_derivative_histograms(TH2F const& h_conversion, TH2F & h_derivative_x, TH2F & h_derivative_y);
-     void create_cornerScore_histogram(TH2F const& h_derivative_x, TH2F const& h_derivative_y, TH2D & h_cornerScore);
-     size_t perform_maximum_suppression(TH2D const& h_cornerScore,
+     std::vector<TH2F> fConversion_histos;
+     std::vector<TH2F> fDerivativeX_histos;
+     std::vector<TH2F> fDerivativeY_histos;
+     std::vector<TH2D> fCornerScore_histos;
+     std::vector<TH2D> fMaxSuppress_histos;
+
+     // The same wire data on contiguous arrays, which the corner finding works on
+     std::vector< ImageArray<float> > WireData_images;
+     std::vector< std::tuple<int,ImageArray<float>,int,int> > WireData_trimmed_images;
+
+     unsigned int event_number = 0;
+     unsigned int run_number = 0;
+
+     /// Run func(i) for i in [0, n) on fNumThreads threads
+     template <typename Func>
+     void run_concurrently(size_t n, Func const& func) const;
+
+     /// Fill the histograms of the intermediate images, if requested
+     void export_histograms(std::vector<ImageSet> const& imageSets);
+
+     void create_image(ImageArray<float> const& wire_data, ImageArray<float> & conversion) const;
+     void create_derivatives(ImageArray<float> const& conversion, ImageArray<float> & derivative_x, ImageArray<float> & derivative_y) const;
+     void create_cornerScore(ImageArray<float> const& derivative_x, ImageArray<float> const& derivative_y, ImageArray<double> & cornerScore) const;
+     size_t perform_maximum_suppression(ImageArray<double> const& cornerScore,
 					std::vector<recob::EndPoint2D> & corner_vector,
-					std::vector<geo::WireID> wireIDs,
+					std::vector<geo::WireID> const& wireIDs,
 					geo::View_t view,
-					TH2D & h_maxSuppress,
+					ImageArray<double> & maxSuppress,
 					int startx=0,
                                         int starty=0) const;
 
      size_t calculate_line_integral_score( TH2F const& h_wire_data,
 					   std::vector<recob::EndPoint2D> const & corner_vector,
-					   std::vector<recob::EndPoint2D> & corner_lineIntegralScore_vector,
-                                           TH2F & h_lineIntegralScore) const;
+					   std::vector<recob::EndPoint2D> & corner_lineIntegralScore_vector) const;
 
-     void attach_feature_points(TH2F const& h_wire_data,
-				std::vector<geo::WireID> wireIDs,
+     void attach_feature_points(ImageArray<float> const& wire_data,
+				std::vector<geo::WireID> const& wireIDs,
 				geo::View_t view,
 				std::vector<recob::EndPoint2D>&,
-				int startx=0,int starty=0);
-     void attach_feature_points_LineIntegralScore(TH2F const& h_wire_data,
-						  std::vector<geo::WireID> wireIDs,
+				ImageSet& images,
+				int startx=0,int starty=0) const;
+     void attach_feature_points_LineIntegralScore(ImageArray<float> const& wire_data,
+						  TH2F const& h_wire_data,
+						  std::vector<geo::WireID> const& wireIDs,
 						  geo::View_t view,
-						  std::vector<recob::EndPoint2D>&);
+						  std::vector<recob::EndPoint2D>&,
+						  ImageSet& images) const;
 
 
      void create_smaller_histos(geo::Geometry const&);
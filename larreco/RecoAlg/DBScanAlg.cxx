@@ -28,8 +28,10 @@
 #include "lardataobj/RecoBase/Hit.h"
 #include "larcorealg/CoreUtils/NumericUtils.h" // util::absDiff()
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
 
 //----------------------------------------------------------
 // RStarTree stuff
@@ -293,6 +295,10 @@ void cluster::DBScanAlg::InitScan(const std::vector< art::Ptr<recob::Hit> >& all
 
   fBadChannels = badChannels;
   fBadWireSum.clear();
+  fWireIndex.clear();
+  fGridWires.clear();
+  fGridFirst.clear();
+  fGridPoints.clear();
 
   // Clear the RTree
   fRTree.Remove(RTree::AcceptAny(),RTree::RemoveLeaf());
@@ -311,7 +317,7 @@ void cluster::DBScanAlg::InitScan(const std::vector< art::Ptr<recob::Hit> >& all
 
 
   // Collect the bad wire list into a useful form
-  if (fClusterMethod) { // Using the R*-tree
+  if (fClusterMethod) { // Using the R*-tree or the wire grid
     fBadWireSum.resize(geom->Nchannels());
     unsigned int count=0;
     for (unsigned int i=0; i<fBadWireSum.size(); ++i) {
@@ -339,7 +345,7 @@ void cluster::DBScanAlg::InitScan(const std::vector< art::Ptr<recob::Hit> >& all
 
     fps.push_back(p);
 
-    if (fClusterMethod) { // Using the R*-tree
+    if (fClusterMethod == 1 || fClusterMethod == 2) { // Using the R*-tree
       // Convert these same values into dbsPoints to feed into the R*-tree
       dbsPoint pp(p[0], p[1], 0.0, p[2]/2.0); // note dividing by two
       fRTree.Insert(j, pp.bounds());
@@ -352,7 +358,9 @@ void cluster::DBScanAlg::InitScan(const std::vector< art::Ptr<recob::Hit> >& all
   fnoise.resize(fps.size(), false);
   fvisited.resize(fps.size(), false);
 
-  if (fClusterMethod) { // Using the R*-tree
+  if (fClusterMethod == 3) BuildGrid();
+
+  if (fClusterMethod == 1 || fClusterMethod == 2) { // Using the R*-tree
     Visitor visitor =
       fRTree.Query(RTree::AcceptAny(),Visitor());
     mf::LogInfo("DBscan") << "InitScan: hits RTree loaded with "
@@ -518,12 +526,156 @@ void cluster::DBScanAlg::computeWidthFactor()
 }
 
 
+//------------------------------------------------------------------
+// Wire grid for the neighbor search of method 3: the points are grouped by
+// wire (the same rounded wire getSimilarity() uses) and sorted in time
+// within each wire. Memory is linear in the number of points.
+void cluster::DBScanAlg::BuildGrid()
+{
+  /// \todo this code assumes that all planes have the same wire pitch
+  double wire_dist = fWirePitch[0];
+
+  unsigned int const nPoints = fps.size();
+
+  fWireIndex.resize(nPoints);
+  for (unsigned int i = 0; i < nPoints; ++i)
+    fWireIndex[i] = (unsigned int)(fps[i][0]/wire_dist+0.5);
+
+  fGridPoints.resize(nPoints);
+  for (unsigned int i = 0; i < nPoints; ++i) fGridPoints[i] = i;
+
+  std::sort(fGridPoints.begin(), fGridPoints.end(),
+	    [this](unsigned int a, unsigned int b){
+	      if (fWireIndex[a] != fWireIndex[b]) return fWireIndex[a] < fWireIndex[b];
+	      if (fps[a][1] != fps[b][1]) return fps[a][1] < fps[b][1];
+	      return a < b;
+	    });
+
+  for (unsigned int i = 0; i < nPoints; ++i){
+    unsigned int const wire = fWireIndex[fGridPoints[i]];
+    if (fGridWires.empty() || fGridWires.back() != wire){
+      fGridWires.push_back(wire);
+      fGridFirst.push_back(i);
+    }
+  }
+  fGridFirst.push_back(nPoints);
+}
+
+//------------------------------------------------------------------
+// Number of bad channels in [0, wire), the count getSimilarity() bridges
+// between two wires is BadWiresBelow(wire2) - BadWiresBelow(wire1)
+unsigned int cluster::DBScanAlg::BadWiresBelow(unsigned int wire) const
+{
+  if (wire == 0 || fBadWireSum.empty()) return 0;
+  return fBadWireSum[std::min(wire, (unsigned int) fBadWireSum.size()) - 1];
+}
+
+//------------------------------------------------------------------
+// The findNeighbors() test of the pair, computed on the fly: same
+// expressions as getSimilarity(), getSimilarity2() and getWidthFactor()
+bool cluster::DBScanAlg::IsNeighbor(unsigned int pid, unsigned int j) const
+{
+  const std::vector<double>& v1 = fps[pid];
+  const std::vector<double>& v2 = fps[j];
+
+  double wire_dist = fWirePitch[0];
+
+  int wirestobridge = util::absDiff(BadWiresBelow(fWireIndex[pid]),
+				    BadWiresBelow(fWireIndex[j]));
+  double cmtobridge = wirestobridge*wire_dist;
+
+  double sim = ( std::abs(v2[0]-v1[0])-cmtobridge)*( std::abs(v2[0]-v1[0])-cmtobridge);
+
+  if (std::abs(v2[0]-v1[0])>1e-10){
+    cmtobridge *= std::abs((v2[1]-v1[1])/(v2[0]-v1[0]));
+  }
+  else cmtobridge = 0;
+
+  double sim2 = ( std::abs(v2[1]-v1[1])-cmtobridge)*( std::abs(v2[1]-v1[1])-cmtobridge);
+
+  double k = 0.1;
+  double WFactor = (exp(4.6*(( v1[2]*v1[2])+( v2[2]*v2[2]))))*k;
+  if (WFactor < 1.0)  WFactor = 1.0;
+  if (WFactor > 6.25) WFactor = 6.25;
+
+  return ((sim)/ (fEps*fEps)) + ((sim2)/ (fEps2*fEps2*(WFactor))) < 1;
+}
+
+//------------------------------------------------------------------
+// Same result as findNeighbors(point, fEps, fEps2), looking only at the
+// wires and times which can pass its test.
+//
+// Along the wires: the distance reduced by the bridged bad wires must be
+// below eps, so only wires within eps/pitch+1 *good* wires can match (runs
+// of bad wires are skipped over).
+// Along the time: the width factor is at most 6.25, so without bad wires
+// in between the time difference is below 2.5 epstwo. Bad wires shrink the
+// time difference by (dx - bridge)/dx, which widens the window accordingly;
+// when that factor cannot be bounded the whole wire is checked.
+std::vector<unsigned int> cluster::DBScanAlg::GridQuery(unsigned int point) const
+{
+  std::vector<unsigned int> ne;
+
+  double wire_dist = fWirePitch[0];
+
+  unsigned int const wire        = fWireIndex[point];
+  unsigned int const maxGoodDiff = (unsigned int)(fEps/wire_dist) + 1;
+  double       const maxTime     = 2.5*fEps2*(1. + 1e-6);
+  double       const time        = fps[point][1];
+
+  auto goodWires = [this](unsigned int w){ return w - BadWiresBelow(w); };
+  unsigned int const good = goodWires(wire);
+
+  auto scanWire = [&](size_t iWire){
+    unsigned int const otherWire = fGridWires[iWire];
+    unsigned int const dWire     = util::absDiff(otherWire, wire);
+    unsigned int const nBad      = util::absDiff(BadWiresBelow(otherWire), BadWiresBelow(wire));
+    unsigned int const nGood     = dWire - nBad;
+
+    double window = std::numeric_limits<double>::max();
+    if (dWire == 0 || nBad == 0) window = maxTime;
+    else if (nGood >= 2)         window = maxTime*(dWire + 1)/(nGood - 1);
+
+    auto first = fGridPoints.begin() + fGridFirst[iWire];
+    auto last  = fGridPoints.begin() + fGridFirst[iWire + 1];
+    if (window < std::numeric_limits<double>::max()) {
+      first = std::lower_bound(first, last, time - window,
+			       [this](unsigned int p, double t){ return fps[p][1] < t; });
+      last  = std::upper_bound(first, last, time + window,
+			       [this](double t, unsigned int p){ return t < fps[p][1]; });
+    }
+    for (auto itr = first; itr != last; ++itr){
+      if (*itr != point && IsNeighbor(point, *itr)) ne.push_back(*itr);
+    }
+  };
+
+  size_t const thisWire = std::lower_bound(fGridWires.begin(), fGridWires.end(), wire)
+                        - fGridWires.begin();
+
+  for (size_t iWire = thisWire; iWire < fGridWires.size(); ++iWire){
+    if (goodWires(fGridWires[iWire]) - good > maxGoodDiff) break;
+    scanWire(iWire);
+  }
+  for (size_t iWire = thisWire; iWire-- > 0; ){
+    if (good - goodWires(fGridWires[iWire]) > maxGoodDiff) break;
+    scanWire(iWire);
+  }
+
+  // findNeighbors() returns the points in index order
+  std::sort(ne.begin(), ne.end());
+
+  return ne;
+}
+
+
 //----------------------------------------------------------------
 /////////////////////////////////////////////////////////////////
 // This is the algorithm that finds clusters:
 // Run the selected clustering algorithm
 void cluster::DBScanAlg::run_cluster() {
   switch(fClusterMethod) {
+  case 3:
+    return run_FN_naive_cluster(); // neighbors from the wire grid
   case 2:
     return run_dbscan_cluster();
   case 1:
@@ -770,7 +922,8 @@ void cluster::DBScanAlg::run_FN_naive_cluster()
 
       fvisited[pid] = true;
       // get the neighbors
-      std::vector<unsigned int> ne = findNeighbors(pid, fEps,fEps2);
+      std::vector<unsigned int> ne = (fClusterMethod == 3)?
+        GridQuery(pid): findNeighbors(pid, fEps,fEps2);
 
       // not enough support -> mark as noise
       if (ne.size() < fMinPts){
@@ -791,7 +944,8 @@ void cluster::DBScanAlg::run_FN_naive_cluster()
 	  if (!fvisited[nPid]){
 	    fvisited[nPid] = true;
 	    // go to neighbors
-	    std::vector<unsigned int> ne1 = findNeighbors(nPid, fEps, fEps2);
+	    std::vector<unsigned int> ne1 = (fClusterMethod == 3)?
+	      GridQuery(nPid): findNeighbors(nPid, fEps, fEps2);
 	    // enough support
 	    if (ne1.size() >= fMinPts){
 
@@ -828,7 +982,9 @@ void cluster::DBScanAlg::run_FN_naive_cluster()
     //if  (fpointId_to_clusterId[y]==0) noise++;
     if  (fpointId_to_clusterId[y] == kNO_CLUSTER) ++noise;
   }
-  mf::LogInfo("DBscan") << "FindNeighbors (naive): Found " << cid
+  mf::LogInfo("DBscan") << "FindNeighbors ("
+			   << ((fClusterMethod == 3)? "wire grid": "naive")
+			   << "): Found " << cid
 			   << " clusters...";
   for (unsigned int c = 0; c < cid; ++c){
     mf::LogVerbatim("DBscan") << "\t" << "Cluster " << c << ":\t"
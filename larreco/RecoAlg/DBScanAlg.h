@@ -86,6 +86,12 @@ namespace cluster{
     std::vector<uint32_t>  fBadWireSum;    ///< running total of bad channels. Used for fast intervening
                                            ///< dead wire counting ala fBadChannelSum[m]-fBadChannelSum[n].
 
+    // Wire grid used by the grid-indexed findNeighbors (method 3)
+    std::vector<unsigned int> fWireIndex;  ///< wire of each point, rounded as in getSimilarity()
+    std::vector<unsigned int> fGridWires;  ///< wires with at least one point, in increasing order
+    std::vector<unsigned int> fGridFirst;  ///< points on fGridWires[i] are fGridPoints[fGridFirst[i]..fGridFirst[i+1])
+    std::vector<unsigned int> fGridPoints; ///< point indices, sorted by wire and then by time
+
     // Three differnt version of the clustering code
     void run_dbscan_cluster();
     void run_FN_cluster();
@@ -98,6 +104,11 @@ namespace cluster{
     std::set<unsigned int> RegionQuery(unsigned int point);
     // Helper for the accelerated run_FN_cluster()
     std::vector<unsigned int> RegionQuery_vector(unsigned int point);
+    // Helpers for the grid-indexed findNeighbors (method 3)
+    void BuildGrid();
+    unsigned int BadWiresBelow(unsigned int wire) const;
+    bool IsNeighbor(unsigned int pid, unsigned int j) const;
+    std::vector<unsigned int> GridQuery(unsigned int point) const;
 
 
   }; // class DBScanAlg
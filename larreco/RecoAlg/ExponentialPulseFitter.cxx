@@ -0,0 +1,326 @@
+/**
+ * @file   ExponentialPulseFitter.cxx
+ * @brief  Levenberg-Marquardt fit of a train of exponential pulses
+ * @see    ExponentialPulseFitter.h
+ */
+
+// Library header
+#include "ExponentialPulseFitter.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::min(), std::max(), std::copy(), std::fill()
+#include <cmath> // std::exp(), std::log(), std::log1p(), std::sqrt()
+
+
+namespace {
+
+  /// Slope factor of the exponentials in the pulse shape
+  constexpr double PulseSlope = 0.4;
+
+  /// log(1 + exp(z)) without overflow
+  inline double softplus(double z)
+    { return (z > 0.)? z + std::log1p(std::exp(-z)): std::log1p(std::exp(z)); }
+
+  /// exp(z) / (1 + exp(z)) without overflow
+  inline double sigmoid(double z) {
+    if (z >= 0.) return 1. / (1. + std::exp(-z));
+    double const e = std::exp(z);
+    return e / (1. + e);
+  } // sigmoid()
+
+  /// Positions of the parameters of a pulse in the parameter list
+  struct PulseIndices {
+    std::size_t tau1, tau2, amplitude, t0;
+
+    PulseIndices(std::size_t iPulse, bool sameShape)
+      : tau1     (sameShape? 0: 4 * iPulse)
+      , tau2     (sameShape? 1: 4 * iPulse + 1)
+      , amplitude(sameShape? 2 * (iPulse + 1): 4 * iPulse + 2)
+      , t0       (sameShape? 2 * (iPulse + 1) + 1: 4 * iPulse + 3)
+      {}
+  }; // PulseIndices
+
+} // local namespace
+
+
+namespace hit {
+
+  //----------------------------------------------------------------------------
+  void ExponentialPulseFitter::SetData
+    (float const* data, std::size_t nSamples, double xStart, bool skipEmpty)
+  {
+    // clear() keeps the capacity, so no allocation once we are warmed up
+    fX.clear();
+    fY.clear();
+
+    for (std::size_t iSample = 0; iSample < nSamples; ++iSample) {
+      if (skipEmpty && data[iSample] == 0.f) continue;
+      fX.push_back(xStart + iSample);
+      fY.push_back(data[iSample]);
+    } // for
+  } // ExponentialPulseFitter::SetData()
+
+
+  //----------------------------------------------------------------------------
+  bool ExponentialPulseFitter::Fit(std::size_t nPulses, bool sameShape,
+                                   std::vector<double>& params,
+                                   std::vector<double> const& parMin,
+                                   std::vector<double> const& parMax)
+  {
+    std::size_t const nParams = NParams(nPulses, sameShape);
+    std::size_t const nPoints = fX.size();
+
+    fNParams     = nParams;
+    fNIterations = 0;
+    fChi2        = 0.;
+
+    fParErrors.assign(nParams, 0.);
+
+    // like ROOT, a fit with no degrees of freedom left is still attempted
+    if (nPoints == 0) return false;
+
+    fResidual.resize(nPoints);
+    fJacobian.resize(nParams * nPoints);
+    fAlpha.resize(nParams * nParams);
+    fMatrix.resize(nParams * nParams);
+    fBeta.resize(nParams);
+    fStep.resize(nParams);
+    fTrial.resize(nParams);
+
+    // start from inside the limits
+    for (std::size_t iPar = 0; iPar < nParams; ++iPar)
+      params[iPar] = std::min(std::max(params[iPar], parMin[iPar]), parMax[iPar]);
+
+    double chi2 = Evaluate(nPulses, sameShape, params.data(), true);
+    FillNormalEquations(nParams);
+
+    double lambda = 1e-3;
+    bool converged = false;
+
+    while (fNIterations < fMaxIterations) {
+
+      // damped normal equations
+      std::copy(fAlpha.begin(), fAlpha.end(), fMatrix.begin());
+      for (std::size_t iPar = 0; iPar < nParams; ++iPar) {
+        double& diag = fMatrix[iPar * nParams + iPar];
+        diag = (diag > 0.)? diag * (1. + lambda): lambda;
+      } // for
+
+      bool const decomposed = Decompose(nParams);
+
+      if (decomposed) {
+        std::copy(fBeta.begin(), fBeta.end(), fStep.begin());
+        Solve(nParams, fStep.data());
+
+        // bounded step: the parameters are projected back into the limits
+        for (std::size_t iPar = 0; iPar < nParams; ++iPar) {
+          fTrial[iPar] = std::min
+            (std::max(params[iPar] + fStep[iPar], parMin[iPar]), parMax[iPar]);
+        } // for
+
+        double const trialChi2
+          = Evaluate(nPulses, sameShape, fTrial.data(), false);
+
+        if (trialChi2 < chi2) {
+          ++fNIterations;
+
+          double const deltaChi2 = chi2 - trialChi2;
+
+          std::copy(fTrial.begin(), fTrial.end(), params.begin());
+          chi2 = Evaluate(nPulses, sameShape, params.data(), true);
+          FillNormalEquations(nParams);
+
+          lambda = std::max(lambda * 0.1, 1e-12);
+
+          if (deltaChi2 <= fRelTolerance * chi2) {
+            converged = true;
+            break;
+          }
+          continue;
+        } // if improved
+      } // if decomposed
+
+      // no improvement possible: either we are sitting on the minimum (the
+      // step vanishes) or the problem is degenerate
+      lambda *= 10.;
+      if (lambda > 1e10) {
+        converged = decomposed;
+        break;
+      }
+    } // while
+
+    fChi2 = chi2;
+
+    // errors from the covariance matrix (J^T J)^-1 at the minimum; with unit
+    // weights ROOT scales them by sqrt(chi2/NDF), and so do we
+    int const ndf = NDF();
+    double const errorScale = (ndf > 0)? std::sqrt(chi2 / ndf): 1.;
+    std::copy(fAlpha.begin(), fAlpha.end(), fMatrix.begin());
+    if (Decompose(nParams)) {
+      for (std::size_t iPar = 0; iPar < nParams; ++iPar) {
+        std::fill(fStep.begin(), fStep.end(), 0.);
+        fStep[iPar] = 1.;
+        Solve(nParams, fStep.data());
+        fParErrors[iPar] = errorScale * std::sqrt(std::max(fStep[iPar], 0.));
+      } // for
+    } // if
+
+    return converged;
+  } // ExponentialPulseFitter::Fit()
+
+
+  //----------------------------------------------------------------------------
+  double ExponentialPulseFitter::Eval
+    (std::size_t nPulses, bool sameShape, double const* params, double x)
+  {
+    double value = 0.;
+    for (std::size_t iPulse = 0; iPulse < nPulses; ++iPulse) {
+      PulseIndices const index(iPulse, sameShape);
+      double const u = PulseSlope * (x - params[index.t0]);
+      value += params[index.amplitude]
+        * std::exp(u / params[index.tau1] - softplus(u / params[index.tau2]));
+    } // for
+    return value;
+  } // ExponentialPulseFitter::Eval()
+
+
+  //----------------------------------------------------------------------------
+  double ExponentialPulseFitter::PulseMaximumX
+    (double t0, double tau1, double tau2, double xMin, double xMax)
+  {
+    // with tau1 <= tau2 the pulse never turns down
+    if (tau1 <= tau2) return xMax;
+    double const xMax0 = t0 + tau2 / PulseSlope * std::log(tau2 / (tau1 - tau2));
+    return std::min(std::max(xMax0, xMin), xMax);
+  } // ExponentialPulseFitter::PulseMaximumX()
+
+
+  //----------------------------------------------------------------------------
+  double ExponentialPulseFitter::Evaluate
+    (std::size_t nPulses, bool sameShape, double const* params, bool jacobian)
+  {
+    std::size_t const nPoints = fX.size();
+    float const* x = fX.data();
+    float const* y = fY.data();
+    double* residual = fResidual.data();
+
+    for (std::size_t i = 0; i < nPoints; ++i) residual[i] = y[i];
+
+    // shared time constants collect the derivatives of all the pulses
+    if (jacobian && sameShape)
+      std::fill(fJacobian.begin(), fJacobian.begin() + 2 * nPoints, 0.);
+
+    for (std::size_t iPulse = 0; iPulse < nPulses; ++iPulse) {
+      PulseIndices const index(iPulse, sameShape);
+      double const amplitude = params[index.amplitude];
+      double const t0        = params[index.t0];
+      double const invTau1   = 1. / params[index.tau1];
+      double const invTau2   = 1. / params[index.tau2];
+
+      double* dTau1      = fJacobian.data() + index.tau1 * nPoints;
+      double* dTau2      = fJacobian.data() + index.tau2 * nPoints;
+      double* dAmplitude = fJacobian.data() + index.amplitude * nPoints;
+      double* dT0        = fJacobian.data() + index.t0 * nPoints;
+
+      for (std::size_t i = 0; i < nPoints; ++i) {
+        double const u  = PulseSlope * (x[i] - t0);
+        double const z1 = u * invTau1;
+        double const z2 = u * invTau2;
+        double const shape = std::exp(z1 - softplus(z2));
+        double const pulse = amplitude * shape;
+
+        residual[i] -= pulse;
+
+        if (!jacobian) continue;
+
+        double const s = sigmoid(z2);
+        dAmplitude[i] = shape;
+        dT0[i] = pulse * PulseSlope * (s * invTau2 - invTau1);
+        if (sameShape) {
+          dTau1[i] -= pulse * z1 * invTau1;
+          dTau2[i] += pulse * z2 * s * invTau2;
+        }
+        else {
+          dTau1[i] = -pulse * z1 * invTau1;
+          dTau2[i] =  pulse * z2 * s * invTau2;
+        }
+      } // for samples
+    } // for pulses
+
+    double chi2 = 0.;
+    for (std::size_t i = 0; i < nPoints; ++i) chi2 += residual[i] * residual[i];
+
+    return chi2;
+  } // ExponentialPulseFitter::Evaluate()
+
+
+  //----------------------------------------------------------------------------
+  void ExponentialPulseFitter::FillNormalEquations(std::size_t nParams) {
+
+    std::size_t const nPoints = fX.size();
+    double const* residual = fResidual.data();
+
+    for (std::size_t j = 0; j < nParams; ++j) {
+      double const* rowJ = fJacobian.data() + j * nPoints;
+
+      double beta = 0.;
+      for (std::size_t i = 0; i < nPoints; ++i) beta += rowJ[i] * residual[i];
+      fBeta[j] = beta;
+
+      for (std::size_t k = 0; k <= j; ++k) {
+        double const* rowK = fJacobian.data() + k * nPoints;
+
+        double alpha = 0.;
+        for (std::size_t i = 0; i < nPoints; ++i) alpha += rowJ[i] * rowK[i];
+        fAlpha[j * nParams + k] = fAlpha[k * nParams + j] = alpha;
+      } // for k
+    } // for j
+
+  } // ExponentialPulseFitter::FillNormalEquations()
+
+
+  //----------------------------------------------------------------------------
+  bool ExponentialPulseFitter::Decompose(std::size_t n) {
+
+    // lower triangular Cholesky factor, stored in place
+    double* a = fMatrix.data();
+    for (std::size_t j = 0; j < n; ++j) {
+      double diag = a[j * n + j];
+      for (std::size_t k = 0; k < j; ++k) diag -= a[j * n + k] * a[j * n + k];
+      if (!(diag > 0.)) return false;
+      diag = std::sqrt(diag);
+      a[j * n + j] = diag;
+
+      for (std::size_t i = j + 1; i < n; ++i) {
+        double value = a[i * n + j];
+        for (std::size_t k = 0; k < j; ++k) value -= a[i * n + k] * a[j * n + k];
+        a[i * n + j] = value / diag;
+      } // for i
+    } // for j
+    return true;
+  } // ExponentialPulseFitter::Decompose()
+
+
+  //----------------------------------------------------------------------------
+  void ExponentialPulseFitter::Solve(std::size_t n, double* rhs) const {
+
+    double const* a = fMatrix.data();
+
+    // L z = rhs
+    for (std::size_t i = 0; i < n; ++i) {
+      double value = rhs[i];
+      for (std::size_t k = 0; k < i; ++k) value -= a[i * n + k] * rhs[k];
+      rhs[i] = value / a[i * n + i];
+    } // for
+
+    // L^T x = z
+    for (std::size_t i = n; i-- > 0; ) {
+      double value = rhs[i];
+      for (std::size_t k = i + 1; k < n; ++k) value -= a[k * n + i] * rhs[k];
+      rhs[i] = value / a[i * n + i];
+    } // for
+
+  } // ExponentialPulseFitter::Solve()
+
+
+} // namespace hit
@@ -0,0 +1,164 @@
+/**
+ * @file   ExponentialPulseFitter.h
+ * @brief  Levenberg-Marquardt fit of a train of exponential pulses
+ * @see    ExponentialPulseFitter.cxx
+ *
+ * The fitter works directly on a span of waveform samples and replaces
+ * filling a TH1F and fitting it with a TF1 built from a formula string, which
+ * DPRawHitFinder used to do for every group of peaks.
+ */
+
+#ifndef EXPONENTIALPULSEFITTER_H
+#define EXPONENTIALPULSEFITTER_H 1
+
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <vector>
+
+namespace hit {
+
+  /** **************************************************************************
+   * @brief Bounded Levenberg-Marquardt fitter for a sum of exponential pulses
+   *
+   * Each pulse has the shape used by DPRawHitFinder:
+   *
+   *     f(x) = A exp(0.4 (x - t0) / tau1) / (1 + exp(0.4 (x - t0) / tau2))
+   *
+   * and the model is the sum of `nPulses` of them, with no baseline.
+   * The parameters follow the DPRawHitFinder convention:
+   * * with the same shape for all the pulses: tau1, tau2, then amplitude and
+   *   t0 of the first pulse, of the second one and so on;
+   * * with a shape for each pulse: tau1, tau2, amplitude and t0 of the first
+   *   pulse, then of the second one and so on. Each pulse uses its own t0 in
+   *   the denominator too, while the old DPRawHitFinder formula used
+   *   parameter `2 i + 3` there, which for the pulses after the first is
+   *   another parameter.
+   *
+   * All samples have unit weight and samples with exactly zero content are
+   * skipped on request, like ROOT does with the "W" fit option. Parameter
+   * errors are the square root of the diagonal of (J^T J)^-1 at the minimum,
+   * scaled by sqrt(chi2/NDF) as ROOT does for fits with unit weights.
+   *
+   * The Jacobian is computed analytically, in a form that does not overflow
+   * for steep pulses. All the buffers are data members that only grow, so
+   * after the first few pulses a fit does not allocate any memory. The object
+   * is therefore not reentrant: use one per thread.
+   */
+  class ExponentialPulseFitter {
+      public:
+
+    /**
+     * @brief Constructor
+     * @param maxIterations maximum number of accepted steps in a fit
+     * @param relTolerance relative chi square change to stop at
+     */
+    ExponentialPulseFitter
+      (unsigned int maxIterations = 100, double relTolerance = 1e-6)
+      : fMaxIterations(maxIterations)
+      , fRelTolerance(relTolerance)
+      {}
+
+    /**
+     * @brief Sets the samples to be fitted
+     * @param data pointer to the first sample
+     * @param nSamples number of samples
+     * @param xStart abscissa of the first sample
+     * @param skipEmpty whether to exclude samples with zero content
+     *
+     * The abscissa of sample `i` is `xStart + i`.
+     */
+    void SetData
+      (float const* data, std::size_t nSamples, double xStart, bool skipEmpty);
+
+    /**
+     * @brief Fits the data with the specified number of pulses
+     * @param nPulses number of pulses in the model
+     * @param sameShape whether all pulses share tau1 and tau2
+     * @param params (in: starting values, out: result) NParams() values
+     * @param parMin lower limits of the parameters
+     * @param parMax upper limits of the parameters
+     * @return whether the fit converged
+     */
+    bool Fit(std::size_t nPulses, bool sameShape,
+             std::vector<double>& params,
+             std::vector<double> const& parMin,
+             std::vector<double> const& parMax);
+
+    /// Chi square of the last fit (sum of squared residuals)
+    double Chi2() const { return fChi2; }
+
+    /// Degrees of freedom of the last fit (not positive if underconstrained)
+    int NDF() const { return int(fX.size()) - int(fNParams); }
+
+    /// Errors of the parameters of the last fit
+    std::vector<double> const& ParErrors() const { return fParErrors; }
+
+    /// Number of iterations used by the last fit
+    unsigned int NIterations() const { return fNIterations; }
+
+
+    /// Number of parameters of the model
+    static std::size_t NParams(std::size_t nPulses, bool sameShape)
+      { return sameShape? 2 * nPulses + 2: 4 * nPulses; }
+
+    /// Value of the model with the specified parameters at x
+    static double Eval
+      (std::size_t nPulses, bool sameShape, double const* params, double x);
+
+    /**
+     * @brief Position of the maximum of a single pulse within a range
+     * @param t0 pulse time parameter
+     * @param tau1 rising time constant
+     * @param tau2 falling time constant
+     * @param xMin lower end of the range
+     * @param xMax upper end of the range
+     * @return the abscissa of the maximum (the amplitude is irrelevant)
+     *
+     * The maximum is found analytically: it is at
+     * `t0 + tau2 / 0.4 log(tau2 / (tau1 - tau2))` when tau1 > tau2, while
+     * the pulse keeps rising otherwise.
+     */
+    static double PulseMaximumX
+      (double t0, double tau1, double tau2, double xMin, double xMax);
+
+      private:
+
+    unsigned int fMaxIterations; ///< maximum number of accepted steps
+    double       fRelTolerance;  ///< relative chi2 change to stop at
+
+    std::size_t  fNParams = 0;     ///< parameters in the last fit
+    double       fChi2 = 0.;       ///< chi square of the last fit
+    unsigned int fNIterations = 0; ///< iterations of the last fit
+
+    // --- workspaces, only grow
+    std::vector<float>  fX;         ///< abscissa of the samples
+    std::vector<float>  fY;         ///< content of the samples
+    std::vector<double> fResidual;  ///< data minus model
+    std::vector<double> fJacobian;  ///< derivatives, one row per parameter
+    std::vector<double> fAlpha;     ///< J^T J
+    std::vector<double> fBeta;      ///< J^T r
+    std::vector<double> fMatrix;    ///< damped J^T J, Cholesky factor
+    std::vector<double> fStep;      ///< proposed parameter step
+    std::vector<double> fTrial;     ///< trial parameters
+    std::vector<double> fParErrors; ///< parameter errors
+
+    /// Evaluates the residuals and (if jacobian is true) the derivatives
+    /// of the model on all the current samples; returns the chi square
+    double Evaluate
+      (std::size_t nPulses, bool sameShape, double const* params, bool jacobian);
+
+    /// Fills J^T J and J^T r from the current Jacobian and residuals
+    void FillNormalEquations(std::size_t nParams);
+
+    /// Cholesky decomposition of fMatrix in place; false if not positive
+    bool Decompose(std::size_t n);
+
+    /// Solves fMatrix x = rhs using the decomposition, result in rhs
+    void Solve(std::size_t n, double* rhs) const;
+
+  }; // class ExponentialPulseFitter
+
+} // namespace hit
+
+#endif // EXPONENTIALPULSEFITTER_H
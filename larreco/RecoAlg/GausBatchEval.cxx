@@ -0,0 +1,50 @@
+/**
+ * @file   GausBatchEval.cxx
+ * @brief  Evaluation of sums of Gaussians on whole arrays of points
+ * @see    GausBatchEval.h
+ */
+
+// Library header
+#include "GausBatchEval.h"
+
+// C/C++ standard libraries
+#include <array>
+#include <utility> // std::index_sequence
+
+
+namespace {
+
+  using BatchKernel_t = void (*)
+    (double const*, std::size_t, double const*, double*, double*, double);
+
+  template <std::size_t... NGaus>
+  constexpr std::array<BatchKernel_t, sizeof...(NGaus)> MakeBatchKernels
+    (std::index_sequence<NGaus...>)
+    { return {{ &hit::details::ngaus_batch<NGaus>... }}; }
+
+  /// Compiled kernels, the n-th element is the one for n Gaussians
+  constexpr std::array<BatchKernel_t, hit::details::MaxBatchGaussians + 1>
+    BatchKernels = MakeBatchKernels
+      (std::make_index_sequence<hit::details::MaxBatchGaussians + 1>());
+
+} // local namespace
+
+
+namespace hit {
+  namespace details {
+
+    //--------------------------------------------------------------------------
+    void ngaus_batch(
+      std::size_t nGaus,
+      double const* x, std::size_t n, double const* params,
+      double* values, double* gradients, double cutOff
+      )
+    {
+      if (nGaus < BatchKernels.size())
+        BatchKernels[nGaus](x, n, params, values, gradients, cutOff);
+      else
+        ngaus_batch_impl(nGaus, x, n, params, values, gradients, cutOff);
+    } // ngaus_batch()
+
+  } // namespace details
+} // namespace hit
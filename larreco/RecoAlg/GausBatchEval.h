@@ -0,0 +1,257 @@
+/**
+ * @file   GausBatchEval.h
+ * @brief  Evaluation of sums of Gaussians on whole arrays of points
+ * @see    GausFitCache.h
+ *
+ * These kernels evaluate a sum of Gaussians and its derivatives with respect
+ * to all the parameters on a full region of interest in one call, instead of
+ * one point at a time as the TF1 interface does. They do not depend on ROOT.
+ *
+ * The loops are written on short contiguous blocks and without branches, so
+ * that the compiler can vectorize them; this includes the exponential, which
+ * is computed by batch_exp() rather than by std::exp().
+ */
+
+#ifndef GAUSBATCHEVAL_H
+#define GAUSBATCHEVAL_H 1
+
+
+// C/C++ standard libraries
+#include <algorithm> // std::min(), std::fill()
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t
+#include <cstring> // std::memcpy()
+#include <limits> // std::numeric_limits<>
+#include <utility> // std::integer_sequence
+
+namespace hit {
+
+  namespace details {
+
+    /// Number of points processed together by the batched kernels
+    constexpr std::size_t GausBatchBlockSize = 64;
+
+    /**
+     * @brief Replaces each of the values with its exponential
+     * @param values array of the arguments, replaced by the results
+     * @param n number of values
+     *
+     * The argument is reduced as x = k ln(2) + r and exp(r) is computed by a
+     * degree 13 polynomial; the relative precision is a few 1e-16 in the
+     * range of the arguments, which is limited to [ -708, 709 ] (results
+     * outside that range are clamped rather than underflowing to 0 or
+     * overflowing).
+     */
+    inline void batch_exp(double* values, std::size_t n) {
+      constexpr double Log2e   = 1.4426950408889634074;
+      constexpr double Ln2Hi   = 6.93145751953125e-1;
+      constexpr double Ln2Lo   = 1.42860682030941723212e-6;
+      constexpr double Shifter = 6755399441055744.0; // 1.5 * 2^52
+      constexpr std::uint64_t ShifterBits = 0x4338000000000000ULL;
+
+      for (std::size_t i = 0; i < n; ++i) {
+        double x = values[i];
+        x = (x < -708.)? -708.: x;
+        x = (x >  709.)?  709.: x;
+
+        // k = round(x / ln 2), obtained in the low mantissa bits of kd
+        double kd = x * Log2e + Shifter;
+        std::uint64_t kBits;
+        std::memcpy(&kBits, &kd, sizeof(kBits));
+        kd -= Shifter;
+
+        double const r = (x - kd * Ln2Hi) - kd * Ln2Lo;
+
+        double p = 1./6227020800.;
+        p = p * r + 1./479001600.;
+        p = p * r + 1./39916800.;
+        p = p * r + 1./3628800.;
+        p = p * r + 1./362880.;
+        p = p * r + 1./40320.;
+        p = p * r + 1./5040.;
+        p = p * r + 1./720.;
+        p = p * r + 1./120.;
+        p = p * r + 1./24.;
+        p = p * r + 1./6.;
+        p = p * r + 0.5;
+        p = p * r + 1.;
+        p = p * r + 1.;
+
+        // 2^k built directly in the exponent bits
+        std::uint64_t const scaleBits = (kBits - ShifterBits + 1023ULL) << 52;
+        double scale;
+        std::memcpy(&scale, &scaleBits, sizeof(scale));
+
+        values[i] = p * scale;
+      } // for
+    } // batch_exp()
+
+
+    /// Cut-off value meaning that the Gaussians are not truncated
+    constexpr double NoGausCutOff = std::numeric_limits<double>::infinity();
+
+
+    /**
+     * @brief Adds one Gaussian of a sum on a block of points
+     * @param iGaus index of the Gaussian in the sum
+     * @param xb the points of the block
+     * @param m number of points in the block
+     * @param start index of the first point of the block
+     * @param n total number of points
+     * @param params parameters of all the Gaussians
+     * @param vb (output) the values of the block, the Gaussian is added
+     * @param gradients (output) derivatives of all points, or nullptr
+     * @param cutOff the Gaussian is 0 beyond this many sigma from its mean
+     * @param expo workspace with room for m values
+     *
+     * This is the body of the loop on the Gaussians of ngaus_batch_impl()
+     * and ngaus_batch().
+     */
+    inline void gaus_batch_block(
+      unsigned int iGaus,
+      double const* xb, std::size_t m, std::size_t start, std::size_t n,
+      double const* params, double* vb, double* gradients, double cutOff,
+      double* expo
+      )
+    {
+      double const amplitude = params[3 * iGaus];
+      double const mean      = params[3 * iGaus + 1];
+      double const invSigma  = 1. / params[3 * iGaus + 2];
+
+      for (std::size_t i = 0; i < m; ++i) {
+        double const z = (xb[i] - mean) * invSigma;
+        expo[i] = -0.5 * z * z;
+      } // for
+
+      batch_exp(expo, m);
+
+      // truncation as in CompiledGausFitCacheBaseStruct::gaus_trunc(),
+      // applied as a mask so that the loop stays without branches
+      if (cutOff < NoGausCutOff) {
+        for (std::size_t i = 0; i < m; ++i) {
+          double const z = (xb[i] - mean) * invSigma;
+          expo[i] *= ((z > -cutOff) && (z < cutOff))? 1.: 0.;
+        } // for
+      }
+
+      for (std::size_t i = 0; i < m; ++i) vb[i] += amplitude * expo[i];
+
+      if (!gradients) return;
+
+      double* dAmplitude = gradients + (3 * iGaus) * n + start;
+      double* dMean      = dAmplitude + n;
+      double* dSigma     = dMean + n;
+
+      for (std::size_t i = 0; i < m; ++i) {
+        double const z = (xb[i] - mean) * invSigma;
+        dAmplitude[i] = expo[i];
+        dMean[i]      = amplitude * expo[i] * z * invSigma;
+        dSigma[i]     = dMean[i] * z;
+      } // for
+    } // gaus_batch_block()
+
+
+    /**
+     * @brief Sum of nGaus Gaussians and its gradient on an array of points
+     * @param nGaus number of Gaussians in the sum
+     * @param x the points where to evaluate the function
+     * @param n number of points
+     * @param params amplitude, mean and sigma of each Gaussian
+     * @param values (output) function values, n of them
+     * @param gradients (output) derivatives, or nullptr if not needed
+     * @param cutOff each Gaussian is 0 beyond this many sigma from its mean
+     *
+     * The derivatives are stored by parameter: the n derivatives with respect
+     * to the first parameter, then the ones with respect to the second, and
+     * so on, for a total of 3 * nGaus * n values.
+     * The parameters have the same meaning as in
+     * CompiledGausFitCacheBaseStruct::ngaus().
+     */
+    inline void ngaus_batch_impl(
+      unsigned int nGaus,
+      double const* x, std::size_t n, double const* params,
+      double* values, double* gradients, double cutOff = NoGausCutOff
+      )
+    {
+      double expo[GausBatchBlockSize];
+
+      for (std::size_t start = 0; start < n; start += GausBatchBlockSize) {
+        std::size_t const m = std::min(GausBatchBlockSize, n - start);
+        double* vb = values + start;
+
+        std::fill(vb, vb + m, 0.);
+
+        for (unsigned int iGaus = 0; iGaus < nGaus; ++iGaus) {
+          gaus_batch_block
+            (iGaus, x + start, m, start, n, params, vb, gradients, cutOff, expo);
+        } // for Gaussians
+      } // for blocks
+
+    } // ngaus_batch_impl()
+
+
+    /// Adds the Gaussians with the indices in the sequence on a block
+    template <unsigned int... IGaus>
+    inline void ngaus_batch_block(
+      std::integer_sequence<unsigned int, IGaus...>,
+      double const* xb, std::size_t m, std::size_t start, std::size_t n,
+      double const* params, double* vb, double* gradients, double cutOff,
+      double* expo
+      )
+    {
+      (gaus_batch_block
+        (IGaus, xb, m, start, n, params, vb, gradients, cutOff, expo), ...);
+    } // ngaus_batch_block()
+
+
+    /**
+     * @brief Batched sum of NGaus Gaussians (see ngaus_batch_impl())
+     *
+     * The loop on the Gaussians is expanded at compile time, so that each
+     * of them is evaluated with its parameter offsets known as constants.
+     */
+    template <unsigned int NGaus>
+    void ngaus_batch(
+      double const* x, std::size_t n, double const* params,
+      double* values, double* gradients, double cutOff = NoGausCutOff
+      )
+    {
+      double expo[GausBatchBlockSize];
+
+      for (std::size_t start = 0; start < n; start += GausBatchBlockSize) {
+        std::size_t const m = std::min(GausBatchBlockSize, n - start);
+        double* vb = values + start;
+
+        std::fill(vb, vb + m, 0.);
+
+        if constexpr (NGaus > 0) {
+          ngaus_batch_block(
+            std::make_integer_sequence<unsigned int, NGaus>(),
+            x + start, m, start, n, params, vb, gradients, cutOff, expo
+            );
+        }
+      } // for blocks
+    } // ngaus_batch()
+
+
+    /// Maximum number of Gaussians with a compiled batched kernel
+    constexpr unsigned int MaxBatchGaussians = 32;
+
+    /**
+     * @brief Batched sum of nGaus Gaussians, chosen at run time
+     * @see ngaus_batch()
+     *
+     * Up to MaxBatchGaussians the kernel compiled for the specific number of
+     * Gaussians is used; beyond that, the generic one.
+     */
+    void ngaus_batch(
+      std::size_t nGaus,
+      double const* x, std::size_t n, double const* params,
+      double* values, double* gradients, double cutOff = NoGausCutOff
+      );
+
+  } // namespace details
+
+} // namespace hit
+
+#endif // GAUSBATCHEVAL_H
@@ -109,6 +109,17 @@ namespace hit {
       << MaxGaussians() << " addends available\n";
   } // CompiledGausFitCache<>::CannotCreateFunction()
 
+
+  void details::CompiledGausFitCacheBaseStruct::EvalBatchWithCutOff(
+    std::size_t nGaus,
+    Double_t const* x, std::size_t n, Double_t const* params,
+    Double_t* values, Double_t* gradients, Double_t cutOff
+    ) const
+  {
+    if (nGaus > MaxGaussians()) CannotCreateFunction(nGaus);
+    hit::details::ngaus_batch(nGaus, x, n, params, values, gradients, cutOff);
+  } // CompiledGausFitCacheBaseStruct::EvalBatchWithCutOff()
+
   //----------------------------------------------------------------------------
 
 } // namespace hit
@@ -14,9 +14,13 @@
 
 
 // C/C++ standard libraries
+#include <cstddef> // std::size_t
 #include <string>
 #include <vector>
 
+// LArSoft libraries
+#include "larreco/RecoAlg/GausBatchEval.h"
+
 // ROOT libraries
 #include "RtypesCore.h" // Double_t
 #include "TF1.h" // Double_t
@@ -217,8 +221,59 @@ namespace hit {
       using NGaussTruncClass = FuncSum<NGaus, gaus_trunc<CutOff>, 3U>;
 
 
+      /**
+       * @brief Sum of NGaus Gaussians and its gradient on many points at once
+       * @tparam NGaus number of Gaussians in the sum
+       * @param x the points where to evaluate the function
+       * @param n number of points
+       * @param params parameters, as for ngaus()
+       * @param values (output) the n values of the function
+       * @param gradients (output) the derivatives, or nullptr if not needed
+       *
+       * This is the batched equivalent of ngaus(), computing the function on a
+       * whole region of interest in one call. The gradient is stored by
+       * parameter: the n derivatives respect to the first parameter first.
+       */
+      template <unsigned int NGaus>
+      static void ngaus_batch(
+        Double_t const* x, std::size_t n, Double_t const* params,
+        Double_t* values, Double_t* gradients = nullptr
+        )
+        { hit::details::ngaus_batch<NGaus>(x, n, params, values, gradients); }
+
+      /// Batched equivalent of ngaus_trunc() (see ngaus_batch())
+      template <unsigned int NGaus, unsigned int CutOff>
+      static void ngaus_trunc_batch(
+        Double_t const* x, std::size_t n, Double_t const* params,
+        Double_t* values, Double_t* gradients = nullptr
+        )
+        {
+          hit::details::ngaus_batch<NGaus>
+            (x, n, params, values, gradients, Double_t(CutOff));
+        }
+
+      /// Batched evaluation of the function with nGaus Gaussians
+      /// (see ngaus_batch(); nGaus must not exceed MaxGaussians())
+      virtual void EvalBatch(
+        std::size_t nGaus,
+        Double_t const* x, std::size_t n, Double_t const* params,
+        Double_t* values, Double_t* gradients = nullptr
+        ) const
+        {
+          EvalBatchWithCutOff(nGaus, x, n, params, values, gradients,
+            hit::details::NoGausCutOff);
+        }
+
+
         protected:
 
+      /// Batched evaluation of nGaus Gaussians truncated at cutOff sigmas
+      void EvalBatchWithCutOff(
+        std::size_t nGaus,
+        Double_t const* x, std::size_t n, Double_t const* params,
+        Double_t* values, Double_t* gradients, Double_t cutOff
+        ) const;
+
       /**
        * @brief A helper class initializing the function vector
        * @tparam NFunc the maximum number of base functions in a function
@@ -329,6 +384,17 @@ namespace hit {
     /// Returns the maximum number of Gaussians in a function that we support
     constexpr unsigned int StoredMaxGaussians() const { return MaxGaus; }
 
+    /// Batched evaluation of the truncated function with nGaus Gaussians
+    virtual void EvalBatch(
+      std::size_t nGaus,
+      Double_t const* x, std::size_t n, Double_t const* params,
+      Double_t* values, Double_t* gradients = nullptr
+      ) const override
+      {
+        EvalBatchWithCutOff
+          (nGaus, x, n, params, values, gradients, Double_t(CutOff));
+      }
+
       protected:
 
     /// Throws an error, since this class can't create functions run-time
@@ -0,0 +1,291 @@
+/**
+ * @file   GausLMFitter.cxx
+ * @brief  Levenberg-Marquardt fit of a sum of Gaussians without ROOT objects
+ * @see    GausLMFitter.h
+ */
+
+// Library header
+#include "GausLMFitter.h"
+#include "GausBatchEval.h"
+
+// C/C++ standard libraries
+#include <algorithm> // std::min(), std::max(), std::copy()
+#include <cmath> // std::exp(), std::sqrt()
+
+
+namespace hit {
+
+  //----------------------------------------------------------------------------
+  void GausLMFitter::SetData
+    (float const* data, std::size_t nSamples, double xStart, bool skipEmpty)
+  {
+    // clear() keeps the capacity, so no allocation once we are warmed up
+    fX.clear();
+    fY.clear();
+
+    for (std::size_t iSample = 0; iSample < nSamples; ++iSample) {
+      if (skipEmpty && data[iSample] == 0.f) continue;
+      fX.push_back(xStart + iSample);
+      fY.push_back(data[iSample]);
+    } // for
+  } // GausLMFitter::SetData()
+
+
+  //----------------------------------------------------------------------------
+  bool GausLMFitter::Fit(std::size_t nGaus,
+                         std::vector<double>& params,
+                         std::vector<double> const& parMin,
+                         std::vector<double> const& parMax,
+                         bool floatBaseline)
+  {
+    std::size_t const nParams = 3 * nGaus + 1;
+    std::size_t const nPoints = fX.size();
+
+    fNFree       = floatBaseline? nParams: nParams - 1;
+    fNIterations = 0;
+    fChi2        = 0.;
+
+    fParErrors.assign(nParams, 0.);
+
+    if (nPoints <= fNFree) return false;
+
+    fResidual.resize(nPoints);
+    fArg.resize(nPoints);
+    fJacobian.resize(fNFree * nPoints);
+    fAlpha.resize(fNFree * fNFree);
+    fMatrix.resize(fNFree * fNFree);
+    fBeta.resize(fNFree);
+    fStep.resize(fNFree);
+    fTrial.resize(nParams);
+
+    // start from inside the limits
+    for (std::size_t iPar = 0; iPar < fNFree; ++iPar)
+      params[iPar] = std::min(std::max(params[iPar], parMin[iPar]), parMax[iPar]);
+
+    double chi2 = Evaluate(nGaus, params.data(), true);
+    FillNormalEquations(fNFree);
+
+    double lambda = 1e-3;
+    bool converged = false;
+
+    while (fNIterations < fMaxIterations) {
+
+      // damped normal equations
+      std::copy(fAlpha.begin(), fAlpha.end(), fMatrix.begin());
+      for (std::size_t iPar = 0; iPar < fNFree; ++iPar) {
+        double& diag = fMatrix[iPar * fNFree + iPar];
+        diag = (diag > 0.)? diag * (1. + lambda): lambda;
+      } // for
+
+      bool const decomposed = Decompose(fNFree);
+
+      if (decomposed) {
+        std::copy(fBeta.begin(), fBeta.end(), fStep.begin());
+        Solve(fNFree, fStep.data());
+
+        // bounded step: the parameters are projected back into the limits
+        std::copy(params.begin(), params.begin() + nParams, fTrial.begin());
+        for (std::size_t iPar = 0; iPar < fNFree; ++iPar) {
+          fTrial[iPar] = std::min
+            (std::max(params[iPar] + fStep[iPar], parMin[iPar]), parMax[iPar]);
+        } // for
+
+        double const trialChi2 = Evaluate(nGaus, fTrial.data(), false);
+
+        if (trialChi2 < chi2) {
+          ++fNIterations;
+
+          double const deltaChi2 = chi2 - trialChi2;
+
+          std::copy(fTrial.begin(), fTrial.begin() + nParams, params.begin());
+          chi2 = Evaluate(nGaus, params.data(), true);
+          FillNormalEquations(fNFree);
+
+          lambda = std::max(lambda * 0.1, 1e-12);
+
+          if (deltaChi2 <= fRelTolerance * chi2) {
+            converged = true;
+            break;
+          }
+          continue;
+        } // if improved
+      } // if decomposed
+
+      // no improvement possible: either we are sitting on the minimum (the
+      // step vanishes) or the problem is degenerate
+      lambda *= 10.;
+      if (lambda > 1e10) {
+        converged = decomposed;
+        break;
+      }
+    } // while
+
+    fChi2 = chi2;
+
+    // errors from the covariance matrix (J^T J)^-1 at the minimum; with unit
+    // weights ROOT scales them by sqrt(chi2/NDF), and so do we
+    int const ndf = NDF();
+    double const errorScale = (ndf > 0)? std::sqrt(chi2 / ndf): 1.;
+    std::copy(fAlpha.begin(), fAlpha.end(), fMatrix.begin());
+    if (Decompose(fNFree)) {
+      for (std::size_t iPar = 0; iPar < fNFree; ++iPar) {
+        std::fill(fStep.begin(), fStep.end(), 0.);
+        fStep[iPar] = 1.;
+        Solve(fNFree, fStep.data());
+        fParErrors[iPar] = errorScale * std::sqrt(std::max(fStep[iPar], 0.));
+      } // for
+    } // if
+
+    return converged;
+  } // GausLMFitter::Fit()
+
+
+  //----------------------------------------------------------------------------
+  double GausLMFitter::Evaluate
+    (std::size_t nGaus, double const* params, bool jacobian)
+  {
+    std::size_t const nPoints = fX.size();
+    double const* x = fX.data();
+    double const* y = fY.data();
+    double* residual = fResidual.data();
+    double* arg = fArg.data();
+
+    double const baseline = params[3 * nGaus];
+
+    if (fBatchKernel) {
+      // the Jacobian rows for the Gaussians have the layout of the kernel
+      details::ngaus_batch
+        (nGaus, x, nPoints, params, arg, jacobian? fJacobian.data(): nullptr);
+      for (std::size_t i = 0; i < nPoints; ++i)
+        residual[i] = y[i] - baseline - arg[i];
+    }
+    else {
+      for (std::size_t i = 0; i < nPoints; ++i) residual[i] = y[i] - baseline;
+      EvaluateGaussians(nGaus, params, jacobian);
+    }
+
+    if (jacobian && (fNFree > 3 * nGaus)) {
+      double* dBaseline = fJacobian.data() + (3 * nGaus) * nPoints;
+      std::fill(dBaseline, dBaseline + nPoints, 1.);
+    }
+
+    double chi2 = 0.;
+    for (std::size_t i = 0; i < nPoints; ++i) chi2 += residual[i] * residual[i];
+
+    return chi2;
+  } // GausLMFitter::Evaluate()
+
+
+  //----------------------------------------------------------------------------
+  void GausLMFitter::EvaluateGaussians
+    (std::size_t nGaus, double const* params, bool jacobian)
+  {
+    std::size_t const nPoints = fX.size();
+    double const* x = fX.data();
+    double* residual = fResidual.data();
+    double* arg = fArg.data();
+
+    // the loops are kept simple and on contiguous arrays so that the compiler
+    // can vectorize them
+    for (std::size_t iGaus = 0; iGaus < nGaus; ++iGaus) {
+      double const amplitude = params[3 * iGaus];
+      double const mean      = params[3 * iGaus + 1];
+      double const invSigma  = 1. / params[3 * iGaus + 2];
+
+      for (std::size_t i = 0; i < nPoints; ++i) {
+        double const z = (x[i] - mean) * invSigma;
+        arg[i] = -0.5 * z * z;
+      } // for
+
+      for (std::size_t i = 0; i < nPoints; ++i) arg[i] = std::exp(arg[i]);
+
+      for (std::size_t i = 0; i < nPoints; ++i)
+        residual[i] -= amplitude * arg[i];
+
+      if (!jacobian) continue;
+
+      double* dAmplitude = fJacobian.data() + (3 * iGaus) * nPoints;
+      double* dMean      = dAmplitude + nPoints;
+      double* dSigma     = dMean + nPoints;
+
+      for (std::size_t i = 0; i < nPoints; ++i) {
+        double const z = (x[i] - mean) * invSigma;
+        dAmplitude[i] = arg[i];
+        dMean[i]      = amplitude * arg[i] * z * invSigma;
+        dSigma[i]     = dMean[i] * z;
+      } // for
+    } // for Gaussians
+
+  } // GausLMFitter::EvaluateGaussians()
+
+
+  //----------------------------------------------------------------------------
+  void GausLMFitter::FillNormalEquations(std::size_t nParams) {
+
+    std::size_t const nPoints = fX.size();
+    double const* residual = fResidual.data();
+
+    for (std::size_t j = 0; j < nParams; ++j) {
+      double const* rowJ = fJacobian.data() + j * nPoints;
+
+      double beta = 0.;
+      for (std::size_t i = 0; i < nPoints; ++i) beta += rowJ[i] * residual[i];
+      fBeta[j] = beta;
+
+      for (std::size_t k = 0; k <= j; ++k) {
+        double const* rowK = fJacobian.data() + k * nPoints;
+
+        double alpha = 0.;
+        for (std::size_t i = 0; i < nPoints; ++i) alpha += rowJ[i] * rowK[i];
+        fAlpha[j * nParams + k] = fAlpha[k * nParams + j] = alpha;
+      } // for k
+    } // for j
+
+  } // GausLMFitter::FillNormalEquations()
+
+
+  //----------------------------------------------------------------------------
+  bool GausLMFitter::Decompose(std::size_t n) {
+
+    // lower triangular Cholesky factor, stored in place
+    double* a = fMatrix.data();
+    for (std::size_t j = 0; j < n; ++j) {
+      double diag = a[j * n + j];
+      for (std::size_t k = 0; k < j; ++k) diag -= a[j * n + k] * a[j * n + k];
+      if (!(diag > 0.)) return false;
+      diag = std::sqrt(diag);
+      a[j * n + j] = diag;
+
+      for (std::size_t i = j + 1; i < n; ++i) {
+        double value = a[i * n + j];
+        for (std::size_t k = 0; k < j; ++k) value -= a[i * n + k] * a[j * n + k];
+        a[i * n + j] = value / diag;
+      } // for i
+    } // for j
+    return true;
+  } // GausLMFitter::Decompose()
+
+
+  //----------------------------------------------------------------------------
+  void GausLMFitter::Solve(std::size_t n, double* rhs) const {
+
+    double const* a = fMatrix.data();
+
+    // L z = rhs
+    for (std::size_t i = 0; i < n; ++i) {
+      double value = rhs[i];
+      for (std::size_t k = 0; k < i; ++k) value -= a[i * n + k] * rhs[k];
+      rhs[i] = value / a[i * n + i];
+    } // for
+
+    // L^T x = z
+    for (std::size_t i = n; i-- > 0; ) {
+      double value = rhs[i];
+      for (std::size_t k = i + 1; k < n; ++k) value -= a[k * n + i] * rhs[k];
+      rhs[i] = value / a[i * n + i];
+    } // for
+
+  } // GausLMFitter::Solve()
+
+
+} // namespace hit
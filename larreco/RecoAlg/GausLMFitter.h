@@ -0,0 +1,148 @@
+/**
+ * @file   GausLMFitter.h
+ * @brief  Levenberg-Marquardt fit of a sum of Gaussians without ROOT objects
+ * @see    GausLMFitter.cxx
+ *
+ * The fitter works directly on a span of waveform samples and is meant as a
+ * replacement for filling a TH1 and calling TH1::Fit() with a function from
+ * GausFitCache, which pays for a histogram, a TF1 and Minuit on every pulse.
+ */
+
+#ifndef GAUSLMFITTER_H
+#define GAUSLMFITTER_H 1
+
+
+// C/C++ standard libraries
+#include <cstddef> // std::size_t
+#include <vector>
+
+namespace hit {
+
+  /** **************************************************************************
+   * @brief Bounded Levenberg-Marquardt fitter for a sum of Gaussians
+   *
+   * The model is a sum of `nGaus` Gaussians plus a constant baseline:
+   *
+   *     f(x) = sum_i A_i exp(-(x - m_i)^2 / (2 s_i^2)) + b
+   *
+   * The parameters follow the GausFitCache convention: amplitude, mean and
+   * sigma of the first Gaussian, then of the second one and so on; the
+   * baseline is always the last parameter and it can be kept fixed.
+   *
+   * All samples have unit weight, which is what ROOT does with the "W" fit
+   * option; samples with exactly zero content are skipped on request, again
+   * like ROOT does with that option. Parameter errors are the square root of
+   * the diagonal of (J^T J)^-1 at the minimum, scaled by sqrt(chi2/NDF) as
+   * ROOT does for fits with unit weights.
+   *
+   * The Jacobian is computed analytically. All the buffers are data members
+   * that only grow, so after the first few pulses a fit does not allocate any
+   * memory. The object is therefore not reentrant: use one per thread.
+   */
+  class GausLMFitter {
+      public:
+
+    /**
+     * @brief Constructor
+     * @param maxIterations maximum number of accepted steps in a fit
+     * @param relTolerance relative chi square change to stop at
+     * @param batchKernel use the batched kernels from GausBatchEval.h
+     *
+     * The batched kernels compute the model for all samples in blocks, with
+     * their own vectorizable exponential, instead of with std::exp().
+     */
+    GausLMFitter(
+      unsigned int maxIterations = 100, double relTolerance = 1e-6,
+      bool batchKernel = false
+      )
+      : fMaxIterations(maxIterations)
+      , fRelTolerance(relTolerance)
+      , fBatchKernel(batchKernel)
+      {}
+
+    /**
+     * @brief Sets the samples to be fitted
+     * @param data pointer to the first sample
+     * @param nSamples number of samples
+     * @param xStart abscissa of the first sample
+     * @param skipEmpty whether to exclude samples with zero content
+     *
+     * The abscissa of sample `i` is `xStart + i`.
+     */
+    void SetData
+      (float const* data, std::size_t nSamples, double xStart, bool skipEmpty);
+
+    /**
+     * @brief Fits the data with the specified number of Gaussians
+     * @param nGaus number of Gaussians in the model
+     * @param params (in: starting values, out: result) 3 * nGaus + 1 values
+     * @param parMin lower limits of the parameters
+     * @param parMax upper limits of the parameters
+     * @param floatBaseline if false, the baseline is kept at its start value
+     * @return whether the fit converged
+     *
+     * Limits for the baseline are ignored when it is not floating.
+     */
+    bool Fit(std::size_t nGaus,
+             std::vector<double>& params,
+             std::vector<double> const& parMin,
+             std::vector<double> const& parMax,
+             bool floatBaseline);
+
+    /// Chi square of the last fit (sum of squared residuals)
+    double Chi2() const { return fChi2; }
+
+    /// Degrees of freedom of the last fit
+    int NDF() const { return int(fX.size()) - int(fNFree); }
+
+    /// Errors of the parameters of the last fit (0 for fixed ones)
+    std::vector<double> const& ParErrors() const { return fParErrors; }
+
+    /// Number of iterations used by the last fit
+    unsigned int NIterations() const { return fNIterations; }
+
+      private:
+
+    unsigned int fMaxIterations; ///< maximum number of accepted steps
+    double       fRelTolerance;  ///< relative chi2 change to stop at
+    bool         fBatchKernel;   ///< evaluate with details::ngaus_batch()
+
+    std::size_t  fNFree = 0;       ///< free parameters in the last fit
+    double       fChi2 = 0.;       ///< chi square of the last fit
+    unsigned int fNIterations = 0; ///< iterations of the last fit
+
+    // --- workspaces, only grow
+    std::vector<double> fX;         ///< abscissa of the samples
+    std::vector<double> fY;         ///< content of the samples
+    std::vector<double> fResidual;  ///< data minus model
+    std::vector<double> fArg;       ///< exponent argument, then exponential
+    std::vector<double> fJacobian;  ///< derivatives, one row per parameter
+    std::vector<double> fAlpha;     ///< J^T J
+    std::vector<double> fBeta;      ///< J^T r
+    std::vector<double> fMatrix;    ///< damped J^T J, Cholesky factor
+    std::vector<double> fStep;      ///< proposed parameter step
+    std::vector<double> fTrial;     ///< trial parameters
+    std::vector<double> fParErrors; ///< parameter errors
+
+    /// Evaluates the residuals and (if jacobian is true) the derivatives
+    /// of the model on all the current samples; returns the chi square
+    double Evaluate(std::size_t nGaus, double const* params, bool jacobian);
+
+    /// Subtracts the Gaussians from the residuals and fills their derivatives
+    void EvaluateGaussians
+      (std::size_t nGaus, double const* params, bool jacobian);
+
+    /// Fills J^T J and J^T r from the current Jacobian and residuals
+    void FillNormalEquations(std::size_t nParams);
+
+    /// Cholesky decomposition of fMatrix in place; false if not positive
+    bool Decompose(std::size_t n);
+
+    /// Solves fMatrix x = rhs using the decomposition, result in rhs
+    void Solve(std::size_t n, double* rhs) const;
+
+  }; // class GausLMFitter
+
+} // namespace hit
+
+#endif // GAUSLMFITTER_H
@@ -30,6 +30,38 @@
 #include "lardata/RecoObjects/KHitTrack.h"
 #include "lardata/RecoObjects/KHitWireX.h"
 
+namespace {
+
+    /// A hit with the number of its wire, which is the sort key within a plane.
+    typedef std::pair<unsigned int, art::Ptr<recob::Hit> > WireHit_t;
+
+    /// The hits of one plane: a range of the flat hit array, sorted by wire.
+    struct PlaneHits_t {
+        std::vector<WireHit_t>::const_iterator first;
+        std::vector<WireHit_t>::const_iterator last;
+
+        std::vector<WireHit_t>::const_iterator begin() const { return first; }
+        std::vector<WireHit_t>::const_iterator end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+
+        /// First hit with wire number not less than wire.
+        std::vector<WireHit_t>::const_iterator lower_bound(unsigned int wire) const
+        {
+            return std::lower_bound(first, last, wire,
+                                    [](const WireHit_t& h, unsigned int w){ return h.first < w; });
+        }
+
+        /// First hit with wire number greater than wire.
+        std::vector<WireHit_t>::const_iterator upper_bound(unsigned int wire) const
+        {
+            return std::upper_bound(first, last, wire,
+                                    [](unsigned int w, const WireHit_t& h){ return w < h.first; });
+        }
+    };
+
+} // end anonymous namespace
+
 //----------------------------------------------------------------------
 // Constructor.
 //
@@ -894,34 +926,69 @@ namespace  trkf{
         int n2filt = 0;  // Number of two-hit space points after filtering/merging.
         int n3filt = 0;  // Number of three-hit space pointe after filtering/merging.
 
-        // Sort hits into maps indexed by [cryostat][tpc][plane][wire].
+        // Sort hits into a single flat array ordered by [cryostat][tpc][plane][wire]
+        // (hits on the same wire keep their input order).  The hits of each
+        // plane are a contiguous range of the array, and wire windows are
+        // found by binary search.
         // If using mc information, also generate maps of sim::IDEs and mc
         // position indexed by hit.
 
-        std::vector< std::vector<std::vector<std::multimap<unsigned int, art::Ptr<recob::Hit> > > > > hitmap;
         fHitMCMap.clear();
 
+        // Index of the first plane of each [cryostat][tpc] in the global plane numbering.
         unsigned int ncstat = geom->Ncryostats();
-        hitmap.resize(ncstat);
+        std::vector<std::vector<unsigned int> > firstPlane(ncstat);
+        unsigned int nplanes_total = 0;
         for(unsigned int cstat = 0; cstat < ncstat; ++cstat){
             unsigned int ntpc = geom->Cryostat(cstat).NTPC();
-            hitmap[cstat].resize(ntpc);
+            firstPlane[cstat].resize(ntpc);
             for(unsigned int tpc = 0; tpc < ntpc; ++tpc) {
-                int nplane = geom->Cryostat(cstat).TPC(tpc).Nplanes();
-                hitmap[cstat][tpc].resize(nplane);
+                firstPlane[cstat][tpc] = nplanes_total;
+                nplanes_total += geom->Cryostat(cstat).TPC(tpc).Nplanes();
             }
         }
 
+        // Counting sort of the hits by plane.
+        std::vector<unsigned int> hitPlane;
+        hitPlane.reserve(hits.size());
+        std::vector<unsigned int> planeOffset(nplanes_total + 1, 0);
         for(art::PtrVector<recob::Hit>::const_iterator ihit = hits.begin(); ihit != hits.end(); ++ihit) {
             const art::Ptr<recob::Hit>& phit = *ihit;
             geo::View_t view = phit->View();
+            unsigned int iplane = nplanes_total;  // Hit view not enabled.
             if((view == geo::kU && fEnableU) ||
                (view == geo::kV && fEnableV) ||
                (view == geo::kZ && fEnableW)) {
                 geo::WireID phitWireID = phit->WireID();
-                hitmap[phitWireID.Cryostat][phitWireID.TPC][phitWireID.Plane].insert(std::make_pair(phitWireID.Wire, phit));
+                iplane = firstPlane[phitWireID.Cryostat][phitWireID.TPC] + phitWireID.Plane;
+                ++planeOffset[iplane + 1];
             }
+            hitPlane.push_back(iplane);
         }
+        for(unsigned int i = 0; i < nplanes_total; ++i)
+            planeOffset[i + 1] += planeOffset[i];
+
+        std::vector<WireHit_t> sortedHits(planeOffset.back());
+        {
+            std::vector<unsigned int> next(planeOffset.begin(), planeOffset.end() - 1);
+            for(size_t i = 0; i < hits.size(); ++i) {
+                if(hitPlane[i] == nplanes_total) continue;
+                const art::Ptr<recob::Hit>& phit = hits[i];
+                sortedHits[next[hitPlane[i]]++] = WireHit_t(phit->WireID().Wire, phit);
+            }
+        }
+        for(unsigned int i = 0; i < nplanes_total; ++i) {
+            std::stable_sort(sortedHits.begin() + planeOffset[i], sortedHits.begin() + planeOffset[i + 1],
+                             [](const WireHit_t& a, const WireHit_t& b){ return a.first < b.first; });
+        }
+
+        // Hits of one plane.
+        auto hitmap = [&](unsigned int cstat, unsigned int tpc, unsigned int plane)
+        {
+            unsigned int iplane = firstPlane[cstat][tpc] + plane;
+            return PlaneHits_t{sortedHits.begin() + planeOffset[iplane],
+                               sortedHits.begin() + planeOffset[iplane + 1]};
+        };
 
         // Fill mc information, including IDEs and closest neighbors
         // of each hit.
@@ -935,9 +1002,8 @@ namespace  trkf{
                 for(unsigned int tpc = 0; tpc < geom->Cryostat(cstat).NTPC(); ++tpc) {
                     int nplane = geom->Cryostat(cstat).TPC(tpc).Nplanes();
                     for(int plane = 0; plane < nplane; ++plane) {
-                        for(std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator ihit = hitmap[cstat][tpc][plane].begin();
-                            ihit != hitmap[cstat][tpc][plane].end(); ++ihit) {
-                            const art::Ptr<recob::Hit>& phit = ihit->second;
+                        for(const WireHit_t& whit : hitmap(cstat, tpc, plane)) {
+                            const art::Ptr<recob::Hit>& phit = whit.second;
                             const recob::Hit& hit = *phit;
                             HitMCInfo& mcinfo = fHitMCMap[&hit];   // Default HitMCInfo.
 
@@ -976,9 +1042,8 @@ namespace  trkf{
                 for(unsigned int tpc = 0; tpc < geom->Cryostat(cstat).NTPC(); ++tpc) {
                     int nplane = geom->Cryostat(cstat).TPC(tpc).Nplanes();
                     for(int plane = 0; plane < nplane; ++plane) {
-                        for(std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator ihit = hitmap[cstat][tpc][plane].begin();
-                            ihit != hitmap[cstat][tpc][plane].end(); ++ihit) {
-                            const art::Ptr<recob::Hit>& phit = ihit->second;
+                        for(const WireHit_t& whit : hitmap(cstat, tpc, plane)) {
+                            const art::Ptr<recob::Hit>& phit = whit.second;
                             const recob::Hit& hit = *phit;
                             HitMCInfo& mcinfo = fHitMCMap[&hit];
                             if(mcinfo.xyz.size() != 0) {
@@ -987,9 +1052,8 @@ namespace  trkf{
                                 // Fill nearest neighbor information for this hit.
 
                                 for(int plane2 = 0; plane2 < nplane; ++plane2) {
-                                    for(std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator jhit = hitmap[cstat][tpc][plane2].begin();
-                                        jhit != hitmap[cstat][tpc][plane2].end(); ++jhit) {
-                                        const art::Ptr<recob::Hit>& phit2 = jhit->second;
+                                    for(const WireHit_t& whit2 : hitmap(cstat, tpc, plane2)) {
+                                        const art::Ptr<recob::Hit>& phit2 = whit2.second;
                                         const recob::Hit& hit2 = *phit2;
                                         const HitMCInfo& mcinfo2 = fHitMCMap[&hit2];
 
@@ -1022,23 +1086,27 @@ namespace  trkf{
 
             for(unsigned int cstat = 0; cstat < ncstat; ++cstat){
                 for(unsigned int tpc = 0; tpc < geom->Cryostat(cstat).NTPC(); ++tpc) {
-                    int nplane = hitmap[cstat][tpc].size();
+                    int nplane = geom->Cryostat(cstat).TPC(tpc).Nplanes();
                     for(int plane = 0; plane < nplane; ++plane) {
                         debug << "TPC, Plane: " << tpc << ", " << plane
-                        << ", hits = " << hitmap[cstat][tpc][plane].size() << "\n";
+                        << ", hits = " << hitmap(cstat, tpc, plane).size() << "\n";
                     }
                 }
             } // end loop over cryostats
         } // if debug
 
-        // Make empty multimap from hit pointer on preferred
-        // (most-populated or collection) plane to space points that
-        // include that hit (used for sorting, filtering, and
-        // merging).
+        // Make empty list of candidate space points, each with the hit
+        // pointer on preferred (most-populated or collection) plane as key
+        // (used for sorting, filtering, and merging).  Before each transfer
+        // the candidates are ordered by key, keeping the order in which they
+        // were made for equal keys.
 
         typedef const recob::Hit* sptkey_type;
-        std::multimap<sptkey_type, recob::SpacePoint> sptmap;
-        std::set<sptkey_type> sptkeys;              // Keys of multimap.
+        std::vector<recob::SpacePoint> sptcands;   // Candidate space points.
+        std::vector<sptkey_type> sptcandkeys;      // Key of each candidate.
+        std::vector<size_t> sptorder;              // Candidates in key order.
+        sptcands.reserve(hits.size());
+        sptcandkeys.reserve(hits.size());
 
         // Loop over TPCs.
         for(unsigned int cstat = 0; cstat < ncstat; ++cstat){
@@ -1057,7 +1125,7 @@ namespace  trkf{
                 // wires.  It will also force space points to be sorted by
                 // collection plane wire.
 
-                int nplane = hitmap[cstat][tpc].size();
+                int nplane = geom->Cryostat(cstat).TPC(tpc).Nplanes();
                 std::vector<int> index(nplane);
 
                 for(int i=0; i<nplane; ++i)
@@ -1070,7 +1138,7 @@ namespace  trkf{
                         geom->SignalType(geo::PlaneID(tpcid, index[i])) == geo::kCollection;
                         bool jcoll = fPreferColl &&
                         geom->SignalType(geo::PlaneID(tpcid, index[j])) == geo::kCollection;
-                        if((hitmap[cstat][tpc][index[i]].size() > hitmap[cstat][tpc][index[j]].size() &&
+                        if((hitmap(cstat, tpc, index[i]).size() > hitmap(cstat, tpc, index[j]).size() &&
                             !jcoll) || icoll) {
                             int temp = index[i];
                             index[i] = index[j];
@@ -1082,12 +1150,11 @@ namespace  trkf{
                 // how many views with hits?
                 // This will allow for the special case where we might have only 2 planes of information and
                 // still want space points even if a three plane TPC
-                std::vector<std::multimap<unsigned int, art::Ptr<recob::Hit>>>& hitsByPlaneVec = hitmap[cstat][tpc];
                 int nViewsWithHits(0);
 
                 for(int i = 0; i < nplane; i++)
                 {
-                    if (hitsByPlaneVec[index[i]].size() > 0) nViewsWithHits++;
+                    if (hitmap(cstat, tpc, index[i]).size() > 0) nViewsWithHits++;
                 }
 
                 // If two-view space points are allowed, make a double loop
@@ -1099,12 +1166,14 @@ namespace  trkf{
                     for(int i=0; i<nplane-1; ++i) {
                         unsigned int plane1 = index[i];
 
-                        if (hitmap[cstat][tpc][plane1].empty()) continue;
+                        const PlaneHits_t hits1 = hitmap(cstat, tpc, plane1);
+                        if (hits1.empty()) continue;
 
                         for(int j=i+1; j<nplane; ++j) {
                             unsigned int plane2 = index[j];
 
-                            if (hitmap[cstat][tpc][plane2].empty()) continue;
+                            const PlaneHits_t hits2 = hitmap(cstat, tpc, plane2);
+                            if (hits2.empty()) continue;
 
                             // Get angle, pitch, and offset of plane2 wires.
                             const geo::WireGeo& wgeo2 = geom->Cryostat(cstat).TPC(tpc).Plane(plane2).Wire(0);
@@ -1118,7 +1187,7 @@ namespace  trkf{
                             double dist2 = -xyz21[1] * c2 + xyz21[2] * s2;
                             double pitch2 = geom->WirePitch(plane2, tpc, cstat);
 
-                            if(!fPreferColl && hitmap[cstat][tpc][plane1].size() > hitmap[cstat][tpc][plane2].size())
+                            if(!fPreferColl && hits1.size() > hits2.size())
                                 throw cet::exception("SpacePointAlg") << "makeSpacePoints(): hitmaps with incompatible size\n";
 
 
@@ -1127,11 +1196,9 @@ namespace  trkf{
                             art::PtrVector<recob::Hit> hitvec;
                             hitvec.reserve(2);
 
-                            for(std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                                ihit1 = hitmap[cstat][tpc][plane1].begin();
-                                ihit1 != hitmap[cstat][tpc][plane1].end(); ++ihit1) {
+                            for(const WireHit_t& whit1 : hits1) {
 
-                                const art::Ptr<recob::Hit>& phit1 = ihit1->second;
+                                const art::Ptr<recob::Hit>& phit1 = whit1.second;
                                 geo::WireID phit1WireID = phit1->WireID();
                                 const geo::WireGeo& wgeo = geom->WireIDToWireGeo(phit1WireID);
 
@@ -1154,9 +1221,9 @@ namespace  trkf{
                                 int wmin = std::max(0., std::min(wire21, wire22));
                                 int wmax = std::max(0., std::max(wire21, wire22) + 1.);
 
-                                std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                                ihit2 = hitmap[cstat][tpc][plane2].lower_bound(wmin),
-                                ihit2end = hitmap[cstat][tpc][plane2].upper_bound(wmax);
+                                std::vector<WireHit_t>::const_iterator
+                                ihit2 = hits2.lower_bound(wmin),
+                                ihit2end = hits2.upper_bound(wmax);
 
                                 for(; ihit2 != ihit2end; ++ihit2) {
 
@@ -1176,18 +1243,12 @@ namespace  trkf{
 
                                         ++n2;
 
-                                        // make a dummy vector of recob::SpacePoints
+                                        // The space point goes into the candidate list
                                         // as we are filtering or merging and don't want to
-                                        // add the created SpacePoint to the final collection just yet
-                                        // This dummy vector will hold just one recob::SpacePoint,
-                                        // which will go into the multimap and then the vector
-                                        // will go out of scope.
-
-                                        std::vector<recob::SpacePoint> sptv;
-                                        fillSpacePoint(hitvec, sptv, sptmap.size());
-                                        sptkey_type key = &*phit2;
-                                        sptmap.insert(std::pair<sptkey_type, recob::SpacePoint>(key, sptv.back()));
-                                        sptkeys.insert(key);
+                                        // add it to the final collection just yet.
+
+                                        fillSpacePoint(hitvec, sptcands, sptcands.size());
+                                        sptcandkeys.push_back(&*phit2);
                                     }
                                 }
                             }
@@ -1259,10 +1320,12 @@ namespace  trkf{
 
                     // Loop over hits in plane1.
 
-                    std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                    ihit1 = hitmap[cstat][tpc][plane1].begin(),
-                    ihit1end = hitmap[cstat][tpc][plane1].end();
-                    for(; ihit1 != ihit1end; ++ihit1) {
+                    const PlaneHits_t hits1 = hitmap(cstat, tpc, plane1);
+                    const PlaneHits_t hits2 = hitmap(cstat, tpc, plane2);
+                    const PlaneHits_t hits3 = hitmap(cstat, tpc, plane3);
+
+                    for(std::vector<WireHit_t>::const_iterator ihit1 = hits1.begin();
+                        ihit1 != hits1.end(); ++ihit1) {
 
                         unsigned int wire1 = ihit1->first;
                         const art::Ptr<recob::Hit>& phit1 = ihit1->second;
@@ -1294,9 +1357,9 @@ namespace  trkf{
                         int wmin = std::max(0., std::min(wire21, wire22));
                         int wmax = std::max(0., std::max(wire21, wire22) + 1.);
 
-                        std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                        ihit2 = hitmap[cstat][tpc][plane2].lower_bound(wmin),
-                        ihit2end = hitmap[cstat][tpc][plane2].upper_bound(wmax);
+                        std::vector<WireHit_t>::const_iterator
+                        ihit2 = hits2.lower_bound(wmin),
+                        ihit2end = hits2.upper_bound(wmax);
 
                         for(; ihit2 != ihit2end; ++ihit2) {
 
@@ -1333,9 +1396,9 @@ namespace  trkf{
                                     int w3min = std::max(0., std::ceil(w3pred - w3delta));
                                     int w3max = std::max(0., std::floor(w3pred + w3delta));
 
-                                    std::map<unsigned int, art::Ptr<recob::Hit> >::const_iterator
-                                    ihit3 = hitmap[cstat][tpc][plane3].lower_bound(w3min),
-                                    ihit3end = hitmap[cstat][tpc][plane3].upper_bound(w3max);
+                                    std::vector<WireHit_t>::const_iterator
+                                    ihit3 = hits3.lower_bound(w3min),
+                                    ihit3end = hits3.upper_bound(w3max);
 
                                     for(; ihit3 != ihit3end; ++ihit3) {
 
@@ -1371,18 +1434,12 @@ namespace  trkf{
 
                                                     ++n3;
 
-                                                    // make a dummy vector of recob::SpacePoints
+                                                    // The space point goes into the candidate list
                                                     // as we are filtering or merging and don't want to
-                                                    // add the created SpacePoint to the final collection just yet
-                                                    // This dummy vector will hold just one recob::SpacePoint,
-                                                    // which will go into the multimap and then the vector
-                                                    // will go out of scope.
-
-                                                    std::vector<recob::SpacePoint> sptv;
-                                                    fillSpacePoint(hitvec, sptv, sptmap.size()-1);
-                                                    sptkey_type key = &*phit3;
-                                                    sptmap.insert(std::pair<sptkey_type, recob::SpacePoint>(key, sptv.back()));
-                                                    sptkeys.insert(key);
+                                                    // add it to the final collection just yet.
+
+                                                    fillSpacePoint(hitvec, sptcands, sptcands.size()-1);
+                                                    sptcandkeys.push_back(&*phit3);
                                                 }
                                             }
                                         }
@@ -1393,20 +1450,28 @@ namespace  trkf{
                     }
                 }// end if fMinViews <= 3
 
+                // Order the candidates by key.  Runs of equal keys are the
+                // groups of space points to filter or merge.
+
+                sptorder.resize(sptcands.size());
+                for(size_t k = 0; k < sptorder.size(); ++k)
+                    sptorder[k] = k;
+                std::stable_sort(sptorder.begin(), sptorder.end(),
+                                 [&sptcandkeys](size_t a, size_t b){ return sptcandkeys[a] < sptcandkeys[b]; });
+
                 // Do Filtering.
 
                 if(fFilter) {
 
-                    // Transfer (some) space points from sptmap to spts.
+                    // Transfer (some) space points from the candidates to spts.
 
-                    spts.reserve(spts.size() + sptkeys.size());
+                    spts.reserve(spts.size() + sptorder.size());
 
-                    // Loop over keys of space point map.
+                    // Loop over groups of candidates with the same key.
                     // Space points that have the same key are candidates for filtering.
 
-                    for(std::set<sptkey_type>::const_iterator i = sptkeys.begin();
-                        i != sptkeys.end(); ++i) {
-                        sptkey_type key = *i;
+                    for(size_t igroup = 0; igroup < sptorder.size(); ) {
+                        sptkey_type key = sptcandkeys[sptorder[igroup]];
 
                         // Loop over space points corresponding to the current key.
                         // Choose the single best space point from among this group.
@@ -1414,14 +1479,15 @@ namespace  trkf{
                         double best_chisq = 0.;
                         const recob::SpacePoint* best_spt = 0;
 
-                        for(std::multimap<sptkey_type, recob::SpacePoint>::const_iterator j = sptmap.lower_bound(key);
-                            j != sptmap.upper_bound(key); ++j) {
-                            const recob::SpacePoint& spt = j->second;
+                        size_t jgroup = igroup;
+                        for(; jgroup < sptorder.size() && sptcandkeys[sptorder[jgroup]] == key; ++jgroup) {
+                            const recob::SpacePoint& spt = sptcands[sptorder[jgroup]];
                             if(best_spt == 0 || spt.Chisq() < best_chisq) {
                                 best_spt = &spt;
                                 best_chisq = spt.Chisq();
                             }
                         }
+                        igroup = jgroup;
 
                         // Transfer best filtered space point to result vector.
 
@@ -1439,27 +1505,26 @@ namespace  trkf{
 
                 else if(fMerge) {
 
-                    // Transfer merged space points from sptmap to spts.
+                    // Transfer merged space points from the candidates to spts.
 
-                    spts.reserve(spts.size() + sptkeys.size());
+                    spts.reserve(spts.size() + sptorder.size());
 
-                    // Loop over keys of space point map.
+                    // Loop over groups of candidates with the same key.
                     // Space points that have the same key are candidates for merging.
 
-                    for(std::set<sptkey_type>::const_iterator i = sptkeys.begin();
-                        i != sptkeys.end(); ++i) {
-                        sptkey_type key = *i;
+                    art::PtrVector<recob::Hit> merged_hits;
+
+                    for(size_t igroup = 0; igroup < sptorder.size(); ) {
+                        sptkey_type key = sptcandkeys[sptorder[igroup]];
 
                         // Loop over space points corresponding to the current key.
                         // Make a collection of hits that is the union of the hits
                         // from each candidate space point.
 
-                        std::multimap<sptkey_type, recob::SpacePoint>::const_iterator
-                        jSPT = sptmap.lower_bound(key), jSPTend = sptmap.upper_bound(key);
-
-                        art::PtrVector<recob::Hit> merged_hits;
-                        for(; jSPT != jSPTend; ++jSPT) {
-                            const recob::SpacePoint& spt = jSPT->second;
+                        merged_hits.clear();
+                        size_t jgroup = igroup;
+                        for(; jgroup < sptorder.size() && sptcandkeys[sptorder[jgroup]] == key; ++jgroup) {
+                            const recob::SpacePoint& spt = sptcands[sptorder[jgroup]];
 
                             // Loop over hits from this space points.
                             // Add each hit to the collection of all hits.
@@ -1472,6 +1537,7 @@ namespace  trkf{
                                 merged_hits.push_back(hit);
                             }
                         }
+                        igroup = jgroup;
 
                         // Remove duplicates.
 
@@ -1482,7 +1548,7 @@ namespace  trkf{
 
                         // Construct a complex space points using merged hits.
 
-                        fillComplexSpacePoint(merged_hits, spts, sptmap.size() + spts.size()-1);
+                        fillComplexSpacePoint(merged_hits, spts, sptcands.size() + spts.size()-1);
 
                         if(fMinViews <= 2)
                             ++n2filt;
@@ -1495,17 +1561,14 @@ namespace  trkf{
 
                 else {
 
-                    // Transfer all space points from sptmap to spts.
+                    // Transfer all space points from the candidates to spts.
 
-                    spts.reserve(spts.size() + sptkeys.size());
+                    spts.reserve(spts.size() + sptorder.size());
 
                     // Loop over space points.
 
-                    for(std::multimap<sptkey_type, recob::SpacePoint>::const_iterator j = sptmap.begin();
-                        j != sptmap.end(); ++j) {
-                        const recob::SpacePoint& spt = j->second;
-                        spts.push_back(spt);
-                    }
+                    for(size_t k : sptorder)
+                        spts.push_back(sptcands[k]);
 
                     // Update statistics.
 
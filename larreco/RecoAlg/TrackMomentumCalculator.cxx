@@ -17,22 +17,22 @@
 #include "Math/Functor.h"
 #include "Math/GenVector/PositionVector3D.h"
 #include "Minuit2/Minuit2Minimizer.h"
-#include "Rtypes.h"
-#include "TAxis.h"
-#include "TGraphErrors.h"
 #include "TMath.h"
 #include "TMatrixDSymEigen.h"
 #include "TMatrixDSymfwd.h"
 #include "TMatrixDfwd.h"
 #include "TMatrixT.h"
 #include "TMatrixTSym.h"
-#include "TPolyLine3D.h"
 #include "TSpline.h"
 #include "TVectorDfwd.h"
 #include "TVectorT.h"
 #include "canvas/Persistency/Common/Ptr.h"
 #include "lardataobj/RecoBase/Track.h"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
 using std::cout;
 using std::endl;
 
@@ -67,9 +67,9 @@ namespace {
 
   class FcnWrapper {
   public:
-    explicit FcnWrapper(std::vector<double>&& xmeas,
-                        std::vector<double>&& ymeas,
-                        std::vector<double>&& eymeas)
+    explicit FcnWrapper(std::vector<double> const& xmeas,
+                        std::vector<double> const& ymeas,
+                        std::vector<double> const& eymeas)
       : xmeas_{xmeas}
       , ymeas_{ymeas}
       , eymeas_{eymeas}
@@ -121,9 +121,9 @@ namespace {
     }
 
   private:
-    std::vector<double> const xmeas_;
-    std::vector<double> const ymeas_;
-    std::vector<double> const eymeas_;
+    std::vector<double> const& xmeas_;
+    std::vector<double> const& ymeas_;
+    std::vector<double> const& eymeas_;
   };
 
 }
@@ -140,6 +140,34 @@ namespace trkf {
     }
   }
 
+  TrackMomentumCalculator::Workspace::Workspace()
+    : minimizer{std::make_unique<ROOT::Minuit2::Minuit2Minimizer>()}
+  {}
+
+  TrackMomentumCalculator::Workspace::~Workspace() = default;
+  TrackMomentumCalculator::Workspace::Workspace(Workspace&&) noexcept = default;
+  TrackMomentumCalculator::Workspace&
+  TrackMomentumCalculator::Workspace::operator=(Workspace&&) noexcept = default;
+
+  void
+  TrackMomentumCalculator::fillPoints_(recob::Track const& trk,
+                                       bool const dir,
+                                       Workspace& ws) const
+  {
+    ws.recoX.clear();
+    ws.recoY.clear();
+    ws.recoZ.clear();
+
+    int const n_points = trk.NumberTrajectoryPoints();
+    for (int i = 0; i < n_points; ++i) {
+      auto const index = dir ? i : n_points - 1 - i;
+      auto const& pos = trk.LocationAtPoint(index);
+      ws.recoX.push_back(pos.X());
+      ws.recoY.push_back(pos.Y());
+      ws.recoZ.push_back(pos.Z());
+    }
+  }
+
   double
   TrackMomentumCalculator::GetTrackMomentum(double trkrange, int pdg) const
   {
@@ -253,44 +281,44 @@ namespace trkf {
   TrackMomentumCalculator::GetMomentumMultiScatterLLHD(
     const art::Ptr<recob::Track>& trk)
   {
-    std::vector<float> recoX;
-    std::vector<float> recoY;
-    std::vector<float> recoZ;
-
-    int n_points = trk->NumberTrajectoryPoints();
-
-    for (int i = 0; i < n_points; i++) {
-      auto const& pos = trk->LocationAtPoint(i);
-      recoX.push_back(pos.X());
-      recoY.push_back(pos.Y());
-      recoZ.push_back(pos.Z());
-    }
+    fillPoints_(*trk, true, fWorkspace);
+    return GetMomentumMultiScatterLLHD(
+      fWorkspace.recoX, fWorkspace.recoY, fWorkspace.recoZ, fWorkspace);
+  }
 
+  double
+  TrackMomentumCalculator::GetMomentumMultiScatterLLHD(
+    std::vector<float> const& recoX,
+    std::vector<float> const& recoY,
+    std::vector<float> const& recoZ,
+    Workspace& ws) const
+  {
     if (recoX.size() < 2)
       return -1.0;
 
-    if (!plotRecoTracks_(recoX, recoY, recoZ))
-      return -1.0;
-
     constexpr double seg_size{10.};
 
-    auto const segments = getSegTracks_(recoX, recoY, recoZ, seg_size);
-    if (!segments.has_value())
+    if (!getSegTracks_(recoX, recoY, recoZ, seg_size, ws))
       return -1.0;
 
-    auto const seg_steps = segments->x.size();
+    auto const& segments = ws.segments;
+    auto const seg_steps = segments.x.size();
     if (seg_steps < 2)
       return -1;
 
-    double const recoL = segments->L.at(seg_steps - 1);
+    double const recoL = segments.L.at(seg_steps - 1);
     if (recoL < minLength || recoL > maxLength)
       return -1;
 
-    std::vector<float> dEi;
-    std::vector<float> dEj;
-    std::vector<float> dthij;
-    std::vector<float> ind;
-    if (getDeltaThetaij_(dEi, dEj, dthij, ind, *segments, seg_size) != 0)
+    auto& dEi = ws.dEi;
+    auto& dEj = ws.dEj;
+    auto& dthij = ws.dthij;
+    auto& ind = ws.ind;
+    dEi.clear();
+    dEj.clear();
+    dthij.clear();
+    ind.clear();
+    if (getDeltaThetaij_(dEi, dEj, dthij, ind, segments, seg_size) != 0)
       return -1.0;
 
     double logL = 1e+16;
@@ -341,43 +369,43 @@ namespace trkf {
     art::Ptr<recob::Track> const& trk,
     bool const dir)
   {
-    std::vector<float> recoX;
-    std::vector<float> recoY;
-    std::vector<float> recoZ;
-
-    int const n_points = trk->NumberTrajectoryPoints();
-    for (int i = 0; i < n_points; ++i) {
-      auto const index = dir ? i : n_points - 1 - i;
-      auto const& pos = trk->LocationAtPoint(index);
-      recoX.push_back(pos.X());
-      recoY.push_back(pos.Y());
-      recoZ.push_back(pos.Z());
-    }
+    fillPoints_(*trk, dir, fWorkspace);
+    return GetMuMultiScatterLLHD3(
+      fWorkspace.recoX, fWorkspace.recoY, fWorkspace.recoZ, fWorkspace);
+  }
 
+  double
+  TrackMomentumCalculator::GetMuMultiScatterLLHD3(
+    std::vector<float> const& recoX,
+    std::vector<float> const& recoY,
+    std::vector<float> const& recoZ,
+    Workspace& ws) const
+  {
     if (recoX.size() < 2)
       return -1.0;
 
-    if (!plotRecoTracks_(recoX, recoY, recoZ))
-      return -1.0;
-
     constexpr double seg_size{5.0};
-    auto const segments = getSegTracks_(recoX, recoY, recoZ, seg_size);
-    if (!segments.has_value())
+    if (!getSegTracks_(recoX, recoY, recoZ, seg_size, ws))
       return -1.0;
 
-    auto const seg_steps = segments->x.size();
+    auto const& segments = ws.segments;
+    auto const seg_steps = segments.x.size();
     if (seg_steps < 2)
       return -1;
 
-    double const recoL = segments->L.at(seg_steps - 1);
+    double const recoL = segments.L.at(seg_steps - 1);
     if (recoL < 15.0 || recoL > maxLength)
       return -1;
 
-    std::vector<float> dEi;
-    std::vector<float> dEj;
-    std::vector<float> dthij;
-    std::vector<float> ind;
-    if (getDeltaThetaij_(dEi, dEj, dthij, ind, *segments, seg_size) != 0)
+    auto& dEi = ws.dEi;
+    auto& dEj = ws.dEj;
+    auto& dthij = ws.dthij;
+    auto& ind = ws.ind;
+    dEi.clear();
+    dEj.clear();
+    dthij.clear();
+    ind.clear();
+    if (getDeltaThetaij_(dEi, dEj, dthij, ind, segments, seg_size) != 0)
       return -1.0;
 
     double const p_range = recoL * kcal;
@@ -493,50 +521,43 @@ namespace trkf {
   TrackMomentumCalculator::GetMomentumMultiScatterChi2(
     const art::Ptr<recob::Track>& trk)
   {
-    std::vector<float> recoX;
-    std::vector<float> recoY;
-    std::vector<float> recoZ;
-
-    int n_points = trk->NumberTrajectoryPoints();
-
-    for (int i = 0; i < n_points; i++) {
-      auto const& pos = trk->LocationAtPoint(i);
-      recoX.push_back(pos.X());
-      recoY.push_back(pos.Y());
-      recoZ.push_back(pos.Z());
-    }
+    fillPoints_(*trk, true, fWorkspace);
+    return GetMomentumMultiScatterChi2(
+      fWorkspace.recoX, fWorkspace.recoY, fWorkspace.recoZ, fWorkspace);
+  }
 
+  double
+  TrackMomentumCalculator::GetMomentumMultiScatterChi2(
+    std::vector<float> const& recoX,
+    std::vector<float> const& recoY,
+    std::vector<float> const& recoZ,
+    Workspace& ws) const
+  {
     if (recoX.size() < 2)
       return -1.0;
 
-    if (!plotRecoTracks_(recoX, recoY, recoZ))
-      return -1.0;
-
     double const seg_size{steps_size};
-    auto const segments = getSegTracks_(recoX, recoY, recoZ, seg_size);
-    if (!segments.has_value())
+    if (!getSegTracks_(recoX, recoY, recoZ, seg_size, ws))
       return -1.0;
 
-    auto const seg_steps = segments->x.size();
+    auto const& segments = ws.segments;
+    auto const seg_steps = segments.x.size();
     if (seg_steps < 2)
       return -1;
 
-    double const recoL = segments->L.at(seg_steps - 1);
+    double const recoL = segments.L.at(seg_steps - 1);
     if (recoL < minLength || recoL > maxLength)
       return -1;
 
-    double ymax = -999.0;
-    double ymin = +999.0;
-
-    std::vector<double> xmeas;
-    std::vector<double> ymeas;
-    std::vector<double> eymeas;
-    xmeas.reserve(n_steps);
-    ymeas.reserve(n_steps);
-    eymeas.reserve(n_steps);
+    auto& xmeas = ws.xmeas;
+    auto& ymeas = ws.ymeas;
+    auto& eymeas = ws.eymeas;
+    xmeas.clear();
+    ymeas.clear();
+    eymeas.clear();
     for (int j = 0; j < n_steps; j++) {
       double const trial = steps.at(j);
-      auto const [mean, rms, rmse] = getDeltaThetaRMS_(*segments, trial);
+      auto const [mean, rms, rmse] = getDeltaThetaRMS_(segments, trial, ws.angles);
 
       if (std::isnan(mean) || std::isinf(mean)) {
         mf::LogDebug("TrackMomentumCalculator") << "Returned mean is either nan or infinity.";
@@ -554,11 +575,6 @@ namespace trkf {
       xmeas.push_back(trial); // Is this what is intended?
       ymeas.push_back(rms);
       eymeas.push_back(std::sqrt(cet::sum_of_squares(rmse, 0.05 * rms))); // <--- conservative syst. error to fix chi^{2} behaviour !!!
-
-      if (ymin > rms)
-        ymin = rms;
-      if (ymax < rms)
-        ymax = rms;
     }
 
     assert(xmeas.size() == ymeas.size());
@@ -567,23 +583,10 @@ namespace trkf {
       return -1.0;
     }
 
-    TGraphErrors gr_meas{n_steps, xmeas.data(), ymeas.data(), nullptr, eymeas.data()};
-
-    gr_meas.SetTitle("(#Delta#theta)_{rms} versus material thickness; Material "
-                     "thickness in cm; (#Delta#theta)_{rms} in mrad");
-
-    gr_meas.SetLineColor(kBlack);
-    gr_meas.SetMarkerColor(kBlack);
-    gr_meas.SetMarkerStyle(20);
-    gr_meas.SetMarkerSize(1.2);
-
-    gr_meas.GetXaxis()->SetLimits(steps.at(0) - steps.at(0),
-                                  steps.at(n_steps - 1) + steps.at(0));
-    gr_meas.SetMinimum(0.0);
-    gr_meas.SetMaximum(1.80 * ymax);
-
-    ROOT::Minuit2::Minuit2Minimizer mP{};
-    FcnWrapper const wrapper{move(xmeas), move(ymeas), move(eymeas)};
+    // Clear() brings the minimizer back to its freshly constructed state
+    auto& mP = *ws.minimizer;
+    mP.Clear();
+    FcnWrapper const wrapper{xmeas, ymeas, eymeas};
     ROOT::Math::Functor FCA([&wrapper](double const* xs) { return wrapper.my_mcs_chi2(xs); }, 2);
 
     mP.SetFunction(FCA);
@@ -609,43 +612,82 @@ namespace trkf {
     return mstatus ? p_mcs : -1.0;
   }
 
-  bool
-  TrackMomentumCalculator::plotRecoTracks_(std::vector<float> const& xxx,
-                                           std::vector<float> const& yyy,
-                                           std::vector<float> const& zzz)
+  std::vector<double>
+  TrackMomentumCalculator::GetMomentaMultiScatterChi2(
+    std::vector<art::Ptr<recob::Track>> const& trks,
+    unsigned int const nThreads) const
   {
-    auto const n = xxx.size();
-    auto const y_size = yyy.size();
-    auto const z_size = zzz.size();
+    // Resolve the pointers up front, art::Ptr may need to fetch the product
+    std::vector<recob::Track const*> tracks;
+    tracks.reserve(trks.size());
+    for (auto const& trk : trks)
+      tracks.push_back(trk.get());
+
+    std::vector<double> momenta(tracks.size(), -1.0);
+
+    auto fitRange = [&](tbb::blocked_range<std::size_t> const& range) {
+      Workspace ws;
+      for (std::size_t i = range.begin(); i != range.end(); ++i) {
+        fillPoints_(*tracks[i], true, ws);
+        momenta[i] = GetMomentumMultiScatterChi2(ws.recoX, ws.recoY, ws.recoZ, ws);
+      }
+    };
 
-    if (n != y_size || n != z_size) {
-      cout << " ( Get reco tacks ) Error ! " << endl;
-      return false;
+    tbb::blocked_range<std::size_t> const all{0, tracks.size()};
+    if (nThreads < 2 || tracks.size() < 2) {
+      fitRange(all);
+      return momenta;
     }
 
-    // Here, we perform a const-cast to float* because, sadly,
-    // TPolyLine3D requires a pointer to a non-const object.  We will
-    // trust that ROOT does not mess around with the underlying data.
-    auto xs = const_cast<float*>(xxx.data());
-    auto ys = const_cast<float*>(yyy.data());
-    auto zs = const_cast<float*>(zzz.data());
-
-    auto const narrowed_size =
-      static_cast<int>(n); // ROOT requires a signed integral type
-    delete gr_reco_xyz;
-    gr_reco_xyz = new TPolyLine3D{narrowed_size, zs, xs, ys};
-    gr_reco_yz = TGraph{narrowed_size, zzz.data(), yyy.data()};
-    gr_reco_xz = TGraph{narrowed_size, zzz.data(), xxx.data()};
-    gr_reco_xy = TGraph{narrowed_size, xxx.data(), yyy.data()};
+    tbb::task_arena arena(nThreads);
+    arena.execute([&] { tbb::parallel_for(all, fitRange); });
+    return momenta;
+  }
 
-    return true;
+  TrackMomentumCalculator::Plots
+  TrackMomentumCalculator::MakePlots(art::Ptr<recob::Track> const& trk,
+                                     double const seg_size) const
+  {
+    Plots plots;
+
+    Workspace ws;
+    fillPoints_(*trk, true, ws);
+
+    auto const& xxx = ws.recoX;
+    auto const& yyy = ws.recoY;
+    auto const& zzz = ws.recoZ;
+
+    auto const n = static_cast<int>(xxx.size()); // ROOT requires a signed integral type
+    for (int i = 0; i < n; ++i)
+      plots.reco_xyz.SetPoint(i, zzz[i], xxx[i], yyy[i]);
+    plots.reco_yz = TGraph{n, zzz.data(), yyy.data()};
+    plots.reco_xz = TGraph{n, zzz.data(), xxx.data()};
+    plots.reco_xy = TGraph{n, xxx.data(), yyy.data()};
+
+    if (n < 2 || !getSegTracks_(xxx, yyy, zzz, seg_size, ws))
+      return plots;
+
+    auto const& segx = ws.segments.x;
+    auto const& segy = ws.segments.y;
+    auto const& segz = ws.segments.z;
+
+    auto const n_seg = static_cast<int>(segx.size());
+    for (int i = 0; i < n_seg; ++i)
+      plots.seg_xyz.SetPoint(i, segz[i], segx[i], segy[i]);
+    plots.seg_yz = TGraph{n_seg, segz.data(), segy.data()};
+    plots.seg_xz = TGraph{n_seg, segz.data(), segx.data()};
+    plots.seg_xy = TGraph{n_seg, segx.data(), segy.data()};
+
+    return plots;
   }
 
-  std::optional<TrackMomentumCalculator::Segments>
+
+  bool
   TrackMomentumCalculator::getSegTracks_(std::vector<float> const& xxx,
                                          std::vector<float> const& yyy,
                                          std::vector<float> const& zzz,
-                                         double const seg_size)
+                                         double const seg_size,
+                                         Workspace& ws) const
   {
     double stag = 0.0;
 
@@ -655,19 +697,24 @@ namespace trkf {
 
     if ((a1 != a2) || (a1 != a3) || (a2 != a3)) {
       cout << " ( Digitize reco tacks ) Error ! " << endl;
-      return std::nullopt;
+      return false;
     }
 
     int const stopper = seg_stop / seg_size;
 
-    std::vector<float> segx, segnx;
-    std::vector<float> segy, segny;
-    std::vector<float> segz, segnz;
-    std::vector<float> segL;
-
-    int ntot = 0;
+    auto& segx = ws.segments.x;
+    auto& segy = ws.segments.y;
+    auto& segz = ws.segments.z;
+    auto& segL = ws.segments.L;
+    segx.clear();
+    segy.clear();
+    segz.clear();
+    segL.clear();
+    ws.segments.nx.clear();
+    ws.segments.ny.clear();
+    ws.segments.nz.clear();
 
-    n_seg = 0;
+    int n_seg = 0;
 
     double x0{};
     double y0{};
@@ -679,9 +726,12 @@ namespace trkf {
 
     int indC = 0;
 
-    std::vector<float> vx;
-    std::vector<float> vy;
-    std::vector<float> vz;
+    auto& vx = ws.vx;
+    auto& vy = ws.vy;
+    auto& vz = ws.vz;
+    vx.clear();
+    vy.clear();
+    vz.clear();
 
     for (int i = 0; i < a1; i++) {
       x0 = xxx.at(i);
@@ -698,18 +748,12 @@ namespace trkf {
 
         segL.push_back(stag);
 
-        x_seg[n_seg] = x0;
-        y_seg[n_seg] = y0;
-        z_seg[n_seg] = z0;
-
         n_seg++;
 
         vx.push_back(x0);
         vy.push_back(y0);
         vz.push_back(z0);
 
-        ntot++;
-
         indC = i + 1;
 
         break;
@@ -733,8 +777,6 @@ namespace trkf {
         vx.push_back(x1);
         vy.push_back(y1);
         vz.push_back(z1);
-
-        ntot++;
       }
 
       if (dr1 <= seg_size && dr2 > seg_size) {
@@ -745,7 +787,7 @@ namespace trkf {
 
         if (dr == 0) {
           cout << " ( Zero ) Error ! " << endl;
-          return std::nullopt;
+          return false;
         }
 
         double const beta =
@@ -756,7 +798,7 @@ namespace trkf {
 
         if (delta < 0.0) {
           cout << " ( Discriminant ) Error ! " << endl;
-          return std::nullopt;
+          return false;
         }
 
         double const lysi1 = (-beta + std::sqrt(delta)) / 2.0;
@@ -772,9 +814,6 @@ namespace trkf {
 
         segL.push_back(1.0 * n_seg * 1.0 * seg_size + stag);
 
-        x_seg[n_seg] = xp;
-        y_seg[n_seg] = yp;
-        z_seg[n_seg] = zp;
         n_seg++;
 
         x0 = xp;
@@ -785,101 +824,8 @@ namespace trkf {
         vy.push_back(y0);
         vz.push_back(z0);
 
-        ntot++;
-
-        auto const na = vx.size();
-        double sumx = 0.0;
-        double sumy = 0.0;
-        double sumz = 0.0;
-
-        for (std::size_t i = 0; i < na; ++i) {
-          sumx += vx.at(i);
-          sumy += vy.at(i);
-          sumz += vz.at(i);
-        }
-
-        sumx /= na;
-        sumy /= na;
-        sumz /= na;
-
-        std::vector<double> mx;
-        std::vector<double> my;
-        std::vector<double> mz;
-
-        TMatrixDSym m(3);
-
-        for (std::size_t i = 0; i < na; ++i) {
-          double const xxw1 = vx.at(i);
-          double const yyw1 = vy.at(i);
-          double const zzw1 = vz.at(i);
-
-          mx.push_back(xxw1 - sumx);
-          my.push_back(yyw1 - sumy);
-          mz.push_back(zzw1 - sumz);
-
-          double const xxw0 = mx.at(i);
-          double const yyw0 = my.at(i);
-          double const zzw0 = mz.at(i);
-
-          m(0, 0) += xxw0 * xxw0 / na;
-          m(0, 1) += xxw0 * yyw0 / na;
-          m(0, 2) += xxw0 * zzw0 / na;
-
-          m(1, 0) += yyw0 * xxw0 / na;
-          m(1, 1) += yyw0 * yyw0 / na;
-          m(1, 2) += yyw0 * zzw0 / na;
-
-          m(2, 0) += zzw0 * xxw0 / na;
-          m(2, 1) += zzw0 * yyw0 / na;
-          m(2, 2) += zzw0 * zzw0 / na;
-        }
-
-        TMatrixDSymEigen me(m);
-
-        TVectorD eigenval = me.GetEigenValues();
-        TMatrixD eigenvec = me.GetEigenVectors();
-
-        double max1 = -666.0;
-
-        double ind1 = 0;
-
-        for (int i = 0; i < 3; ++i) {
-          double const p1 = eigenval(i);
-
-          if (p1 > max1) {
-            max1 = p1;
-            ind1 = i;
-          }
-        }
-
-        double ax = eigenvec(0, ind1);
-        double ay = eigenvec(1, ind1);
-        double az = eigenvec(2, ind1);
-
-        if (n_seg > 1) {
-          if (segx.at(n_seg - 1) - segx.at(n_seg - 2) > 0)
-            ax = std::abs(ax);
-          else
-            ax = -1.0 * std::abs(ax);
-
-          if (segy.at(n_seg - 1) - segy.at(n_seg - 2) > 0)
-            ay = std::abs(ay);
-          else
-            ay = -1.0 * std::abs(ay);
-
-          if (segz.at(n_seg - 1) - segz.at(n_seg - 2) > 0)
-            az = std::abs(az);
-          else
-            az = -1.0 * std::abs(az);
-
-          segnx.push_back(ax);
-          segny.push_back(ay);
-          segnz.push_back(az);
-        }
-        else
-          return std::nullopt;
-
-        ntot = 0;
+        if (!addSegmentDirection_(ws))
+          return false;
 
         vx.clear();
         vy.clear();
@@ -888,8 +834,6 @@ namespace trkf {
         vx.push_back(x0);
         vy.push_back(y0);
         vz.push_back(z0);
-
-        ntot++;
       }
       else if (dr1 > seg_size) {
         double const dx = x1 - x0;
@@ -899,7 +843,7 @@ namespace trkf {
 
         if (dr == 0) {
           cout << " ( Zero ) Error ! " << endl;
-          return std::nullopt;
+          return false;
         }
 
         double const t = seg_size / dr;
@@ -912,9 +856,6 @@ namespace trkf {
         segz.push_back(zp);
         segL.push_back(1.0 * n_seg * 1.0 * seg_size + stag);
 
-        x_seg[n_seg] = xp;
-        y_seg[n_seg] = yp;
-        z_seg[n_seg] = zp;
         n_seg++;
 
         x0 = xp;
@@ -927,130 +868,124 @@ namespace trkf {
         vy.push_back(y0);
         vz.push_back(z0);
 
-        ntot++;
+        if (!addSegmentDirection_(ws))
+          return false;
 
-        double na = vx.size();
-
-        double sumx = 0.0;
-        double sumy = 0.0;
-        double sumz = 0.0;
-
-        for (std::size_t i = 0; i < na; ++i) {
-          sumx += vx.at(i);
-          sumy += vy.at(i);
-          sumz += vz.at(i);
-        }
+        vx.clear();
+        vy.clear();
+        vz.clear();
 
-        sumx /= na;
-        sumy /= na;
-        sumz /= na;
+        vx.push_back(x0);
+        vy.push_back(y0);
+        vz.push_back(z0);
+      }
 
-        std::vector<double> mx;
-        std::vector<double> my;
-        std::vector<double> mz;
+      if (n_seg >= (stopper + 1.0) && seg_stop != -1)
+        break;
+    }
 
-        TMatrixDSym m(3);
+    return true;
+  }
 
-        for (int i = 0; i < na; ++i) {
-          double const xxw1 = vx.at(i);
-          double const yyw1 = vy.at(i);
-          double const zzw1 = vz.at(i);
+  bool
+  TrackMomentumCalculator::addSegmentDirection_(Workspace& ws) const
+  {
+    // Principal axis of the points of the segment just closed, oriented along
+    // the step between the last two segment starts
+    auto const& vx = ws.vx;
+    auto const& vy = ws.vy;
+    auto const& vz = ws.vz;
+
+    auto const na = vx.size();
+    double sumx = 0.0;
+    double sumy = 0.0;
+    double sumz = 0.0;
+
+    for (std::size_t i = 0; i < na; ++i) {
+      sumx += vx[i];
+      sumy += vy[i];
+      sumz += vz[i];
+    }
 
-          mx.push_back(xxw1 - sumx);
-          my.push_back(yyw1 - sumy);
-          mz.push_back(zzw1 - sumz);
+    sumx /= na;
+    sumy /= na;
+    sumz /= na;
 
-          double const xxw0 = mx.at(i);
-          double const yyw0 = my.at(i);
-          double const zzw0 = mz.at(i);
+    TMatrixDSym m(3);
 
-          m(0, 0) += xxw0 * xxw0 / na;
-          m(0, 1) += xxw0 * yyw0 / na;
-          m(0, 2) += xxw0 * zzw0 / na;
+    for (std::size_t i = 0; i < na; ++i) {
+      double const xxw0 = vx[i] - sumx;
+      double const yyw0 = vy[i] - sumy;
+      double const zzw0 = vz[i] - sumz;
 
-          m(1, 0) += yyw0 * xxw0 / na;
-          m(1, 1) += yyw0 * yyw0 / na;
-          m(1, 2) += yyw0 * zzw0 / na;
+      m(0, 0) += xxw0 * xxw0 / na;
+      m(0, 1) += xxw0 * yyw0 / na;
+      m(0, 2) += xxw0 * zzw0 / na;
 
-          m(2, 0) += zzw0 * xxw0 / na;
-          m(2, 1) += zzw0 * yyw0 / na;
-          m(2, 2) += zzw0 * zzw0 / na;
-        }
+      m(1, 0) += yyw0 * xxw0 / na;
+      m(1, 1) += yyw0 * yyw0 / na;
+      m(1, 2) += yyw0 * zzw0 / na;
 
-        TMatrixDSymEigen me(m);
+      m(2, 0) += zzw0 * xxw0 / na;
+      m(2, 1) += zzw0 * yyw0 / na;
+      m(2, 2) += zzw0 * zzw0 / na;
+    }
 
-        TVectorD eigenval = me.GetEigenValues();
-        TMatrixD eigenvec = me.GetEigenVectors();
+    TMatrixDSymEigen me(m);
 
-        double max1 = -666.0;
-        double ind1 = 0;
+    auto const& eigenval = me.GetEigenValues();
+    auto const& eigenvec = me.GetEigenVectors();
 
-        for (int i = 0; i < 3; ++i) {
-          double const p1 = eigenval(i);
+    double max1 = -666.0;
+    int ind1 = 0;
 
-          if (p1 > max1) {
-            max1 = p1;
-            ind1 = i;
-          }
-        }
+    for (int i = 0; i < 3; ++i) {
+      double const p1 = eigenval(i);
 
-        double ax = eigenvec(0, ind1);
-        double ay = eigenvec(1, ind1);
-        double az = eigenvec(2, ind1);
-
-        if (n_seg > 1) {
-          if (segx.at(n_seg - 1) - segx.at(n_seg - 2) > 0)
-            ax = std::abs(ax);
-          else
-            ax = -1.0 * std::abs(ax);
-
-          if (segy.at(n_seg - 1) - segy.at(n_seg - 2) > 0)
-            ay = std::abs(ay);
-          else
-            ay = -1.0 * std::abs(ay);
-
-          if (segz.at(n_seg - 1) - segz.at(n_seg - 2) > 0)
-            az = std::abs(az);
-          else
-            az = -1.0 * std::abs(az);
-
-          segnx.push_back(ax);
-          segny.push_back(ay);
-          segnz.push_back(az);
-        }
+      if (p1 > max1) {
+        max1 = p1;
+        ind1 = i;
+      }
+    }
 
-        else
-          return std::nullopt;
+    double ax = eigenvec(0, ind1);
+    double ay = eigenvec(1, ind1);
+    double az = eigenvec(2, ind1);
 
-        ntot = 0;
+    auto const& segx = ws.segments.x;
+    auto const& segy = ws.segments.y;
+    auto const& segz = ws.segments.z;
+    auto const n_seg = segx.size();
 
-        vx.clear();
-        vy.clear();
-        vz.clear();
+    if (n_seg <= 1)
+      return false;
 
-        vx.push_back(x0);
-        vy.push_back(y0);
-        vz.push_back(z0);
+    if (segx.at(n_seg - 1) - segx.at(n_seg - 2) > 0)
+      ax = std::abs(ax);
+    else
+      ax = -1.0 * std::abs(ax);
 
-        ntot++;
-      }
+    if (segy.at(n_seg - 1) - segy.at(n_seg - 2) > 0)
+      ay = std::abs(ay);
+    else
+      ay = -1.0 * std::abs(ay);
 
-      if (n_seg >= (stopper + 1.0) && seg_stop != -1)
-        break;
-    }
+    if (segz.at(n_seg - 1) - segz.at(n_seg - 2) > 0)
+      az = std::abs(az);
+    else
+      az = -1.0 * std::abs(az);
 
-    delete gr_seg_xyz;
-    gr_seg_xyz = new TPolyLine3D{n_seg, z_seg, x_seg, y_seg};
-    gr_seg_yz = TGraph{n_seg, z_seg, y_seg};
-    gr_seg_xz = TGraph{n_seg, z_seg, x_seg};
-    gr_seg_xy = TGraph{n_seg, x_seg, y_seg};
+    ws.segments.nx.push_back(ax);
+    ws.segments.ny.push_back(ay);
+    ws.segments.nz.push_back(az);
 
-    return std::make_optional<Segments>(Segments{segx, segnx, segy, segny, segz, segnz, segL});
+    return true;
   }
 
   std::tuple<double, double, double>
   TrackMomentumCalculator::getDeltaThetaRMS_(Segments const& segments,
-                                             double const thick) const
+                                             double const thick,
+                                             std::vector<float>& buf0) const
   {
     auto const& segnx = segments.nx;
     auto const& segny = segments.ny;
@@ -1070,7 +1005,7 @@ namespace trkf {
 
     double const thick1 = thick + 0.13;
 
-    std::vector<float> buf0;
+    buf0.clear();
 
     for (int i = 0; i < tot; i++) {
       double const dx = segnx.at(i);
@@ -9,13 +9,18 @@
 #include "lardataobj/RecoBase/Track.h"
 
 #include "TGraph.h"
+#include "TPolyLine3D.h"
 #include "TVector3.h"
 
-#include <optional>
+#include <memory>
 #include <vector>
 #include <tuple>
 
-class TPolyLine3D;
+namespace ROOT {
+  namespace Minuit2 {
+    class Minuit2Minimizer;
+  }
+}
 
 namespace trkf {
 
@@ -24,31 +29,86 @@ namespace trkf {
     TrackMomentumCalculator(double minLength = 100.0,
                             double maxLength = 1350.0);
 
+    struct Segments {
+      std::vector<float> x, nx;
+      std::vector<float> y, ny;
+      std::vector<float> z, nz;
+      std::vector<float> L;
+    };
+
+    /// Buffers and minimizer reused from one track to the next. The const
+    /// interface below only writes into the Workspace it is given, so it can
+    /// be called from several threads with one Workspace per thread.
+    class Workspace {
+    public:
+      Workspace();
+      ~Workspace();
+      Workspace(Workspace&&) noexcept;
+      Workspace& operator=(Workspace&&) noexcept;
+
+    private:
+      friend class TrackMomentumCalculator;
+
+      std::vector<float> recoX, recoY, recoZ; ///< trajectory points
+      Segments segments;
+      std::vector<float> vx, vy, vz;          ///< points of the current segment
+      std::vector<float> dEi, dEj, dthij, ind;
+      std::vector<float> angles;              ///< for the RMS at one thickness
+      std::vector<double> xmeas, ymeas, eymeas;
+      std::unique_ptr<ROOT::Minuit2::Minuit2Minimizer> minimizer;
+    };
+
+    /// Graphs of a track and of its segmentation, for display only
+    struct Plots {
+      TPolyLine3D reco_xyz;
+      TGraph reco_xy, reco_yz, reco_xz;
+      TPolyLine3D seg_xyz;
+      TGraph seg_xy, seg_yz, seg_xz;
+    };
+
     double GetTrackMomentum(double trkrange, int pdg) const;
     double GetMomentumMultiScatterChi2(art::Ptr<recob::Track> const& trk);
     double GetMomentumMultiScatterLLHD(art::Ptr<recob::Track> const& trk);
     double GetMuMultiScatterLLHD3(art::Ptr<recob::Track> const& trk, bool dir);
     TVector3 GetMultiScatterStartingPoint(art::Ptr<recob::Track> const& trk);
 
+    // Same as above on the trajectory points (in the direction to use), with
+    // the buffers of the caller
+    double GetMomentumMultiScatterChi2(std::vector<float> const& xxx,
+                                       std::vector<float> const& yyy,
+                                       std::vector<float> const& zzz,
+                                       Workspace& ws) const;
+    double GetMomentumMultiScatterLLHD(std::vector<float> const& xxx,
+                                       std::vector<float> const& yyy,
+                                       std::vector<float> const& zzz,
+                                       Workspace& ws) const;
+    double GetMuMultiScatterLLHD3(std::vector<float> const& xxx,
+                                  std::vector<float> const& yyy,
+                                  std::vector<float> const& zzz,
+                                  Workspace& ws) const;
+
+    /// GetMomentumMultiScatterChi2 of each track, on up to nThreads threads
+    std::vector<double> GetMomentaMultiScatterChi2(
+      std::vector<art::Ptr<recob::Track>> const& trks,
+      unsigned int nThreads = 1) const;
+
+    /// Graphs of the track and of its segmentation into seg_size (cm) pieces
+    Plots MakePlots(art::Ptr<recob::Track> const& trk, double seg_size) const;
+
   private:
-    bool plotRecoTracks_(std::vector<float> const& xxx,
-                         std::vector<float> const& yyy,
-                         std::vector<float> const& zzz);
+    void fillPoints_(recob::Track const& trk, bool dir, Workspace& ws) const;
 
-    struct Segments {
-      std::vector<float> x, nx;
-      std::vector<float> y, ny;
-      std::vector<float> z, nz;
-      std::vector<float> L;
-    };
+    bool getSegTracks_(std::vector<float> const& xxx,
+                       std::vector<float> const& yyy,
+                       std::vector<float> const& zzz,
+                       double seg_size,
+                       Workspace& ws) const;
 
-    std::optional<Segments> getSegTracks_(std::vector<float> const& xxx,
-                                          std::vector<float> const& yyy,
-                                          std::vector<float> const& zzz,
-                                          double seg_size);
+    bool addSegmentDirection_(Workspace& ws) const;
 
     std::tuple<double, double, double> getDeltaThetaRMS_(Segments const& segments,
-                                                         double thick) const;
+                                                         double thick,
+                                                         std::vector<float>& buf0) const;
 
     int getDeltaThetaij_(std::vector<float>& ei,
                          std::vector<float>& ej,
@@ -66,11 +126,6 @@ namespace trkf {
                        double x0, double x1) const;
 
     float seg_stop{-1.};
-    int n_seg{};
-
-    float x_seg[50000];
-    float y_seg[50000];
-    float z_seg[50000];
 
     double find_angle(double vz, double vy) const;
 
@@ -81,26 +136,8 @@ namespace trkf {
     double minLength;
     double maxLength;
 
-    // The following are objects that are created but not drawn or
-    // saved.  This class should consider accepting a "debug"
-    // parameter where if it is specified, then the graphs will be
-    // created; otherwise, their creation is unnecessary and impedes
-    // efficiency.
-    //
-    // N.B. TPolyLine3D objects are owned by ROOT, and we thus refer
-    // to them by pointer.  It is important that 'delete' is not
-    // called on the TPolyLine3D pointers during destruction of a
-    // TrackMomentumCalculator object.
-    TPolyLine3D* gr_reco_xyz{nullptr};
-    TGraph gr_reco_xy{};
-    TGraph gr_reco_yz{};
-    TGraph gr_reco_xz{};
-
-    TPolyLine3D* gr_seg_xyz{nullptr};
-    TGraph gr_seg_xy{};
-    TGraph gr_seg_yz{};
-    TGraph gr_seg_xz{};
-
+    // Used by the art::Ptr interface
+    Workspace fWorkspace;
   };
 
 } // namespace trkf
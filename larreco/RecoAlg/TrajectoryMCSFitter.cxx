@@ -95,12 +95,15 @@ void TrajectoryMCSFitter::breakTrajInSegments(const recob::TrackTrajectory& traj
 }
 
 const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doLikelihoodScan(std::vector<float>& dtheta, std::vector<float>& seg_nradlengths, std::vector<float>& cumLen, bool fwdFit, bool momDepConst, int pid) const {
+  const SegmentTable segs = makeSegmentTable(dtheta, seg_nradlengths, cumLen, fwdFit);
+  if (scanMode_==1) return doAdaptiveScan(segs, momDepConst, pid);
+  //
   int    best_idx  = -1;
   double best_logL = std::numeric_limits<double>::max();
   double best_p    = -1.0;
   std::vector<float> vlogL;
-  for (double p_test = pMin_; p_test <= pMax_; p_test+=pStep_) {
-    double logL = mcsLikelihood(p_test, angResol_, dtheta, seg_nradlengths, cumLen, fwdFit, momDepConst, pid);
+  for (double p_test : pGrid_) {
+    double logL = mcsLikelihood(p_test, angResol_, segs, momDepConst, pid);
     if (logL < best_logL) {
       best_p    = p_test;
       best_logL = logL;
@@ -132,6 +135,66 @@ const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doLikelihoodScan(std:
   return ScanResult(best_p, std::max(lunc,runc), best_logL);
 }
 
+const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doAdaptiveScan(const SegmentTable& segs, bool momDepConst, int pid) const {
+  //
+  const int n = pGrid_.size();
+  if (n==0) return ScanResult(-1.0, -1.0, std::numeric_limits<double>::max());
+  //
+  // likelihood at the grid points, evaluated when first needed
+  std::vector<double> vlogL(n, 0.);
+  std::vector<bool> done(n, false);
+  auto logL = [&](int i) {
+    if (!done[i]) {
+      vlogL[i] = mcsLikelihood(pGrid_[i], angResol_, segs, momDepConst, pid);
+      done[i] = true;
+    }
+    return vlogL[i];
+  };
+  //
+  // coarse scan, with a power of two step (about sqrt(n)) so that it can be halved down to the grid step
+  int step = 1;
+  while (4*step*step<=n) step*=2;
+  int best = 0;
+  for (int i=step; i<n; i+=step) {
+    if (logL(i) < logL(best)) best = i;
+  }
+  if (logL(n-1) < logL(best)) best = n-1;
+  for (int h=step/2; h>=1; h/=2) {
+    const int center = best;
+    if (center-h>=0 && logL(center-h) <= logL(best)) best = center-h;
+    if (center+h<n  && logL(center+h) <  logL(best)) best = center+h;
+  }
+  // walk down to a grid minimum (the first point of a plateau, as in the full scan)
+  while (true) {
+    if      (best>0   && logL(best-1) <= logL(best)) best--;
+    else if (best<n-1 && logL(best+1) <  logL(best)) best++;
+    else break;
+  }
+  //
+  // uncertainty: distance to the farthest point before the first one with dLL>=0.5, on each side;
+  // the edge is bracketed by doubling the distance, then bisected
+  auto sideUnc = [&](int dir) {
+    const int range = (dir<0 ? best : n-1-best);
+    // dLL in float, as the full scan stores the likelihood values
+    auto outside = [&](int d) { return d>range || !(float(logL(best+dir*d))-float(logL(best)) < 0.5); };
+    int lo = 0;
+    int hi = 1;
+    while (!outside(hi)) {
+      lo = hi;
+      hi *= 2;
+    }
+    while (hi-lo>1) {
+      const int mid = (lo+hi)/2;
+      if (outside(mid)) hi = mid;
+      else lo = mid;
+    }
+    return (lo>0 ? lo*pStep_ : -1.0);
+  };
+  const double lunc = sideUnc(-1);
+  const double runc = sideUnc(+1);
+  return ScanResult(pGrid_[best], std::max(lunc,runc), logL(best));
+}
+
 void TrajectoryMCSFitter::linearRegression(const recob::TrackTrajectory& traj, const size_t firstPoint, const size_t lastPoint, Vector_t& pcdir) const {
   //
   int npoints = 0;
@@ -185,10 +248,31 @@ void TrajectoryMCSFitter::linearRegression(const recob::TrackTrajectory& traj, c
 }
 
 double TrajectoryMCSFitter::mcsLikelihood(double p, double theta0x, std::vector<float>& dthetaij, std::vector<float>& seg_nradl, std::vector<float>& cumLen, bool fwd, bool momDepConst, int pid) const {
+  return mcsLikelihood(p, theta0x, makeSegmentTable(dthetaij, seg_nradl, cumLen, fwd), momDepConst, pid);
+}
+
+TrajectoryMCSFitter::SegmentTable TrajectoryMCSFitter::makeSegmentTable(const std::vector<float>& dthetaij, const std::vector<float>& seg_nradl, const std::vector<float>& cumLen, bool fwd) const {
   //
   const int beg  = (fwd ? 0 : (dthetaij.size()-1));
   const int end  = (fwd ? dthetaij.size() : -1);
   const int incr = (fwd ? +1 : -1);
+  //
+  constexpr double HL_term2 = 0.038;
+  SegmentTable segs;
+  for (int i = beg; i != end; i+=incr ) {
+    if (dthetaij[i]<0) {
+      //cout << "skip segment with too few points" << endl;
+      continue;
+    }
+    segs.dtheta.push_back(dthetaij[i]);
+    segs.cumLen.push_back(cumLen[i]);
+    segs.logTerm.push_back( 1.0 + HL_term2 * std::log( seg_nradl[i] ) );
+    segs.sqrtRadl.push_back( sqrt( seg_nradl[i] ) );
+  }
+  return segs;
+}
+
+double TrajectoryMCSFitter::mcsLikelihood(double p, double theta0x, const SegmentTable& segs, bool momDepConst, int pid) const {
   //
   // bool print = false;//(p>1.999 && p<2.001);
   //
@@ -199,20 +283,16 @@ double TrajectoryMCSFitter::mcsLikelihood(double p, double theta0x, std::vector<
   //
   double const fixedterm = 0.5 * std::log( 2.0 * M_PI );
   double result = 0;
-  for (int i = beg; i != end; i+=incr ) {
-    if (dthetaij[i]<0) {
-      //cout << "skip segment with too few points" << endl;
-      continue;
-    }
+  for (size_t i = 0; i < segs.dtheta.size(); ++i) {
     //
     if (eLossMode_==1) {
       // ELoss mode: MIP (constant)
       constexpr double kcal = 0.002105;
-      const double Eij = Etot - kcal*cumLen[i];//energy at this segment
+      const double Eij = Etot - kcal*segs.cumLen[i];//energy at this segment
       Eij2 = Eij*Eij;
     } else {
       // Non constant energy loss distribution
-      const double Eij = GetE(Etot,cumLen[i],m);
+      const double Eij = GetE(Etot,segs.cumLen[i],m);
       Eij2 = Eij*Eij;
     }
     //
@@ -223,16 +303,14 @@ double TrajectoryMCSFitter::mcsLikelihood(double p, double theta0x, std::vector<
     const double pij = sqrt(Eij2 - m2);//momentum at this segment
     const double beta = sqrt( 1. - ((m2)/(pij*pij + m2)) );
     constexpr double tuned_HL_term1 = 11.0038; // https://arxiv.org/abs/1703.06187
-    constexpr double HL_term2 = 0.038;
-    const double tH0 = ( (momDepConst ? MomentumDependentConstant(pij) : tuned_HL_term1) / (pij*beta) ) * ( 1.0 + HL_term2 * std::log( seg_nradl[i] ) ) * sqrt( seg_nradl[i] );
+    const double tH0 = ( (momDepConst ? MomentumDependentConstant(pij) : tuned_HL_term1) / (pij*beta) ) * segs.logTerm[i] * segs.sqrtRadl[i];
     const double rms = sqrt( 2.0*( tH0 * tH0 + theta0x * theta0x ) );
     if (rms==0.0) {
       std::cout << " Error : RMS cannot be zero ! " << std::endl;
       return std::numeric_limits<double>::max();
     }
-    const double arg = dthetaij[i]/rms;
+    const double arg = segs.dtheta[i]/rms;
     result += ( std::log( rms ) + 0.5 * arg * arg + fixedterm);
-    // if (print && fwd==true) cout << "TrajectoryMCSFitter pij=" << pij << " dthetaij[i]=" << dthetaij[i] << " tH0=" << tH0 << " rms=" << rms << " prob=" << ( std::log( rms ) + 0.5 * arg * arg + fixedterm) << " const=" << (momDepConst ? MomentumDependentConstant(pij) : tuned_HL_term1) << " beta=" << beta << " red_length=" << seg_nradl[i] << endl;
   }
   return result;
 }
@@ -18,7 +18,11 @@ namespace trkf {
    *
    * Class for Maximum Likelihood fit of Multiple Coulomb Scattering angles between segments within a Track or Trajectory.
    *
-   * Inputs are: a Track or Trajectory, and various fit parameters (pIdHypothesis, minNumSegments, segmentLength, pMin, pMax, pStep, angResol)
+   * Inputs are: a Track or Trajectory, and various fit parameters (pIdHypothesis, minNumSegments, segmentLength, pMin, pMax, pStep, angResol, scanMode)
+   *
+   * The likelihood is minimized over the momentum grid from pMin to pMax in steps of pStep, either by evaluating it at every grid point (scanMode 0)
+   * or by a coarse-to-fine search which only evaluates it around the minimum and at the edges of the uncertainty interval (scanMode 1).
+   * The two agree as long as the likelihood has a single minimum on the grid, and is monotonic on either side of it.
    *
    * Outputs are: a recob::MCSFitResult, containing:
    *   resulting momentum, momentum uncertainty, and best likelihood value (both for fwd and bwd fit);
@@ -87,10 +91,15 @@ namespace trkf {
 	Comment("Angular resolution parameter used in modified Highland formula. Unit is mrad."),
 	3.0
       };
+      fhicl::Atom<int> scanMode {
+        Name("scanMode"),
+	Comment("Default is the full likelihood scan. Choose 1 for a coarse-to-fine search on the same momentum grid."),
+	0
+      };
     };
     using Parameters = fhicl::Table<Config>;
     //
-    TrajectoryMCSFitter(int pIdHyp, int minNSegs, double segLen, int minHitsPerSegment, int nElossSteps, int eLossMode, double pMin, double pMax, double pStep, double angResol){
+    TrajectoryMCSFitter(int pIdHyp, int minNSegs, double segLen, int minHitsPerSegment, int nElossSteps, int eLossMode, double pMin, double pMax, double pStep, double angResol, int scanMode = 0){
       pIdHyp_ = pIdHyp;
       minNSegs_ = minNSegs;
       segLen_ = segLen;
@@ -101,9 +110,12 @@ namespace trkf {
       pMax_ = pMax;
       pStep_ = pStep;
       angResol_ = angResol;
+      scanMode_ = scanMode;
+      //same accumulation as the scan always used, so that the grid points are unchanged
+      for (double p_test = pMin_; p_test <= pMax_; p_test+=pStep_) pGrid_.push_back(p_test);
     }
     explicit TrajectoryMCSFitter(const Parameters & p)
-      : TrajectoryMCSFitter(p().pIdHypothesis(),p().minNumSegments(),p().segmentLength(),p().minHitsPerSegment(),p().nElossSteps(),p().eLossMode(),p().pMin(),p().pMax(),p().pStep(),p().angResol()) {}
+      : TrajectoryMCSFitter(p().pIdHypothesis(),p().minNumSegments(),p().segmentLength(),p().minHitsPerSegment(),p().nElossSteps(),p().eLossMode(),p().pMin(),p().pMax(),p().pStep(),p().angResol(),p().scanMode()) {}
     //
     recob::MCSFitResult fitMcs(const recob::TrackTrajectory& traj, bool momDepConst = true) const { return fitMcs(traj,pIdHyp_,momDepConst); }
     recob::MCSFitResult fitMcs(const recob::Track& track,          bool momDepConst = true) const { return fitMcs(track,pIdHyp_,momDepConst); }
@@ -121,6 +133,16 @@ namespace trkf {
     void linearRegression(const recob::TrackTrajectory& traj, const size_t firstPoint, const size_t lastPoint, recob::tracking::Vector_t& pcdir) const;
     double mcsLikelihood(double p, double theta0x, std::vector<float>& dthetaij, std::vector<float>& seg_nradl, std::vector<float>& cumLen, bool fwd, bool momDepConst, int pid) const;
     //
+    // Momentum independent inputs of the likelihood for the segments which enter it, in the order they are used
+    struct SegmentTable {
+      std::vector<float>  dtheta;   // scattering angle (mrad)
+      std::vector<float>  cumLen;   // length travelled before the segment
+      std::vector<double> logTerm;  // 1 + HL_term2 * log(nradl)
+      std::vector<double> sqrtRadl; // sqrt(nradl)
+    };
+    SegmentTable makeSegmentTable(const std::vector<float>& dthetaij, const std::vector<float>& seg_nradl, const std::vector<float>& cumLen, bool fwd) const;
+    double mcsLikelihood(double p, double theta0x, const SegmentTable& segs, bool momDepConst, int pid) const;
+    //
     struct ScanResult {
       public:
         ScanResult(double ap, double apUnc, double alogL) : p(ap), pUnc(apUnc), logL(alogL) {}
@@ -128,6 +150,7 @@ namespace trkf {
     };
     //
     const ScanResult doLikelihoodScan(std::vector<float>& dtheta, std::vector<float>& seg_nradlengths, std::vector<float>& cumLen, bool fwdFit, bool momDepConst, int pid) const;
+    const ScanResult doAdaptiveScan(const SegmentTable& segs, bool momDepConst, int pid) const;
     //
     inline double MomentumDependentConstant(const double p) const {
       //these are from https://arxiv.org/abs/1703.06187
@@ -158,6 +181,8 @@ namespace trkf {
     double pMax_;
     double pStep_;
     double angResol_;
+    int    scanMode_;
+    std::vector<double> pGrid_;
   };
 }
 
@@ -92,6 +92,8 @@ ShowerReco3D::ShowerReco3D(fhicl::ParameterSet const & p)
 
   fManager.MatchManager().AddPriorityAlgo(fCPAlgoArray);
   fManager.MatchManager().AddMatchAlgo(fCFAlgoTimeOverlap);
+  fManager.MatchManager().SetCandidateMargins(-1,p.get<double>("MatchTimeMargin",-1));
+  fManager.MatchManager().SetNumThreads(p.get<unsigned int>("NumThreads",1));
 
   fShowerAlgo->Verbose(p.get<bool>("Verbosity"));
   fShowerAlgo->SetUseArea(p.get<bool>("UseArea"));
@@ -5,8 +5,6 @@
 
 #include <vector>
 
-#include "QuadExpr.h"
-
 /// Allow InductionWireHit and CollectionWireHit to be put in the same maps
 /// where necessary.
 class WireHit
@@ -73,18 +71,4 @@ public:
   std::vector<SpaceCharge*> fCrossings;
 };
 
-double Metric(const std::vector<SpaceCharge*>& scs, double alpha);
-double Metric(const std::vector<CollectionWireHit*>& cwires, double alpha);
-QuadExpr Metric(const SpaceCharge* sci, const SpaceCharge* scj, double alpha);
-
-double SolvePair(CollectionWireHit* cwire,
-                 SpaceCharge* sci, SpaceCharge* scj,
-                 double xmin, double xmax,
-                 double alpha);
-void Iterate(CollectionWireHit* cwire, double alpha);
-void Iterate(SpaceCharge* sc, double alpha);
-void Iterate(const std::vector<CollectionWireHit*>& cwires,
-             const std::vector<SpaceCharge*>& orphanSCs,
-             double alpha);
-
 #endif
@@ -0,0 +1,422 @@
+#include "SolverGraph.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <unordered_map>
+
+#include "tbb/parallel_for.h"
+
+template<class T> T sqr(T x){return x*x;}
+
+// ---------------------------------------------------------------------------
+SolverGraph::SolverGraph(const std::vector<CollectionWireHit*>& cwires,
+                         const std::vector<SpaceCharge*>& orphanSCs)
+{
+  std::unordered_map<const SpaceCharge*, unsigned int> scIdx;
+  std::unordered_map<const InductionWireHit*, int> iwIdx;
+
+  auto inductionIndex = [&](const InductionWireHit* iwire)
+    {
+      if(!iwire) return kNoWire;
+      auto ins = iwIdx.emplace(iwire, int(fIWCharge.size()));
+      if(ins.second){
+        fIWCharge.push_back(iwire->fCharge);
+        fIWPred.push_back(iwire->fPred);
+      }
+      return ins.first->second;
+    };
+
+  std::vector<const SpaceCharge*> scs;
+  fCWCharge.reserve(cwires.size());
+  fCWFirstSC.reserve(cwires.size()+1);
+  for(unsigned int i = 0; i < cwires.size(); ++i){
+    fCWCharge.push_back(cwires[i]->fCharge);
+    fCWFirstSC.push_back(scs.size());
+    for(const SpaceCharge* sc: cwires[i]->fCrossings){
+      scIdx[sc] = scs.size();
+      scs.push_back(sc);
+      fSCCWire.push_back(i);
+    }
+  }
+  fCWFirstSC.push_back(scs.size());
+
+  for(const SpaceCharge* sc: orphanSCs){
+    scIdx[sc] = scs.size();
+    scs.push_back(sc);
+    fSCCWire.push_back(kNoWire);
+  }
+
+  fSCWire1.reserve(scs.size());
+  fSCWire2.reserve(scs.size());
+  fSCPred.reserve(scs.size());
+  fSCNeiPotential.reserve(scs.size());
+  fNeiFirst.reserve(scs.size()+1);
+
+  for(const SpaceCharge* sc: scs){
+    fSCWire1.push_back(inductionIndex(sc->fWire1));
+    fSCWire2.push_back(inductionIndex(sc->fWire2));
+    fSCPred.push_back(sc->fPred);
+    fSCNeiPotential.push_back(sc->fNeiPotential);
+
+    fNeiFirst.push_back(fNeiSC.size());
+    for(const Neighbour& nei: sc->fNeighbours){
+      fNeiSC.push_back(scIdx.at(nei.fSC));
+      fNeiCoupling.push_back(nei.fCoupling);
+    }
+  }
+  fNeiFirst.push_back(fNeiSC.size());
+}
+
+// ---------------------------------------------------------------------------
+void SolverGraph::
+CopyPredictions(const std::vector<CollectionWireHit*>& cwires,
+                const std::vector<SpaceCharge*>& orphanSCs) const
+{
+  // Same order as in the constructor
+  std::vector<SpaceCharge*> scs;
+  scs.reserve(NSpaceCharges());
+  for(CollectionWireHit* cwire: cwires)
+    scs.insert(scs.end(), cwire->fCrossings.begin(), cwire->fCrossings.end());
+  scs.insert(scs.end(), orphanSCs.begin(), orphanSCs.end());
+
+  for(unsigned int iSC = 0; iSC < NSpaceCharges(); ++iSC){
+    scs[iSC]->fPred = fSCPred[iSC];
+    scs[iSC]->fNeiPotential = fSCNeiPotential[iSC];
+  }
+
+  // Wires are shared between space charges, setting them repeatedly is harmless
+  for(unsigned int iSC = 0; iSC < NSpaceCharges(); ++iSC){
+    const SpaceCharge* sc = scs[iSC];
+    if(sc->fWire1) sc->fWire1->fPred = fIWPred[fSCWire1[iSC]];
+    if(sc->fWire2) sc->fWire2->fPred = fIWPred[fSCWire2[iSC]];
+  }
+}
+
+// ---------------------------------------------------------------------------
+void SolverGraph::AddCharge(unsigned int sc, double dq)
+{
+  fSCPred[sc] += dq;
+
+  for(unsigned int k = fNeiFirst[sc]; k < fNeiFirst[sc+1]; ++k)
+    fSCNeiPotential[fNeiSC[k]] += dq * fNeiCoupling[k];
+
+  if(fSCWire1[sc] != kNoWire) fIWPred[fSCWire1[sc]] += dq;
+  if(fSCWire2[sc] != kNoWire) fIWPred[fSCWire2[sc]] += dq;
+}
+
+// ---------------------------------------------------------------------------
+double Metric(const SolverGraph& g, double alpha)
+{
+  double ret = 0;
+
+  // Only the space charges of the collection wires enter, the orphans don't
+  std::vector<bool> iwires(g.NInductionWires(), false);
+  for(unsigned int sc = 0; sc < g.FirstOrphan(); ++sc){
+    if(g.fSCWire1[sc] != SolverGraph::kNoWire) iwires[g.fSCWire1[sc]] = true;
+    if(g.fSCWire2[sc] != SolverGraph::kNoWire) iwires[g.fSCWire2[sc]] = true;
+
+    if(alpha != 0){
+      ret -= alpha*sqr(g.fSCPred[sc]);
+      // "Double-counting" of the two ends of the connection is
+      // intentional. Otherwise we'd have a half in the line above.
+      ret -= alpha * g.fSCPred[sc] * g.fSCNeiPotential[sc];
+    }
+  }
+
+  for(unsigned int iw = 0; iw < g.NInductionWires(); ++iw){
+    if(iwires[iw]) ret += sqr(g.fIWCharge[iw] - g.fIWPred[iw]);
+  }
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+QuadExpr Metric(const SolverGraph& g, unsigned int sci, unsigned int scj,
+                double alpha)
+{
+  QuadExpr ret = 0;
+
+  // How much charge moves from scj to sci
+  QuadExpr x = QuadExpr::X();
+
+  if(alpha != 0){
+    const double scip = g.fSCPred[sci];
+    const double scjp = g.fSCPred[scj];
+
+    // Self energy. SpaceCharges are never the same object
+    ret -= alpha*sqr(scip + x);
+    ret -= alpha*sqr(scjp - x);
+
+    // Interaction. We're only seeing one end of the double-ended connection
+    // here, so multiply by two.
+    ret -= 2 * alpha * (scip + x) * g.fSCNeiPotential[sci];
+    ret -= 2 * alpha * (scjp - x) * g.fSCNeiPotential[scj];
+
+    // This miscounts if i and j are neighbours of each other
+    for(unsigned int k = g.fNeiFirst[sci]; k < g.fNeiFirst[sci+1]; ++k){
+      if(g.fNeiSC[k] == scj){
+        const double coupling = g.fNeiCoupling[k];
+        // If we detect that case, remove the erroneous terms
+        ret += 2 * alpha * (scip + x) * scjp * coupling;
+        ret += 2 * alpha * (scjp - x) * scip * coupling;
+
+        // And replace with the correct interaction terms
+        ret -= 2 * alpha * (scip + x) * (scjp - x) * coupling;
+        break;
+      }
+    }
+  }
+
+  const std::vector<int>* wires[2] = {&g.fSCWire1, &g.fSCWire2};
+  for(const std::vector<int>* w: wires){
+    const int iwire = (*w)[sci];
+    const int jwire = (*w)[scj];
+
+    if(iwire == jwire){
+      // Same wire means movement of charge cancels itself out
+      if(iwire != SolverGraph::kNoWire)
+        ret += sqr(g.fIWCharge[iwire] - g.fIWPred[iwire]);
+    }
+    else{
+      if(iwire != SolverGraph::kNoWire)
+        ret += sqr(g.fIWCharge[iwire] - (g.fIWPred[iwire] + x));
+      if(jwire != SolverGraph::kNoWire)
+        ret += sqr(g.fIWCharge[jwire] - (g.fIWPred[jwire] - x));
+    }
+  }
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+QuadExpr Metric(const SolverGraph& g, unsigned int sc, double alpha)
+{
+  QuadExpr ret = 0;
+
+  // How much charge is added to sc
+  QuadExpr x = QuadExpr::X();
+
+  if(alpha != 0){
+    const double scp = g.fSCPred[sc];
+
+    // Self energy
+    ret -= alpha*sqr(scp + x);
+
+    // Interaction. We're only seeing one end of the double-ended connection
+    // here, so multiply by two.
+    ret -= 2 * alpha * (scp + x) * g.fSCNeiPotential[sc];
+  }
+
+  // Prediction of the induction wires
+  const int w1 = g.fSCWire1[sc];
+  const int w2 = g.fSCWire2[sc];
+  ret += sqr(g.fIWCharge[w1] - (g.fIWPred[w1] + x));
+  ret += sqr(g.fIWCharge[w2] - (g.fIWPred[w2] + x));
+
+  return ret;
+}
+
+// ---------------------------------------------------------------------------
+double SolvePair(const SolverGraph& g, unsigned int sci, unsigned int scj,
+                 double alpha)
+{
+  const QuadExpr chisq = Metric(g, sci, scj, alpha);
+  const double chisq0 = chisq.Eval(0);
+
+  // Find the minimum of a quadratic expression
+  double x = -chisq.Linear()/(2*chisq.Quadratic());
+
+  // Don't allow either SpaceCharge to go negative
+  const double xmin = -g.fSCPred[sci];
+  const double xmax =  g.fSCPred[scj];
+
+  // Clamp to allowed range
+  x = std::min(xmax, x);
+  x = std::max(xmin, x);
+
+  const double chisq_new = chisq.Eval(x);
+
+  // Should try these too, because the function might be convex not concave, so
+  // d/dx=0 gives the max not the min, and the true min is at one extreme of
+  // the range.
+  const double chisq_p = chisq.Eval(xmax);
+  const double chisq_n = chisq.Eval(xmin);
+
+  if(std::min(std::min(chisq_p, chisq_n), chisq_new) > chisq0+1){
+    std::cout << "Solution at " << x << " is worse than current state! Scan from " << xmin << " to " << xmax << std::endl;
+    for(double x = xmin; x < xmax; x += .01*(xmax-xmin)){
+      std::cout << x << " " << chisq.Eval(x) << std::endl;
+    }
+
+    std::cout << "Soln, original, up edge, low edge:" << std::endl;
+    std::cout << chisq_new << " " << chisq0 << " " << chisq_p << " " << chisq_n << std::endl;
+    abort();
+  }
+
+  if(std::min(chisq_n, chisq_p) < chisq_new){
+    if(chisq_n < chisq_p) return xmin;
+    return xmax;
+  }
+
+  return x;
+}
+
+// ---------------------------------------------------------------------------
+void Iterate(SolverGraph& g, unsigned int cwire, double alpha)
+{
+  // Consider all pairs of crossings
+  const unsigned int first = g.fCWFirstSC[cwire];
+  const unsigned int last = g.fCWFirstSC[cwire+1];
+
+  for(unsigned int i = first; i+1 < last; ++i){
+    for(unsigned int j = i+1; j < last; ++j){
+      const double x = SolvePair(g, i, j, alpha);
+
+      if(x == 0) continue;
+
+      // Actually make the update
+      g.AddCharge(i, +x);
+      g.AddCharge(j, -x);
+    } // end for j
+  } // end for i
+}
+
+// ---------------------------------------------------------------------------
+void IterateOrphan(SolverGraph& g, unsigned int sc, double alpha)
+{
+  const QuadExpr chisq = Metric(g, sc, alpha);
+
+  // Find the minimum of a quadratic expression
+  double x = -chisq.Linear()/(2*chisq.Quadratic());
+
+  // Don't allow the SpaceCharge to go negative
+  const double xmin = -g.fSCPred[sc];
+
+  // Clamp to allowed range
+  x = std::max(xmin, x);
+
+  const double chisq_new = chisq.Eval(x);
+
+  // Should try here too, because the function might be convex not concave, so
+  // d/dx=0 gives the max not the min, and the true min is at one extreme of
+  // the range.
+  const double chisq_n = chisq.Eval(xmin);
+
+  if(chisq_n < chisq_new)
+    g.AddCharge(sc, xmin);
+  else
+    g.AddCharge(sc, x);
+}
+
+// ---------------------------------------------------------------------------
+void Iterate(SolverGraph& g, double alpha)
+{
+  // Visiting in a "random" order helps prevent local artefacts that are slow
+  // to break up.
+  const unsigned int nCWires = g.NCollectionWires();
+  unsigned int cwireIdx = 0;
+  if(nCWires != 0){
+    do{
+      Iterate(g, cwireIdx, alpha);
+
+      const unsigned int prime = 1299827;
+      cwireIdx = (cwireIdx+prime)%nCWires;
+    } while(cwireIdx != 0);
+  }
+
+  for(unsigned int sc = g.FirstOrphan(); sc < g.NSpaceCharges(); ++sc)
+    IterateOrphan(g, sc, alpha);
+}
+
+// ---------------------------------------------------------------------------
+std::vector<std::vector<unsigned int>> ColorWires(const SolverGraph& g)
+{
+  // Updating a collection wire writes the predictions of its space charges and
+  // of their induction wires, and the potential of the neighbouring space
+  // charges. Two wires can be updated together if none of these overlap. Every
+  // wire is summarized by the set of objects it touches: itself, its
+  // induction wires and the owners (collection wire, or the space charge
+  // itself for orphans) of its neighbours. Neighbour relationships are
+  // symmetric, so two wires conflict exactly when their sets intersect.
+  //
+  // The objects are numbered collection wires first, then induction wires,
+  // then orphans.
+  const unsigned int nCWires = g.NCollectionWires();
+  const unsigned int iwOffset = nCWires;
+  const unsigned int orphanOffset = iwOffset + g.NInductionWires();
+
+  std::vector<std::vector<unsigned int>> usedColors(orphanOffset + g.NSpaceCharges() - g.FirstOrphan());
+
+  std::vector<std::vector<unsigned int>> colors;
+  std::vector<unsigned int> touched;
+  std::vector<bool> forbidden;
+
+  // Color in the same "random" order the serial sweep uses, so that each color
+  // is visited in that order too
+  unsigned int cwireIdx = 0;
+  if(nCWires == 0) return colors;
+  do{
+    touched.clear();
+    touched.push_back(cwireIdx);
+    for(unsigned int sc = g.fCWFirstSC[cwireIdx]; sc < g.fCWFirstSC[cwireIdx+1]; ++sc){
+      if(g.fSCWire1[sc] != SolverGraph::kNoWire) touched.push_back(iwOffset + g.fSCWire1[sc]);
+      if(g.fSCWire2[sc] != SolverGraph::kNoWire) touched.push_back(iwOffset + g.fSCWire2[sc]);
+      for(unsigned int k = g.fNeiFirst[sc]; k < g.fNeiFirst[sc+1]; ++k){
+        const unsigned int nei = g.fNeiSC[k];
+        if(g.fSCCWire[nei] != SolverGraph::kNoWire)
+          touched.push_back(g.fSCCWire[nei]);
+        else
+          touched.push_back(orphanOffset + (nei - g.FirstOrphan()));
+      }
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    forbidden.assign(colors.size(), false);
+    for(unsigned int obj: touched){
+      for(unsigned int color: usedColors[obj]) forbidden[color] = true;
+    }
+
+    const unsigned int color =
+      std::find(forbidden.begin(), forbidden.end(), false) - forbidden.begin();
+    if(color == colors.size()) colors.emplace_back();
+    colors[color].push_back(cwireIdx);
+
+    for(unsigned int obj: touched) usedColors[obj].push_back(color);
+
+    const unsigned int prime = 1299827;
+    cwireIdx = (cwireIdx+prime)%nCWires;
+  } while(cwireIdx != 0);
+
+  return colors;
+}
+
+// ---------------------------------------------------------------------------
+void Iterate(SolverGraph& g,
+             const std::vector<std::vector<unsigned int>>& colors,
+             double alpha,
+             unsigned int nThreads)
+{
+  for(const std::vector<unsigned int>& cwires: colors){
+    // Contiguous blocks of wires, one per worker. Wires of the same color are
+    // independent, so the order within the color doesn't matter.
+    const size_t nBlocks = std::max(std::min(size_t(nThreads), cwires.size()),
+                                    size_t(1));
+
+    auto iterateBlock = [&](size_t block)
+      {
+        const size_t begin = (block * cwires.size()) / nBlocks;
+        const size_t end = ((block+1) * cwires.size()) / nBlocks;
+        for(size_t i = begin; i < end; ++i) Iterate(g, cwires[i], alpha);
+      };
+
+    if(nBlocks > 1)
+      tbb::parallel_for(size_t(0), nBlocks, iterateBlock);
+    else
+      iterateBlock(0);
+  }
+
+  for(unsigned int sc = g.FirstOrphan(); sc < g.NSpaceCharges(); ++sc)
+    IterateOrphan(g, sc, alpha);
+}
@@ -0,0 +1,81 @@
+#ifndef RECO3D_SOLVERGRAPH_H
+#define RECO3D_SOLVERGRAPH_H
+
+#include <vector>
+
+#include "QuadExpr.h"
+#include "Solver.h"
+
+/// Flattened copy of the system built out of CollectionWireHit, SpaceCharge
+/// and InductionWireHit objects. Every quantity lives in a contiguous array
+/// indexed by the position of the object, and the adjacency (crossings of a
+/// collection wire, neighbours of a space charge) is stored in compressed
+/// sparse row form, so the minimization never chases pointers.
+///
+/// The space charges of each collection wire are contiguous, in the order of
+/// the wires, and the orphans follow them.
+class SolverGraph
+{
+public:
+  SolverGraph(const std::vector<CollectionWireHit*>& cwires,
+              const std::vector<SpaceCharge*>& orphanSCs);
+
+  /// Write the predictions back into the objects the graph was built from
+  void CopyPredictions(const std::vector<CollectionWireHit*>& cwires,
+                       const std::vector<SpaceCharge*>& orphanSCs) const;
+
+  unsigned int NCollectionWires() const {return fCWCharge.size();}
+  unsigned int NSpaceCharges() const {return fSCPred.size();}
+  unsigned int NInductionWires() const {return fIWCharge.size();}
+  /// Index of the first orphan space charge
+  unsigned int FirstOrphan() const {return fCWFirstSC.back();}
+
+  void AddCharge(unsigned int sc, double dq);
+
+  // Induction wires
+  std::vector<double> fIWCharge;
+  std::vector<double> fIWPred;
+
+  // Collection wires. The crossings of wire i are the space charges in
+  // [fCWFirstSC[i], fCWFirstSC[i+1]).
+  std::vector<double> fCWCharge;
+  std::vector<unsigned int> fCWFirstSC;
+
+  // Space charges. kNoWire marks a missing induction or collection wire.
+  static constexpr int kNoWire = -1;
+  std::vector<int> fSCCWire;
+  std::vector<int> fSCWire1, fSCWire2;
+  std::vector<double> fSCPred;
+  std::vector<double> fSCNeiPotential; ///< Neighbour-induced potential
+
+  // Neighbours of space charge i are [fNeiFirst[i], fNeiFirst[i+1])
+  std::vector<unsigned int> fNeiFirst;
+  std::vector<unsigned int> fNeiSC;
+  std::vector<double> fNeiCoupling;
+};
+
+double Metric(const SolverGraph& g, double alpha);
+QuadExpr Metric(const SolverGraph& g, unsigned int sci, unsigned int scj,
+                double alpha);
+QuadExpr Metric(const SolverGraph& g, unsigned int sc, double alpha);
+
+double SolvePair(const SolverGraph& g, unsigned int sci, unsigned int scj,
+                 double alpha);
+void Iterate(SolverGraph& g, unsigned int cwire, double alpha);
+void IterateOrphan(SolverGraph& g, unsigned int sc, double alpha);
+void Iterate(SolverGraph& g, double alpha);
+
+/// Partition the collection wires into "colors" such that no two wires of the
+/// same color share an induction wire or are coupled by a neighbour
+/// relationship. The wires of one color can then be updated concurrently.
+std::vector<std::vector<unsigned int>> ColorWires(const SolverGraph& g);
+
+/// Same as the sweep above, but visiting the colors in turn and spreading the
+/// wires of each color over \a nThreads workers. The result does not depend on
+/// the number of threads.
+void Iterate(SolverGraph& g,
+             const std::vector<std::vector<unsigned int>>& colors,
+             double alpha,
+             unsigned int nThreads);
+
+#endif
@@ -3,6 +3,8 @@
 // Test file at Caltech: /nfs/raid11/dunesam/prodgenie_nu_dune10kt_1x2x6_mcc7.0/prodgenie_nu_dune10kt_1x2x6_63_20160811T171439_merged.root
 
 // C/C++ standard libraries
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <iostream>
 
@@ -30,6 +32,7 @@
 #include "larreco/SpacePointSolver/HitReaders/IHitReader.h"
 
 #include "Solver.h"
+#include "SolverGraph.h"
 #include "TripletFinder.h"
 
 template<class T> T sqr(T x){return x*x;}
@@ -70,8 +73,8 @@ private:
                    bool incNei,
                    HitMap_t& hitmap) const;
 
-  void Minimize(const std::vector<CollectionWireHit*>& cwires,
-                const std::vector<SpaceCharge*>& orphanSCs,
+  void Minimize(SolverGraph& graph,
+                const std::vector<std::vector<unsigned int>>& colors,
                 double alpha,
                 int maxiterations);
 
@@ -106,6 +109,9 @@ private:
 
   double fXHitOffset;
 
+  /// More than one thread switches to the colored sweep, see ColorWires()
+  unsigned int fNumThreads;
+
   const detinfo::DetectorProperties* detprop;
   const geo::GeometryCore* geom;
   std::unique_ptr<reco3d::IHitReader> fHitReader; ///<  Expt specific tool for reading hits
@@ -125,7 +131,8 @@ SpacePointSolver::SpacePointSolver(const fhicl::ParameterSet& pset) :
     fDistThreshDrift(pset.get<double>("WireIntersectThresholdDriftDir")),
     fMaxIterationsNoReg(pset.get<int>("MaxIterationsNoReg")),
     fMaxIterationsReg(pset.get<int>("MaxIterationsReg")),
-    fXHitOffset(pset.get<double>("XHitOffset"))
+    fXHitOffset(pset.get<double>("XHitOffset")),
+    fNumThreads(std::max(pset.get<unsigned int>("NumThreads", 1), 1u))
 {
   recob::ChargedSpacePointCollectionCreator::produces(producesCollector(), "pre");
   if(fFit){
@@ -184,10 +191,18 @@ AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const
     int fX, fY, fZ;
   };
 
-  std::map<IntCoord, std::vector<SpaceCharge*>> scMap;
-  for(SpaceCharge* sc: spaceCharges){
-    scMap[IntCoord(*sc)].push_back(sc);
-  }
+  // Flat list of the space charges sorted by cell. Each cell is a contiguous
+  // range found by binary search; the stable sort keeps the charges of a cell
+  // in their original order.
+  std::vector<std::pair<IntCoord, SpaceCharge*>> scCells;
+  scCells.reserve(spaceCharges.size());
+  for(SpaceCharge* sc: spaceCharges) scCells.emplace_back(IntCoord(*sc), sc);
+  auto cellLess = [](const std::pair<IntCoord, SpaceCharge*>& a,
+                     const std::pair<IntCoord, SpaceCharge*>& b)
+    {
+      return a.first < b.first;
+    };
+  std::stable_sort(scCells.begin(), scCells.end(), cellLess);
 
   std::cout << "Neighbour search..." << std::endl;
 
@@ -198,7 +213,10 @@ AddNeighbours(const std::vector<SpaceCharge*>& spaceCharges) const
   for(SpaceCharge* sc1: spaceCharges){
     IntCoord ic(*sc1);
     for(IntCoord icn: ic.Neighbours()){
-      for(SpaceCharge* sc2: scMap[icn]){
+      const auto range = std::equal_range(scCells.begin(), scCells.end(),
+                                          std::make_pair(icn, sc1), cellLess);
+      for(auto it = range.first; it != range.second; ++it){
+        SpaceCharge* sc2 = it->second;
 
         ++Ntests;
 
@@ -410,17 +428,24 @@ FillSystemToSpacePointsAndAssns(const std::vector<art::Ptr<recob::Hit>>& hitlist
 }
 
 // ---------------------------------------------------------------------------
-void SpacePointSolver::Minimize(const std::vector<CollectionWireHit*>& cwires,
-                                const std::vector<SpaceCharge*>& orphanSCs,
+void SpacePointSolver::Minimize(SolverGraph& graph,
+                                const std::vector<std::vector<unsigned int>>& colors,
                                 double alpha,
                                 int maxiterations)
 {
-  double prevMetric = Metric(cwires, alpha);
+  double prevMetric = Metric(graph, alpha);
   std::cout << "Begin: " << prevMetric << std::endl;
   for(int i = 0; i < maxiterations; ++i){
-    Iterate(cwires, orphanSCs, alpha);
-    const double metric = Metric(cwires, alpha);
-    std::cout << i << " " << metric << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    if(fNumThreads > 1)
+      Iterate(graph, colors, alpha, fNumThreads);
+    else
+      Iterate(graph, alpha);
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+    const double metric = Metric(graph, alpha);
+    std::cout << i << " " << metric << " (" << elapsed.count() << " ms)" << std::endl;
     if(metric > prevMetric){
       std::cout << "Warning: metric increased" << std::endl;
       return;
@@ -510,15 +535,34 @@ void SpacePointSolver::produce(art::Event& evt)
   spcol_pre.put();
 
   if(fFit){
+    // The minimization runs on the flattened copy of the system. The
+    // neighbour lists are the bulk of the memory and only the graph needs
+    // them from here on.
+    SolverGraph graph(cwires, orphanSCs);
+    for(CollectionWireHit* cwire: cwires)
+      for(SpaceCharge* sc: cwire->fCrossings)
+        std::vector<Neighbour>().swap(sc->fNeighbours);
+    for(SpaceCharge* sc: orphanSCs)
+      std::vector<Neighbour>().swap(sc->fNeighbours);
+
+    std::vector<std::vector<unsigned int>> colors;
+    if(fNumThreads > 1){
+      colors = ColorWires(graph);
+      std::cout << colors.size() << " independent sets of collection wires for "
+                << fNumThreads << " threads" << std::endl;
+    }
+
     std::cout << "Iterating with no regularization..." << std::endl;
-    Minimize(cwires, orphanSCs, 0, fMaxIterationsNoReg);
+    Minimize(graph, colors, 0, fMaxIterationsNoReg);
 
+    graph.CopyPredictions(cwires, orphanSCs);
     FillSystemToSpacePoints(cwires, orphanSCs, spcol_noreg);
     spcol_noreg.put();
 
     std::cout << "Now with regularization..." << std::endl;
-    Minimize(cwires, orphanSCs, fAlpha, fMaxIterationsReg);
+    Minimize(graph, colors, fAlpha, fMaxIterationsReg);
 
+    graph.CopyPredictions(cwires, orphanSCs);
     FillSystemToSpacePointsAndAssns(hitlist, cwires, orphanSCs, hitmap, spcol, *assns);
     spcol.put();
     evt.put(std::move(assns));
@@ -1,9 +1,14 @@
 #include "larreco/SpacePointSolver/TripletFinder.h"
 
 #include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
 
 #include "TVector3.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "larcore/Geometry/Geometry.h"
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
@@ -26,6 +31,12 @@ namespace reco3d
       fDistThreshDrift(distThreshDrift),
       fXHitOffset(xhitOffset)
   {
+    if(!(distThreshDrift > 0)){
+      throw cet::exception("TripletFinder")
+        << "Drift direction wire intersection threshold must be positive, got "
+        << distThreshDrift << "\n";
+    }
+
     FillHitMap(xhits, fX_by_tpc);
     FillHitMap(uhits, fU_by_tpc);
     FillHitMap(vhits, fV_by_tpc);
@@ -41,12 +52,13 @@ namespace reco3d
              std::map<geo::TPCID, std::vector<HitOrChan>>& out)
   {
     for(const art::Ptr<recob::Hit>& hit: hits){
-      for(geo::TPCID tpc: geom->ROPtoTPCs(geom->ChannelToROP(hit->Channel()))){
+      const ChannelGeometry& chanGeom = GetChannelGeometry(hit->Channel());
+      for(geo::TPCID tpc: chanGeom.tpcs){
         double xpos = 0;
-        for(geo::WireID wire: geom->ChannelToWire(hit->Channel())){
+        for(geo::WireID wire: chanGeom.wires){
           if(geo::TPCID(wire) == tpc){
             xpos = detprop->ConvertTicksToX(hit->PeakTime(), wire);
-            if (geom->SignalType(wire) == geo::kCollection) xpos += fXHitOffset;
+            if (chanGeom.collection) xpos += fXHitOffset;
           }
         }
 
@@ -64,18 +76,89 @@ namespace reco3d
              std::map<geo::TPCID, std::vector<raw::ChannelID_t>>& out)
   {
     for(raw::ChannelID_t chan: bads){
-      for(geo::TPCID tpc: geom->ROPtoTPCs(geom->ChannelToROP(chan))){
+      for(geo::TPCID tpc: GetChannelGeometry(chan).tpcs){
         out[tpc].push_back(chan);
       }
     }
   }
 
+  // -------------------------------------------------------------------------
+  const ChannelGeometry& TripletFinder::
+  GetChannelGeometry(raw::ChannelID_t chan)
+  {
+    auto ins = fChannelGeom.emplace(chan, ChannelGeometry());
+    ChannelGeometry& chanGeom = ins.first->second;
+    if(ins.second){
+      chanGeom.tpcs = geom->ROPtoTPCs(geom->ChannelToROP(chan));
+      chanGeom.wires = geom->ChannelToWire(chan);
+      chanGeom.collection = (geom->SignalType(chan) == geo::kCollection);
+    }
+    return chanGeom;
+  }
+
+  // -------------------------------------------------------------------------
+  WireHitIndex::WireHitIndex(geo::TPCID tpc,
+                             const std::vector<HitOrChan>& hits,
+                             const ChannelGeometryMap& chanGeom)
+  {
+    // Wires of each hit in this TPC. A channel can be wrapped onto several
+    // wires of the same plane, so a hit can be on several of them.
+    std::vector<std::pair<int, unsigned int>> entries;
+    entries.reserve(hits.size());
+    for(unsigned int i = 0; i < hits.size(); ++i){
+      for(geo::WireID wire: chanGeom.at(hits[i].chan).wires){
+        if(geo::TPCID(wire) != tpc) continue;
+        if(entries.empty()) fPlane = wire;
+        entries.emplace_back(wire.Wire, i);
+      }
+    }
+
+    // The hits are sorted in x, so they stay sorted within each wire
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const auto& a, const auto& b){return a.first < b.first;});
+
+    fX.reserve(entries.size());
+    fHitIdx.reserve(entries.size());
+    for(const auto& e: entries){
+      if(fWires.empty() || fWires.back() != e.first){
+        fWires.push_back(e.first);
+        fWireFirst.push_back(fHitIdx.size());
+      }
+      fX.push_back(hits[e.second].xpos);
+      fHitIdx.push_back(e.second);
+    }
+    fWireFirst.push_back(fHitIdx.size());
+  }
+
+  // -------------------------------------------------------------------------
+  void WireHitIndex::Query(int wmin, int wmax, double xlo, double xhi,
+                           std::vector<unsigned int>& out) const
+  {
+    out.clear();
+
+    const auto wbegin = std::lower_bound(fWires.begin(), fWires.end(), wmin);
+    for(auto wit = wbegin; wit != fWires.end() && *wit <= wmax; ++wit){
+      const size_t iw = wit - fWires.begin();
+      const auto xbegin = fX.begin() + fWireFirst[iw];
+      const auto xend = fX.begin() + fWireFirst[iw+1];
+
+      for(auto xit = std::lower_bound(xbegin, xend, xlo);
+          xit != xend && *xit <= xhi; ++xit){
+        out.push_back(fHitIdx[xit - fX.begin()]);
+      }
+    }
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+  }
+
   // -------------------------------------------------------------------------
   class IntersectionCache
   {
   public:
-    IntersectionCache(geo::TPCID tpc)
+    IntersectionCache(geo::TPCID tpc, const ChannelGeometryMap& chanGeom)
       : geom(art::ServiceHandle<geo::Geometry const>()->provider()),
+        fChanGeom(chanGeom),
         fTPC(tpc)
     {
     }
@@ -101,9 +184,9 @@ namespace reco3d
     bool ISect(raw::ChannelID_t chanA, raw::ChannelID_t chanB,
                geo::WireIDIntersection& pt) const
     {
-      for(geo::WireID awire: geom->ChannelToWire(chanA)){
+      for(geo::WireID awire: fChanGeom.at(chanA).wires){
         if(geo::TPCID(awire) != fTPC) continue;
-        for(geo::WireID bwire: geom->ChannelToWire(chanB)){
+        for(geo::WireID bwire: fChanGeom.at(chanB).wires){
           if(geo::TPCID(bwire) != fTPC) continue;
 
           if(geom->WireIDsIntersect(awire, bwire, pt)) return true;
@@ -114,6 +197,7 @@ namespace reco3d
     }
 
     const geo::GeometryCore* geom;
+    const ChannelGeometryMap& fChanGeom;
 
     std::map<std::pair<raw::ChannelID_t, raw::ChannelID_t>, bool> fMap;
     std::map<std::pair<raw::ChannelID_t, raw::ChannelID_t>, geo::WireIDIntersection> fPtMap;
@@ -163,7 +247,7 @@ namespace reco3d
       std::vector<ChannelDoublet> xvs = DoubletsXV(tpc);
 
       // Cache to prevent repeating the same questions
-      IntersectionCache isectUV(tpc);
+      IntersectionCache isectUV(tpc, fChannelGeom);
 
       // For the efficient looping below to work we need to sort the doublet
       // lists so the X hits occur in the same order.
@@ -288,9 +372,13 @@ namespace reco3d
   {
     std::vector<ChannelDoublet> ret;
 
-    IntersectionCache isect(tpc);
+    IntersectionCache isect(tpc, fChannelGeom);
+
+    const WireHitIndex index(tpc, bhits, fChannelGeom);
+    std::vector<unsigned int> cands;
 
-    auto b_begin = bhits.begin();
+    // Range of wires of the other plane crossed by each channel
+    std::map<raw::ChannelID_t, std::pair<int, int>> wireRanges;
 
     for(const HitOrChan& a: ahits){
       // Bad channels are easy because there's no timing constraint
@@ -301,14 +389,37 @@ namespace reco3d
         }
       }
 
-      while(b_begin != bhits.end() &&
-            b_begin->xpos < a.xpos &&
-            !CloseDrift(b_begin->xpos, a.xpos)) ++b_begin;
+      if(index.Empty()) continue;
+
+      // Only the wires of the other plane that the projection of this wire
+      // crosses can intersect it. One wire of margin on either side.
+      auto ins = wireRanges.emplace(a.chan, std::make_pair(0, 0));
+      int& wmin = ins.first->second.first;
+      int& wmax = ins.first->second.second;
+      if(ins.second){
+        wmin = std::numeric_limits<int>::max();
+        wmax = std::numeric_limits<int>::min();
+        for(geo::WireID awire: fChannelGeom.at(a.chan).wires){
+          if(geo::TPCID(awire) != tpc) continue;
+          const auto ends = geom->WireEndPoints(awire);
+          const TVector3 r0 = ends.start();
+          const TVector3 r1 = ends.end();
+          const double w0 = geom->WireCoordinate(r0.Y(), r0.Z(), index.Plane());
+          const double w1 = geom->WireCoordinate(r1.Y(), r1.Z(), index.Plane());
+          wmin = std::min(wmin, int(std::floor(std::min(w0, w1)))-1);
+          wmax = std::max(wmax, int(std::ceil(std::max(w0, w1)))+1);
+        }
+      }
+      if(wmin > wmax) continue;
+
+      // In increasing index, ie xpos, order as the hits were scanned before
+      index.Query(wmin, wmax,
+                  a.xpos-fDistThreshDrift, a.xpos+fDistThreshDrift, cands);
 
-      for(auto bit = b_begin; bit != bhits.end(); ++bit){
-        const HitOrChan& b = *bit;
+      for(unsigned int bidx: cands){
+        const HitOrChan& b = bhits[bidx];
 
-        if(b.xpos > a.xpos && !CloseDrift(b.xpos, a.xpos)) break;
+        if(!CloseDrift(b.xpos, a.xpos)) continue;
 
         geo::WireIDIntersection pt;
         if(!isect(a.chan, b.chan, pt)) continue;
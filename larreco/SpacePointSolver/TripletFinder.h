@@ -39,6 +39,49 @@ namespace reco3d
     geo::WireIDIntersection pt;
   };
 
+  /// Geometry of a channel, looked up once per channel rather than per hit
+  struct ChannelGeometry
+  {
+    std::vector<geo::TPCID> tpcs;
+    std::vector<geo::WireID> wires;
+    bool collection;
+  };
+
+  using ChannelGeometryMap = std::map<raw::ChannelID_t, ChannelGeometry>;
+
+  /// Index of the hits of one plane in one TPC by wire and drift position.
+  /// Only the wires with hits are stored, each with its hits sorted in x, so
+  /// that the hits compatible with a given wire range and drift window are
+  /// found by binary searches without scanning the whole list.
+  class WireHitIndex
+  {
+  public:
+    /// \a hits must be sorted by xpos, as FillHitMap() leaves them, and
+    /// their channels must be in \a chanGeom
+    WireHitIndex(geo::TPCID tpc,
+                 const std::vector<HitOrChan>& hits,
+                 const ChannelGeometryMap& chanGeom);
+
+    bool Empty() const {return fHitIdx.empty();}
+    geo::PlaneID Plane() const {return fPlane;}
+
+    /// Indices of the hits on wires [\a wmin, \a wmax] with drift position
+    /// in [\a xlo, \a xhi], in increasing order
+    void Query(int wmin, int wmax, double xlo, double xhi,
+               std::vector<unsigned int>& out) const;
+
+  protected:
+    geo::PlaneID fPlane;
+
+    /// Wires with hits, in increasing order
+    std::vector<int> fWires;
+    /// The hits of wire fWires[i] are [fWireFirst[i], fWireFirst[i+1]) in
+    /// fX and fHitIdx, sorted by drift position
+    std::vector<unsigned int> fWireFirst;
+    std::vector<double> fX;
+    std::vector<unsigned int> fHitIdx;
+  };
+
   struct XYZ
   {
     double x, y, z;
@@ -77,6 +120,9 @@ namespace reco3d
     void FillBadMap(const std::vector<raw::ChannelID_t>& bads,
                     std::map<geo::TPCID, std::vector<raw::ChannelID_t>>& out);
 
+    /// Geometry of the channel, from the cache filled on first use
+    const ChannelGeometry& GetChannelGeometry(raw::ChannelID_t chan);
+
     bool CloseDrift(double xa, double xb) const;
     bool CloseSpace(geo::WireIDIntersection ra,
                     geo::WireIDIntersection rb) const;
@@ -94,6 +140,9 @@ namespace reco3d
     double fDistThreshDrift;
     double fXHitOffset;
 
+    /// Geometry of the channels of all the hits and bad channels
+    ChannelGeometryMap fChannelGeom;
+
     std::map<geo::TPCID, std::vector<HitOrChan>> fX_by_tpc;
     std::map<geo::TPCID, std::vector<HitOrChan>> fU_by_tpc;
     std::map<geo::TPCID, std::vector<HitOrChan>> fV_by_tpc;
@@ -33,6 +33,10 @@
 #include "lardata/RecoObjects/TrackStatePropagator.h"
 #include "lardataobj/MCBase/MCTrack.h"
 
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include <algorithm>
 #include <memory>
 
 namespace trkf {
@@ -144,6 +148,11 @@ namespace trkf {
         Name("keepInputTrajectoryPoints"),
         Comment("Option to keep positions and directions from input trajectory/track. The fit will provide only covariance matrices, chi2, ndof, particle Id and absolute momentum. It may also modify the trajectory point flags. In order to avoid inconsistencies, it has to be used with the following fitter options all set to false: sortHitsByPlane, sortOutputHitsMinLength, skipNegProp.")
       };
+      fhicl::Atom<unsigned int> numThreads {
+        Name("numThreads"),
+        Comment("Number of threads fitting the tracks of an event concurrently. The outputs are in the same order for any number of threads."),
+        1
+      };
     };
 
     struct Config {
@@ -174,9 +183,32 @@ namespace trkf {
   private:
     void produce(art::Event & e) override;
 
+    /// Propagator and fitter used by one of the extra threads (the fitter keeps a pointer to the propagator)
+    struct Worker {
+      explicit Worker(Parameters const & p) : prop{p().propagator}, kalmanFitter{&prop, p().fitter} {}
+      TrackStatePropagator prop;
+      trkf::TrackKalmanFitter kalmanFitter;
+    };
+
+    /// Inputs of the fit of one track (or shower), collected before running the fits, and its outputs
+    struct FitJob {
+      const recob::Track* track = nullptr;
+      const recob::Shower* shower = nullptr;
+      unsigned int iPF = 0;
+      int pId = 0;
+      double mom = 0.;
+      bool flipDir = false;
+      std::vector<art::Ptr<recob::Hit> > inHits;
+      bool fitok = false;
+      recob::Track outTrack;
+      std::vector<art::Ptr<recob::Hit> > outHits;
+      trkmkr::OptionalOutputs optionals;
+    };
+
     Parameters p_;
     TrackStatePropagator prop;
     trkf::TrackKalmanFitter kalmanFitter;
+    std::vector<std::unique_ptr<Worker> > workers; // one per extra thread
     mutable trkf::TrackMomentumCalculator tmc{};
     bool inputFromPF;
 
@@ -198,6 +230,9 @@ namespace trkf {
     bool   setDirFlip(const recob::Track& track, TVector3& mcdir, const std::vector<art::Ptr<recob::Vertex> >* vertices = 0) const;
 
     void restoreInputPoints(const recob::Trajectory& track,const std::vector<art::Ptr<recob::Hit> >& inHits,recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits) const;
+
+    void fitJob(FitJob& job, const trkf::TrackKalmanFitter& fitter) const;
+    void fitJobs(std::vector<FitJob>& jobs) const;
   };
 }
 
@@ -209,6 +244,9 @@ trkf::KalmanFilterFinalTrackFitter::KalmanFilterFinalTrackFitter(trkf::KalmanFil
   , inputFromPF{p_().options().trackFromPF() || p_().options().showerFromPF()}
 {
 
+  for (unsigned int thread = 1; thread < p_().options().numThreads(); ++thread)
+    workers.push_back(std::make_unique<Worker>(p_));
+
   if (inputFromPF) {
     pfParticleInputTag = art::InputTag(p_().inputs().inputPFParticleLabel());
     if (p_().options().showerFromPF()) showerInputTag = art::InputTag(p_().inputs().inputShowersLabel());
@@ -315,6 +353,34 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event & e)
     //std::cout << "mc momentum value = " << pval << " GeV" << std::endl;
   }
 
+  //store the output track of a successful fit, with its associations
+  auto storeTrack = [&](FitJob& job, bool withSpacePoints) {
+    outputTracks->emplace_back(std::move(job.outTrack));
+    art::Ptr<recob::Track> aptr(tid, outputTracks->size()-1, tidgetter);
+    unsigned int ip = 0;
+    for (auto const& trhit: job.outHits) {
+      //the fitter produces collections with 1-1 match between hits and point
+      recob::TrackHitMeta metadata(ip,-1);
+      outputHitsMeta->addSingle(aptr, trhit, metadata);
+      outputHits->addSingle(aptr, trhit);
+      if (withSpacePoints && p_().options().produceSpacePoints() && outputTracks->back().HasValidPoint(ip)) {
+	auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
+	double fXYZ[3] = {tp.X(),tp.Y(),tp.Z()};
+	double fErrXYZ[6] = {0};
+	recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
+	outputSpacePoints->emplace_back(std::move(sp));
+	art::Ptr<recob::SpacePoint> apsp(spid, outputSpacePoints->size()-1, spidgetter);
+	outputHitSpacePointAssn->addSingle(trhit, apsp);
+      }
+      ip++;
+    }
+    outputHitInfo->emplace_back(job.optionals.trackFitHitInfos());
+    return aptr;
+  };
+
+  //the inputs of all fits are collected first, then the fits are run (possibly concurrently), then the outputs are stored in input order
+  std::vector<FitJob> jobs;
+
   if (inputFromPF) {
 
     auto outputPFAssn = std::make_unique<art::Assns<recob::PFParticle, recob::Track> >();
@@ -337,44 +403,19 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event & e)
 
 	for (unsigned int iTrack = 0; iTrack < tracks.size(); ++iTrack) {
 
-	  const recob::Track& track = *tracks[iTrack];
+	  FitJob& job = jobs.emplace_back();
+	  job.track = &*tracks[iTrack];
+	  job.iPF = iPF;
 	  art::Ptr<recob::Track> ptrack = tracks[iTrack];
-	  const int pId = setPId(iTrack, trackId, inputPFParticle->at(iPF).PdgCode());
-	  const double mom = setMomValue(ptrack, trackCalo, pMC, pId);
-	  const bool flipDir = setDirFlip(track, mcdir, &vertices);
+	  job.pId = setPId(iTrack, trackId, inputPFParticle->at(iPF).PdgCode());
+	  job.mom = setMomValue(ptrack, trackCalo, pMC, job.pId);
+	  job.flipDir = setDirFlip(*job.track, mcdir, &vertices);
 
 	  //this is not computationally optimal, but at least preserves the order unlike FindManyP
-	  std::vector<art::Ptr<recob::Hit> > inHits;
 	  for (auto it = tkHitsAssn.begin(); it!=tkHitsAssn.end(); ++it) {
-	    if (it->first == ptrack) inHits.push_back(it->second);
-	    else if (inHits.size()>0) break;
+	    if (it->first == ptrack) job.inHits.push_back(it->second);
+	    else if (job.inHits.size()>0) break;
 	  }
-
-	  recob::Track outTrack;
-	  std::vector<art::Ptr<recob::Hit> > outHits;
-	  trkmkr::OptionalOutputs optionals;
-	  if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-          bool fitok = kalmanFitter.fitTrack(track.Trajectory(),track.ID(),
-					      track.VertexCovarianceLocal5D(),track.EndCovarianceLocal5D(),
-					      inHits, mom, pId, flipDir, outTrack, outHits, optionals);
-	  if (!fitok) continue;
-
-	  if (p_().options().keepInputTrajectoryPoints()) {
-	    restoreInputPoints(track.Trajectory().Trajectory(),inHits,outTrack,outHits);
-	  }
-
-	  outputTracks->emplace_back(std::move(outTrack));
-	  art::Ptr<recob::Track> aptr(tid, outputTracks->size()-1, tidgetter);
-	  unsigned int ip = 0;
-	  for (auto const& trhit: outHits) {
-	    //the fitter produces collections with 1-1 match between hits and point
-	    recob::TrackHitMeta metadata(ip,-1);
-	    outputHitsMeta->addSingle(aptr, trhit, metadata);
-	    outputHits->addSingle(aptr, trhit);
-	    ip++;
-	  }
-	  outputPFAssn->addSingle(art::Ptr<recob::PFParticle>(inputPFParticle, iPF), aptr);
-	  outputHitInfo->emplace_back(optionals.trackFitHitInfos());
 	}
       }
 
@@ -396,7 +437,9 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event & e)
 	//auto const& shHitsAssn = *e.getValidHandle<art::Assns<recob::Shower, recob::Hit> >(showerInputTag);
 	for (unsigned int iShower = 0; iShower < showers.size(); ++iShower) {
 	  //
-	  const recob::Shower& shower = *showers[iShower];
+	  FitJob& job = jobs.emplace_back();
+	  job.shower = &*showers[iShower];
+	  job.iPF = iPF;
 	  // art::Ptr<recob::Shower> pshower = showers[iShower];
 	  // //this is not computationally optimal, but at least preserves the order unlike FindManyP
 	  // std::vector<art::Ptr<recob::Hit> > inHits;
@@ -404,46 +447,23 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event & e)
 	  //   if (it->first == pshower) inHits.push_back(it->second);
 	  //   else if (inHits.size()>0) break;
 	  // }
-
-	  recob::Track outTrack;
-	  std::vector<art::Ptr<recob::Hit> > outHits;
-	  trkmkr::OptionalOutputs optionals;
-	  if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-	  Point_t pos(shower.ShowerStart().X(),shower.ShowerStart().Y(),shower.ShowerStart().Z());
-	  Vector_t dir(shower.Direction().X(),shower.Direction().Y(),shower.Direction().Z());
-	  auto cov = SMatrixSym55();
-	  auto pid = p_().options().pdgId();
-	  auto mom = p_().options().pval();
-          bool fitok = kalmanFitter.fitTrack(pos, dir, cov, inHits, std::vector<recob::TrajectoryPointFlags>(),
-					      shower.ID(), mom, pid,
-					      outTrack, outHits, optionals);
-	  if (!fitok) continue;
-
-	  outputTracks->emplace_back(std::move(outTrack));
-	  art::Ptr<recob::Track> aptr(tid, outputTracks->size()-1, tidgetter);
-	  unsigned int ip = 0;
-	  for (auto const& trhit: outHits) {
-	    // the fitter produces collections with 1-1 match between hits and point
-	    recob::TrackHitMeta metadata(ip,-1);
-	    outputHitsMeta->addSingle(aptr, trhit, metadata);
-	    outputHits->addSingle(aptr, trhit);
-	    if (p_().options().produceSpacePoints() && outputTracks->back().HasValidPoint(ip)) {
-	      auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
-	      double fXYZ[3] = {tp.X(),tp.Y(),tp.Z()};
-	      double fErrXYZ[6] = {0};
-	      recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
-	      outputSpacePoints->emplace_back(std::move(sp));
-	      art::Ptr<recob::SpacePoint> apsp(spid, outputSpacePoints->size()-1, spidgetter);
-	      outputHitSpacePointAssn->addSingle(trhit, apsp);
-	    }
-	    ip++;
-	  }
-	  outputPFAssn->addSingle(art::Ptr<recob::PFParticle>(inputPFParticle, iPF), aptr);
-	  outputHitInfo->emplace_back(optionals.trackFitHitInfos());
+	  job.pId = p_().options().pdgId();
+	  job.mom = p_().options().pval();
+	  job.inHits = inHits;
 	}
       }
 
     }
+
+    fitJobs(jobs);
+
+    for (auto& job : jobs) {
+      if (!job.fitok) continue;
+      //space points are stored only for the fits of showers
+      auto aptr = storeTrack(job, job.shower != nullptr);
+      outputPFAssn->addSingle(art::Ptr<recob::PFParticle>(inputPFParticle, job.iPF), aptr);
+    }
+
     e.put(std::move(outputTracks));
     e.put(std::move(outputHitsMeta));
     e.put(std::move(outputHits));
@@ -468,55 +488,29 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event & e)
       trackId = std::make_unique<art::FindManyP<anab::ParticleID>>(inputTracks, e, pidInputTag);
     }
 
+    jobs.resize(inputTracks->size());
     for (unsigned int iTrack = 0; iTrack < inputTracks->size(); ++iTrack) {
 
-      const recob::Track& track = inputTracks->at(iTrack);
+      FitJob& job = jobs[iTrack];
+      job.track = &inputTracks->at(iTrack);
       art::Ptr<recob::Track> ptrack(inputTracks, iTrack);
-      const int pId = setPId(iTrack, trackId);
-      const double mom = setMomValue(ptrack, trackCalo, pMC, pId);
-      const bool flipDir = setDirFlip(track, mcdir);
+      job.pId = setPId(iTrack, trackId);
+      job.mom = setMomValue(ptrack, trackCalo, pMC, job.pId);
+      job.flipDir = setDirFlip(*job.track, mcdir);
 
       //this is not computationally optimal, but at least preserves the order unlike FindManyP
-      std::vector<art::Ptr<recob::Hit> > inHits;
       for (auto it = tkHitsAssn.begin(); it!=tkHitsAssn.end(); ++it) {
-	if (it->first == ptrack) inHits.push_back(it->second);
-	else if (inHits.size()>0) break;
+	if (it->first == ptrack) job.inHits.push_back(it->second);
+	else if (job.inHits.size()>0) break;
       }
+    }
 
-      recob::Track outTrack;
-      std::vector<art::Ptr<recob::Hit> > outHits;
-      trkmkr::OptionalOutputs optionals;
-      if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-      bool fitok = kalmanFitter.fitTrack(track.Trajectory(),track.ID(),
-					  track.VertexCovarianceLocal5D(),track.EndCovarianceLocal5D(),
-					  inHits, mom, pId, flipDir, outTrack, outHits, optionals);
-      if (!fitok) continue;
-
-      if (p_().options().keepInputTrajectoryPoints()) {
-	restoreInputPoints(track.Trajectory().Trajectory(),inHits,outTrack,outHits);
-      }
+    fitJobs(jobs);
 
-      outputTracks->emplace_back(std::move(outTrack));
-      art::Ptr<recob::Track> aptr(tid, outputTracks->size()-1, tidgetter);
-      unsigned int ip = 0;
-      for (auto const& trhit: outHits) {
-	//the fitter produces collections with 1-1 match between hits and point
-	recob::TrackHitMeta metadata(ip,-1);
-	outputHitsMeta->addSingle(aptr, trhit, metadata);
-	outputHits->addSingle(aptr, trhit);
-	if (p_().options().produceSpacePoints() && outputTracks->back().HasValidPoint(ip)) {
-	  auto& tp = outputTracks->back().Trajectory().LocationAtPoint(ip);
-	  double fXYZ[3] = {tp.X(),tp.Y(),tp.Z()};
-	  double fErrXYZ[6] = {0};
-	  recob::SpacePoint sp(fXYZ, fErrXYZ, -1.);
-	  outputSpacePoints->emplace_back(std::move(sp));
-	  art::Ptr<recob::SpacePoint> apsp(spid, outputSpacePoints->size()-1, spidgetter);
-	  outputHitSpacePointAssn->addSingle(trhit, apsp);
-	}
-	ip++;
-      }
-      outputHitInfo->emplace_back(optionals.trackFitHitInfos());
+    for (auto& job : jobs) {
+      if (job.fitok) storeTrack(job, true);
     }
+
     e.put(std::move(outputTracks));
     e.put(std::move(outputHitsMeta));
     e.put(std::move(outputHits));
@@ -530,6 +524,42 @@ void trkf::KalmanFilterFinalTrackFitter::produce(art::Event & e)
   }
 }
 
+void trkf::KalmanFilterFinalTrackFitter::fitJob(FitJob& job, const trkf::TrackKalmanFitter& fitter) const {
+  if (p_().options().produceTrackFitHitInfo()) job.optionals.initTrackFitInfos();
+  if (job.track) {
+    const recob::Track& track = *job.track;
+    job.fitok = fitter.fitTrack(track.Trajectory(),track.ID(),
+				track.VertexCovarianceLocal5D(),track.EndCovarianceLocal5D(),
+				job.inHits, job.mom, job.pId, job.flipDir, job.outTrack, job.outHits, job.optionals);
+    if (job.fitok && p_().options().keepInputTrajectoryPoints()) {
+      restoreInputPoints(track.Trajectory().Trajectory(),job.inHits,job.outTrack,job.outHits);
+    }
+  } else {
+    const recob::Shower& shower = *job.shower;
+    Point_t pos(shower.ShowerStart().X(),shower.ShowerStart().Y(),shower.ShowerStart().Z());
+    Vector_t dir(shower.Direction().X(),shower.Direction().Y(),shower.Direction().Z());
+    auto cov = SMatrixSym55();
+    job.fitok = fitter.fitTrack(pos, dir, cov, job.inHits, std::vector<recob::TrajectoryPointFlags>(),
+				shower.ID(), job.mom, job.pId,
+				job.outTrack, job.outHits, job.optionals);
+  }
+}
+
+void trkf::KalmanFilterFinalTrackFitter::fitJobs(std::vector<FitJob>& jobs) const {
+  //each thread has its own fitter and propagator; the jobs are dealt out in turn since the fit time grows with the number of hits
+  const size_t numGroups = std::min(workers.size()+1, jobs.size());
+  auto fitGroup = [&](const size_t group) {
+    const auto& fitter = group == 0 ? kalmanFitter : workers[group-1]->kalmanFitter;
+    for (size_t iJob = group; iJob < jobs.size(); iJob += numGroups) fitJob(jobs[iJob], fitter);
+  };
+  if (numGroups > 1) {
+    tbb::task_arena arena(numGroups);
+    arena.execute([&] { tbb::parallel_for(size_t(0), numGroups, fitGroup); });
+  }
+  else if (numGroups == 1)
+    fitGroup(0);
+}
+
 void trkf::KalmanFilterFinalTrackFitter::restoreInputPoints(const recob::Trajectory& track,const std::vector<art::Ptr<recob::Hit> >& inHits,recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits) const {
   const auto np = outTrack.NumberTrajectoryPoints();
   std::vector<Point_t>                     positions(np);
@@ -26,6 +26,10 @@
 
 #include "lardataobj/MCBase/MCTrack.h"
 
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include <algorithm>
 #include <memory>
 
 namespace trkf {
@@ -101,6 +105,11 @@ namespace trkf {
         Name("keepInputTrajectoryPoints"),
         Comment("Option to keep positions and directions from input trajectory. The fit will provide only covariance matrices, chi2, ndof, particle Id and absolute momentum. It may also modify the trajectory point flags. In order to avoid inconsistencies, it has to be used with the following fitter options all set to false: sortHitsByPlane, sortOutputHitsMinLength, skipNegProp.")
       };
+      fhicl::Atom<unsigned int> numThreads {
+        Name("numThreads"),
+        Comment("Number of threads fitting the trajectories of an event concurrently. The outputs are in the same order for any number of threads."),
+        1
+      };
     };
 
     struct Config {
@@ -131,9 +140,25 @@ namespace trkf {
   private:
     void produce(art::Event & e) override;
 
+    /// Propagator and fitter used by one of the extra threads (the fitter keeps a pointer to the propagator)
+    struct Worker {
+      explicit Worker(Parameters const & p) : prop{p().propagator}, kalmanFitter{&prop, p().fitter} {}
+      TrackStatePropagator prop;
+      trkf::TrackKalmanFitter kalmanFitter;
+    };
+
+    /// Outputs of the fit of one trajectory, kept until they are stored in input order
+    struct FitResult {
+      bool fitok = false;
+      recob::Track outTrack;
+      std::vector<art::Ptr<recob::Hit> > outHits;
+      trkmkr::OptionalOutputs optionals;
+    };
+
     Parameters p_;
     TrackStatePropagator prop;
     trkf::TrackKalmanFitter kalmanFitter;
+    std::vector<std::unique_ptr<Worker> > workers; // one per extra thread
     trkf::TrackMomentumCalculator tmc{};
 
     art::InputTag trajectoryInputTag;
@@ -146,6 +171,10 @@ namespace trkf {
     bool   setDirFlip(const recob::TrackTrajectory* ptraj, TVector3& mcdir) const;
 
     void restoreInputPoints(const recob::TrackTrajectory& track,const std::vector<art::Ptr<recob::Hit> >& inHits,recob::Track& outTrack, std::vector<art::Ptr<recob::Hit> >& outHits) const;
+
+    /// Call fit(i, fitter) for i in [0, n), over numThreads threads each with its own fitter
+    template <typename Func>
+    void fitConcurrently(size_t n, Func const& fit) const;
   };
 }
 
@@ -160,6 +189,9 @@ trkf::KalmanFilterTrajectoryFitter::KalmanFilterTrajectoryFitter(trkf::KalmanFil
 
   isTT = p_().inputs().isTrackTrajectory();
 
+  for (unsigned int thread = 1; thread < p_().options().numThreads(); ++thread)
+    workers.push_back(std::make_unique<Worker>(p_));
+
   produces<std::vector<recob::Track> >();
   produces<art::Assns<recob::Track, recob::Hit> >();
   produces<art::Assns<recob::Track, recob::Hit, recob::TrackHitMeta> >();
@@ -263,12 +295,11 @@ void trkf::KalmanFilterTrajectoryFitter::produce(art::Event & e)
     nTrajs = trajectoryVec->size();
   }
 
+  //the hits of each trajectory are collected first, then the trajectories are fit (possibly concurrently), then the outputs are stored in input order
+  std::vector<std::vector<art::Ptr<recob::Hit> > > inHitsVec(nTrajs);
   for (unsigned int iTraj = 0; iTraj < nTrajs; ++iTraj) {
-
-    const recob::TrackTrajectory& inTraj = (isTT ? trackTrajectoryVec->at(iTraj) : recob::TrackTrajectory(trajectoryVec->at(iTraj), std::vector<recob::TrajectoryPointFlags>()) );
-    //const std::vector<recob::TrajectoryPointFlags>& inFlags = (isTT ? trackTrajectoryVec->at(iTraj).Flags() : std::vector<recob::TrajectoryPointFlags>());
     //this is not computationally optimal, but at least preserves the order unlike FindManyP
-    std::vector<art::Ptr<recob::Hit> > inHits;
+    std::vector<art::Ptr<recob::Hit> >& inHits = inHitsVec[iTraj];
     if (isTT) {
       for (auto it = trackTrajectoryHitsAssn->begin(); it!=trackTrajectoryHitsAssn->end(); ++it) {
 	if (it->first.key() == iTraj) inHits.push_back(it->second);
@@ -280,28 +311,41 @@ void trkf::KalmanFilterTrajectoryFitter::produce(art::Event & e)
 	else if (inHits.size()>0) break;
       }
     }
+  }
+
+  std::vector<FitResult> results(nTrajs);
+  fitConcurrently(nTrajs, [&](const unsigned int iTraj, const trkf::TrackKalmanFitter& fitter) {
+
+    const recob::TrackTrajectory& inTraj = (isTT ? trackTrajectoryVec->at(iTraj) : recob::TrackTrajectory(trajectoryVec->at(iTraj), std::vector<recob::TrajectoryPointFlags>()) );
+    //const std::vector<recob::TrajectoryPointFlags>& inFlags = (isTT ? trackTrajectoryVec->at(iTraj).Flags() : std::vector<recob::TrajectoryPointFlags>());
+    const std::vector<art::Ptr<recob::Hit> >& inHits = inHitsVec[iTraj];
     const int pId = setPId();
+    // runs in the fit threads: the range-based estimate of tmc keeps no state
     const double mom = setMomValue(&inTraj, pMC, pId);
     const bool flipDir = setDirFlip(&inTraj, mcdir);
 
-    recob::Track outTrack;
-    std::vector<art::Ptr<recob::Hit> > outHits;
-    trkmkr::OptionalOutputs optionals;
-    if (p_().options().produceTrackFitHitInfo()) optionals.initTrackFitInfos();
-    bool fitok = kalmanFitter.fitTrack(inTraj,iTraj,
-					SMatrixSym55(),SMatrixSym55(),
-					inHits,//inFlags,
-					mom, pId, flipDir, outTrack, outHits, optionals);
-    if (!fitok) continue;
+    FitResult& result = results[iTraj];
+    if (p_().options().produceTrackFitHitInfo()) result.optionals.initTrackFitInfos();
+    result.fitok = fitter.fitTrack(inTraj,iTraj,
+				   SMatrixSym55(),SMatrixSym55(),
+				   inHits,//inFlags,
+				   mom, pId, flipDir, result.outTrack, result.outHits, result.optionals);
+    if (!result.fitok) return;
 
     if (p_().options().keepInputTrajectoryPoints()) {
-      restoreInputPoints(inTraj,inHits,outTrack,outHits);
+      restoreInputPoints(inTraj,inHits,result.outTrack,result.outHits);
     }
+  });
+
+  for (unsigned int iTraj = 0; iTraj < nTrajs; ++iTraj) {
 
-    outputTracks->emplace_back(std::move(outTrack));
+    FitResult& result = results[iTraj];
+    if (!result.fitok) continue;
+
+    outputTracks->emplace_back(std::move(result.outTrack));
     art::Ptr<recob::Track> aptr(tid, outputTracks->size()-1, tidgetter);
     unsigned int ip = 0;
-    for (auto const& trhit: outHits) {
+    for (auto const& trhit: result.outHits) {
       //the fitter produces collections with 1-1 match between hits and point
       recob::TrackHitMeta metadata(ip,-1);
       outputHitsMeta->addSingle(aptr, trhit, metadata);
@@ -317,7 +361,7 @@ void trkf::KalmanFilterTrajectoryFitter::produce(art::Event & e)
       }
       ip++;
     }
-    outputHitInfo->emplace_back(optionals.trackFitHitInfos());
+    outputHitInfo->emplace_back(result.optionals.trackFitHitInfos());
     if (isTT) {
       outputTTjTAssn->addSingle(art::Ptr<recob::TrackTrajectory>(inputTrackTrajectoryH, iTraj),aptr);
     } else {
@@ -395,4 +439,20 @@ bool trkf::KalmanFilterTrajectoryFitter::setDirFlip(const recob::TrackTrajectory
   return result;
 }
 
+template <typename Func>
+void trkf::KalmanFilterTrajectoryFitter::fitConcurrently(size_t n, Func const& fit) const {
+  //each thread has its own fitter and propagator; the fits are dealt out in turn since the fit time grows with the number of hits
+  const size_t numGroups = std::min(workers.size()+1, n);
+  auto fitGroup = [&](const size_t group) {
+    const auto& fitter = group == 0 ? kalmanFitter : workers[group-1]->kalmanFitter;
+    for (size_t i = group; i < n; i += numGroups) fit(i, fitter);
+  };
+  if (numGroups > 1) {
+    tbb::task_arena arena(numGroups);
+    arena.execute([&] { tbb::parallel_for(size_t(0), numGroups, fitGroup); });
+  }
+  else if (numGroups == 1)
+    fitGroup(0);
+}
+
 DEFINE_ART_MODULE(trkf::KalmanFilterTrajectoryFitter)
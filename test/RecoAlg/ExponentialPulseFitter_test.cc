@@ -0,0 +1,206 @@
+/**
+ * @file   ExponentialPulseFitter_test.cc
+ * @brief  Test for the fitter in ExponentialPulseFitter.h
+ * @see    ExponentialPulseFitter.h
+ *
+ * The pulse shape is checked against its analytic properties: the rising and
+ * falling slopes are set by tau1 and tau2, and PulseMaximumX() is where the
+ * derivative vanishes. Fits of noiseless pulse trains must give back the
+ * time constants they were made with, and a fit of a noisy pulse train is
+ * compared with the bounded ROOT fit DPRawHitFinder used to do.
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility> // std::make_pair()
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( ExponentialPulseFitter_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// ROOT libraries
+#include "TH1F.h"
+#include "TF1.h"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/ExponentialPulseFitter.h"
+
+
+using Fitter_t = hit::ExponentialPulseFitter;
+
+
+/// Samples a pulse train at the centre of each tick, with Gaussian noise
+std::vector<float> SamplePulses(
+  std::size_t nTicks, std::size_t nPulses, bool sameShape,
+  std::vector<double> const& params, double noise = 0.
+) {
+  std::mt19937 rng(4321);
+  std::normal_distribution<double> gaus(0., noise);
+  std::vector<float> ticks(nTicks);
+  for (std::size_t i = 0; i < nTicks; ++i) {
+    ticks[i] = Fitter_t::Eval(nPulses, sameShape, params.data(), i + 0.5);
+    if (noise > 0.) ticks[i] += gaus(rng);
+  }
+  return ticks;
+} // SamplePulses()
+
+
+/// Logarithmic derivative of a single pulse at x, by finite differences
+double LogSlope(std::vector<double> const& params, double x) {
+  double const h = 1e-3;
+  return (std::log(Fitter_t::Eval(1, true, params.data(), x + h))
+    - std::log(Fitter_t::Eval(1, true, params.data(), x - h))) / (2. * h);
+} // LogSlope()
+
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE( ExponentialPulseFitterSuite )
+
+
+BOOST_AUTO_TEST_CASE(PulseShapeTest)
+{
+  // tau1, tau2, amplitude, t0
+  std::vector<double> const params { 3.0, 0.9, 60., 20. };
+
+  // half of the amplitude at t0
+  BOOST_CHECK_CLOSE(Fitter_t::Eval(1, true, params.data(), 20.), 30., 1e-10);
+
+  // well before t0 the pulse rises as exp(0.4 x / tau1), well after it falls
+  // as exp(0.4 x / tau1 - 0.4 x / tau2)
+  BOOST_CHECK_CLOSE(LogSlope(params, -20.), 0.4 / 3.0, 1e-4);
+  BOOST_CHECK_CLOSE(LogSlope(params, 60.), 0.4 / 3.0 - 0.4 / 0.9, 1e-4);
+} // BOOST_AUTO_TEST_CASE(PulseShapeTest)
+
+
+BOOST_AUTO_TEST_CASE(PulseMaximumTest)
+{
+  for (double tau2: { 0.5, 0.9, 1.5, 2.9 }) {
+    double const tau1 = 3.0;
+    std::vector<double> const params { tau1, tau2, 1., 20. };
+
+    double const xMax = Fitter_t::PulseMaximumX(20., tau1, tau2, 0., 100.);
+
+    // the closed form, where the derivative of the pulse vanishes
+    BOOST_CHECK_CLOSE
+      (xMax, 20. + tau2 / 0.4 * std::log(tau2 / (tau1 - tau2)), 1e-10);
+    BOOST_CHECK_SMALL(LogSlope(params, xMax), 1e-6);
+    BOOST_CHECK_GT(LogSlope(params, xMax - 0.1), 0.);
+    BOOST_CHECK_LT(LogSlope(params, xMax + 0.1), 0.);
+  } // for
+
+  // a maximum out of the range is moved to the nearest end
+  BOOST_CHECK_EQUAL(Fitter_t::PulseMaximumX(20., 3.0, 0.9, 25., 45.), 25.);
+  BOOST_CHECK_EQUAL(Fitter_t::PulseMaximumX(20., 3.0, 2.9, 5., 30.), 30.);
+
+  // a pulse that never turns down peaks at the end of the range
+  BOOST_CHECK_EQUAL(Fitter_t::PulseMaximumX(20., 0.8, 0.9, 5., 45.), 45.);
+  BOOST_CHECK_EQUAL(Fitter_t::PulseMaximumX(20., 0.9, 0.9, 5., 45.), 45.);
+} // BOOST_AUTO_TEST_CASE(PulseMaximumTest)
+
+
+BOOST_AUTO_TEST_CASE(RiseAndFallTimesTest)
+{
+  // a slow and a fast pulse, each fitted from the time constants of the other
+  std::vector<double> const slow { 4.0, 2.0, 40., 18. };
+  std::vector<double> const fast { 1.5, 0.6, 80., 14. };
+
+  std::vector<double> const parMin { 0.1, 0.1, 1., 5. };
+  std::vector<double> const parMax { 10., 10., 200., 30. };
+
+  Fitter_t fitter;
+  for (auto const& [ truth, start ]: { std::make_pair(slow, fast), std::make_pair(fast, slow) }) {
+    std::vector<float> const ticks = SamplePulses(40, 1, true, truth);
+    fitter.SetData(ticks.data(), ticks.size(), 0.5, true);
+
+    std::vector<double> params(start);
+    BOOST_REQUIRE(fitter.Fit(1, true, params, parMin, parMax));
+
+    BOOST_CHECK_EQUAL(fitter.NDF(), 36);
+    for (std::size_t p = 0; p < truth.size(); ++p)
+      BOOST_CHECK_CLOSE(params[p], truth[p], 0.01);
+  } // for
+} // BOOST_AUTO_TEST_CASE(RiseAndFallTimesTest)
+
+
+BOOST_AUTO_TEST_CASE(SameShapeTest)
+{
+  // two pulses sharing the time constants, the second one on the tail of the
+  // first: tau1, tau2, then amplitude and t0 of each pulse
+  std::vector<double> const truth
+    { 3.0, 0.9,  60., 15.,  35., 27. };
+  std::vector<double> params
+    { 2.0, 1.2,  50., 14.,  40., 26. };
+  std::vector<double> const parMin
+    { 0.1, 0.1,  5., 10.,  5., 22. };
+  std::vector<double> const parMax
+    { 10., 10.,  100., 20.,  80., 32. };
+
+  // empty ticks are left out of the fit
+  std::vector<float> ticks = SamplePulses(50, 2, true, truth);
+  for (std::size_t i = 0; i < 4; ++i) ticks[i] = 0.f;
+
+  Fitter_t fitter;
+  fitter.SetData(ticks.data(), ticks.size(), 0.5, true);
+  BOOST_REQUIRE(fitter.Fit(2, true, params, parMin, parMax));
+
+  BOOST_CHECK_EQUAL(fitter.NDF(), 50 - 4 - 6);
+  for (std::size_t p = 0; p < truth.size(); ++p)
+    BOOST_CHECK_CLOSE(params[p], truth[p], 0.01);
+} // BOOST_AUTO_TEST_CASE(SameShapeTest)
+
+
+BOOST_AUTO_TEST_CASE(CompareWithROOTTest)
+{
+  // two pulses with their own shape, fitted with the DPRawHitFinder formula
+  // and options, with the t0 of each pulse in its denominator
+  std::vector<double> const truth
+    { 3.0, 0.9, 60., 15.,   2.2, 1.2, 35., 27. };
+  std::vector<double> const start
+    { 2.0, 0.5, 50., 14.,   1.5, 0.8, 40., 26. };
+  std::vector<double> const parMin
+    { 0.1, 0.1, 5., 10.,   0.1, 0.1, 5., 22. };
+  std::vector<double> const parMax
+    { 10., 10., 100., 20.,   10., 10., 80., 32. };
+  std::size_t const nParams = truth.size();
+
+  std::vector<float> const ticks = SamplePulses(50, 2, false, truth, 0.3);
+  double const roiSize = ticks.size();
+
+  std::string eqn;
+  for (int first: { 0, 4 }) {
+    auto const par = [first](int p){ return "[" + std::to_string(first + p) + "]"; };
+    if (!eqn.empty()) eqn += "+";
+    eqn += par(2) + "*exp(0.4*(x-" + par(3) + ")/" + par(0) + ")"
+      "/(1+exp(0.4*(x-" + par(3) + ")/" + par(1) + "))";
+  } // for
+
+  TH1F hitSignal("hitSignal", "", ticks.size(), 0., roiSize);
+  hitSignal.Sumw2();
+  for (std::size_t i = 0; i < ticks.size(); ++i)
+    hitSignal.SetBinContent(i + 1, ticks[i]);
+
+  TF1 Exponentials("Exponentials", eqn.c_str(), 0., roiSize);
+  for (std::size_t p = 0; p < nParams; ++p) {
+    Exponentials.SetParameter(p, start[p]);
+    Exponentials.SetParLimits(p, parMin[p], parMax[p]);
+  }
+  BOOST_REQUIRE_EQUAL(hitSignal.Fit(&Exponentials, "QNRWM", "", 0., roiSize), 0);
+
+  std::vector<double> params(start);
+  Fitter_t fitter;
+  fitter.SetData(ticks.data(), ticks.size(), 0.5, true);
+  BOOST_REQUIRE(fitter.Fit(2, false, params, parMin, parMax));
+
+  BOOST_CHECK_EQUAL(fitter.NDF(), Exponentials.GetNDF());
+  BOOST_CHECK_CLOSE(fitter.Chi2(), Exponentials.GetChisquare(), 0.1);
+  for (std::size_t p = 0; p < nParams; ++p) {
+    BOOST_CHECK_CLOSE(params[p], Exponentials.GetParameter(p), 0.1);
+    BOOST_CHECK_CLOSE(fitter.ParErrors()[p], Exponentials.GetParError(p), 10.);
+  }
+} // BOOST_AUTO_TEST_CASE(CompareWithROOTTest)
+
+
+BOOST_AUTO_TEST_SUITE_END()
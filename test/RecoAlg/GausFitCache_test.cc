@@ -14,6 +14,8 @@
 #include <cmath>
 #include <array>
 #include <limits> // std::numeric_limits<>
+#include <algorithm> // std::copy()
+#include <vector>
 // #include <iostream>
 
 // boost test libraries
@@ -396,6 +398,121 @@ BOOST_AUTO_TEST_CASE(ThreeGaussianTest)
 } // BOOST_AUTO_TEST_CASE(ThreeGaussianTest)
 
 
+// Test that the vectorizable exponential matches std::exp()
+BOOST_AUTO_TEST_CASE(BatchExpTest)
+{
+  std::vector<double> values;
+  for (double x = -700.; x <= 0.; x += 0.37) values.push_back(x);
+  std::vector<double> const args = values;
+
+  hit::details::batch_exp(values.data(), values.size());
+
+  for (size_t i = 0; i < args.size(); ++i) {
+    // we use tolerance of 10^-12 (10^-10 %)
+    BOOST_CHECK_CLOSE(values[i], std::exp(args[i]), 1e-10);
+  } // for
+
+} // BOOST_AUTO_TEST_CASE(BatchExpTest)
+
+
+// Test that the batched three-Gaussian function and its gradient behave as
+// the TF1 one
+BOOST_AUTO_TEST_CASE(BatchedThreeGaussianTest)
+{
+
+  const Double_t Params[] = {
+    4.0, -2.0, 1.5,
+    5.0,  0.1, 0.3,
+    2.0,  1.0, 0.5
+  }; // Params[]
+  constexpr size_t NParams = 9;
+
+  // more points than a block, to cross a block boundary
+  std::vector<Double_t> x;
+  for (double xv = -10.; xv <= +10.; xv += 0.1) x.push_back(xv);
+  const size_t n = x.size();
+
+  std::vector<Double_t> values(n), gradients(NParams * n), generic(n);
+  hit::details::CompiledGausFitCacheBaseStruct::ngaus_batch<3>
+    (x.data(), n, Params, values.data(), gradients.data());
+
+  // the run-time dispatched kernel must agree with the compiled one
+  hit::CompiledGausFitCache<3> GausCache("BatchedGaussians");
+  GausCache.EvalBatch(3, x.data(), n, Params, generic.data());
+
+  for (size_t i = 0; i < n; ++i) {
+    const Double_t expected
+      = hit::details::CompiledGausFitCacheBaseStruct::ngaus<3>(&x[i], Params);
+
+    // we use tolerance of 10^-5 (0.001%)
+    BOOST_CHECK_CLOSE(values[i], expected, 0.001);
+    BOOST_CHECK_EQUAL(generic[i], values[i]);
+
+    // derivatives, compared with a numeric estimation
+    for (size_t iParam = 0; iParam < NParams; ++iParam) {
+      Double_t shifted[NParams];
+      std::copy(Params, Params + NParams, shifted);
+      const Double_t h = 1e-6;
+      shifted[iParam] = Params[iParam] + h;
+      const Double_t up
+        = hit::details::CompiledGausFitCacheBaseStruct::ngaus<3>(&x[i], shifted);
+      shifted[iParam] = Params[iParam] - h;
+      const Double_t down
+        = hit::details::CompiledGausFitCacheBaseStruct::ngaus<3>(&x[i], shifted);
+
+      BOOST_CHECK_SMALL(gradients[iParam * n + i] - (up - down) / (2. * h), 1e-6);
+    } // for parameters
+  } // for x
+
+} // BOOST_AUTO_TEST_CASE(BatchedThreeGaussianTest)
+
+
+// Test that the batched truncated Gaussians behave as the TF1 ones, and that
+// the unrolled kernels agree with the generic loop
+BOOST_AUTO_TEST_CASE(BatchedTruncatedGaussianTest)
+{
+
+  const Double_t Params[] = {
+    4.0, -2.0, 1.5,
+    5.0,  0.1, 0.3,
+  }; // Params[]
+  constexpr size_t NParams = 6;
+
+  std::vector<Double_t> x;
+  for (double xv = -10.; xv <= +10.; xv += 0.1) x.push_back(xv);
+  const size_t n = x.size();
+
+  std::vector<Double_t> values(n), gradients(NParams * n);
+  std::vector<Double_t> generic(n), genericGradients(NParams * n);
+  hit::CompiledTruncatedGausFitCache<2, 4> GausCache("BatchedTruncGaussians");
+  GausCache.EvalBatch(2, x.data(), n, Params, values.data(), gradients.data());
+  hit::details::ngaus_batch_impl
+    (2, x.data(), n, Params, generic.data(), genericGradients.data(), 4.);
+
+  for (size_t i = 0; i < n; ++i) {
+    const Double_t expected = hit::details::CompiledGausFitCacheBaseStruct
+      ::ngaus_trunc<2, 4>(&x[i], Params);
+
+    // we use tolerance of 10^-5 (0.001%)
+    BOOST_CHECK_CLOSE(values[i], expected, 0.001);
+    BOOST_CHECK_EQUAL(generic[i], values[i]);
+
+    for (size_t iParam = 0; iParam < NParams; ++iParam) {
+      BOOST_CHECK_EQUAL
+        (genericGradients[iParam * n + i], gradients[iParam * n + i]);
+    } // for parameters
+
+    // beyond the cut-off, there is no dependence on the parameters
+    if (std::abs(x[i] - Params[1]) >= 4. * Params[2]) {
+      BOOST_CHECK_EQUAL(gradients[0 * n + i], 0.);
+      BOOST_CHECK_EQUAL(gradients[1 * n + i], 0.);
+      BOOST_CHECK_EQUAL(gradients[2 * n + i], 0.);
+    }
+  } // for x
+
+} // BOOST_AUTO_TEST_CASE(BatchedTruncatedGaussianTest)
+
+
 // Test a fit with a three-Gaussian function from the run-time generated cache
 BOOST_AUTO_TEST_CASE(RunTimeThreeGaussianFitTest)
 {
@@ -0,0 +1,199 @@
+/**
+ * @file   GausLMFitter_test.cc
+ * @brief  Test for the fitter in GausLMFitter.h
+ * @see    GausLMFitter.h
+ *
+ * The results are compared with the ones of a bounded ROOT fit of the same
+ * waveform with a function from GausFitCache, set up the same way
+ * PeakFitterGaussian does it, or of the graph fit CCHitFinderAlg used to do.
+ *
+ * The waveforms are synthetic: sums of Gaussians with a deterministic ripple
+ * standing in for the noise, since no recorded regions of interest are
+ * available to the unit tests. A comparison on recorded data is left to the
+ * HitFinderBenchmark module, which runs both fitters on the same input.
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <string>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( GausLMFitter_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// ROOT libraries
+#include "TGraph.h"
+#include "TH1F.h"
+#include "TF1.h"
+
+// LArSoft libraries
+#include "larreco/RecoAlg/GausFitCache.h"
+#include "larreco/RecoAlg/GausLMFitter.h"
+
+
+template <typename T>
+inline T sqr(T v) { return v*v; }
+
+
+/// Builds a waveform with the given Gaussians and a deterministic ripple
+std::vector<float> MakeWaveform
+  (std::size_t nSamples, std::vector<double> const& params, double ripple)
+{
+  std::vector<float> waveform(nSamples, 0.f);
+  for (std::size_t i = 0; i < nSamples; ++i) {
+    double const x = i + 0.5;
+    double value = ripple * std::sin(1.7 * i);
+    for (std::size_t p = 0; p + 2 < params.size(); p += 3)
+      value += params[p] * std::exp(-0.5 * sqr((x - params[p+1]) / params[p+2]));
+    waveform[i] = value;
+  } // for
+  return waveform;
+} // MakeWaveform()
+
+
+/// Fits the waveform with both fitters and compares the results
+void CompareWithROOT(
+  std::vector<float> const& waveform,
+  std::vector<double> const& start,
+  double tol
+) {
+  std::size_t const nGaus   = start.size() / 3;
+  std::size_t const nParams = 3 * nGaus + 1;
+  double const roiSize = waveform.size();
+
+  // limits as in PeakFitterGaussian
+  std::vector<double> params(start), parMin(nParams, 0.), parMax(nParams, 0.);
+  params.push_back(0.); // baseline
+  for (std::size_t p = 0; p < 3 * nGaus; p += 3) {
+    parMin[p]   = 0.1 * start[p];
+    parMax[p]   = 2.0 * start[p];
+    parMin[p+1] = std::max(start[p+1] - 2. * start[p+2], 0.);
+    parMax[p+1] = std::min(start[p+1] + 2. * start[p+2], roiSize);
+    parMin[p+2] = std::max(0.5, 0.1 * start[p+2]);
+    parMax[p+2] = 3. * start[p+2];
+  } // for
+
+  // ROOT fit
+  TH1F Hist("GausLMFitterTest", "", waveform.size(), 0., roiSize);
+  Hist.Sumw2();
+  for (std::size_t i = 0; i < waveform.size(); ++i)
+    Hist.SetBinContent(i + 1, waveform[i]);
+
+  hit::GausFitCache GausCache("GausLMFitterTestCache");
+  TF1& Gaus = *(GausCache.Get(nGaus));
+  for (std::size_t p = 0; p < 3 * nGaus; ++p) {
+    Gaus.SetParameter(p, params[p]);
+    Gaus.SetParLimits(p, parMin[p], parMax[p]);
+  }
+  BOOST_REQUIRE_EQUAL(Hist.Fit(&Gaus, "QNWB", "", 0., roiSize), 0);
+
+  // our fit
+  hit::GausLMFitter fitter;
+  fitter.SetData(waveform.data(), waveform.size(), 0.5, true);
+  BOOST_REQUIRE(fitter.Fit(nGaus, params, parMin, parMax, false));
+
+  BOOST_CHECK_EQUAL(fitter.NDF(), Gaus.GetNDF());
+  BOOST_CHECK_CLOSE(fitter.Chi2(), Gaus.GetChisquare(), tol * 100.);
+
+  for (std::size_t p = 0; p < 3 * nGaus; ++p) {
+    BOOST_CHECK_CLOSE(params[p], Gaus.GetParameter(p), tol * 100.);
+    BOOST_CHECK_CLOSE(fitter.ParErrors()[p], Gaus.GetParError(p), 10.);
+  }
+} // CompareWithROOT()
+
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE( GausLMFitterSuite )
+
+
+BOOST_AUTO_TEST_CASE(SingleGaussianTest)
+{
+  std::vector<double> const truth { 40., 20., 3. };
+  std::vector<double> const start { 30., 18., 4. };
+  CompareWithROOT(MakeWaveform(40, truth, 0.3), start, 1e-3);
+} // BOOST_AUTO_TEST_CASE(SingleGaussianTest)
+
+
+BOOST_AUTO_TEST_CASE(TwoGaussianTest)
+{
+  std::vector<double> const truth { 40., 20., 3.,  25., 28., 2.5 };
+  std::vector<double> const start { 30., 18., 4.,  20., 30., 2.  };
+  CompareWithROOT(MakeWaveform(60, truth, 0.3), start, 1e-3);
+} // BOOST_AUTO_TEST_CASE(TwoGaussianTest)
+
+
+BOOST_AUTO_TEST_CASE(FourGaussianTest)
+{
+  std::vector<double> const truth
+    { 12., 10., 2.,  30., 17., 2.5,  22., 25., 3.,  8., 33., 2. };
+  std::vector<double> const start
+    { 10., 11., 2.,  25., 16., 2.,   20., 24., 3.,  9., 34., 2. };
+  CompareWithROOT(MakeWaveform(45, truth, 0.2), start, 1e-3);
+} // BOOST_AUTO_TEST_CASE(FourGaussianTest)
+
+
+BOOST_AUTO_TEST_CASE(FloatingBaselineTest)
+{
+  std::vector<double> const truth { 40., 20., 3. };
+  std::vector<float> waveform = MakeWaveform(40, truth, 0.);
+  for (float& sample: waveform) sample += 2.5;
+
+  std::vector<double> params { 30., 18., 4., 0. };
+  std::vector<double> const parMin { 3., 10., 0.5, -12. };
+  std::vector<double> const parMax { 60., 26., 12., 12. };
+
+  hit::GausLMFitter fitter;
+  fitter.SetData(waveform.data(), waveform.size(), 0.5, true);
+  BOOST_REQUIRE(fitter.Fit(1, params, parMin, parMax, true));
+
+  BOOST_CHECK_EQUAL(fitter.NDF(), 36);
+  BOOST_CHECK_CLOSE(params[0], 40., 0.01);
+  BOOST_CHECK_CLOSE(params[1], 20., 0.01);
+  BOOST_CHECK_CLOSE(params[2],  3., 0.01);
+  BOOST_CHECK_CLOSE(params[3],  2.5, 0.01);
+} // BOOST_AUTO_TEST_CASE(FloatingBaselineTest)
+
+
+BOOST_AUTO_TEST_CASE(CCHitFinderGraphFitTest)
+{
+  // the fit CCHitFinderAlg used to do: a TGraph of the signal against the tick
+  // number, unit weights and bounded parameters ("WNQB"), no baseline
+  std::vector<double> const truth { 40., 12., 3.,  25., 19., 2.5 };
+  std::vector<float> const signl = MakeWaveform(32, truth, 0.3);
+  std::size_t const npt = signl.size();
+  double const minRMS = 3.;
+
+  // starting values and limits as in CCHitFinderAlg::FitNG(), from the bumps
+  std::vector<double> params { signl[12], 12., minRMS,  signl[19], 19., minRMS, 0. };
+  std::vector<double> const parMin { 0., 0., 1.,  0., 0., 1.,  0. };
+  std::vector<double> const parMax
+    { 9999., double(npt), 3. * minRMS,  9999., double(npt), 3. * minRMS,  0. };
+
+  TGraph graph(npt);
+  for (std::size_t i = 0; i < npt; ++i) graph.SetPoint(i, i, signl[i]);
+
+  hit::GausFitCache GausCache("CCHitFinderGraphFitTestCache");
+  TF1& Gaus = *(GausCache.Get(2));
+  for (std::size_t p = 0; p < 6; ++p) {
+    Gaus.SetParameter(p, params[p]);
+    Gaus.SetParLimits(p, parMin[p], parMax[p]);
+  }
+  BOOST_REQUIRE_EQUAL(graph.Fit(&Gaus, "WNQB"), 0);
+
+  hit::GausLMFitter fitter;
+  fitter.SetData(signl.data(), npt, 0., false);
+  BOOST_REQUIRE(fitter.Fit(2, params, parMin, parMax, false));
+
+  BOOST_CHECK_EQUAL(fitter.NDF(), Gaus.GetNDF());
+  BOOST_CHECK_CLOSE(fitter.Chi2(), Gaus.GetChisquare(), 0.1);
+
+  // the errors are scaled by sqrt(chi2/NDF) in both
+  for (std::size_t p = 0; p < 6; ++p) {
+    BOOST_CHECK_CLOSE(params[p], Gaus.GetParameter(p), 0.1);
+    BOOST_CHECK_CLOSE(fitter.ParErrors()[p], Gaus.GetParError(p), 10.);
+  }
+} // BOOST_AUTO_TEST_CASE(CCHitFinderGraphFitTest)
+
+
+BOOST_AUTO_TEST_SUITE_END()
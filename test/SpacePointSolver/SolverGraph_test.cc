@@ -0,0 +1,193 @@
+/**
+ * @file   SolverGraph_test.cc
+ * @brief  Test for the flattened space point solver in SolverGraph.h
+ * @see    SolverGraph.h
+ *
+ * The graph sums the metric in a different order than the pointer-based
+ * objects it is built from, so the results are compared within a
+ * floating-point tolerance rather than exactly.
+ */
+
+// C/C++ standard libraries
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+// boost test libraries
+#define BOOST_TEST_MODULE ( SolverGraph_test )
+#include "cetlib/quiet_unit_test.hpp"
+
+// LArSoft libraries
+#include "larreco/SpacePointSolver/SolverGraph.h"
+
+
+/// A small system of wires and space charges with neighbours
+struct TestSystem {
+
+  std::vector<InductionWireHit*> iwires;
+  std::vector<CollectionWireHit*> cwires;
+  std::vector<SpaceCharge*> orphanSCs;
+
+  TestSystem(unsigned int nCWires, unsigned int nIWires, unsigned int seed)
+    {
+      std::mt19937 rng(seed);
+      std::uniform_real_distribution<double> charge(1., 10.);
+      std::uniform_int_distribution<unsigned int> nCross(1, 4);
+      std::uniform_int_distribution<unsigned int> iwire(0, nIWires - 1);
+
+      for(unsigned int i = 0; i < 2*nIWires; ++i)
+        iwires.push_back(new InductionWireHit(i, charge(rng)));
+
+      std::vector<std::vector<SpaceCharge*>> crossings(nCWires);
+      std::vector<SpaceCharge*> scs;
+      for(unsigned int i = 0; i < nCWires; ++i){
+        for(unsigned int j = nCross(rng); j > 0; --j){
+          crossings[i].push_back
+            (new SpaceCharge(i, j, 0, nullptr, iwires[iwire(rng)],
+                             iwires[nIWires + iwire(rng)]));
+          scs.push_back(crossings[i].back());
+        }
+      }
+      for(unsigned int i = 0; i < nCWires / 4; ++i){
+        orphanSCs.push_back
+          (new SpaceCharge(i + 0.5, 0, 0, nullptr, iwires[iwire(rng)],
+                           iwires[nIWires + iwire(rng)]));
+        scs.push_back(orphanSCs.back());
+      }
+
+      // symmetric neighbours between nearby space charges
+      for(unsigned int i = 0; i < scs.size(); ++i){
+        for(unsigned int j = i+1; j < scs.size(); ++j){
+          const double dist = std::hypot(scs[i]->fX - scs[j]->fX,
+                                         scs[i]->fY - scs[j]->fY);
+          if(dist > 1.5) continue;
+          const double coupling = 0.5 * std::exp(-dist);
+          scs[i]->fNeighbours.emplace_back(scs[j], coupling);
+          scs[j]->fNeighbours.emplace_back(scs[i], coupling);
+        }
+      }
+
+      for(unsigned int i = 0; i < nCWires; ++i){
+        cwires.push_back(new CollectionWireHit(i, charge(rng), crossings[i]));
+        for(SpaceCharge* sc: crossings[i]) sc->fCWire = cwires.back();
+      }
+    }
+
+  ~TestSystem()
+    {
+      for(CollectionWireHit* cwire: cwires) delete cwire;
+      for(SpaceCharge* sc: orphanSCs) delete sc;
+      for(InductionWireHit* iwire: iwires) delete iwire;
+    }
+
+}; // struct TestSystem
+
+
+/// The metric as computed on the objects, summing over a set of wire pointers
+double ReferenceMetric(const std::vector<CollectionWireHit*>& cwires,
+                       double alpha)
+{
+  double ret = 0;
+
+  std::set<const InductionWireHit*> iwires;
+  for(const CollectionWireHit* cwire: cwires){
+    for(const SpaceCharge* sc: cwire->fCrossings){
+      if(sc->fWire1) iwires.insert(sc->fWire1);
+      if(sc->fWire2) iwires.insert(sc->fWire2);
+
+      ret -= alpha * sc->fPred * sc->fPred;
+      ret -= alpha * sc->fPred * sc->fNeiPotential;
+    }
+  }
+
+  for(const InductionWireHit* iwire: iwires)
+    ret += (iwire->fCharge - iwire->fPred) * (iwire->fCharge - iwire->fPred);
+
+  return ret;
+} // ReferenceMetric()
+
+
+/// Compares the predictions of two graphs exactly
+void CheckSamePredictions(const SolverGraph& a, const SolverGraph& b)
+{
+  BOOST_REQUIRE_EQUAL(a.NSpaceCharges(), b.NSpaceCharges());
+  for(unsigned int sc = 0; sc < a.NSpaceCharges(); ++sc){
+    BOOST_CHECK_EQUAL(a.fSCPred[sc], b.fSCPred[sc]);
+    BOOST_CHECK_EQUAL(a.fSCNeiPotential[sc], b.fSCNeiPotential[sc]);
+  }
+  BOOST_REQUIRE_EQUAL(a.NInductionWires(), b.NInductionWires());
+  for(unsigned int iw = 0; iw < a.NInductionWires(); ++iw)
+    BOOST_CHECK_EQUAL(a.fIWPred[iw], b.fIWPred[iw]);
+} // CheckSamePredictions()
+
+
+//******************************************************************************
+BOOST_AUTO_TEST_SUITE( SolverGraphSuite )
+
+
+BOOST_AUTO_TEST_CASE(MetricTest)
+{
+  const double alpha = 0.05;
+  TestSystem system(200, 60, 12345);
+  SolverGraph graph(system.cwires, system.orphanSCs);
+
+  // we use tolerance of 10^-10 (10^-8 %)
+  BOOST_CHECK_CLOSE(Metric(graph, alpha),
+                    ReferenceMetric(system.cwires, alpha), 1e-8);
+
+  // after some iterations, copied back into the objects
+  for(int i = 0; i < 5; ++i) Iterate(graph, alpha);
+  graph.CopyPredictions(system.cwires, system.orphanSCs);
+
+  BOOST_CHECK_CLOSE(Metric(graph, alpha),
+                    ReferenceMetric(system.cwires, alpha), 1e-8);
+} // BOOST_AUTO_TEST_CASE(MetricTest)
+
+
+BOOST_AUTO_TEST_CASE(IterateTest)
+{
+  const double alpha = 0.05;
+  TestSystem system(200, 60, 54321);
+  SolverGraph graph(system.cwires, system.orphanSCs);
+
+  // the metric never increases
+  double prevMetric = Metric(graph, alpha);
+  for(int i = 0; i < 5; ++i){
+    Iterate(graph, alpha);
+    const double metric = Metric(graph, alpha);
+    BOOST_CHECK_LE(metric, prevMetric + 1e-9 * std::abs(prevMetric));
+    prevMetric = metric;
+  }
+
+  // no space charge is negative
+  for(unsigned int sc = 0; sc < graph.NSpaceCharges(); ++sc)
+    BOOST_CHECK_GE(graph.fSCPred[sc], 0.);
+} // BOOST_AUTO_TEST_CASE(IterateTest)
+
+
+BOOST_AUTO_TEST_CASE(ColoredIterateTest)
+{
+  const double alpha = 0.05;
+  TestSystem system(200, 60, 2468);
+  SolverGraph serial(system.cwires, system.orphanSCs);
+  SolverGraph threaded(system.cwires, system.orphanSCs);
+
+  const std::vector<std::vector<unsigned int>> colors = ColorWires(serial);
+
+  // every wire is in exactly one color
+  std::vector<unsigned int> count(serial.NCollectionWires(), 0);
+  for(const std::vector<unsigned int>& color: colors)
+    for(unsigned int cwire: color) ++count[cwire];
+  for(unsigned int n: count) BOOST_CHECK_EQUAL(n, 1U);
+
+  // the result does not depend on the number of threads
+  for(int i = 0; i < 5; ++i){
+    Iterate(serial, colors, alpha, 1);
+    Iterate(threaded, colors, alpha, 4);
+  }
+  CheckSamePredictions(serial, threaded);
+} // BOOST_AUTO_TEST_CASE(ColoredIterateTest)
+
+
+BOOST_AUTO_TEST_SUITE_END()